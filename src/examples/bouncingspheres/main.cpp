@@ -19,7 +19,8 @@ class MyAPI :
     public APITraits::HasCubeTopology<3>,
     public APITraits::HasOpaqueMPIDataType<BaseContainer>,
     public APITraits::HasStencil<Stencils::Moore<3, 1> >,
-    public APITraits::HasNanoSteps<2>
+    public APITraits::HasNanoSteps<2>,
+    public APITraits::HasIncrementalMigration
 {};
 
 class Sphere;
@@ -2,14 +2,12 @@
 
 using namespace LibGeoDecomp;
 
-class TemperatureRecorder;
 class RainMaker;
 
 class BushFireCell
 {
 public:
     friend void runSimulation();
-    friend class TemperatureRecorder;
     friend class RainMaker;
 
     enum State {BURNING, GUTTED};
@@ -224,38 +222,6 @@ private:
     }
 };
 
-class TemperatureRecorder : public Clonable<Writer<BushFireCell>, TemperatureRecorder>
-{
-public:
-    typedef Writer<BushFireCell>::GridType GridType;
-
-    explicit TemperatureRecorder(const unsigned outputPeriod) :
-        Clonable<Writer<BushFireCell>, TemperatureRecorder>("", outputPeriod),
-        avrgTemperature(0)
-    {}
-
-    void stepFinished(const GridType& grid, unsigned step, WriterEvent event)
-    {
-        avrgTemperature = 0;
-
-        CoordBox<2> box = grid.boundingBox();
-        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
-            avrgTemperature += grid.get(*i).temperature;
-        }
-
-        avrgTemperature /= box.dimensions.prod();
-        std::cout << "averageTemperature(" << step << ") = " << avrgTemperature << "\n";
-    }
-
-    double averageTemperature() const
-    {
-        return avrgTemperature;
-    }
-
-private:
-    double avrgTemperature;
-};
-
 class RainMaker : public Steerer<BushFireCell>
 {
 public:
@@ -263,10 +229,11 @@ public:
     using Steerer<BushFireCell>::GridType;
     using Steerer<BushFireCell>::Topology;
 
-    RainMaker(const unsigned ioPeriod, TemperatureRecorder *trigger) :
+    RainMaker(const unsigned ioPeriod, ReductionWriter<BushFireCell>::ResultsPtr reductions, const Coord<2>& dim) :
         Steerer<BushFireCell>(ioPeriod),
         waterAvailable(true),
-        trigger(trigger)
+        reductions(reductions),
+        numCells(dim.prod())
     {}
 
     void nextStep(
@@ -279,7 +246,18 @@ public:
         bool lastCall,
         SteererFeedback *feedback)
     {
-        if (waterAvailable && (trigger->averageTemperature() > 250)) {
+        if (!reductions->available()) {
+            return;
+        }
+
+        // results belong to the latest output step, which may lag
+        // behind the current step:
+        double averageTemperature = (*reductions)["temperature"] / numCells;
+        if (lastCall && (rank == 0)) {
+            std::cout << "averageTemperature(" << reductions->step() << ") = " << averageTemperature << "\n";
+        }
+
+        if (waterAvailable && (averageTemperature > 250)) {
             std::cout << "WARNING---------------------------------------------------\n"
                       << "WARNING: initiating rain at time step " << step << "\n"
                       << "WARNING---------------------------------------------------\n";
@@ -302,7 +280,8 @@ public:
 
 private:
     bool waterAvailable;
-    TemperatureRecorder *trigger;
+    ReductionWriter<BushFireCell>::ResultsPtr reductions;
+    double numCells;
 };
 
 void runSimulation()
@@ -324,9 +303,10 @@ void runSimulation()
 
     sim.addWriter(new TracingWriter<BushFireCell>(500, maxSteps));
 
-    TemperatureRecorder *temperatureRecorder = new TemperatureRecorder(100);
-    sim.addWriter(temperatureRecorder);
-    sim.addSteerer(new RainMaker(100, temperatureRecorder));
+    ReductionWriter<BushFireCell> *reductionWriter = new ReductionWriter<BushFireCell>(100);
+    reductionWriter->addReduction("temperature", &BushFireCell::temperature, ReductionWriter<BushFireCell>::SUM);
+    sim.addWriter(reductionWriter);
+    sim.addSteerer(new RainMaker(100, reductionWriter->results(), dim));
 
     sim.run();
 }
@@ -34,7 +34,10 @@
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/stencils.h>
 #include <libgeodecomp/geometry/voronoimesher.h>
+#include <libgeodecomp/io/asyncwriter.h>
+#include <libgeodecomp/io/parallelinitializer.h>
 #include <libgeodecomp/io/ppmwriter.h>
+#include <libgeodecomp/io/reductionwriter.h>
 #include <libgeodecomp/io/remotesteerer.h>
 #include <libgeodecomp/io/serialbovwriter.h>
 #include <libgeodecomp/io/silowriter.h>
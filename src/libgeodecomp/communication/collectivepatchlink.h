@@ -0,0 +1,456 @@
+#ifndef LIBGEODECOMP_COMMUNICATION_COLLECTIVEPATCHLINK_H
+#define LIBGEODECOMP_COMMUNICATION_COLLECTIVEPATCHLINK_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/communication/patchlink.h>
+#include <libgeodecomp/misc/limits.h>
+#include <libgeodecomp/misc/stringops.h>
+
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * An alternative to PatchLink which bundles the ghost zone
+ * communication of all links of a rank: instead of one message (or
+ * two for variable-size cells) per link and sync point, all patches
+ * of a sync point are packed into a single contiguous buffer and
+ * exchanged via one MPI_Ineighbor_alltoallv on a distributed graph
+ * communicator (see Exchange).
+ *
+ * At each sync point the Accepters put() their patches, then the
+ * SyncPoint starts the collective, which is completed when the first
+ * Provider asks for its patch. Every rank of the communicator needs
+ * to start the collective exactly once per sync point, even if it
+ * has no links at all, hence each rank needs a SyncPoint. All links
+ * and the SyncPoint of an Exchange need to share the same schedule
+ * (first/last nano step and stride), as is the case for the
+ * PatchLinks of an UpdateGroup.
+ *
+ * Like SharedMemoryPatchLink this requires grids and cells which
+ * support zero-copy transfers (see PatchLinkHelpers::SelectZeroCopy).
+ */
+template<class GRID_TYPE>
+class CollectivePatchLink
+{
+public:
+    typedef typename GRID_TYPE::CellType CellType;
+    typedef typename PatchLink<GRID_TYPE>::ZeroCopy Supported;
+
+    const static int DIM = GRID_TYPE::DIM;
+
+    /**
+     * Holds the graph communicator and the send/receive buffers for
+     * all links of a rank. Construction is collective for all ranks
+     * of the communicator.
+     */
+    class Exchange
+    {
+    public:
+        /**
+         * outgoing maps the target ranks of our Accepters to their
+         * Regions, incoming the source ranks of our Providers.
+         */
+        Exchange(
+            const std::map<int, Region<DIM> >& outgoing,
+            const std::map<int, Region<DIM> >& incoming,
+            const MPI_Datatype& cellMPIDatatype,
+            MPI_Comm communicator = MPI_COMM_WORLD) :
+            cellMPIDatatype(cellMPIDatatype),
+            request(MPI_REQUEST_NULL),
+            numPuts(0),
+            pendingNanoStep(0),
+            receivedNanoStep(0),
+            inFlight(false),
+            received(false)
+        {
+            std::vector<int> destinations;
+            std::vector<int> sources;
+            initBuffer(outgoing, &destinations, &sendCounts, &sendDisplacements, &sendIndex, &sendBuffer);
+            initBuffer(incoming, &sources,      &recvCounts, &recvDisplacements, &recvIndex, &recvBuffer);
+
+            MPI_Dist_graph_create_adjacent(
+                communicator,
+                int(sources.size()),
+                data(sources),
+                MPI_UNWEIGHTED,
+                int(destinations.size()),
+                data(destinations),
+                MPI_UNWEIGHTED,
+                MPI_INFO_NULL,
+                0,
+                &graphCommunicator);
+        }
+
+        ~Exchange()
+        {
+            if (inFlight) {
+                MPI_Wait(&request, MPI_STATUS_IGNORE);
+            }
+            MPI_Comm_free(&graphCommunicator);
+        }
+
+        /**
+         * Packs the patch for target. The collective will only be
+         * started by start().
+         */
+        void put(int target, const GRID_TYPE& grid, const Region<DIM>& region, std::size_t nanoStep)
+        {
+            if (numPuts == 0) {
+                // the send buffer may still be in use:
+                wait();
+                pendingNanoStep = nanoStep;
+            }
+            checkNanoStep(nanoStep);
+
+            CellType *cursor = data(sendBuffer) + sendDisplacements[lookup(sendIndex, target)];
+            for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+                grid.get(*i, cursor);
+                cursor += i->length();
+            }
+
+            ++numPuts;
+        }
+
+        /**
+         * Starts the collective for nanoStep once all outgoing
+         * patches have been put(). Ranks without any patches need to
+         * call this, too, as the collective can't complete on their
+         * neighbors otherwise.
+         */
+        void start(std::size_t nanoStep)
+        {
+            if (numPuts != sendCounts.size()) {
+                throw std::logic_error(
+                    "CollectivePatchLink::Exchange: only " + StringOps::itoa(numPuts) + " out of " +
+                    StringOps::itoa(sendCounts.size()) + " patches put before sync point");
+            }
+
+            if (sendCounts.empty()) {
+                // no put() has waited for the previous collective:
+                wait();
+                pendingNanoStep = nanoStep;
+            }
+            checkNanoStep(nanoStep);
+
+            MPI_Ineighbor_alltoallv(
+                data(sendBuffer),
+                data(sendCounts),
+                data(sendDisplacements),
+                cellMPIDatatype,
+                data(recvBuffer),
+                data(recvCounts),
+                data(recvDisplacements),
+                cellMPIDatatype,
+                graphCommunicator,
+                &request);
+            numPuts = 0;
+            inFlight = true;
+            received = false;
+        }
+
+        /**
+         * Unpacks the patch from source, waits for the collective
+         * to complete if necessary. The collective needs to have been
+         * started for nanoStep.
+         */
+        void get(int source, GRID_TYPE *grid, const Region<DIM>& region, std::size_t nanoStep)
+        {
+            if (!received || (receivedNanoStep != nanoStep)) {
+                if (!inFlight || (pendingNanoStep != nanoStep)) {
+                    throw std::logic_error(
+                        "CollectivePatchLink::Exchange: patches for nano step " + StringOps::itoa(nanoStep) +
+                        " requested before the collective was started");
+                }
+
+                wait();
+            }
+
+            const CellType *cursor = data(recvBuffer) + recvDisplacements[lookup(recvIndex, source)];
+            for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+                grid->set(*i, cursor);
+                cursor += i->length();
+            }
+        }
+
+    private:
+        MPI_Comm graphCommunicator;
+        MPI_Datatype cellMPIDatatype;
+        MPI_Request request;
+        std::vector<int> sendCounts;
+        std::vector<int> sendDisplacements;
+        std::vector<int> recvCounts;
+        std::vector<int> recvDisplacements;
+        std::map<int, std::size_t> sendIndex;
+        std::map<int, std::size_t> recvIndex;
+        std::vector<CellType> sendBuffer;
+        std::vector<CellType> recvBuffer;
+        std::size_t numPuts;
+        std::size_t pendingNanoStep;
+        std::size_t receivedNanoStep;
+        bool inFlight;
+        bool received;
+
+        static void initBuffer(
+            const std::map<int, Region<DIM> >& regions,
+            std::vector<int> *ranks,
+            std::vector<int> *counts,
+            std::vector<int> *displacements,
+            std::map<int, std::size_t> *index,
+            std::vector<CellType> *buffer)
+        {
+            std::size_t offset = 0;
+            for (typename std::map<int, Region<DIM> >::const_iterator i = regions.begin(); i != regions.end(); ++i) {
+                (*index)[i->first] = ranks->size();
+                ranks->push_back(i->first);
+                counts->push_back(int(i->second.size()));
+                displacements->push_back(int(offset));
+
+                offset += i->second.size();
+                if (offset > std::size_t(Limits<int>::getMax())) {
+                    throw std::invalid_argument("buffer size exceeds std::numeric_limits<int>::max()");
+                }
+            }
+
+            buffer->resize(offset);
+        }
+
+        template<typename T>
+        static T *data(std::vector<T>& vec)
+        {
+            return vec.empty() ? 0 : &vec[0];
+        }
+
+        static std::size_t lookup(const std::map<int, std::size_t>& index, int rank)
+        {
+            std::map<int, std::size_t>::const_iterator i = index.find(rank);
+            if (i == index.end()) {
+                throw std::logic_error("CollectivePatchLink::Exchange: no link to rank " + StringOps::itoa(rank));
+            }
+
+            return i->second;
+        }
+
+        void checkNanoStep(std::size_t nanoStep) const
+        {
+            if (nanoStep != pendingNanoStep) {
+                throw std::logic_error(
+                    "CollectivePatchLink::Exchange: got nano step " + StringOps::itoa(nanoStep) +
+                    ", expected " + StringOps::itoa(pendingNanoStep));
+            }
+        }
+
+        void wait()
+        {
+            if (inFlight) {
+                MPI_Wait(&request, MPI_STATUS_IGNORE);
+                inFlight = false;
+                received = true;
+                receivedNanoStep = pendingNanoStep;
+            }
+        }
+    };
+
+    typedef typename SharedPtr<Exchange>::Type ExchangePtr;
+
+    /**
+     * Hands its patches to the Exchange. Derives from
+     * PatchLink::Accepter so it can be used wherever a PatchLink is
+     * expected, but doesn't use any of its MPI facilities, hence
+     * these aren't set up.
+     */
+    class Accepter : public PatchLink<GRID_TYPE>::Accepter
+    {
+    public:
+        typedef typename PatchLink<GRID_TYPE>::Accepter ParentType;
+        using ParentType::checkNanoStepPut;
+        using ParentType::infinity;
+        using ParentType::lastNanoStep;
+        using ParentType::region;
+        using ParentType::requestedNanoSteps;
+        using ParentType::stride;
+
+        inline Accepter(
+            const Region<DIM>& region,
+            const int dest,
+            const int tag,
+            const MPI_Datatype& cellMPIDatatype,
+            ExchangePtr exchange,
+            MPI_Comm communicator = MPI_COMM_WORLD) :
+            ParentType(
+                region,
+                dest,
+                tag,
+                cellMPIDatatype,
+                communicator,
+                typename PatchLink<GRID_TYPE>::NoTransport()),
+            dest(dest),
+            exchange(exchange)
+        {}
+
+        virtual void put(
+            const GRID_TYPE& grid,
+            const Region<DIM>& /* unused: validRegion */,
+            const Coord<DIM>& /* unused: globalGridDimensions */,
+            const std::size_t nanoStep,
+            const std::size_t /* unused: rank */)
+        {
+            if (!checkNanoStepPut(nanoStep)) {
+                return;
+            }
+
+            exchange->put(dest, grid, region, nanoStep);
+
+            std::size_t nextNanoStep = (min)(requestedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                requestedNanoSteps << nextNanoStep;
+            }
+
+            erase_min(requestedNanoSteps);
+        }
+
+    private:
+        int dest;
+        ExchangePtr exchange;
+    };
+
+    /**
+     * Starts the Exchange's collective at each sync point. Needs to
+     * be put() after all Accepters, which the Stepper in turn serves
+     * before any Providers of the same nano step. Unlike the links it
+     * is required on every rank of the Exchange's communicator.
+     */
+    class SyncPoint : public PatchLink<GRID_TYPE>::Accepter
+    {
+    public:
+        typedef typename PatchLink<GRID_TYPE>::Accepter ParentType;
+        using ParentType::checkNanoStepPut;
+        using ParentType::infinity;
+        using ParentType::lastNanoStep;
+        using ParentType::requestedNanoSteps;
+        using ParentType::stride;
+
+        inline SyncPoint(
+            const MPI_Datatype& cellMPIDatatype,
+            ExchangePtr exchange,
+            MPI_Comm communicator = MPI_COMM_WORLD) :
+            ParentType(
+                Region<DIM>(),
+                MPI_PROC_NULL,
+                0,
+                cellMPIDatatype,
+                communicator,
+                typename PatchLink<GRID_TYPE>::NoTransport()),
+            exchange(exchange)
+        {}
+
+        virtual void put(
+            const GRID_TYPE& /* unused: grid */,
+            const Region<DIM>& /* unused: validRegion */,
+            const Coord<DIM>& /* unused: globalGridDimensions */,
+            const std::size_t nanoStep,
+            const std::size_t /* unused: rank */)
+        {
+            if (!checkNanoStepPut(nanoStep)) {
+                return;
+            }
+
+            exchange->start(nanoStep);
+
+            std::size_t nextNanoStep = (min)(requestedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                requestedNanoSteps << nextNanoStep;
+            }
+
+            erase_min(requestedNanoSteps);
+        }
+
+    private:
+        ExchangePtr exchange;
+    };
+
+    /**
+     * Retrieves its patches from the Exchange.
+     */
+    class Provider : public PatchLink<GRID_TYPE>::Provider
+    {
+    public:
+        typedef typename PatchLink<GRID_TYPE>::Provider ParentType;
+        using ParentType::checkNanoStepGet;
+        using ParentType::infinity;
+        using ParentType::lastNanoStep;
+        using ParentType::region;
+        using ParentType::storedNanoSteps;
+        using ParentType::stride;
+        using ParentType::get;
+
+        inline Provider(
+            const Region<DIM>& region,
+            const int source,
+            const int tag,
+            const MPI_Datatype& cellMPIDatatype,
+            ExchangePtr exchange,
+            MPI_Comm communicator = MPI_COMM_WORLD) :
+            ParentType(
+                region,
+                source,
+                tag,
+                cellMPIDatatype,
+                communicator,
+                typename PatchLink<GRID_TYPE>::NoTransport()),
+            source(source),
+            exchange(exchange)
+        {}
+
+        /**
+         * Pending collectives are completed by the Exchange.
+         */
+        virtual void cleanup()
+        {}
+
+        virtual void charge(const std::size_t next, const std::size_t last, const std::size_t newStride)
+        {
+            PatchLink<GRID_TYPE>::Link::charge(next, last, newStride);
+            storedNanoSteps << next;
+        }
+
+        virtual void get(
+            GRID_TYPE *grid,
+            const Region<DIM>& /* unused: patchableRegion */,
+            const Coord<DIM>& /* unused: globalGridDimensions */,
+            const std::size_t nanoStep,
+            const std::size_t /* unused: rank */,
+            const bool /* unused: remove */ = true)
+        {
+            if (storedNanoSteps.empty() || (nanoStep < (min)(storedNanoSteps))) {
+                return;
+            }
+
+            checkNanoStepGet(nanoStep);
+            exchange->get(source, grid, region, nanoStep);
+
+            std::size_t nextNanoStep = (min)(storedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                storedNanoSteps << nextNanoStep;
+            }
+
+            erase_min(storedNanoSteps);
+        }
+
+    private:
+        int source;
+        ExchangePtr exchange;
+    };
+};
+
+}
+
+#endif
+#endif
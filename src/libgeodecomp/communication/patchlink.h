@@ -5,14 +5,54 @@
 #ifdef LIBGEODECOMP_WITH_MPI
 
 #include <deque>
+#include <functional>
 #include <libgeodecomp/communication/mpilayer.h>
 #include <libgeodecomp/misc/limits.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/grid.h>
 #include <libgeodecomp/storage/patchaccepter.h>
 #include <libgeodecomp/storage/patchprovider.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
 
 namespace LibGeoDecomp {
 
+namespace PatchLinkHelpers {
+
+/**
+ * Patches can be sent/received directly from/into grid memory (by
+ * means of a derived MPI datatype) if the grid stores its cells
+ * contiguously and the cells are serialized as they are (i.e. no
+ * SoA or Boost.Serialization).
+ */
+template<typename GRID_TYPE, typename BUFFER_TYPE>
+class SelectZeroCopy
+{
+public:
+    typedef APITraits::FalseType Value;
+};
+
+/**
+ * see above
+ */
+template<typename CELL, typename TOPOLOGY>
+class SelectZeroCopy<Grid<CELL, TOPOLOGY>, std::vector<CELL> >
+{
+public:
+    typedef APITraits::TrueType Value;
+};
+
+/**
+ * see above
+ */
+template<typename CELL, typename TOPOLOGY, bool TOPOLOGICALLY_CORRECT>
+class SelectZeroCopy<DisplacedGrid<CELL, TOPOLOGY, TOPOLOGICALLY_CORRECT>, std::vector<CELL> >
+{
+public:
+    typedef APITraits::TrueType Value;
+};
+
+}
+
 /**
  * PatchLink encapsulates the transmission of patches to and from
  * remote processes. PatchLink::Accepter takes the patches from a
@@ -28,9 +68,27 @@ public:
     typedef typename GRID_TYPE::CellType CellType;
     typedef typename SerializationBuffer<CellType>::BufferType BufferType;
     typedef typename SerializationBuffer<CellType>::FixedSize FixedSize;
+    typedef typename PatchLinkHelpers::SelectZeroCopy<GRID_TYPE, BufferType>::Value ZeroCopy;
 
     const static int DIM = GRID_TYPE::DIM;
 
+    /**
+     * Number of serialization buffers per link. With more than one
+     * buffer PatchLink::Accepter::put() won't have to wait for the
+     * previous transmission to complete before it can serialize the
+     * next patch.
+     */
+    static const std::size_t DEFAULT_NUM_BUFFERS = 2;
+
+    /**
+     * Selects the constructors of Accepter and Provider for derived
+     * links which bring their own transport (e.g.
+     * SharedMemoryPatchLink). These set up neither serialization
+     * buffers nor MPI requests.
+     */
+    class NoTransport
+    {};
+
     class Link
     {
     public:
@@ -39,22 +97,56 @@ public:
          * avoid collisions if more than two patchlinks per node-pair
          * are present, the tag parameter needs to be unique (for this
          * pair).
+         *
+         * numBuffers sets the length of the ring of serialization
+         * buffers, i.e. the maximum number of patches per link which
+         * may be in flight simultaneously.
          */
         inline Link(
             const Region<DIM>& region,
             int tag,
-            MPI_Comm communicator = MPI_COMM_WORLD) :
+            MPI_Comm communicator = MPI_COMM_WORLD,
+            std::size_t numBuffers = DEFAULT_NUM_BUFFERS) :
+            lastNanoStep(0),
+            stride(1),
+            mpiLayer(communicator),
+            region(region),
+            buffers(numBuffers, SerializationBuffer<CellType>::create(region)),
+            dataSizes(numBuffers, 0),
+            headerRequests(numBuffers, MPI_REQUEST_NULL),
+            payloadRequests(numBuffers, MPI_REQUEST_NULL),
+            inFlight(numBuffers, false),
+            tag(tag)
+        {
+            if (numBuffers == 0) {
+                throw std::invalid_argument("PatchLink requires at least one buffer");
+            }
+        }
+
+        inline Link(
+            const Region<DIM>& region,
+            int tag,
+            MPI_Comm communicator,
+            NoTransport) :
             lastNanoStep(0),
             stride(1),
             mpiLayer(communicator),
             region(region),
-            buffer(SerializationBuffer<CellType>::create(region)),
             tag(tag)
         {}
 
         virtual ~Link()
         {
+            // Providers have canceled their pending receives by now,
+            // so this only waits for sends:
             wait();
+
+            // only persistent requests remain after wait():
+            for (std::size_t i = 0; i < payloadRequests.size(); ++i) {
+                if (payloadRequests[i] != MPI_REQUEST_NULL) {
+                    MPI_Request_free(&payloadRequests[i]);
+                }
+            }
         }
 
         /**
@@ -73,11 +165,17 @@ public:
 
         inline void wait()
         {
+            for (std::size_t i = 0; i < buffers.size(); ++i) {
+                waitForSlot(i);
+            }
             mpiLayer.wait(tag);
         }
 
         inline void cancel()
         {
+            for (std::size_t i = 0; i < buffers.size(); ++i) {
+                cancelSlot(i);
+            }
             mpiLayer.cancelAll();
         }
 
@@ -86,22 +184,86 @@ public:
         long stride;
         MPILayer mpiLayer;
         Region<DIM> region;
-        BufferType buffer;
+        std::vector<BufferType> buffers;
+        std::vector<int> dataSizes;
+        std::vector<MPI_Request> headerRequests;
+        std::vector<MPI_Request> payloadRequests;
+        std::vector<bool> inFlight;
         int tag;
+
+        /**
+         * Blocks until the transmission associated with the given
+         * buffer has completed. Persistent requests remain allocated
+         * (but inactive) so they can be restarted.
+         */
+        inline void waitForSlot(std::size_t slot)
+        {
+            if (!inFlight[slot]) {
+                return;
+            }
+
+            MPI_Wait(&headerRequests[slot],  MPI_STATUS_IGNORE);
+            MPI_Wait(&payloadRequests[slot], MPI_STATUS_IGNORE);
+            inFlight[slot] = false;
+        }
+
+        inline void cancelSlot(std::size_t slot)
+        {
+            if (!inFlight[slot]) {
+                return;
+            }
+
+            if (headerRequests[slot] != MPI_REQUEST_NULL) {
+                MPI_Cancel(&headerRequests[slot]);
+            }
+            if (payloadRequests[slot] != MPI_REQUEST_NULL) {
+                MPI_Cancel(&payloadRequests[slot]);
+            }
+            waitForSlot(slot);
+        }
+
+        inline int bufferSize(std::size_t slot) const
+        {
+            if (buffers[slot].size() > std::size_t(Limits<int>::getMax())) {
+                throw std::invalid_argument("buffer size exceeds std::numeric_limits<int>::max()");
+            }
+
+            return buffers[slot].size();
+        }
     };
 
+    /**
+     * Sends patches to a remote Provider. Patches are serialized into
+     * a ring of buffers, so a new patch can be handed to MPI while
+     * earlier ones are still in flight. Fixed-size cells are sent via
+     * persistent requests which are set up once upon construction.
+     *
+     * If zeroCopy is set, patches are sent directly from the grid,
+     * bypassing the serialization buffers. This is only honored for
+     * grids and cells which support it (see
+     * PatchLinkHelpers::SelectZeroCopy). These sends are
+     * non-blocking and completed by releaseGrid(). Their datatype
+     * depends on the grid's geometry, which isn't known before the
+     * first put() (see updateZeroCopyDatatype()).
+     */
     class Accepter :
         public Link,
         public PatchAccepter<GRID_TYPE>
     {
     public:
-        using Link::buffer;
+        using Link::buffers;
+        using Link::bufferSize;
+        using Link::dataSizes;
+        using Link::headerRequests;
+        using Link::inFlight;
         using Link::lastNanoStep;
         using Link::mpiLayer;
+        using Link::payloadRequests;
         using Link::region;
         using Link::stride;
         using Link::tag;
         using Link::wait;
+        using Link::waitForSlot;
         using PatchAccepter<GRID_TYPE>::checkNanoStepPut;
         using PatchAccepter<GRID_TYPE>::infinity;
         using PatchAccepter<GRID_TYPE>::pushRequest;
@@ -112,11 +274,27 @@ public:
             const int dest,
             const int tag,
             const MPI_Datatype& cellMPIDatatype,
-            MPI_Comm communicator = MPI_COMM_WORLD) :
-            Link(region, tag, communicator),
+            MPI_Comm communicator = MPI_COMM_WORLD,
+            std::size_t numBuffers = DEFAULT_NUM_BUFFERS,
+            bool zeroCopy = false) :
+            Link(region, tag, communicator, numBuffers),
             dest(dest),
-            cellMPIDatatype(cellMPIDatatype)
-        {}
+            cellMPIDatatype(cellMPIDatatype),
+            nextSlot(0),
+            zeroCopy(zeroCopy && supportsZeroCopy(ZeroCopy())),
+            zeroCopyRequest(MPI_REQUEST_NULL),
+            zeroCopyDatatype(MPI_DATATYPE_NULL),
+            zeroCopyInitialized(false),
+            zeroCopyFeasible(false)
+        {
+            initRequests(FixedSize());
+        }
+
+        virtual ~Accepter()
+        {
+            releaseGrid();
+            freeZeroCopyDatatype();
+        }
 
         virtual void charge(std::size_t next, std::size_t last, std::size_t newStride)
         {
@@ -135,11 +313,16 @@ public:
                 return;
             }
 
-            wait();
-            SerializationBuffer<CellType>::resize(&buffer, region.size());
-            grid.saveRegion(&buffer, region);
-            sendHeader(FixedSize());
-            mpiLayer.send(&buffer[0], dest, buffer.size(), tag, cellMPIDatatype);
+            if (!sendDirectly(grid, ZeroCopy())) {
+                std::size_t slot = nextSlot;
+                nextSlot = (nextSlot + 1) % buffers.size();
+
+                // this will only block if all buffers are still in flight:
+                waitForSlot(slot);
+                SerializationBuffer<CellType>::resize(&buffers[slot], region.size());
+                grid.saveRegion(&buffers[slot], region);
+                send(slot, FixedSize());
+            }
 
             std::size_t nextNanoStep = (min)(requestedNanoSteps) + stride;
             if ((lastNanoStep == infinity()) ||
@@ -150,39 +333,248 @@ public:
             erase_min(requestedNanoSteps);
         }
 
+        /**
+         * Completes the pending zero-copy send, if any. Until then
+         * the grid handed to put() must not be modified.
+         */
+        virtual void releaseGrid()
+        {
+            if (zeroCopyRequest != MPI_REQUEST_NULL) {
+                MPI_Wait(&zeroCopyRequest, MPI_STATUS_IGNORE);
+            }
+        }
+
+    protected:
+        inline Accepter(
+            const Region<DIM>& region,
+            const int dest,
+            const int tag,
+            const MPI_Datatype& cellMPIDatatype,
+            MPI_Comm communicator,
+            NoTransport) :
+            Link(region, tag, communicator, NoTransport()),
+            dest(dest),
+            cellMPIDatatype(cellMPIDatatype),
+            nextSlot(0),
+            zeroCopy(false),
+            zeroCopyRequest(MPI_REQUEST_NULL),
+            zeroCopyDatatype(MPI_DATATYPE_NULL),
+            zeroCopyInitialized(false),
+            zeroCopyFeasible(false)
+        {}
+
     private:
         int dest;
-        int dataSize;
         MPI_Datatype cellMPIDatatype;
+        std::size_t nextSlot;
+        bool zeroCopy;
+        MPI_Request zeroCopyRequest;
+        MPI_Datatype zeroCopyDatatype;
+        CoordBox<DIM> zeroCopyBox;
+        bool zeroCopyInitialized;
+        bool zeroCopyFeasible;
 
-        void sendHeader(APITraits::TrueType)
+        /**
+         * Returns true if the patch can be sent directly from the
+         * grid's memory via zeroCopyDatatype. The
+         * datatype describes the layout of the Region within the grid
+         * relative to the Region's first cell (see zeroCopyAddress()).
+         * This is not feasible if any streak isn't stored contiguously
+         * (e.g. if it wraps around a torus).
+         *
+         * Steppers alternate between grids of identical geometry, so
+         * the datatype only needs to be rebuilt if the grid's bounding
+         * box changes.
+         */
+        bool updateZeroCopyDatatype(const GRID_TYPE& grid)
         {
-            // we don't need any header for fixed size buffers
+            if (!zeroCopy) {
+                return false;
+            }
+
+            CoordBox<DIM> box = grid.boundingBox();
+            if (zeroCopyInitialized && (box == zeroCopyBox)) {
+                return zeroCopyFeasible;
+            }
+
+            freeZeroCopyDatatype();
+            zeroCopyInitialized = true;
+            zeroCopyFeasible = false;
+            zeroCopyBox = box;
+
+            std::less<const CellType*> less;
+            const CellType *begin = grid.data();
+            const CellType *end = begin + box.dimensions.prod();
+            const CellType *first = zeroCopyAddress(grid);
+
+            std::vector<int> lengths;
+            std::vector<MPI_Aint> displacements;
+            lengths.reserve(region.numStreaks());
+            displacements.reserve(region.numStreaks());
+
+            for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+                Coord<DIM> lastCoord = i->origin;
+                lastCoord.x() = i->endX - 1;
+                const CellType *streakBegin = &grid[i->origin];
+                const CellType *streakLast = &grid[lastCoord];
+
+                if (less(streakBegin, begin) ||
+                    !less(streakLast, end) ||
+                    ((streakLast - streakBegin) != (i->length() - 1))) {
+                    return false;
+                }
+
+                lengths << i->length();
+                displacements << MPI_Aint(
+                    reinterpret_cast<const char*>(streakBegin) -
+                    reinterpret_cast<const char*>(first));
+            }
+
+            MPI_Type_create_hindexed(
+                lengths.size(),
+                &lengths[0],
+                &displacements[0],
+                cellMPIDatatype,
+                &zeroCopyDatatype);
+            MPI_Type_commit(&zeroCopyDatatype);
+            zeroCopyFeasible = true;
+
+            return true;
         }
 
-        void sendHeader(APITraits::FalseType)
+        inline const CellType *zeroCopyAddress(const GRID_TYPE& grid) const
         {
-            if (buffer.size() > std::size_t(Limits<int>::getMax())) {
-                throw std::invalid_argument("buffer size exceeds std::numeric_limits<int>::max()");
+            return &grid[region.beginStreak()->origin];
+        }
+
+        static bool supportsZeroCopy(APITraits::TrueType)
+        {
+            return true;
+        }
+
+        static bool supportsZeroCopy(APITraits::FalseType)
+        {
+            return false;
+        }
+
+        void freeZeroCopyDatatype()
+        {
+            if (zeroCopyDatatype != MPI_DATATYPE_NULL) {
+                MPI_Type_free(&zeroCopyDatatype);
             }
+        }
 
-            dataSize = buffer.size();
-            mpiLayer.send(&dataSize, dest, 1, tag, MPI_INT);
+        /**
+         * The send remains in flight after put() returns, so the
+         * Stepper can hand the grid to all of its Accepters before
+         * waiting for any of them (see releaseGrid()). Waiting can't
+         * deadlock as all Providers pre-post their receives.
+         */
+        bool sendDirectly(const GRID_TYPE& grid, APITraits::TrueType)
+        {
+            releaseGrid();
+            if (!updateZeroCopyDatatype(grid)) {
+                return false;
+            }
+
+            MPI_Isend(
+                const_cast<CellType*>(zeroCopyAddress(grid)),
+                1,
+                zeroCopyDatatype,
+                dest,
+                tag,
+                mpiLayer.communicator(),
+                &zeroCopyRequest);
+            return true;
+        }
+
+        bool sendDirectly(const GRID_TYPE& /* unused: grid */, APITraits::FalseType)
+        {
+            return false;
+        }
+
+        void initRequests(APITraits::TrueType)
+        {
+            for (std::size_t i = 0; i < buffers.size(); ++i) {
+                MPI_Send_init(
+                    buffers[i].data(),
+                    bufferSize(i),
+                    cellMPIDatatype,
+                    dest,
+                    tag,
+                    mpiLayer.communicator(),
+                    &payloadRequests[i]);
+            }
+        }
+
+        void initRequests(APITraits::FalseType)
+        {
+            // buffer sizes vary, so we can't use persistent requests
+        }
+
+        void send(std::size_t slot, APITraits::TrueType)
+        {
+            MPI_Start(&payloadRequests[slot]);
+            inFlight[slot] = true;
+        }
+
+        void send(std::size_t slot, APITraits::FalseType)
+        {
+            // the receiver needs to know the size of the payload in
+            // advance, hence we send a header first:
+            dataSizes[slot] = bufferSize(slot);
+            MPI_Isend(
+                &dataSizes[slot],
+                1,
+                MPI_INT,
+                dest,
+                tag,
+                mpiLayer.communicator(),
+                &headerRequests[slot]);
+            MPI_Isend(
+                buffers[slot].data(),
+                dataSizes[slot],
+                cellMPIDatatype,
+                dest,
+                tag,
+                mpiLayer.communicator(),
+                &payloadRequests[slot]);
+            inFlight[slot] = true;
         }
     };
 
+    /**
+     * Receives patches from a remote Accepter. For fixed-size cells
+     * the receives for upcoming nano steps are pre-posted (one per
+     * buffer) via persistent requests. Variable-size cells require a
+     * header to be received first, so here only one transmission may
+     * be pending at a time.
+     *
+     * Patches are always received into the buffers and then copied
+     * into the grid: the target grid isn't known before get(), but
+     * the receives need to be pre-posted, or two zero-copy Accepters
+     * waiting for their sends to complete would block each other
+     * forever. The derived datatype of zero-copy Accepters matches
+     * the plain sequence of cells received here.
+     */
     class Provider :
         public Link,
         public PatchProvider<GRID_TYPE>
     {
     public:
-        using Link::buffer;
+        using Link::bufferSize;
+        using Link::buffers;
+        using Link::cancel;
+        using Link::cancelSlot;
+        using Link::inFlight;
         using Link::lastNanoStep;
         using Link::mpiLayer;
+        using Link::payloadRequests;
         using Link::region;
         using Link::stride;
         using Link::tag;
         using Link::wait;
+        using Link::waitForSlot;
         using PatchProvider<GRID_TYPE>::checkNanoStepGet;
         using PatchProvider<GRID_TYPE>::infinity;
         using PatchProvider<GRID_TYPE>::storedNanoSteps;
@@ -194,25 +586,54 @@ public:
             int source,
             int tag,
             const MPI_Datatype& cellMPIDatatype,
-            MPI_Comm communicator = MPI_COMM_WORLD) :
-            Link(region, tag, communicator),
+            MPI_Comm communicator = MPI_COMM_WORLD,
+            std::size_t numBuffers = DEFAULT_NUM_BUFFERS) :
+            Link(region, tag, communicator, numBuffers),
             source(source),
             dataSize(0),
             cellMPIDatatype(cellMPIDatatype),
-            transmissionInFlight(false)
-        {}
+            transmissionInFlight(false),
+            oldestSlot(0)
+        {
+            initRequests(FixedSize());
+        }
 
+        /**
+         * Receives which are still pre-posted can't be waited for:
+         * without a prior cleanup() their sends may never be issued.
+         */
+        virtual ~Provider()
+        {
+            cancel();
+        }
+
+        /**
+         * Only the receive for the oldest pending nano step is
+         * guaranteed to be matched by a send which has already been
+         * issued, so it is completed here. Pre-posted receives for
+         * later steps are canceled.
+         */
         virtual void cleanup()
         {
             if (transmissionInFlight) {
                 recvSecondPart(FixedSize());
+                transmissionInFlight = false;
             }
+
+            while (storedNanoSteps.size() > 1) {
+                std::size_t slot = (oldestSlot + storedNanoSteps.size() - 1) % buffers.size();
+                cancelSlot(slot);
+                storedNanoSteps.erase(*storedNanoSteps.rbegin());
+            }
+
+            waitForSlot(oldestSlot);
         }
 
         virtual void charge(const std::size_t next, const std::size_t last, const std::size_t newStride)
         {
             Link::charge(next, last, newStride);
             recv(next);
+            prepostReceives(next);
         }
 
         virtual void get(
@@ -228,40 +649,105 @@ public:
             }
 
             checkNanoStepGet(nanoStep);
-            wait();
+            std::size_t slot = oldestSlot;
+            waitForSlot(slot);
+            mpiLayer.wait(tag);
             recvSecondPart(FixedSize());
             transmissionInFlight = false;
 
-            grid->loadRegion(buffer, region);
-
-            std::size_t nextNanoStep = (min)(storedNanoSteps) + stride;
-            if ((lastNanoStep == infinity()) ||
-                (nextNanoStep < lastNanoStep)) {
-                recv(nextNanoStep);
-            }
+            grid->loadRegion(buffers[slot], region);
 
+            std::size_t latestNanoStep = *storedNanoSteps.rbegin();
             erase_min(storedNanoSteps);
+            oldestSlot = (oldestSlot + 1) % receiveDepth(FixedSize());
+            prepostReceives(latestNanoStep);
         }
 
         void recv(const std::size_t nanoStep)
         {
+            std::size_t slot = (oldestSlot + storedNanoSteps.size()) % buffers.size();
             storedNanoSteps << nanoStep;
-            recvFirstPart(FixedSize());
+            recvFirstPart(slot, FixedSize());
             transmissionInFlight = true;
         }
 
+    protected:
+        inline Provider(
+            const Region<DIM>& region,
+            int source,
+            int tag,
+            const MPI_Datatype& cellMPIDatatype,
+            MPI_Comm communicator,
+            NoTransport) :
+            Link(region, tag, communicator, NoTransport()),
+            source(source),
+            dataSize(0),
+            cellMPIDatatype(cellMPIDatatype),
+            transmissionInFlight(false),
+            oldestSlot(0)
+        {}
+
     private:
         int source;
         int dataSize;
         MPI_Datatype cellMPIDatatype;
         bool transmissionInFlight;
+        std::size_t oldestSlot;
 
-        void recvFirstPart(APITraits::TrueType)
+        /**
+         * Posts receives for the nano steps following latestNanoStep
+         * until either all buffers are occupied or lastNanoStep has
+         * been reached.
+         */
+        void prepostReceives(std::size_t latestNanoStep)
+        {
+            while (storedNanoSteps.size() < receiveDepth(FixedSize())) {
+                latestNanoStep += stride;
+                if ((lastNanoStep != infinity()) &&
+                    (latestNanoStep >= lastNanoStep)) {
+                    return;
+                }
+
+                recv(latestNanoStep);
+            }
+        }
+
+        std::size_t receiveDepth(APITraits::TrueType) const
+        {
+            return buffers.size();
+        }
+
+        std::size_t receiveDepth(APITraits::FalseType) const
+        {
+            return 1;
+        }
+
+        void initRequests(APITraits::TrueType)
+        {
+            for (std::size_t i = 0; i < buffers.size(); ++i) {
+                MPI_Recv_init(
+                    buffers[i].data(),
+                    bufferSize(i),
+                    cellMPIDatatype,
+                    source,
+                    tag,
+                    mpiLayer.communicator(),
+                    &payloadRequests[i]);
+            }
+        }
+
+        void initRequests(APITraits::FalseType)
         {
-            mpiLayer.recv(&buffer[0], source, buffer.size(), tag, cellMPIDatatype);
+            // buffer sizes vary, so we can't use persistent requests
         }
 
-        void recvFirstPart(APITraits::FalseType)
+        void recvFirstPart(std::size_t slot, APITraits::TrueType)
+        {
+            MPI_Start(&payloadRequests[slot]);
+            inFlight[slot] = true;
+        }
+
+        void recvFirstPart(std::size_t /* unused: slot */, APITraits::FalseType)
         {
             mpiLayer.recv(&dataSize, source, 1, tag, MPI_INT);
         }
@@ -273,9 +759,10 @@ public:
 
         void recvSecondPart(APITraits::FalseType)
         {
-            buffer.resize(dataSize);
-            mpiLayer.recv(&buffer[0], source, dataSize, tag, cellMPIDatatype);
-            wait();
+            mpiLayer.wait(tag);
+            buffers[0].resize(dataSize);
+            mpiLayer.recv(buffers[0].data(), source, dataSize, tag, cellMPIDatatype);
+            mpiLayer.wait(tag);
         }
     };
 
@@ -0,0 +1,452 @@
+#ifndef LIBGEODECOMP_COMMUNICATION_SHAREDMEMORYPATCHLINK_H
+#define LIBGEODECOMP_COMMUNICATION_SHAREDMEMORYPATCHLINK_H
+
+#include <libgeodecomp/config.h>
+#if defined(LIBGEODECOMP_WITH_MPI) && defined(LIBGEODECOMP_WITH_CPP14)
+
+#include <libgeodecomp/communication/patchlink.h>
+#include <libgeodecomp/misc/stringops.h>
+
+#include <atomic>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * A drop-in replacement for PatchLink for ranks which reside on the
+ * same node: the Accepter copies its patches into a segment of an
+ * MPI-3 shared memory window (see Window), from which the Provider
+ * copies them directly into its grid. This bypasses both the
+ * SerializationBuffers and MPI's transport layer.
+ *
+ * Each link owns a ring of NUM_SLOTS patches within its Accepter's
+ * segment. Accepter and Provider synchronize via two counters next
+ * to the ring (patches published/consumed), so the Accepter only
+ * blocks if the Provider is lagging behind by NUM_SLOTS patches,
+ * just like a PatchLink whose buffers are all in flight.
+ *
+ * The window is kept in a passive target epoch (MPI_Win_lock_all)
+ * for its whole lifetime. As required by the unified memory model,
+ * both sides call MPI_Win_sync between accessing the payload and
+ * updating or polling the counters, so payload writes are visible to
+ * the peer before the corresponding counter is.
+ *
+ * Only grids and cells which support zero-copy transfers (see
+ * PatchLinkHelpers::SelectZeroCopy) can be exchanged this way.
+ */
+template<class GRID_TYPE>
+class SharedMemoryPatchLink
+{
+public:
+    typedef typename GRID_TYPE::CellType CellType;
+    typedef typename PatchLink<GRID_TYPE>::ZeroCopy Supported;
+
+    const static int DIM = GRID_TYPE::DIM;
+    static const std::size_t NUM_SLOTS = PatchLink<GRID_TYPE>::DEFAULT_NUM_BUFFERS;
+
+    /**
+     * Placed at the beginning of each link's ring. The counters live
+     * on separate cache lines as they're written by different
+     * processes.
+     */
+    class Header
+    {
+    public:
+        Header() :
+            published(0),
+            consumed(0)
+        {}
+
+        std::atomic<std::size_t> published;
+        char padding0[64];
+        std::atomic<std::size_t> consumed;
+        char padding1[64];
+        std::size_t nanoSteps[NUM_SLOTS];
+    };
+
+    /**
+     * Ring of patches for a single link within a shared segment.
+     */
+    class Channel
+    {
+    public:
+        explicit Channel(char *base = 0) :
+            header(reinterpret_cast<Header*>(base)),
+            payload(reinterpret_cast<CellType*>(base + headerSize()))
+        {}
+
+        static std::size_t headerSize()
+        {
+            return roundUp(sizeof(Header));
+        }
+
+        static std::size_t size(std::size_t regionSize)
+        {
+            return headerSize() + roundUp(NUM_SLOTS * regionSize * sizeof(CellType));
+        }
+
+        static std::size_t roundUp(std::size_t size)
+        {
+            return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        Header *header;
+        CellType *payload;
+
+    private:
+        static const std::size_t ALIGNMENT = 64;
+    };
+
+    /**
+     * Manages the shared memory window of all ranks on a node. Each
+     * rank exports one segment, which holds a directory of the links
+     * it feeds, followed by their Channels. All functions which take
+     * a rank refer to ranks within the communicator the Window was
+     * created for.
+     */
+    class Window
+    {
+    public:
+        explicit Window(MPI_Comm communicator) :
+            communicator(communicator),
+            window(MPI_WIN_NULL)
+        {
+            MPI_Comm_split_type(communicator, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodeCommunicator);
+
+            int size;
+            MPI_Comm_size(communicator, &size);
+            std::vector<int> ranks(size);
+            for (int i = 0; i < size; ++i) {
+                ranks[i] = i;
+            }
+            nodeRanks.resize(size);
+
+            MPI_Group group;
+            MPI_Group nodeGroup;
+            MPI_Comm_group(communicator, &group);
+            MPI_Comm_group(nodeCommunicator, &nodeGroup);
+            MPI_Group_translate_ranks(group, size, &ranks[0], nodeGroup, &nodeRanks[0]);
+            MPI_Group_free(&group);
+            MPI_Group_free(&nodeGroup);
+        }
+
+        ~Window()
+        {
+            free();
+            MPI_Comm_free(&nodeCommunicator);
+        }
+
+        /**
+         * True if rank shares its node (and hence its memory) with
+         * the calling rank.
+         */
+        bool isLocal(int rank) const
+        {
+            return nodeRanks[rank] != MPI_UNDEFINED;
+        }
+
+        /**
+         * (Re-)allocates the shared window, setting up one Channel
+         * for each entry of outgoing, which maps target ranks to the
+         * Regions they'll receive from us. All targets need to be
+         * local. Collective for all ranks on the node.
+         */
+        void allocate(const std::map<int, Region<DIM> >& outgoing)
+        {
+            free();
+
+            std::size_t directorySize = Channel::roundUp(sizeof(std::size_t) * (1 + 2 * outgoing.size()));
+            std::size_t segmentSize = directorySize;
+            for (typename std::map<int, Region<DIM> >::const_iterator i = outgoing.begin(); i != outgoing.end(); ++i) {
+                if (!isLocal(i->first)) {
+                    throw std::invalid_argument("target rank " + StringOps::itoa(i->first) + " isn't on this node");
+                }
+                segmentSize += Channel::size(i->second.size());
+            }
+
+            char *segment;
+            MPI_Win_allocate_shared(
+                MPI_Aint(segmentSize),
+                1,
+                MPI_INFO_NULL,
+                nodeCommunicator,
+                &segment,
+                &window);
+            MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+
+            // directory: number of entries followed by pairs of
+            // target rank and offset of the Channel:
+            std::size_t *directory = reinterpret_cast<std::size_t*>(segment);
+            directory[0] = outgoing.size();
+            std::size_t offset = directorySize;
+            std::size_t index = 0;
+            for (typename std::map<int, Region<DIM> >::const_iterator i = outgoing.begin(); i != outgoing.end(); ++i) {
+                directory[1 + 2 * index + 0] = std::size_t(i->first);
+                directory[1 + 2 * index + 1] = offset;
+                new (segment + offset) Header();
+
+                offset += Channel::size(i->second.size());
+                ++index;
+            }
+
+            // providers may only look up their Channels once all
+            // directories have been written:
+            MPI_Win_sync(window);
+            MPI_Barrier(nodeCommunicator);
+            MPI_Win_sync(window);
+        }
+
+        /**
+         * Returns the Channel via which source sends patches to
+         * target. One of both needs to be the calling rank.
+         */
+        Channel channel(int source, int target) const
+        {
+            if (window == MPI_WIN_NULL) {
+                throw std::logic_error("shared memory window not allocated");
+            }
+
+            MPI_Aint size;
+            int displacementUnit;
+            char *segment;
+            MPI_Win_shared_query(window, nodeRanks[source], &size, &displacementUnit, &segment);
+
+            const std::size_t *directory = reinterpret_cast<const std::size_t*>(segment);
+            for (std::size_t i = 0; i < directory[0]; ++i) {
+                if (directory[1 + 2 * i] == std::size_t(target)) {
+                    return Channel(segment + directory[1 + 2 * i + 1]);
+                }
+            }
+
+            throw std::logic_error(
+                "no shared memory channel from rank " + StringOps::itoa(source) +
+                " to rank " + StringOps::itoa(target));
+        }
+
+        MPI_Comm getCommunicator() const
+        {
+            return communicator;
+        }
+
+        MPI_Win getWindow() const
+        {
+            return window;
+        }
+
+    private:
+        MPI_Comm communicator;
+        MPI_Comm nodeCommunicator;
+        MPI_Win window;
+        std::vector<int> nodeRanks;
+
+        void free()
+        {
+            if (window != MPI_WIN_NULL) {
+                MPI_Win_unlock_all(window);
+                MPI_Win_free(&window);
+            }
+        }
+    };
+
+    /**
+     * Copies patches into the ring of its Channel. Derives from
+     * PatchLink::Accepter so it can be handed out wherever a
+     * PatchLink is expected, but doesn't use any of its MPI
+     * facilities, hence these aren't set up.
+     */
+    class Accepter : public PatchLink<GRID_TYPE>::Accepter
+    {
+    public:
+        typedef typename PatchLink<GRID_TYPE>::Accepter ParentType;
+        using ParentType::checkNanoStepPut;
+        using ParentType::infinity;
+        using ParentType::lastNanoStep;
+        using ParentType::region;
+        using ParentType::requestedNanoSteps;
+        using ParentType::stride;
+
+        inline Accepter(
+            const Region<DIM>& region,
+            const int dest,
+            const int tag,
+            const MPI_Datatype& cellMPIDatatype,
+            const Window& window,
+            const int source) :
+            ParentType(
+                region,
+                dest,
+                tag,
+                cellMPIDatatype,
+                window.getCommunicator(),
+                typename PatchLink<GRID_TYPE>::NoTransport()),
+            communicator(window.getCommunicator()),
+            window(window.getWindow()),
+            channel(window.channel(source, dest))
+        {}
+
+        virtual void put(
+            const GRID_TYPE& grid,
+            const Region<DIM>& /*validRegion*/,
+            const Coord<DIM>& globalGridDimensions,
+            const std::size_t nanoStep,
+            const std::size_t rank)
+        {
+            if (!checkNanoStepPut(nanoStep)) {
+                return;
+            }
+
+            Header *header = channel.header;
+            std::size_t count = header->published.load(std::memory_order_relaxed);
+            while ((count - header->consumed.load(std::memory_order_acquire)) == NUM_SLOTS) {
+                progress(communicator, window);
+            }
+
+            std::size_t slot = count % NUM_SLOTS;
+            CellType *cursor = channel.payload + slot * region.size();
+            for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+                grid.get(*i, cursor);
+                cursor += i->length();
+            }
+            header->nanoSteps[slot] = nanoStep;
+            // the payload needs to be visible before the counter is:
+            MPI_Win_sync(window);
+            header->published.store(count + 1, std::memory_order_release);
+
+            std::size_t nextNanoStep = (min)(requestedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                requestedNanoSteps << nextNanoStep;
+            }
+
+            erase_min(requestedNanoSteps);
+        }
+
+    private:
+        MPI_Comm communicator;
+        MPI_Win window;
+        Channel channel;
+    };
+
+    /**
+     * Copies patches from the ring of its Channel into the grid.
+     */
+    class Provider : public PatchLink<GRID_TYPE>::Provider
+    {
+    public:
+        typedef typename PatchLink<GRID_TYPE>::Provider ParentType;
+        using ParentType::checkNanoStepGet;
+        using ParentType::infinity;
+        using ParentType::lastNanoStep;
+        using ParentType::region;
+        using ParentType::storedNanoSteps;
+        using ParentType::stride;
+        using ParentType::get;
+
+        inline Provider(
+            const Region<DIM>& region,
+            const int source,
+            const int tag,
+            const MPI_Datatype& cellMPIDatatype,
+            const Window& window,
+            const int target) :
+            ParentType(
+                region,
+                source,
+                tag,
+                cellMPIDatatype,
+                window.getCommunicator(),
+                typename PatchLink<GRID_TYPE>::NoTransport()),
+            communicator(window.getCommunicator()),
+            window(window.getWindow()),
+            channel(window.channel(source, target))
+        {}
+
+        /**
+         * Pending patches will be discarded along with the Window.
+         */
+        virtual void cleanup()
+        {}
+
+        virtual void charge(const std::size_t next, const std::size_t last, const std::size_t newStride)
+        {
+            PatchLink<GRID_TYPE>::Link::charge(next, last, newStride);
+            storedNanoSteps << next;
+        }
+
+        virtual void get(
+            GRID_TYPE *grid,
+            const Region<DIM>& patchableRegion,
+            const Coord<DIM>& globalGridDimensions,
+            const std::size_t nanoStep,
+            const std::size_t rank,
+            const bool remove = true)
+        {
+            if (storedNanoSteps.empty() || (nanoStep < (min)(storedNanoSteps))) {
+                return;
+            }
+
+            checkNanoStepGet(nanoStep);
+
+            Header *header = channel.header;
+            std::size_t count = header->consumed.load(std::memory_order_relaxed);
+            while (header->published.load(std::memory_order_acquire) == count) {
+                progress(communicator, window);
+            }
+            MPI_Win_sync(window);
+
+            std::size_t slot = count % NUM_SLOTS;
+            if (header->nanoSteps[slot] != nanoStep) {
+                throw std::logic_error(
+                    "SharedMemoryPatchLink received patch for nano step " + StringOps::itoa(header->nanoSteps[slot]) +
+                    ", expected " + StringOps::itoa(nanoStep));
+            }
+
+            const CellType *cursor = channel.payload + slot * region.size();
+            for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+                grid->set(*i, cursor);
+                cursor += i->length();
+            }
+            // we're done reading the slot before the Accepter may
+            // overwrite it:
+            MPI_Win_sync(window);
+            header->consumed.store(count + 1, std::memory_order_release);
+
+            std::size_t nextNanoStep = (min)(storedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                storedNanoSteps << nextNanoStep;
+            }
+
+            erase_min(storedNanoSteps);
+        }
+
+    private:
+        MPI_Comm communicator;
+        MPI_Win window;
+        Channel channel;
+    };
+
+private:
+    /**
+     * Our peer might be blocked in an MPI call which waits for one of
+     * our own non-blocking transmissions. Probing keeps MPI's progress
+     * engine going while we're waiting for the peer. Syncing the
+     * window makes the peer's counter updates visible to us.
+     */
+    static void progress(MPI_Comm communicator, MPI_Win window)
+    {
+        int flag;
+        MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, communicator, &flag, MPI_STATUS_IGNORE);
+        MPI_Win_sync(window);
+        std::this_thread::yield();
+    }
+};
+
+}
+
+#endif
+#endif
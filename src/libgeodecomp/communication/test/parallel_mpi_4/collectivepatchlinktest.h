@@ -0,0 +1,121 @@
+#include <libgeodecomp/communication/collectivepatchlink.h>
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class CollectivePatchLinkTest : public CxxTest::TestSuite
+{
+public:
+    typedef DisplacedGrid<int> GridType;
+    typedef CollectivePatchLink<GridType> LinkType;
+    typedef SharedPtr<LinkType::Accepter>::Type AccepterPtr;
+    typedef SharedPtr<LinkType::Provider>::Type ProviderPtr;
+
+    void testRing()
+    {
+        MPILayer mpiLayer;
+        int rank = mpiLayer.rank();
+        int size = mpiLayer.size();
+        std::vector<int> neighbors;
+        neighbors << (rank + 1) % size
+                  << (rank - 1 + size) % size;
+
+        checkExchange(neighbors);
+    }
+
+    void testRankWithoutNeighbors()
+    {
+        // the last rank is left out of the ring, yet it still needs
+        // to take part in the collective:
+        MPILayer mpiLayer;
+        int rank = mpiLayer.rank();
+        int size = mpiLayer.size() - 1;
+        std::vector<int> neighbors;
+        if (rank < size) {
+            neighbors << (rank + 1) % size
+                      << (rank - 1 + size) % size;
+        }
+
+        checkExchange(neighbors);
+    }
+
+private:
+    void checkExchange(const std::vector<int>& neighbors)
+    {
+        int rank = MPILayer().rank();
+        std::map<int, Region<2> > outgoing;
+        std::map<int, Region<2> > incoming;
+        for (std::size_t i = 0; i < neighbors.size(); ++i) {
+            outgoing[neighbors[i]] = makeRegion(rank, neighbors[i]);
+            incoming[neighbors[i]] = makeRegion(neighbors[i], rank);
+        }
+        LinkType::ExchangePtr exchange(new LinkType::Exchange(outgoing, incoming, MPI_INT));
+
+        std::vector<AccepterPtr> accepters;
+        std::vector<ProviderPtr> providers;
+        for (std::size_t i = 0; i < neighbors.size(); ++i) {
+            int peer = neighbors[i];
+            accepters << AccepterPtr(new LinkType::Accepter(outgoing[peer], peer, 4711, MPI_INT, exchange));
+            providers << ProviderPtr(new LinkType::Provider(incoming[peer], peer, 4711, MPI_INT, exchange));
+            accepters.back()->charge(4, 40, 4);
+            providers.back()->charge(4, 40, 4);
+        }
+        LinkType::SyncPoint syncPoint(MPI_INT, exchange);
+        syncPoint.charge(4, 40, 4);
+
+        CoordBox<2> box(Coord<2>(), Coord<2>(50, 20));
+        Region<2> boundingRegion;
+        boundingRegion << box;
+        GridType sendGrid(box, -1);
+        GridType recvGrid(box, -1);
+
+        for (std::size_t nanoStep = 4; nanoStep < 40; nanoStep += 4) {
+            for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+                sendGrid[*i] = int(rank * 100000 + nanoStep * 1000 + i->toIndex(box.dimensions));
+            }
+
+            for (std::size_t i = 0; i < accepters.size(); ++i) {
+                accepters[i]->put(sendGrid, boundingRegion, box.dimensions, nanoStep, rank);
+            }
+            if (!accepters.empty()) {
+                // nano steps without a request are to be ignored:
+                accepters[0]->put(sendGrid, boundingRegion, box.dimensions, nanoStep + 1, rank);
+
+                // patches can't be retrieved before the collective has been started:
+                TS_ASSERT_THROWS(
+                    providers[0]->get(&recvGrid, boundingRegion, box.dimensions, nanoStep, rank),
+                    std::logic_error&);
+            }
+            syncPoint.put(sendGrid, boundingRegion, box.dimensions, nanoStep, rank);
+
+            for (std::size_t i = 0; i < providers.size(); ++i) {
+                providers[i]->get(&recvGrid, boundingRegion, box.dimensions, nanoStep, rank);
+
+                int source = neighbors[i];
+                Region<2> region = incoming[source];
+                for (Region<2>::Iterator j = region.begin(); j != region.end(); ++j) {
+                    TS_ASSERT_EQUALS(
+                        int(source * 100000 + nanoStep * 1000 + j->toIndex(box.dimensions)),
+                        recvGrid[*j]);
+                }
+            }
+        }
+    }
+
+    Region<2> makeRegion(int source, int target)
+    {
+        Region<2> ret;
+        ret << CoordBox<2>(Coord<2>(source, target), Coord<2>(10 + source, 3 + target))
+            << Streak<2>(Coord<2>(20, 15 + source), 30 + target);
+        return ret;
+    }
+};
+
+}
@@ -239,6 +239,274 @@ public:
         }
     }
 
+    void testMultipleBuffersInFlight()
+    {
+        std::vector<SharedPtr<PatchAccepterType>::Type> accepters;
+        std::vector<SharedPtr<PatchProviderType>::Type> providers;
+        std::size_t numBuffers = 3;
+        int stride = 2;
+        std::size_t maxNanoSteps = 24;
+        // testMultiple2() may still have receives pending on the
+        // default tags while we're already sending:
+        int tagOffset = 100;
+
+        for (int i = 0; i < mpiLayer->size(); ++i) {
+            if (i != mpiLayer->rank()) {
+                accepters << SharedPtr<PatchAccepterType>::Type(
+                    new PatchAccepterType(
+                        region1,
+                        i,
+                        genTag(mpiLayer->rank(), i) + tagOffset,
+                        MPI_INT,
+                        MPI_COMM_WORLD,
+                        numBuffers));
+
+                providers << SharedPtr<PatchProviderType>::Type(
+                    new PatchProviderType(
+                        region1,
+                        i,
+                        genTag(i, mpiLayer->rank()) + tagOffset,
+                        MPI_INT,
+                        MPI_COMM_WORLD,
+                        numBuffers));
+            }
+        }
+
+        for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+            accepters[i]->charge(0, PatchAccepter<GridType>::infinity(), stride);
+            providers[i]->charge(0, PatchProvider<GridType>::infinity(), stride);
+            TS_ASSERT_EQUALS(numBuffers, providers[i]->storedNanoSteps.size());
+        }
+
+        // send as many patches as we have buffers before receiving
+        // any, so all of them are in flight simultaneously:
+        std::size_t blockSize = numBuffers * stride;
+        for (std::size_t block = 0; block < maxNanoSteps; block += blockSize) {
+            for (std::size_t nanoStep = block; nanoStep < (block + blockSize); nanoStep += stride) {
+                GridType mySendGrid = markGrid(region1, mpiLayer->rank() * 10000 + nanoStep * 100);
+
+                for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                    accepters[i]->put(mySendGrid, boundingRegion, boundingBox.dimensions, nanoStep, mpiLayer->rank());
+                }
+            }
+
+            for (std::size_t nanoStep = block; nanoStep < (block + blockSize); nanoStep += stride) {
+                for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                    std::size_t senderRank = i >= mpiLayer->rank() ? i + 1 : i;
+                    GridType expected = markGrid(region1, senderRank * 10000 + nanoStep * 100);
+                    GridType actual = zeroGrid;
+                    providers[i]->get(&actual, boundingRegion, boundingBox.dimensions, nanoStep, senderRank);
+
+                    TS_ASSERT_EQUALS(actual, expected);
+                }
+            }
+        }
+
+        // only the oldest pre-posted receive is matched by a send,
+        // the others need to be dropped by cleanup():
+        GridType mySendGrid = markGrid(region1, mpiLayer->rank());
+        for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+            accepters[i]->put(mySendGrid, boundingRegion, boundingBox.dimensions, maxNanoSteps, mpiLayer->rank());
+        }
+        for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+            providers[i]->cleanup();
+            TS_ASSERT_EQUALS(std::size_t(1), providers[i]->storedNanoSteps.size());
+        }
+    }
+
+    void testDestructionWithoutCleanup()
+    {
+        std::size_t numBuffers = 3;
+        int tagOffset = 200;
+
+        for (int i = 0; i < mpiLayer->size(); ++i) {
+            if (i != mpiLayer->rank()) {
+                PatchProviderType provider(
+                    region1,
+                    i,
+                    genTag(i, mpiLayer->rank()) + tagOffset,
+                    MPI_INT,
+                    MPI_COMM_WORLD,
+                    numBuffers);
+
+                // none of these receives will ever be matched, so
+                // the destructor must not wait for them:
+                provider.charge(0, PatchProvider<GridType>::infinity(), 1);
+                TS_ASSERT_EQUALS(numBuffers, provider.storedNanoSteps.size());
+            }
+        }
+
+        mpiLayer->barrier();
+    }
+
+    void testZeroCopy()
+    {
+        // zero-copy and buffered Accepters need to interoperate with
+        // the same Providers:
+        for (int mode = 0; mode < 2; ++mode) {
+            bool zeroCopyAccepter = (mode == 0);
+
+            std::vector<SharedPtr<PatchAccepterType>::Type> accepters;
+            std::vector<SharedPtr<PatchProviderType>::Type> providers;
+            int stride = 3;
+            std::size_t maxNanoSteps = 20;
+
+            for (int i = 0; i < mpiLayer->size(); ++i) {
+                if (i != mpiLayer->rank()) {
+                    accepters << SharedPtr<PatchAccepterType>::Type(
+                        new PatchAccepterType(
+                            region2,
+                            i,
+                            genTag(mpiLayer->rank(), i),
+                            MPI_INT,
+                            MPI_COMM_WORLD,
+                            PatchLink<GridType>::DEFAULT_NUM_BUFFERS,
+                            zeroCopyAccepter));
+
+                    providers << SharedPtr<PatchProviderType>::Type(
+                        new PatchProviderType(
+                            region2,
+                            i,
+                            genTag(i, mpiLayer->rank()),
+                            MPI_INT));
+                }
+            }
+
+            for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                accepters[i]->charge(0, maxNanoSteps, stride);
+                providers[i]->charge(0, maxNanoSteps, stride);
+            }
+
+            for (std::size_t nanoStep = 0; nanoStep < maxNanoSteps; nanoStep += stride) {
+                GridType mySendGrid = markGrid(region2, mpiLayer->rank() * 10000 + nanoStep * 100);
+
+                for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                    accepters[i]->put(mySendGrid, boundingRegion, boundingBox.dimensions, nanoStep, mpiLayer->rank());
+                }
+                // zero-copy sends read from mySendGrid until released:
+                for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                    accepters[i]->releaseGrid();
+                }
+
+                for (int i = 0; i < mpiLayer->size() - 1; ++i) {
+                    std::size_t senderRank = i >= mpiLayer->rank() ? i + 1 : i;
+                    GridType expected = markGrid(region2, senderRank * 10000 + nanoStep * 100);
+                    GridType actual = zeroGrid;
+                    providers[i]->get(&actual, boundingRegion, boundingBox.dimensions, nanoStep, senderRank);
+
+                    TS_ASSERT_EQUALS(actual, expected);
+                }
+            }
+
+            mpiLayer->barrier();
+        }
+    }
+
+    void testZeroCopyLargePatches()
+    {
+        // patches beyond MPI's eager limit can only be sent once the
+        // receiver has posted a matching receive. All ranks wait for
+        // their sends before they receive, so this would block
+        // forever if the Providers didn't pre-post their receives:
+        CoordBox<2> box(Coord<2>(), Coord<2>(1000, 1000));
+        Region<2> region;
+        region << box;
+        GridType sendGrid(box, mpiLayer->rank());
+
+        std::vector<SharedPtr<PatchAccepterType>::Type> accepters;
+        std::vector<SharedPtr<PatchProviderType>::Type> providers;
+        std::vector<int> senders;
+
+        for (int i = 0; i < mpiLayer->size(); ++i) {
+            if (i != mpiLayer->rank()) {
+                accepters << SharedPtr<PatchAccepterType>::Type(
+                    new PatchAccepterType(
+                        region,
+                        i,
+                        genTag(mpiLayer->rank(), i),
+                        MPI_INT,
+                        MPI_COMM_WORLD,
+                        PatchLink<GridType>::DEFAULT_NUM_BUFFERS,
+                        true));
+
+                providers << SharedPtr<PatchProviderType>::Type(
+                    new PatchProviderType(
+                        region,
+                        i,
+                        genTag(i, mpiLayer->rank()),
+                        MPI_INT));
+                senders << i;
+            }
+        }
+
+        std::size_t maxNanoSteps = 3;
+        for (std::size_t i = 0; i < accepters.size(); ++i) {
+            accepters[i]->charge(0, maxNanoSteps, 1);
+            providers[i]->charge(0, maxNanoSteps, 1);
+        }
+
+        for (std::size_t nanoStep = 0; nanoStep < maxNanoSteps; ++nanoStep) {
+            for (std::size_t i = 0; i < accepters.size(); ++i) {
+                accepters[i]->put(sendGrid, region, box.dimensions, nanoStep, mpiLayer->rank());
+            }
+            for (std::size_t i = 0; i < accepters.size(); ++i) {
+                accepters[i]->releaseGrid();
+            }
+
+            for (std::size_t i = 0; i < providers.size(); ++i) {
+                GridType recvGrid(box, -1);
+                providers[i]->get(&recvGrid, region, box.dimensions, nanoStep, mpiLayer->rank());
+
+                TS_ASSERT_EQUALS(senders[i], recvGrid[Coord<2>(  0,   0)]);
+                TS_ASSERT_EQUALS(senders[i], recvGrid[Coord<2>(999, 999)]);
+            }
+        }
+
+        mpiLayer->barrier();
+    }
+
+    void testZeroCopyFallback()
+    {
+        // one streak wraps around the torus and hence isn't stored
+        // contiguously, so the links need to fall back to buffering:
+        typedef DisplacedGrid<int, Topologies::Torus<2>::Topology, true> TorusGridType;
+        Region<2> region;
+        region << Streak<2>(Coord<2>(-2, 4), 2);
+        region << Streak<2>(Coord<2>( 1, 1), 4);
+
+        TorusGridType sendGrid(boundingBox, 0, 0, boundingBox.dimensions);
+        TorusGridType recvGrid(boundingBox, 0, 0, boundingBox.dimensions);
+        for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+            sendGrid[*i] = mpiLayer->rank() * 1000 + i->y() * 10 + i->x();
+        }
+
+        int receiver = (mpiLayer->rank() + 1) % mpiLayer->size();
+        int sender = (mpiLayer->rank() - 1 + mpiLayer->size()) % mpiLayer->size();
+
+        PatchLink<TorusGridType>::Accepter accepter(
+            region,
+            receiver,
+            4711,
+            MPI_INT,
+            MPI_COMM_WORLD,
+            PatchLink<TorusGridType>::DEFAULT_NUM_BUFFERS,
+            true);
+        PatchLink<TorusGridType>::Provider provider(
+            region,
+            sender,
+            4711,
+            MPI_INT);
+
+        accepter.charge(5, 6, 1);
+        provider.charge(5, 6, 1);
+        accepter.put(sendGrid, boundingRegion, boundingBox.dimensions, 5, mpiLayer->rank());
+        provider.get(&recvGrid, boundingRegion, boundingBox.dimensions, 5, mpiLayer->rank());
+
+        for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+            TS_ASSERT_EQUALS(sender * 1000 + i->y() * 10 + i->x(), recvGrid[*i]);
+        }
+    }
+
     void testSoA()
     {
         Coord<3> dim(30, 20, 10);
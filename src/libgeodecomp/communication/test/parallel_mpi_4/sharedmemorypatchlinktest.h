@@ -0,0 +1,84 @@
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/communication/sharedmemorypatchlink.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class SharedMemoryPatchLinkTest : public CxxTest::TestSuite
+{
+public:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    typedef DisplacedGrid<int> GridType;
+    typedef SharedMemoryPatchLink<GridType> LinkType;
+#endif
+
+    void testRing()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        MPILayer mpiLayer;
+        int rank = mpiLayer.rank();
+        int size = mpiLayer.size();
+        int target = (rank + 1) % size;
+        int source = (rank - 1 + size) % size;
+
+        LinkType::Window window(MPI_COMM_WORLD);
+        for (int i = 0; i < size; ++i) {
+            // all tests run on a single node:
+            TS_ASSERT(window.isLocal(i));
+        }
+
+        CoordBox<2> box(Coord<2>(-10, -5), Coord<2>(40, 30));
+        // the Region differs between ranks, each rank needs to use
+        // the Region of its source when receiving:
+        std::map<int, Region<2> > outgoing;
+        outgoing[target] = makeRegion(rank);
+        window.allocate(outgoing);
+
+        LinkType::Accepter accepter(outgoing[target], target, 4711, MPI_INT, window, rank);
+        LinkType::Provider provider(makeRegion(source), source, 4711, MPI_INT, window, rank);
+        accepter.charge(5, 50, 3);
+        provider.charge(5, 50, 3);
+
+        Region<2> boundingRegion;
+        boundingRegion << box;
+        GridType sendGrid(box, -1);
+        GridType recvGrid(box, -1);
+        for (std::size_t nanoStep = 5; nanoStep < 50; nanoStep += 3) {
+            for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+                sendGrid[*i] = int(rank * 100000 + nanoStep * 1000 + i->toIndex(box.dimensions));
+            }
+
+            // nano steps without a request are to be ignored:
+            accepter.put(sendGrid, boundingRegion, box.dimensions, nanoStep - 1, rank);
+            accepter.put(sendGrid, boundingRegion, box.dimensions, nanoStep, rank);
+            provider.get(&recvGrid, boundingRegion, box.dimensions, nanoStep, rank);
+
+            Region<2> region = makeRegion(source);
+            for (Region<2>::Iterator i = region.begin(); i != region.end(); ++i) {
+                TS_ASSERT_EQUALS(
+                    int(source * 100000 + nanoStep * 1000 + i->toIndex(box.dimensions)),
+                    recvGrid[*i]);
+            }
+        }
+
+        TS_ASSERT_THROWS(window.channel(rank, rank), std::logic_error&);
+        mpiLayer.barrier();
+#endif
+    }
+
+private:
+    Region<2> makeRegion(int rank)
+    {
+        Region<2> ret;
+        ret << CoordBox<2>(Coord<2>(-10 + rank, -5), Coord<2>(3 + rank, 20))
+            << Streak<2>(Coord<2>(5, 7 + rank), 29);
+        return ret;
+    }
+};
+
+}
@@ -0,0 +1,389 @@
+#ifndef LIBGEODECOMP_COMMUNICATION_THREADPATCHLINK_H
+#define LIBGEODECOMP_COMMUNICATION_THREADPATCHLINK_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_CPP14
+
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stringops.h>
+#include <libgeodecomp/storage/patchaccepter.h>
+#include <libgeodecomp/storage/patchprovider.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace ThreadPatchLinkHelpers {
+
+/**
+ * A bounded, lock-free single-producer/single-consumer queue of
+ * serialized patches. Buffers are swapped in and out of the slots,
+ * so once the queue has warmed up neither side needs to allocate.
+ */
+template<typename BUFFER_TYPE>
+class Channel
+{
+public:
+    explicit Channel(std::size_t capacity) :
+        slots(capacity),
+        nanoSteps(capacity),
+        head(0),
+        tail(0)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("Channel requires a capacity of at least 1");
+        }
+    }
+
+    /**
+     * Hands over the contents of buffer. buffer will receive
+     * whatever the consumer left in the slot, which may be reused
+     * for the next patch. Blocks while the queue is full.
+     */
+    void push(std::size_t nanoStep, BUFFER_TYPE *buffer)
+    {
+        std::size_t myTail = tail.load(std::memory_order_relaxed);
+        while ((myTail - head.load(std::memory_order_acquire)) == slots.size()) {
+            std::this_thread::yield();
+        }
+
+        std::size_t slot = myTail % slots.size();
+        nanoSteps[slot] = nanoStep;
+        std::swap(slots[slot], *buffer);
+        tail.store(myTail + 1, std::memory_order_release);
+    }
+
+    /**
+     * Retrieves the oldest patch, blocks while the queue is empty.
+     */
+    void pop(std::size_t *nanoStep, BUFFER_TYPE *buffer)
+    {
+        std::size_t myHead = head.load(std::memory_order_relaxed);
+        while (tail.load(std::memory_order_acquire) == myHead) {
+            std::this_thread::yield();
+        }
+
+        std::size_t slot = myHead % slots.size();
+        *nanoStep = nanoSteps[slot];
+        std::swap(slots[slot], *buffer);
+        head.store(myHead + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<BUFFER_TYPE> slots;
+    std::vector<std::size_t> nanoSteps;
+    // head is only written by the consumer, tail only by the
+    // producer. The padding keeps them on separate cache lines to
+    // avoid false sharing:
+    std::atomic<std::size_t> head;
+    char padding[64];
+    std::atomic<std::size_t> tail;
+};
+
+}
+
+/**
+ * ThreadPatchLink is the counterpart of PatchLink for subdomains
+ * which are hosted by threads of the same process: instead of being
+ * sent via MPI, patches are passed through lock-free queues in
+ * shared memory. All links of a group of threads are connected via a
+ * common ThreadPatchLink::Exchange.
+ */
+template<class GRID_TYPE>
+class ThreadPatchLink
+{
+public:
+    typedef typename GRID_TYPE::CellType CellType;
+    typedef typename SerializationBuffer<CellType>::BufferType BufferType;
+    typedef ThreadPatchLinkHelpers::Channel<BufferType> ChannelType;
+    typedef typename SharedPtr<ChannelType>::Type ChannelPtr;
+
+    const static int DIM = GRID_TYPE::DIM;
+
+    /**
+     * Maximum number of patches per link which may be queued before
+     * the Accepter blocks.
+     */
+    static const std::size_t DEFAULT_CAPACITY = 2;
+
+    /**
+     * Shared by all threads which participate in a simulation. Acts
+     * as the registry for the Channels between them and provides the
+     * (few) collective operations which an UpdateGroup needs during
+     * setup. Channels may still hold patches once a simulation is
+     * done, so an Exchange must not be reused for another one.
+     */
+    class Exchange
+    {
+    public:
+        explicit Exchange(std::size_t size, std::size_t capacity = DEFAULT_CAPACITY) :
+            numThreads(size),
+            capacity(capacity),
+            waiting(0),
+            generation(0),
+            gatherBuffer(size)
+        {
+            if (size == 0) {
+                throw std::invalid_argument("Exchange requires at least one participant");
+            }
+        }
+
+        std::size_t size() const
+        {
+            return numThreads;
+        }
+
+        /**
+         * Returns the Channel for patches sent from source to target.
+         * Accepter and Provider will both call this, whoever comes
+         * first will create the Channel.
+         */
+        ChannelPtr channel(std::size_t source, std::size_t target)
+        {
+            checkRank(source);
+            checkRank(target);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ChannelPtr& ret = channels[std::make_pair(source, target)];
+            if (!ret) {
+                ret.reset(new ChannelType(capacity));
+            }
+
+            return ret;
+        }
+
+        /**
+         * Blocks until all size() threads have called barrier().
+         */
+        void barrier()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            barrierImplementation(lock);
+        }
+
+        std::vector<CoordBox<DIM> > allGather(const CoordBox<DIM>& box, std::size_t rank)
+        {
+            checkRank(rank);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            gatherBuffer[rank] = box;
+            barrierImplementation(lock);
+            std::vector<CoordBox<DIM> > ret = gatherBuffer;
+            // nobody may overwrite gatherBuffer before all threads
+            // have read it:
+            barrierImplementation(lock);
+
+            return ret;
+        }
+
+    private:
+        std::size_t numThreads;
+        std::size_t capacity;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::size_t waiting;
+        std::size_t generation;
+        std::map<std::pair<std::size_t, std::size_t>, ChannelPtr> channels;
+        std::vector<CoordBox<DIM> > gatherBuffer;
+
+        void barrierImplementation(std::unique_lock<std::mutex>& lock)
+        {
+            std::size_t myGeneration = generation;
+            ++waiting;
+            if (waiting == numThreads) {
+                waiting = 0;
+                ++generation;
+                condition.notify_all();
+                return;
+            }
+
+            while (myGeneration == generation) {
+                condition.wait(lock);
+            }
+        }
+
+        void checkRank(std::size_t rank) const
+        {
+            if (rank >= numThreads) {
+                throw std::invalid_argument(
+                    "rank " + StringOps::itoa(rank) + " exceeds Exchange size " + StringOps::itoa(numThreads));
+            }
+        }
+    };
+
+    typedef typename SharedPtr<Exchange>::Type ExchangePtr;
+
+    class Link
+    {
+    public:
+        inline Link(
+            const Region<DIM>& region,
+            ExchangePtr exchange,
+            std::size_t source,
+            std::size_t target) :
+            lastNanoStep(0),
+            stride(1),
+            region(region),
+            channel(exchange->channel(source, target))
+        {}
+
+        virtual ~Link()
+        {}
+
+        /**
+         * Should be called prior to destruction to allow
+         * implementations to perform any cleanup actions (e.g. to
+         * post any receives to pending transmissions).
+         */
+        virtual void cleanup()
+        {}
+
+        virtual void charge(std::size_t next, std::size_t last, std::size_t newStride)
+        {
+            lastNanoStep = last;
+            stride = newStride;
+        }
+
+    protected:
+        std::size_t lastNanoStep;
+        long stride;
+        Region<DIM> region;
+        ChannelPtr channel;
+        BufferType buffer;
+    };
+
+    class Accepter :
+        public Link,
+        public PatchAccepter<GRID_TYPE>
+    {
+    public:
+        using Link::buffer;
+        using Link::channel;
+        using Link::lastNanoStep;
+        using Link::region;
+        using Link::stride;
+        using PatchAccepter<GRID_TYPE>::checkNanoStepPut;
+        using PatchAccepter<GRID_TYPE>::infinity;
+        using PatchAccepter<GRID_TYPE>::pushRequest;
+        using PatchAccepter<GRID_TYPE>::requestedNanoSteps;
+
+        inline Accepter(
+            const Region<DIM>& region,
+            ExchangePtr exchange,
+            std::size_t source,
+            std::size_t target) :
+            Link(region, exchange, source, target)
+        {}
+
+        virtual void charge(std::size_t next, std::size_t last, std::size_t newStride)
+        {
+            Link::charge(next, last, newStride);
+            pushRequest(next);
+        }
+
+        virtual void put(
+            const GRID_TYPE& grid,
+            const Region<DIM>& /*validRegion*/,
+            const Coord<DIM>& globalGridDimensions,
+            const std::size_t nanoStep,
+            const std::size_t rank)
+        {
+            if (!checkNanoStepPut(nanoStep)) {
+                return;
+            }
+
+            SerializationBuffer<CellType>::resize(&buffer, region.size());
+            grid.saveRegion(&buffer, region);
+            channel->push(nanoStep, &buffer);
+
+            std::size_t nextNanoStep = (min)(requestedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                requestedNanoSteps << nextNanoStep;
+            }
+
+            erase_min(requestedNanoSteps);
+        }
+    };
+
+    class Provider :
+        public Link,
+        public PatchProvider<GRID_TYPE>
+    {
+    public:
+        using Link::buffer;
+        using Link::channel;
+        using Link::lastNanoStep;
+        using Link::region;
+        using Link::stride;
+        using PatchProvider<GRID_TYPE>::checkNanoStepGet;
+        using PatchProvider<GRID_TYPE>::infinity;
+        using PatchProvider<GRID_TYPE>::storedNanoSteps;
+        using PatchProvider<GRID_TYPE>::get;
+
+        inline Provider(
+            const Region<DIM>& region,
+            ExchangePtr exchange,
+            std::size_t source,
+            std::size_t target) :
+            Link(region, exchange, source, target)
+        {}
+
+        virtual void charge(std::size_t next, std::size_t last, std::size_t newStride)
+        {
+            Link::charge(next, last, newStride);
+            recv(next);
+        }
+
+        virtual void get(
+            GRID_TYPE *grid,
+            const Region<DIM>& patchableRegion,
+            const Coord<DIM>& globalGridDimensions,
+            const std::size_t nanoStep,
+            const std::size_t rank,
+            const bool remove = true)
+        {
+            if (storedNanoSteps.empty() || (nanoStep < (min)(storedNanoSteps))) {
+                return;
+            }
+
+            checkNanoStepGet(nanoStep);
+
+            std::size_t sentNanoStep;
+            channel->pop(&sentNanoStep, &buffer);
+            if (sentNanoStep != nanoStep) {
+                throw std::logic_error(
+                    "ThreadPatchLink received patch for nano step " + StringOps::itoa(sentNanoStep) +
+                    ", expected " + StringOps::itoa(nanoStep));
+            }
+            grid->loadRegion(buffer, region);
+
+            std::size_t nextNanoStep = (min)(storedNanoSteps) + stride;
+            if ((lastNanoStep == infinity()) ||
+                (nextNanoStep < lastNanoStep)) {
+                recv(nextNanoStep);
+            }
+
+            erase_min(storedNanoSteps);
+        }
+
+        void recv(const std::size_t nanoStep)
+        {
+            storedNanoSteps << nanoStep;
+        }
+    };
+};
+
+}
+
+#endif
+#endif
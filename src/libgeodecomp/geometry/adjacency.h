@@ -28,6 +28,41 @@ public:
      */
     virtual void getNeighbors(int node, std::vector<int> *neighbors) const = 0;
 
+    /**
+     * Appends the neighbors of all nodes in [beginNode, endNode) to
+     * neighbors. Region::expandWithAdjacency() calls this once per
+     * Streak, so implementations may override it if they can
+     * retrieve whole ranges cheaper than node by node.
+     */
+    virtual void getNeighborsOfRange(int beginNode, int endNode, std::vector<int> *neighbors) const
+    {
+        for (int node = beginNode; node < endNode; ++node) {
+            getNeighbors(node, neighbors);
+        }
+    }
+
+    /**
+     * Appends the edges of all nodes in [beginNode, endNode) in
+     * compressed sparse row format: for each node, offsets receives
+     * the index within neighbors at which its neighbors start. This
+     * is the layout graph partitioners (e.g. SCOTCH) expect.
+     */
+    virtual void getRows(int beginNode, int endNode, std::vector<int> *offsets, std::vector<int> *neighbors) const
+    {
+        for (int node = beginNode; node < endNode; ++node) {
+            offsets->push_back(int(neighbors->size()));
+            getNeighbors(node, neighbors);
+        }
+    }
+
+    /**
+     * Is to be called once all edges have been inserted and before
+     * the adjacency is queried, possibly concurrently. Implementations
+     * which compile their edges into a different layout do so here.
+     */
+    virtual void finalize()
+    {}
+
     /**
      * Retrieves the number of edges in the adjacency
      */
@@ -51,6 +86,7 @@ typename SharedPtr<ADJACENCY>::Type MakeAdjacency(const std::vector<std::pair<Co
         result->insert(it->first.y(), it->first.x());
     }
 
+    result->finalize();
     return result;
 }
 
@@ -0,0 +1,192 @@
+#ifndef LIBGEODECOMP_GEOMETRY_BOUNDINGBOXTREE_H
+#define LIBGEODECOMP_GEOMETRY_BOUNDINGBOXTREE_H
+
+#include <libgeodecomp/geometry/coordbox.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * BoundingBoxTree is a bounding volume hierarchy over a set of
+ * CoordBoxes. It is used to find all boxes intersecting a given query
+ * box in O(log(n) + k) (with k being the number of hits) instead of
+ * testing all n boxes -- e.g. to discover a node's neighbors among
+ * the bounding boxes of all nodes' regions. Empty boxes never
+ * intersect anything and are hence not stored at all.
+ */
+template<int DIM>
+class BoundingBoxTree
+{
+public:
+    friend class BoundingBoxTreeTest;
+
+    /**
+     * Leaves hold at most this many boxes. Testing a handful of
+     * boxes linearly is cheaper than descending further.
+     */
+    static const std::size_t MAX_LEAF_SIZE = 4;
+
+    explicit BoundingBoxTree(const std::vector<CoordBox<DIM> >& boxes = std::vector<CoordBox<DIM> >()) :
+        boxes(boxes)
+    {
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes[i].size() > 0) {
+                indices.push_back(i);
+            }
+        }
+
+        if (!indices.empty()) {
+            build(0, indices.size());
+        }
+    }
+
+    /**
+     * Returns the indices of all boxes which intersect box, in
+     * ascending order.
+     */
+    std::vector<std::size_t> query(const CoordBox<DIM>& box) const
+    {
+        std::vector<std::size_t> ret;
+        if (!nodes.empty() && (box.size() > 0)) {
+            query(0, box, &ret);
+        }
+
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    std::size_t size() const
+    {
+        return indices.size();
+    }
+
+private:
+    class Node
+    {
+    public:
+        Node(const CoordBox<DIM>& hull, std::size_t begin, std::size_t end) :
+            hull(hull),
+            begin(begin),
+            end(end),
+            left(0),
+            right(0)
+        {}
+
+        CoordBox<DIM> hull;
+        // range of indices covered by this node:
+        std::size_t begin;
+        std::size_t end;
+        // children, 0 for leaves (the root is never a child):
+        std::size_t left;
+        std::size_t right;
+    };
+
+    /**
+     * Orders box indices by the position of the boxes' centers along
+     * one axis.
+     */
+    class CenterLess
+    {
+    public:
+        CenterLess(const std::vector<CoordBox<DIM> > *boxes, int axis) :
+            boxes(boxes),
+            axis(axis)
+        {}
+
+        bool operator()(std::size_t a, std::size_t b) const
+        {
+            const CoordBox<DIM>& boxA = (*boxes)[a];
+            const CoordBox<DIM>& boxB = (*boxes)[b];
+            return
+                (2 * boxA.origin[axis] + boxA.dimensions[axis]) <
+                (2 * boxB.origin[axis] + boxB.dimensions[axis]);
+        }
+
+    private:
+        const std::vector<CoordBox<DIM> > *boxes;
+        int axis;
+    };
+
+    std::vector<CoordBox<DIM> > boxes;
+    std::vector<std::size_t> indices;
+    std::vector<Node> nodes;
+
+    /**
+     * Creates the node for indices[begin, end) and its subtree by
+     * splitting at the median along the hull's longest axis. Returns
+     * the node's position in nodes.
+     */
+    std::size_t build(std::size_t begin, std::size_t end)
+    {
+        std::size_t nodeIndex = nodes.size();
+        nodes.push_back(Node(hull(begin, end), begin, end));
+
+        if ((end - begin) <= MAX_LEAF_SIZE) {
+            return nodeIndex;
+        }
+
+        const Coord<DIM>& extent = nodes[nodeIndex].hull.dimensions;
+        int axis = 0;
+        for (int d = 1; d < DIM; ++d) {
+            if (extent[d] > extent[axis]) {
+                axis = d;
+            }
+        }
+
+        std::size_t middle = begin + (end - begin) / 2;
+        std::nth_element(
+            indices.begin() + begin,
+            indices.begin() + middle,
+            indices.begin() + end,
+            CenterLess(&boxes, axis));
+
+        // nodes may be reallocated during recursion, so we can't hold
+        // a reference to the current node:
+        std::size_t left = build(begin, middle);
+        std::size_t right = build(middle, end);
+        nodes[nodeIndex].left = left;
+        nodes[nodeIndex].right = right;
+
+        return nodeIndex;
+    }
+
+    CoordBox<DIM> hull(std::size_t begin, std::size_t end) const
+    {
+        Coord<DIM> lower = boxes[indices[begin]].origin;
+        Coord<DIM> upper = lower + boxes[indices[begin]].dimensions;
+
+        for (std::size_t i = begin + 1; i < end; ++i) {
+            const CoordBox<DIM>& box = boxes[indices[i]];
+            lower = (lower.min)(box.origin);
+            upper = (upper.max)(box.origin + box.dimensions);
+        }
+
+        return CoordBox<DIM>(lower, upper - lower);
+    }
+
+    void query(std::size_t nodeIndex, const CoordBox<DIM>& box, std::vector<std::size_t> *ret) const
+    {
+        const Node& node = nodes[nodeIndex];
+        if (!node.hull.intersects(box)) {
+            return;
+        }
+
+        if (node.left == 0) {
+            for (std::size_t i = node.begin; i < node.end; ++i) {
+                if (boxes[indices[i]].intersects(box)) {
+                    ret->push_back(indices[i]);
+                }
+            }
+            return;
+        }
+
+        query(node.left,  box, ret);
+        query(node.right, box, ret);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef LIBGEODECOMP_GEOMETRY_CELLCOSTS_H
+#define LIBGEODECOMP_GEOMETRY_CELLCOSTS_H
+
+#include <libgeodecomp/geometry/coord.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * Interface for estimates of the computational cost of updating
+ * individual cells. Models with strongly varying per-cell work (e.g.
+ * wet vs. dry cells in a hydrodynamics code) can hand such an
+ * estimate to a Partition (see Partition::setCellCosts()) so that
+ * each node receives an equal share of the total work instead of an
+ * equal number of cells.
+ *
+ * Costs are relative to each other, their unit doesn't matter. All
+ * processes need to yield the same costs for the same coordinates.
+ */
+template<int DIM>
+class CellCosts
+{
+public:
+    virtual ~CellCosts()
+    {}
+
+    virtual double cost(const Coord<DIM>& coord) const = 0;
+};
+
+}
+
+#endif
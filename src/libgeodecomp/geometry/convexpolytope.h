@@ -4,37 +4,58 @@
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/plane.h>
-#include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
 namespace LibGeoDecomp {
 
 /**
  * ConvexPolytope is an intersection of half-spaces. On the 2D plane
- * this is a convex polygone, in 3D space a convex polyhedron.
+ * this is a convex polygone, in 3D space a convex polyhedron (see
+ * the specialization below).
  */
-template<typename COORD, typename ID = int>
+template<typename COORD, typename ID = int, int DIMENSIONS = COORD::DIM>
 class ConvexPolytope
 {
 public:
-    const static std::size_t SAMPLES = 1000;
     const static int DIM = COORD::DIM;
 
     typedef Plane<COORD, ID> EquationType;
 
     explicit ConvexPolytope(
         const COORD& center = COORD(),
-        const COORD& simSpaceDim = COORD()) :
-        center(center),
-        simSpaceDim(simSpaceDim),
-        area(simSpaceDim.prod()),
-        diameter(simSpaceDim.maxElement())
+        const COORD& simSpaceDim = COORD())
+    {
+        reset(center, simSpaceDim);
+    }
+
+    /**
+     * Reinitializes the polytope to the whole simulation space while
+     * retaining allocated memory, so a single instance can be reused
+     * for meshing many elements.
+     */
+    void reset(const COORD& newCenter, const COORD& newSimSpaceDim)
     {
+        center = newCenter;
+        simSpaceDim = newSimSpaceDim;
+        myBoundingBox = CoordBox<DIM>();
+        area = simSpaceDim.prod();
+        diameter = simSpaceDim.maxElement();
+
+        limits.clear();
         limits << EquationType(COORD(center[0], 0),              COORD( 0,  1))
                << EquationType(COORD(0, center[1]),              COORD( 1,  0))
                << EquationType(COORD(simSpaceDim[0], center[1]), COORD(-1,  0))
                << EquationType(COORD(center[0], simSpaceDim[1]), COORD( 0, -1));
-        cutPoints = generateCutPoints(limits);
+        generateCutPoints(limits, &cutPoints);
+        updateMaxRadius();
     }
 
     ConvexPolytope& operator<<(const EquationType& eq)
@@ -66,7 +87,7 @@ public:
         }
 
         if (!deleteSet.empty()) {
-            std::vector<EquationType> newLimits;
+            newLimits.clear();
             for (std::size_t i = 0; i < limits.size(); ++i) {
                 if (!deleteSet.count(i)) {
                     newLimits << limits[i];
@@ -82,7 +103,8 @@ public:
         }
 
         if (!deleteSet.empty() || !newLimitIsSuperfluous) {
-            cutPoints = generateCutPoints(limits);
+            generateCutPoints(limits, &cutPoints);
+            updateMaxRadius();
         }
 
         return *this;
@@ -94,6 +116,13 @@ public:
         COORD base = (center + c.first) * 0.5;
         COORD dir = center - c.first;
 
+        // the bisector can't cut off any corner if it's farther away
+        // from the center than all of them:
+        COORD delta = base - center;
+        if ((1.0 * delta[0] * delta[0] + 1.0 * delta[1] * delta[1]) > maxRadiusSquared) {
+            return *this;
+        }
+
         COORD relative = COORD(boundingBox().origin) - base;
         if ((relative[0] > (boundingBox().dimensions[0] + 1)) ||
             (relative[1] > (boundingBox().dimensions[1] + 1))) {
@@ -180,15 +209,7 @@ public:
             return;
         }
 
-        int hits = 0;
-        for (std::size_t i = 0; i < SAMPLES; ++i) {
-            COORD p = COORD(Random::genDouble(delta[0]),
-                            Random::genDouble(delta[1])) + minCoord;
-            if (includes(p)) {
-                ++hits;
-            }
-        }
-        area = 1.0 * hits / SAMPLES * delta.prod();
+        area = polygonArea();
 
         double newDiameter = delta.maxElement();
         if (newDiameter > diameter) {
@@ -205,9 +226,8 @@ public:
     }
 
     /**
-     * The ConvexPolytope's volume is determined via random sampling
-     * integration. Few samples are used, so this method is highly
-     * inaccurate.
+     * The ConvexPolytope's volume is computed from its corners by
+     * the shoelace formula.
      */
     double getVolume() const
     {
@@ -236,7 +256,10 @@ private:
     double area;
     double diameter;
     std::vector<EquationType> limits;
+    std::vector<EquationType> newLimits;
     std::vector<COORD> cutPoints;
+    std::map<double, COORD> sortedPoints;
+    double maxRadiusSquared;
 
     template<int DIM>
     static Coord<DIM> farAway()
@@ -249,9 +272,10 @@ private:
         return COORD(c[1], -c[0]);
     }
 
-    std::vector<COORD> generateCutPoints(const std::vector<EquationType>& equations) const
+    void generateCutPoints(const std::vector<EquationType>& equations, std::vector<COORD> *cutPoints) const
     {
-        std::vector<COORD> buf(2 * equations.size(), farAway<2>());
+        std::vector<COORD>& buf = *cutPoints;
+        buf.assign(2 * equations.size(), farAway<2>());
 
         for (std::size_t i = 0; i < equations.size(); ++i) {
             for (std::size_t j = 0; j < equations.size(); ++j) {
@@ -293,8 +317,55 @@ private:
                 }
             }
         }
+    }
+
+    void updateMaxRadius()
+    {
+        maxRadiusSquared = 0;
+        for (typename std::vector<COORD>::const_iterator i = cutPoints.begin();
+             i != cutPoints.end();
+             ++i) {
+            if (*i == farAway<2>()) {
+                maxRadiusSquared = Limits<double>::getMax();
+                return;
+            }
+
+            COORD delta = *i - center;
+            maxRadiusSquared = (std::max)(
+                maxRadiusSquared,
+                1.0 * delta[0] * delta[0] + 1.0 * delta[1] * delta[1]);
+        }
+    }
+
+    double polygonArea()
+    {
+        sortedPoints.clear();
+        for (typename std::vector<COORD>::const_iterator i = cutPoints.begin();
+             i != cutPoints.end();
+             ++i) {
+            if (*i == farAway<2>()) {
+                continue;
+            }
+
+            sortedPoints[relativeCoordToAngle(*i - center, cutPoints)] = *i;
+        }
 
-        return buf;
+        if (sortedPoints.size() < 3) {
+            return 0;
+        }
+
+        double sum = 0;
+        COORD previous = sortedPoints.rbegin()->second;
+        for (typename std::map<double, COORD>::const_iterator i = sortedPoints.begin();
+             i != sortedPoints.end();
+             ++i) {
+            sum +=
+                1.0 * previous[0] * i->second[1] -
+                1.0 * previous[1] * i->second[0];
+            previous = i->second;
+        }
+
+        return 0.5 * std::abs(sum);
     }
 
     COORD cutPoint(EquationType eq1, EquationType eq2) const
@@ -406,6 +477,382 @@ private:
     }
 };
 
+
+/**
+ * The 3D ConvexPolytope keeps one convex polygon per limiting plane.
+ * Adding a half-space clips all faces against the new plane
+ * (Sutherland-Hodgman) and closes the resulting hole with a new face.
+ * Unlike in 2D the volume and the faces' areas are computed exactly.
+ */
+template<typename COORD, typename ID>
+class ConvexPolytope<COORD, ID, 3>
+{
+public:
+    const static int DIM = 3;
+
+    typedef Plane<COORD, ID> EquationType;
+
+    explicit ConvexPolytope(
+        const COORD& center = COORD(),
+        const COORD& simSpaceDim = COORD())
+    {
+        reset(center, simSpaceDim);
+    }
+
+    /**
+     * Reinitializes the polytope to the whole simulation space while
+     * retaining allocated memory.
+     */
+    void reset(const COORD& newCenter, const COORD& newSimSpaceDim)
+    {
+        center = newCenter;
+        simSpaceDim = newSimSpaceDim;
+        myBoundingBox = CoordBox<DIM>();
+        volume = simSpaceDim.prod();
+        diameter = simSpaceDim.maxElement();
+        epsilon = 1e-9 * diameter;
+
+        // corner i has coordinate d set to simSpaceDim[d] iff bit d of i is set:
+        static const int FACE_CORNERS[6][4] = {
+            {0, 2, 6, 4},
+            {1, 5, 7, 3},
+            {0, 4, 5, 1},
+            {2, 3, 7, 6},
+            {0, 1, 3, 2},
+            {4, 6, 7, 5}
+        };
+
+        limits.clear();
+        limits << EquationType(COORD(0,              center[1],      center[2]),      COORD( 1,  0,  0))
+               << EquationType(COORD(simSpaceDim[0], center[1],      center[2]),      COORD(-1,  0,  0))
+               << EquationType(COORD(center[0],      0,              center[2]),      COORD( 0,  1,  0))
+               << EquationType(COORD(center[0],      simSpaceDim[1], center[2]),      COORD( 0, -1,  0))
+               << EquationType(COORD(center[0],      center[1],      0),              COORD( 0,  0,  1))
+               << EquationType(COORD(center[0],      center[1],      simSpaceDim[2]), COORD( 0,  0, -1));
+
+        faces.resize(6);
+        for (int f = 0; f < 6; ++f) {
+            faces[f].clear();
+            for (int i = 0; i < 4; ++i) {
+                int corner = FACE_CORNERS[f][i];
+                faces[f] << COORD(
+                    (corner & 1) ? simSpaceDim[0] : 0,
+                    (corner & 2) ? simSpaceDim[1] : 0,
+                    (corner & 4) ? simSpaceDim[2] : 0);
+            }
+        }
+
+        updateMaxRadius();
+    }
+
+    ConvexPolytope& operator<<(const EquationType& eq)
+    {
+        // no need to reinsert if limit already present (would only cause trouble)
+        for (typename std::vector<EquationType>::iterator i = limits.begin();
+             i != limits.end();
+             ++i) {
+            if (eq == *i) {
+                return *this;
+            }
+        }
+
+        double tolerance = epsilon * std::sqrt(eq.dir * eq.dir);
+        if (!cutsOffCorner(eq, tolerance)) {
+            return *this;
+        }
+
+        newFace.clear();
+        std::size_t numFaces = 0;
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            clipFace(eq, tolerance, faces[f], &clippedFace);
+            if (clippedFace.size() < 3) {
+                continue;
+            }
+
+            using std::swap;
+            swap(faces[numFaces], clippedFace);
+            limits[numFaces] = limits[f];
+            ++numFaces;
+        }
+        faces.resize(numFaces);
+        limits.erase(limits.begin() + numFaces, limits.end());
+
+        sortFacePoints(eq);
+        if (newFace.size() >= 3) {
+            faces.push_back(newFace);
+            limits << eq;
+        }
+
+        updateMaxRadius();
+        return *this;
+    }
+
+    template<typename POINT>
+    ConvexPolytope& operator<<(const std::pair<POINT, ID>& c)
+    {
+        COORD base = (center + c.first) * 0.5;
+        COORD dir = center - c.first;
+
+        // the bisector can't cut off any corner if it's farther away
+        // from the center than all of them:
+        COORD delta = base - center;
+        if ((delta * delta) >= maxRadiusSquared) {
+            return *this;
+        }
+
+        *this << EquationType(base, dir, c.second);
+        return *this;
+    }
+
+    /**
+     * Returns the polytope's corners in lexicographical order.
+     */
+    std::vector<COORD> getShape() const
+    {
+        std::vector<COORD> res;
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            for (std::size_t i = 0; i < faces[f].size(); ++i) {
+                addUnique(&res, faces[f][i]);
+            }
+        }
+
+        if (res.size() < 4) {
+            throw std::logic_error("polytope is degenerated");
+        }
+
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+
+    bool includes(const COORD& c)
+    {
+        for (std::size_t i = 0; i < limits.size(); ++i) {
+            if (!limits[i].isOnTop(c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const CoordBox<DIM>& boundingBox() const
+    {
+        return myBoundingBox;
+    }
+
+    /**
+     * Computes the bounding box, the area of each face (stored as
+     * the length of the corresponding limit), the volume and the
+     * diameter.
+     */
+    void updateGeometryData(bool updateBoundingBoxOnly = false)
+    {
+        COORD minCoord = simSpaceDim;
+        COORD maxCoord = -simSpaceDim;
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            for (std::size_t i = 0; i < faces[f].size(); ++i) {
+                maxCoord = (faces[f][i].max)(maxCoord);
+                minCoord = (faces[f][i].min)(minCoord);
+            }
+        }
+        COORD delta = maxCoord - minCoord;
+
+        Coord<DIM> minInt;
+        Coord<DIM> deltaInt;
+        for (int i = 0; i < DIM; ++i) {
+            minInt[i] = minCoord[i];
+            deltaInt[i] = delta[i];
+        }
+        myBoundingBox = CoordBox<DIM>(minInt, deltaInt);
+
+        if (updateBoundingBoxOnly) {
+            return;
+        }
+
+        // decompose the polytope into pyramids with a common apex:
+        volume = 0;
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            const std::vector<COORD>& face = faces[f];
+            COORD normal = COORD(0, 0, 0);
+            for (std::size_t i = 1; (i + 1) < face.size(); ++i) {
+                normal += crossProduct(face[i] - face[0], face[i + 1] - face[0]);
+            }
+
+            double faceArea = 0.5 * std::sqrt(normal * normal);
+            double height = ((center - face[0]) * limits[f].dir) / std::sqrt(limits[f].dir * limits[f].dir);
+            limits[f].length = faceArea;
+            volume += faceArea * height / 3;
+        }
+
+        double newDiameter = delta.maxElement();
+        if (newDiameter > diameter) {
+            throw std::logic_error("diameter should never ever increase!");
+        }
+
+        diameter = newDiameter;
+    }
+
+    const COORD& getCenter() const
+    {
+        return center;
+    }
+
+    double getVolume() const
+    {
+        return volume;
+    }
+
+    const std::vector<EquationType>& getLimits() const
+    {
+        return limits;
+    }
+
+    std::vector<EquationType>& getLimits()
+    {
+        return limits;
+    }
+
+    double getDiameter() const
+    {
+        return diameter;
+    }
+
+private:
+    COORD center;
+    COORD simSpaceDim;
+    CoordBox<DIM> myBoundingBox;
+    double volume;
+    double diameter;
+    double epsilon;
+    double maxRadiusSquared;
+    std::vector<EquationType> limits;
+    std::vector<std::vector<COORD> > faces;
+    std::vector<COORD> clippedFace;
+    std::vector<COORD> newFace;
+    std::vector<std::pair<double, COORD> > sortBuffer;
+
+    static COORD crossProduct(const COORD& a, const COORD& b)
+    {
+        return COORD(
+            a[1] * b[2] - a[2] * b[1],
+            a[2] * b[0] - a[0] * b[2],
+            a[0] * b[1] - a[1] * b[0]);
+    }
+
+    static bool compareAngles(const std::pair<double, COORD>& a, const std::pair<double, COORD>& b)
+    {
+        return a.first < b.first;
+    }
+
+    bool cutsOffCorner(const EquationType& eq, double tolerance) const
+    {
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            for (std::size_t i = 0; i < faces[f].size(); ++i) {
+                if (((faces[f][i] - eq.base) * eq.dir) < -tolerance) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void addUnique(std::vector<COORD> *points, const COORD& point) const
+    {
+        for (typename std::vector<COORD>::const_iterator i = points->begin(); i != points->end(); ++i) {
+            COORD delta = *i - point;
+            if ((delta * delta) <= (epsilon * epsilon)) {
+                return;
+            }
+        }
+
+        *points << point;
+    }
+
+    /**
+     * Intersection points are always computed from the inner corner
+     * so that an edge shared by two faces yields identical points.
+     */
+    static COORD intersect(const COORD& inner, double innerDist, const COORD& outer, double outerDist)
+    {
+        return inner + (outer - inner) * (innerDist / (innerDist - outerDist));
+    }
+
+    void clipFace(
+        const EquationType& eq,
+        double tolerance,
+        const std::vector<COORD>& face,
+        std::vector<COORD> *clipped)
+    {
+        clipped->clear();
+
+        for (std::size_t i = 0; i < face.size(); ++i) {
+            const COORD& a = face[i];
+            const COORD& b = face[(i + 1) % face.size()];
+            double distA = (a - eq.base) * eq.dir;
+            double distB = (b - eq.base) * eq.dir;
+
+            if (distA >= -tolerance) {
+                *clipped << a;
+                if (distA <= tolerance) {
+                    addUnique(&newFace, a);
+                }
+                if ((distA > tolerance) && (distB < -tolerance)) {
+                    COORD cut = intersect(a, distA, b, distB);
+                    *clipped << cut;
+                    addUnique(&newFace, cut);
+                }
+            } else if (distB > tolerance) {
+                COORD cut = intersect(b, distB, a, distA);
+                *clipped << cut;
+                addUnique(&newFace, cut);
+            }
+        }
+    }
+
+    /**
+     * Orders the corners of the new face cyclically around their
+     * centroid.
+     */
+    void sortFacePoints(const EquationType& eq)
+    {
+        if (newFace.size() < 3) {
+            return;
+        }
+
+        COORD centroid = COORD(0, 0, 0);
+        for (std::size_t i = 0; i < newFace.size(); ++i) {
+            centroid += newFace[i];
+        }
+        centroid /= newFace.size();
+
+        // u and v are orthogonal and both lie within the plane:
+        COORD u = newFace[0] - centroid;
+        COORD v = crossProduct(eq.dir, u);
+
+        sortBuffer.clear();
+        for (std::size_t i = 0; i < newFace.size(); ++i) {
+            COORD delta = newFace[i] - centroid;
+            sortBuffer << std::make_pair(std::atan2(delta * v, delta * u), newFace[i]);
+        }
+        std::sort(sortBuffer.begin(), sortBuffer.end(), compareAngles);
+
+        for (std::size_t i = 0; i < newFace.size(); ++i) {
+            newFace[i] = sortBuffer[i].second;
+        }
+    }
+
+    void updateMaxRadius()
+    {
+        maxRadiusSquared = 0;
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            for (std::size_t i = 0; i < faces[f].size(); ++i) {
+                COORD delta = faces[f][i] - center;
+                maxRadiusSquared = (std::max)(maxRadiusSquared, delta * delta);
+            }
+        }
+    }
+};
+
 }
 
 #endif
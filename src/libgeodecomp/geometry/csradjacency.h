@@ -0,0 +1,299 @@
+#ifndef LIBGEODECOMP_GEOMETRY_CSRADJACENCY_H
+#define LIBGEODECOMP_GEOMETRY_CSRADJACENCY_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/adjacency.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Stores the edges of a directed graph in compressed sparse row
+ * (CSR) format: the neighbors of node i are columns[offsets[i]] to
+ * columns[offsets[i + 1] - 1], sorted and free of duplicates.
+ *
+ * Edges are collected by insert() in O(1) each and compiled into
+ * CSR format by finalize(), which groups them by source node via a
+ * counting sort and then sorts the individual rows in parallel. This
+ * makes bulk construction (e.g. via MakeAdjacency()) linear in the
+ * number of edges, plus the row sorts. finalize() has to be called
+ * after the last insert() and before the adjacency is queried, so
+ * concurrent queries only ever read. Queries with pending edges
+ * throw.
+ *
+ * Unlike getNeighbors(), neighbors() provides access to a node's
+ * neighbors without copying or allocating.
+ */
+class CSRAdjacency : public Adjacency
+{
+public:
+    /**
+     * A view of the neighbors of a single node.
+     */
+    class Neighbors
+    {
+    public:
+        Neighbors(const int *beginPtr, const int *endPtr) :
+            beginPtr(beginPtr),
+            endPtr(endPtr)
+        {}
+
+        const int *begin() const
+        {
+            return beginPtr;
+        }
+
+        const int *end() const
+        {
+            return endPtr;
+        }
+
+        std::size_t size() const
+        {
+            return std::size_t(endPtr - beginPtr);
+        }
+
+        bool empty() const
+        {
+            return beginPtr == endPtr;
+        }
+
+        int operator[](std::size_t i) const
+        {
+            return beginPtr[i];
+        }
+
+    private:
+        const int *beginPtr;
+        const int *endPtr;
+    };
+
+    CSRAdjacency() :
+        offsets(1, 0)
+    {}
+
+    /**
+     * Builds the adjacency from an edge list in one go.
+     */
+    explicit CSRAdjacency(const std::vector<std::pair<int, int> >& edges) :
+        offsets(1, 0),
+        pending(edges)
+    {
+        for (std::vector<std::pair<int, int> >::const_iterator i = edges.begin(); i != edges.end(); ++i) {
+            checkNode(i->first);
+            checkNode(i->second);
+        }
+        finalize();
+    }
+
+    /**
+     * Insert a single edge (from, to) to the graph
+     */
+    void insert(int from, int to)
+    {
+        checkNode(from);
+        checkNode(to);
+        pending.push_back(std::make_pair(from, to));
+    }
+
+    /**
+     * Returns all x \in V with (node, x) \in E.
+     */
+    void getNeighbors(int node, std::vector<int> *neighbors) const
+    {
+        Neighbors n = this->neighbors(node);
+        neighbors->insert(neighbors->end(), n.begin(), n.end());
+    }
+
+    /**
+     * The rows of consecutive nodes are stored back to back, so their
+     * neighbors can be copied in one go.
+     */
+    void getNeighborsOfRange(int beginNode, int endNode, std::vector<int> *neighbors) const
+    {
+        checkFinalized();
+
+        if (beginNode >= endNode) {
+            return;
+        }
+
+        neighbors->insert(
+            neighbors->end(),
+            columns.begin() + rowBegin(beginNode),
+            columns.begin() + rowBegin(endNode));
+    }
+
+    /**
+     * Copies the slice of the CSR arrays which covers the range.
+     */
+    void getRows(int beginNode, int endNode, std::vector<int> *offsets, std::vector<int> *neighbors) const
+    {
+        checkFinalized();
+
+        if (beginNode >= endNode) {
+            return;
+        }
+
+        int first = rowBegin(beginNode);
+        int base = int(neighbors->size()) - first;
+        for (int node = beginNode; node < endNode; ++node) {
+            offsets->push_back(base + rowBegin(node));
+        }
+
+        neighbors->insert(
+            neighbors->end(),
+            columns.begin() + first,
+            columns.begin() + rowBegin(endNode));
+    }
+
+    Neighbors neighbors(int node) const
+    {
+        checkFinalized();
+
+        if ((node < 0) || (node >= numNodes())) {
+            return Neighbors(0, 0);
+        }
+
+        const int *base = columns.empty() ? 0 : &columns[0];
+        return Neighbors(base + offsets[node], base + offsets[node + 1]);
+    }
+
+    /**
+     * Retrieves the number of edges in the adjacency
+     */
+    std::size_t size() const
+    {
+        checkFinalized();
+        return columns.size();
+    }
+
+    /**
+     * Nodes are numbered 0 to numNodes() - 1, where numNodes() - 1
+     * is the largest ID of any node with outgoing edges.
+     */
+    int numNodes() const
+    {
+        checkFinalized();
+        return int(offsets.size()) - 1;
+    }
+
+    /**
+     * The row pointers: getOffsets()[i] is the index of the first
+     * neighbor of node i within getColumns(),
+     * getOffsets()[numNodes()] equals size().
+     */
+    const std::vector<int>& getOffsets() const
+    {
+        checkFinalized();
+        return offsets;
+    }
+
+    const std::vector<int>& getColumns() const
+    {
+        checkFinalized();
+        return columns;
+    }
+
+    /**
+     * Compiles pending edges into CSR format, merging them with
+     * those compiled before.
+     */
+    void finalize()
+    {
+        if (pending.empty()) {
+            return;
+        }
+
+        // merge with previously compiled edges, if any:
+        for (int node = 0; node < (int(offsets.size()) - 1); ++node) {
+            for (int i = offsets[node]; i < offsets[node + 1]; ++i) {
+                pending.push_back(std::make_pair(node, columns[i]));
+            }
+        }
+
+        int maxNode = -1;
+        for (std::vector<std::pair<int, int> >::const_iterator i = pending.begin(); i != pending.end(); ++i) {
+            maxNode = (std::max)(maxNode, i->first);
+        }
+        int nodes = maxNode + 1;
+
+        // counting sort by source node:
+        offsets.assign(nodes + 1, 0);
+        for (std::vector<std::pair<int, int> >::const_iterator i = pending.begin(); i != pending.end(); ++i) {
+            ++offsets[i->first + 1];
+        }
+        for (int i = 0; i < nodes; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        columns.resize(pending.size());
+        std::vector<int> cursors(offsets.begin(), offsets.end() - 1);
+        for (std::vector<std::pair<int, int> >::const_iterator i = pending.begin(); i != pending.end(); ++i) {
+            columns[cursors[i->first]++] = i->second;
+        }
+        std::vector<std::pair<int, int> >().swap(pending);
+
+        // rows are independent, so they can be sorted in parallel:
+        std::vector<int> rowSizes(nodes);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (int node = 0; node < nodes; ++node) {
+            int *begin = &columns[0] + offsets[node];
+            int *end   = &columns[0] + offsets[node + 1];
+            std::sort(begin, end);
+            rowSizes[node] = int(std::unique(begin, end) - begin);
+        }
+
+        // squeeze out duplicates:
+        int newOffset = 0;
+        for (int node = 0; node < nodes; ++node) {
+            int oldOffset = offsets[node];
+            offsets[node] = newOffset;
+            if (newOffset != oldOffset) {
+                std::copy(columns.begin() + oldOffset,
+                          columns.begin() + oldOffset + rowSizes[node],
+                          columns.begin() + newOffset);
+            }
+            newOffset += rowSizes[node];
+        }
+        offsets[nodes] = newOffset;
+        columns.resize(newOffset);
+    }
+
+private:
+    std::vector<int> offsets;
+    std::vector<int> columns;
+    std::vector<std::pair<int, int> > pending;
+
+    void checkFinalized() const
+    {
+        if (!pending.empty()) {
+            throw std::logic_error("CSRAdjacency needs to be finalized after insert()");
+        }
+    }
+
+    /**
+     * Returns the index of node's first neighbor within columns,
+     * nodes without outgoing edges are clamped to the valid range.
+     */
+    int rowBegin(int node) const
+    {
+        return offsets[(std::max)(0, (std::min)(node, int(offsets.size()) - 1))];
+    }
+
+    static void checkNode(int node)
+    {
+        if (node < 0) {
+            throw std::invalid_argument("CSRAdjacency expects non-negative node IDs");
+        }
+    }
+};
+
+}
+
+#endif
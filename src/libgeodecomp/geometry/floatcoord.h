@@ -202,7 +202,7 @@ public:
 
     template<template<int> class OTHER_COORD>
     inline
-    FloatCoord scale(const OTHER_COORD<1>& other)
+    FloatCoord scale(const OTHER_COORD<1>& other) const
     {
         return FloatCoord(c[0] * other[0]);
     }
@@ -466,7 +466,7 @@ public:
 
     template<template<int> class OTHER_COORD>
     inline
-    FloatCoord scale(const OTHER_COORD<2>& other)
+    FloatCoord scale(const OTHER_COORD<2>& other) const
     {
         return FloatCoord(c[0] * other[0],
                           c[1] * other[1]);
@@ -751,7 +751,7 @@ public:
 
     template<template<int> class OTHER_COORD>
     inline
-    FloatCoord scale(const OTHER_COORD<3>& other)
+    FloatCoord scale(const OTHER_COORD<3>& other) const
     {
         return FloatCoord(c[0] * other[0],
                           c[1] * other[1],
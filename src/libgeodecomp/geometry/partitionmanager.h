@@ -2,12 +2,16 @@
 #define LIBGEODECOMP_GEOMETRY_PARTITIONMANAGER_H
 
 #include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/boundingboxtree.h>
 #include <libgeodecomp/geometry/partitions/stripingpartition.h>
 #include <libgeodecomp/geometry/dummyadjacencymanufacturer.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/regionbasedadjacency.h>
 #include <libgeodecomp/misc/sharedptr.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace LibGeoDecomp {
 
 /**
@@ -15,6 +19,21 @@ namespace LibGeoDecomp {
  * subdomain (as defined by a Partition) and the inner and outer ghost
  * regions (halos) which are used for synchronization with neighboring
  * subdomains.
+ *
+ * Neighbor candidates are found via BoundingBoxTrees over the
+ * (expanded) bounding boxes of all nodes, which answer each query in
+ * O(log(P) + k) for P nodes and k hits. The trees are built once per
+ * decomposition and kept, so other code which needs to match boxes
+ * against all nodes (e.g. cell migration in MPIUpdateGroup) can
+ * reuse them via findNodes() and findNodesExpanded(). Only the
+ * candidates have their regions retrieved and expanded, and these
+ * are clipped to our vicinity before they are expanded (see
+ * clippedRegion()), so the cost per neighbor scales with the size of
+ * our halo, not with the size of the neighbor's region.
+ *
+ * On a torus the expanded regions wrap around the simulation space,
+ * so nodes at opposite edges have intersecting bounding boxes and
+ * are found just the same.
  */
 template<typename TOPOLOGY>
 class PartitionManager
@@ -92,18 +111,36 @@ public:
 
         boundingBoxes = newBoundingBoxes;
         expandedBoundingBoxes = newExpandedBoundingBoxes;
-        CoordBox<DIM> ownBoundingBox = ownRegion().boundingBox();
-        CoordBox<DIM> ownExpandedBoundingBox = ownExpandedRegion().boundingBox();
-
-        for (unsigned i = 0; i < boundingBoxes.size(); ++i) {
-            if ((i != myRank) &&
-                (boundingBoxes[i].intersects(ownExpandedBoundingBox) ||
-                 expandedBoundingBoxes[i].intersects(ownBoundingBox)) &&
-                (!(getRegion(myRank, ghostZoneWidth) &
-                   getRegion(i,      0)).empty() ||
-                 !(getRegion(i,      ghostZoneWidth) &
-                   getRegion(myRank, 0)).empty())) {
-                intersect(i);
+        boundingBoxTree = BoundingBoxTree<DIM>(boundingBoxes);
+        expandedBoundingBoxTree = BoundingBoxTree<DIM>(expandedBoundingBoxes);
+
+        // only nodes whose (expanded) bounding boxes intersect ours
+        // can be neighbors:
+        std::vector<std::size_t> candidates = findNodes(ownExpandedRegion().boundingBox());
+        std::vector<std::size_t> expandedCandidates = findNodesExpanded(ownRegion().boundingBox());
+        std::vector<std::size_t> neighborCandidates;
+        std::set_union(
+            candidates.begin(),
+            candidates.end(),
+            expandedCandidates.begin(),
+            expandedCandidates.end(),
+            std::back_inserter(neighborCandidates));
+
+        // remote cells outside of this region can't contribute to
+        // any ghost zone fragment:
+        Region<DIM> ownVicinity = vicinity(ownRegion(), getGhostZoneWidth()) + ownExpandedRegion();
+
+        for (std::vector<std::size_t>::iterator i = neighborCandidates.begin();
+             i != neighborCandidates.end();
+             ++i) {
+            if (*i == myRank) {
+                continue;
+            }
+
+            std::vector<Region<DIM> > neighborRegion = clippedRegion(*i, ownVicinity, getGhostZoneWidth());
+            if (!(ownExpandedRegion() & neighborRegion[0]).empty() ||
+                !(neighborRegion[ghostZoneWidth] & ownRegion()).empty()) {
+                intersect(*i, neighborRegion);
             }
         }
 
@@ -232,6 +269,75 @@ public:
         return myRank;
     }
 
+    /**
+     * bounding boxes of all nodes' regions, as passed to resetGhostZones().
+     */
+    inline const std::vector<CoordBox<DIM> >& getBoundingBoxes() const
+    {
+        return boundingBoxes;
+    }
+
+    /**
+     * bounding boxes of all nodes' expanded regions (i.e. including
+     * their outer ghost zones), as passed to resetGhostZones().
+     */
+    inline const std::vector<CoordBox<DIM> >& getExpandedBoundingBoxes() const
+    {
+        return expandedBoundingBoxes;
+    }
+
+    /**
+     * Returns the cells from which region can be reached within
+     * width steps, e.g. to be passed to clippedRegion().
+     */
+    inline Region<DIM> vicinity(const Region<DIM>& region, unsigned width) const
+    {
+        return vicinity(region, width, Topology());
+    }
+
+    /**
+     * Yields the expansions 0 to expansionWidth of the given node's
+     * region, but only of its part within vicinity: if vicinity
+     * stems from vicinity(r, expansionWidth), then getRegion(node, i)
+     * & r equals clippedRegion(node, vicinity, expansionWidth)[i] &
+     * r. Unlike getRegion(), this costs time proportional to the size
+     * of the vicinity instead of the size of the node's region.
+     */
+    inline std::vector<Region<DIM> > clippedRegion(
+        unsigned node,
+        const Region<DIM>& vicinity,
+        unsigned expansionWidth) const
+    {
+        std::vector<Region<DIM> > ret(expansionWidth + 1);
+        ret[0] = partition->getRegion(node) & vicinity;
+        for (std::size_t i = 1; i <= expansionWidth; ++i) {
+            ret[i] = ret[i - 1].expandWithTopology(
+                1,
+                simulationArea.dimensions,
+                Topology(),
+                *adjacency(ret[i - 1]));
+        }
+
+        return ret;
+    }
+
+    /**
+     * Returns the (ascending) IDs of all nodes whose bounding boxes
+     * intersect box.
+     */
+    inline std::vector<std::size_t> findNodes(const CoordBox<DIM>& box) const
+    {
+        return boundingBoxTree.query(box);
+    }
+
+    /**
+     * Same as findNodes(), but for the nodes' expanded bounding boxes.
+     */
+    inline std::vector<std::size_t> findNodesExpanded(const CoordBox<DIM>& box) const
+    {
+        return expandedBoundingBoxTree.query(box);
+    }
+
     inline const Coord<DIM>& getSimulationArea() const
     {
         return simulationArea.dimensions;
@@ -253,6 +359,8 @@ private:
     unsigned ghostZoneWidth;
     std::vector<CoordBox<DIM> > boundingBoxes;
     std::vector<CoordBox<DIM> > expandedBoundingBoxes;
+    BoundingBoxTree<DIM> boundingBoxTree;
+    BoundingBoxTree<DIM> expandedBoundingBoxTree;
 
     const SharedPtr<Adjacency>::Type adjacency(const Region<DIM>& region) const
     {
@@ -323,7 +431,36 @@ private:
         innerRim       = ownInnerSets.back() & rim(0);
     }
 
-    inline void intersect(unsigned node)
+    /**
+     * Yields the cells from which region can be reached within width
+     * steps. On structured grids (whose stencils are symmetric) these
+     * are the cells within width of region, unstructured grids grow
+     * the region via the reverse adjacency instead.
+     */
+    template<typename TOPOLOGY2>
+    inline Region<DIM> vicinity(const Region<DIM>& region, unsigned width, TOPOLOGY2 /* unused */) const
+    {
+        return region.expandWithTopology(width, simulationArea.dimensions, Topology());
+    }
+
+    inline Region<DIM> vicinity(
+        const Region<DIM>& region,
+        unsigned width,
+        Topologies::Unstructured::Topology /* unused */) const
+    {
+        Region<DIM> ret = region;
+        for (unsigned i = 0; i < width; ++i) {
+            ret = ret.expandWithTopology(
+                1,
+                simulationArea.dimensions,
+                Topology(),
+                *reverseAdjacency(ret));
+        }
+
+        return ret;
+    }
+
+    inline void intersect(unsigned node, const std::vector<Region<DIM> >& nodeRegion)
     {
         std::vector<Region<DIM> >& outerGhosts = outerGhostZoneFragments[node];
         std::vector<Region<DIM> >& innerGhosts = innerGhostZoneFragments[node];
@@ -334,8 +471,8 @@ private:
         bool innerFragmentsAllEmpty = true;
 
         for (unsigned i = 0; i <= getGhostZoneWidth(); ++i) {
-            outerGhosts[i] = getRegion(myRank, i) & getRegion(node, 0);
-            innerGhosts[i] = getRegion(myRank, 0) & getRegion(node, i);
+            outerGhosts[i] = ownRegion(i) & nodeRegion[0];
+            innerGhosts[i] = ownRegion(0) & nodeRegion[i];
 
             outerFragmentsAllEmpty &= outerGhosts[i].empty();
             innerFragmentsAllEmpty &= innerGhosts[i].empty();
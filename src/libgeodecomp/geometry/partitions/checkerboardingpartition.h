@@ -2,19 +2,24 @@
 #define LIBGEODECOMP_GEOMETRY_PARTITIONS_CHECKERBOARDINGPARTITION_H
 
 #include <libgeodecomp/geometry/partitions/partition.h>
+#include <libgeodecomp/loadbalancer/loadbalancer.h>
 
 namespace LibGeoDecomp {
 
 /**
  * One of the most used decompostition techniques in computer
- * simulations. It yields cuboid subdomains, but can't handle load
- * balancing (neither static nor dynamic). General advice is to use
- * the RecursiveBisectionPartition or the ZCurvePartition instead.
+ * simulations. It yields cuboid subdomains, but ignores the weights,
+ * so it can't handle dynamic load balancing. CellCosts will only
+ * shift the cuts, which run through the whole domain, so nodes may
+ * still end up with varying loads. General advice is to use the
+ * RecursiveBisectionPartition or the ZCurvePartition instead.
  */
 template<int DIM>
 class CheckerboardingPartition : public Partition<DIM>
 {
 public:
+    typedef typename Partition<DIM>::CellCostsPtr CellCostsPtr;
+
     using Partition<DIM>::startOffsets;
     using Partition<DIM>::weights;
 
@@ -28,6 +33,12 @@ public:
         dimensions(dimensions)
     {
         nodeGridDim = getNodeGridDim(weights.size());
+
+        for (int i = 0; i < DIM; ++i) {
+            for (int j = 0; j <= nodeGridDim[i]; ++j) {
+                cuts[i] << j * dimensions[i] / nodeGridDim[i];
+            }
+        }
     }
 
     Region<DIM> getRegion(const std::size_t node) const
@@ -41,18 +52,52 @@ public:
         Coord<DIM> realStart;
         Coord<DIM> realEnd;
         for(int i = 0; i < DIM; ++i){
-            realStart[i] = logicalCoord[i] * dimensions[i] / nodeGridDim[i];
-            realEnd[i] = (logicalCoord[i]+1) * dimensions[i] / nodeGridDim[i];
+            realStart[i] = cuts[i][logicalCoord[i] + 0];
+            realEnd[i]   = cuts[i][logicalCoord[i] + 1];
         }
         Region<DIM> r;
         r << CoordBox<DIM>(origin + realStart, realEnd - realStart);
         return r;
     }
 
+    /**
+     * Places the cuts along each dimension so that all layers of
+     * nodes receive the same share of the costs. All dimensions'
+     * slice costs are accumulated in a single sweep.
+     */
+    virtual void setCellCosts(const CellCostsPtr& costs)
+    {
+        CoordBox<DIM> box(origin, dimensions);
+        LoadBalancer::LoadVec sliceCosts[DIM];
+        for (int i = 0; i < DIM; ++i) {
+            sliceCosts[i].resize(dimensions[i], 0);
+        }
+
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            double cost = costs->cost(*i);
+            for (int j = 0; j < DIM; ++j) {
+                sliceCosts[j][(*i)[j] - origin[j]] += cost;
+            }
+        }
+
+        for (int i = 0; i < DIM; ++i) {
+            LoadBalancer::LoadVec shares(nodeGridDim[i], 1.0);
+            LoadBalancer::WeightVec widths = LoadBalancer::initialWeights(sliceCosts[i], shares);
+
+            cuts[i].clear();
+            cuts[i] << 0;
+            for (std::size_t j = 0; j < widths.size(); ++j) {
+                cuts[i] << cuts[i].back() + int(widths[j]);
+            }
+        }
+    }
+
 private:
     Coord<DIM> origin;
     Coord<DIM> dimensions;
     Coord<DIM> nodeGridDim;
+    // offsets of the boundaries between the layers of nodes, per dimension:
+    std::vector<int> cuts[DIM];
 
     Coord<DIM> getNodeGridDim(const std::size_t totalNodes) const
     {
@@ -11,6 +11,7 @@
 
 #include <mpi.h>
 #include <ptscotch.h>
+#include <algorithm>
 #include <chrono>
 
 #ifdef SCOTCH_PTHREAD
@@ -148,19 +149,9 @@ private:
         verttabGra.reserve(localCells + 1);
         edgetabGra.reserve(numEdges);
 
-        int currentEdge = 0;
-        for (int i = 0; i < localCells; ++i) {
-            verttabGra.push_back(currentEdge);
-
-            std::size_t before = edgetabGra.size();
-            this->adjacency->getNeighbors(start + i, &edgetabGra);
-
-            currentEdge += edgetabGra.size() - before;
-        }
-
-        numEdges = currentEdge;
-
-        verttabGra.push_back(currentEdge);
+        this->adjacency->getRows(int(start), int(start + localCells), &verttabGra, &edgetabGra);
+        numEdges = edgetabGra.size();
+        verttabGra.push_back(numEdges);
 
         error = SCOTCH_dgraphBuild(
                 &graph,
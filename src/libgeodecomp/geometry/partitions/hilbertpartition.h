@@ -26,6 +26,7 @@ public:
     typedef Grid<std::vector<Coord<2> >, Topologies::Cube<3>::Topology> CacheType;
 
     using Partition<2>::AdjacencyPtr;
+    using Partition<2>::CellCostsPtr;
 
     static SharedPtr<CacheType>::Type squareCoordsCache;
     static Form squareFormTransitions[4][4];
@@ -336,6 +337,11 @@ public:
             (*this)[startOffsets[node + 1]]);
     }
 
+    virtual void setCellCosts(const CellCostsPtr& costs)
+    {
+        this->splitByCellCosts((*this)[startOffsets.front()], *costs);
+    }
+
 private:
     using SpaceFillingCurve<2>::startOffsets;
 
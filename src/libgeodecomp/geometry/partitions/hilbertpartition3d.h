@@ -0,0 +1,341 @@
+#ifndef LIBGEODECOMP_GEOMETRY_PARTITIONS_HILBERTPARTITION3D_H
+#define LIBGEODECOMP_GEOMETRY_PARTITIONS_HILBERTPARTITION3D_H
+
+#include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/partitions/spacefillingcurve.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * A 3D variant of the Hilbert curve. Compared to the
+ * ZCurvePartition it yields subdomains with a better surface to
+ * volume ratio.
+ *
+ * Grids whose dimensions aren't equal powers of two are handled by
+ * clipping the curve of the smallest enclosing cube, so subdomains
+ * are not necessarily connected. The traversal of octants follows C.
+ * Hamilton: "Compact Hilbert Indices" (2006).
+ *
+ * getRegion() adds all octants which lie completely within a node's
+ * section of the curve as a whole, so its cost scales with the
+ * surface of the subdomain, not its volume.
+ */
+class HilbertPartition3D : public SpaceFillingCurve<3>
+{
+public:
+    friend class HilbertPartition3DTest;
+
+    using Partition<3>::AdjacencyPtr;
+    using Partition<3>::CellCostsPtr;
+
+    static const int NUM_OCTANTS = 8;
+
+    /**
+     * A cube of edge length 2^level within the curve's recursion
+     * tree. entry and direction define the orientation in which the
+     * curve traverses the cube.
+     */
+    class Cube
+    {
+    public:
+        inline Cube(
+            const Coord<3>& origin = Coord<3>(),
+            int level = 0,
+            int entry = 0,
+            int direction = 0) :
+            origin(origin),
+            level(level),
+            entry(entry),
+            direction(direction)
+        {}
+
+        /**
+         * Returns the index-th octant along the curve.
+         */
+        inline Cube child(int index) const
+        {
+            int label = rotateLeft(grayCode(index), direction + 1) ^ entry;
+            int halfLength = 1 << (level - 1);
+
+            Coord<3> childOrigin = origin;
+            for (int d = 0; d < 3; ++d) {
+                if ((label >> d) & 1) {
+                    childOrigin[d] += halfLength;
+                }
+            }
+
+            return Cube(
+                childOrigin,
+                level - 1,
+                entry ^ rotateLeft(childEntry(index), direction + 1),
+                (direction + childDirection(index) + 1) % 3);
+        }
+
+        inline std::string toString() const
+        {
+            std::stringstream s;
+            s << "Cube(origin: " << origin << ", level: " << level
+              << ", entry: " << entry << ", direction: " << direction << ")";
+            return s.str();
+        }
+
+        Coord<3> origin;
+        int level;
+        int entry;
+        int direction;
+
+    private:
+        static inline int grayCode(int i)
+        {
+            return i ^ (i >> 1);
+        }
+
+        static inline int trailingSetBits(int i)
+        {
+            int ret = 0;
+            for (; i & 1; i >>= 1) {
+                ++ret;
+            }
+            return ret;
+        }
+
+        static inline int rotateLeft(int bits, int shift)
+        {
+            shift %= 3;
+            return ((bits << shift) | (bits >> (3 - shift))) & 7;
+        }
+
+        static inline int childEntry(int index)
+        {
+            return (index == 0) ? 0 : grayCode(2 * ((index - 1) / 2));
+        }
+
+        static inline int childDirection(int index)
+        {
+            if (index == 0) {
+                return 0;
+            }
+
+            return ((index % 2) ? trailingSetBits(index) : trailingSetBits(index - 1)) % 3;
+        }
+    };
+
+    class Iterator : public SpaceFillingCurve<3>::Iterator
+    {
+    public:
+        using SpaceFillingCurve<3>::Iterator::cursor;
+        using SpaceFillingCurve<3>::Iterator::endReached;
+
+        inline Iterator(
+            const HilbertPartition3D *partition,
+            std::size_t pos) :
+            SpaceFillingCurve<3>::Iterator(partition->origin, false),
+            partition(partition)
+        {
+            if (pos >= partition->numCells(partition->rootCube())) {
+                endReached = true;
+                return;
+            }
+
+            digDown(partition->rootCube(), pos);
+        }
+
+        inline explicit Iterator(const Coord<3>& origin) :
+            SpaceFillingCurve<3>::Iterator(origin, true),
+            partition(0)
+        {}
+
+        inline Iterator& operator++()
+        {
+            if (endReached) {
+                return *this;
+            }
+
+            while (!stack.empty()) {
+                Frame& frame = stack.back();
+                for (++frame.index; frame.index < NUM_OCTANTS; ++frame.index) {
+                    Cube child = frame.cube.child(frame.index);
+                    if (partition->numCells(child) > 0) {
+                        digDown(child, 0);
+                        return *this;
+                    }
+                }
+
+                stack.pop_back();
+            }
+
+            endReached = true;
+            cursor = partition->origin;
+            return *this;
+        }
+
+    private:
+        /**
+         * Remembers which octant of a cube we're currently
+         * traversing.
+         */
+        class Frame
+        {
+        public:
+            inline Frame(const Cube& cube, int index) :
+                cube(cube),
+                index(index)
+            {}
+
+            Cube cube;
+            int index;
+        };
+
+        const HilbertPartition3D *partition;
+        std::vector<Frame> stack;
+
+        inline void digDown(Cube cube, std::size_t pos)
+        {
+            while (cube.level > 0) {
+                for (int i = 0; i < NUM_OCTANTS; ++i) {
+                    Cube child = cube.child(i);
+                    std::size_t cells = partition->numCells(child);
+                    if (pos < cells) {
+                        stack.push_back(Frame(cube, i));
+                        cube = child;
+                        break;
+                    }
+
+                    pos -= cells;
+                }
+            }
+
+            cursor = cube.origin;
+        }
+    };
+
+    inline explicit HilbertPartition3D(
+        const Coord<3>& origin = Coord<3>(),
+        const Coord<3>& dimensions = Coord<3>(),
+        const long& offset = 0,
+        const std::vector<std::size_t>& weights = std::vector<std::size_t>(2),
+        const AdjacencyPtr& /* unused: adjacency */ = AdjacencyPtr()) :
+        SpaceFillingCurve<3>(offset, weights),
+        origin(origin),
+        dimensions(dimensions),
+        level(0)
+    {
+        while ((1 << level) < dimensions.maxElement()) {
+            ++level;
+        }
+    }
+
+    inline Iterator operator[](std::size_t pos) const
+    {
+        return Iterator(this, pos);
+    }
+
+    inline Iterator begin() const
+    {
+        return (*this)[0];
+    }
+
+    inline Iterator end() const
+    {
+        return Iterator(origin);
+    }
+
+    inline Region<3> getRegion(const std::size_t node) const
+    {
+        std::vector<Streak<3> > streaks;
+        collectStreaks(&streaks, rootCube(), startOffsets[node + 0], startOffsets[node + 1]);
+        return SpaceFillingCurve<3>::streaksToRegion(&streaks);
+    }
+
+    virtual void setCellCosts(const CellCostsPtr& costs)
+    {
+        splitByCellCosts((*this)[startOffsets.front()], *costs);
+    }
+
+private:
+    using SpaceFillingCurve<3>::startOffsets;
+
+    Coord<3> origin;
+    Coord<3> dimensions;
+    int level;
+
+    inline Cube rootCube() const
+    {
+        return Cube(origin, level);
+    }
+
+    /**
+     * Returns the part of the cube which lies within the simulation
+     * space (may be empty).
+     */
+    inline CoordBox<3> clip(const Cube& cube) const
+    {
+        CoordBox<3> ret;
+        int length = 1 << cube.level;
+
+        for (int d = 0; d < 3; ++d) {
+            int begin = (std::max)(cube.origin[d], origin[d]);
+            int end = (std::min)(cube.origin[d] + length, origin[d] + dimensions[d]);
+            ret.origin[d] = begin;
+            ret.dimensions[d] = (std::max)(end - begin, 0);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Yields the number of cells of the cube which lie within the
+     * simulation space. Coord::prod() might overflow for large grids.
+     */
+    inline std::size_t numCells(const Cube& cube) const
+    {
+        Coord<3> dim = clip(cube).dimensions;
+        return std::size_t(dim.x()) * dim.y() * dim.z();
+    }
+
+    /**
+     * Adds the streaks of all cells within the section [begin, end)
+     * of the curve through cube to streaks. Cubes which are covered
+     * completely are added as a whole.
+     */
+    void collectStreaks(
+        std::vector<Streak<3> > *streaks,
+        const Cube& cube,
+        std::size_t begin,
+        std::size_t end) const
+    {
+        std::size_t cells = numCells(cube);
+        if ((begin == 0) && (end >= cells)) {
+            CoordBox<3> box = clip(cube);
+            for (CoordBox<3>::StreakIterator i = box.beginStreak(); i != box.endStreak(); ++i) {
+                *streaks << *i;
+            }
+            return;
+        }
+
+        std::size_t offset = 0;
+        for (int i = 0; (i < NUM_OCTANTS) && (offset < end); ++i) {
+            Cube child = cube.child(i);
+            std::size_t childCells = numCells(child);
+
+            if ((childCells > 0) && (begin < (offset + childCells))) {
+                collectStreaks(
+                    streaks,
+                    child,
+                    (begin > offset) ? (begin - offset) : 0,
+                    end - offset);
+            }
+
+            offset += childCells;
+        }
+    }
+};
+
+}
+
+#endif
@@ -553,6 +553,11 @@ public:
         return Iterator(origin, dimensions, pos);
     }
 
+    virtual void setCellCosts(const CellCostsPtr& costs)
+    {
+        this->splitByCellCosts((*this)[startOffsets.front()], *costs);
+    }
+
 private:
     using SpaceFillingCurve<2>::startOffsets;
 
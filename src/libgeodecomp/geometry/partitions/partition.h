@@ -2,6 +2,7 @@
 #define LIBGEODECOMP_GEOMETRY_PARTITIONS_PARTITION_H
 
 #include <libgeodecomp/geometry/adjacency.h>
+#include <libgeodecomp/geometry/cellcosts.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
@@ -19,6 +20,7 @@ class Partition
 {
 public:
     typedef typename SharedPtr<Adjacency>::Type AdjacencyPtr;
+    typedef typename SharedPtr<CellCosts<DIM> >::Type CellCostsPtr;
 
     /**
      * initializes the partition so that the domain will be split up
@@ -52,6 +54,20 @@ public:
 
     virtual Region<DIM> getRegion(const std::size_t node) const = 0;
 
+    /**
+     * Makes the Partition split the domain by accumulated cell costs
+     * rather than by cell count: each node will then receive a share
+     * of the total cost proportional to its weight. The weights still
+     * need to sum up to the number of cells, so LoadBalancers can
+     * work with them as usual.
+     *
+     * Space-filling curves, the RecursiveBisectionPartition and the
+     * CheckerboardingPartition support this, the default
+     * implementation ignores the costs.
+     */
+    virtual void setCellCosts(const CellCostsPtr& /* unused: costs */)
+    {}
+
 protected:
     std::vector<std::size_t> weights;
     std::vector<std::size_t> startOffsets;
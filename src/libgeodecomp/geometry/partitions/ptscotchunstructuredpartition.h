@@ -10,6 +10,7 @@
 
 #include <ptscotch.h>
 
+#include <algorithm>
 #include <chrono>
 
 namespace LibGeoDecomp {
@@ -77,17 +78,9 @@ private:
         verttabGra.reserve(numCells + 1);
         edgetabGra.reserve(numEdges);
 
-        int currentEdge = 0;
-        for (int i = 0; i < numCells; ++i) {
-            verttabGra.push_back(currentEdge);
-
-            std::size_t before = edgetabGra.size();
-            this->adjacency->getNeighbors(i, &edgetabGra);
-
-            currentEdge += edgetabGra.size() - before;
-        }
-
-        verttabGra.push_back(currentEdge);
+        this->adjacency->getRows(0, numCells, &verttabGra, &edgetabGra);
+        numEdges = edgetabGra.size();
+        verttabGra.push_back(numEdges);
 
         error = SCOTCH_graphBuild(
                 &graph,
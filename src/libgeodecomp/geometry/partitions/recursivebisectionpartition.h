@@ -3,6 +3,7 @@
 
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/partitions/partition.h>
+#include <libgeodecomp/loadbalancer/loadbalancer.h>
 #include <libgeodecomp/misc/math.h>
 
 namespace LibGeoDecomp {
@@ -12,6 +13,10 @@ namespace LibGeoDecomp {
  * yields perfectly rectangular domains which can be acutely tuned to
  * match load profiles, but small changes in the load vector may lead
  * to huge communication volumes for rebalanciation.
+ *
+ * If CellCosts are set, each cut is placed so that the accumulated
+ * costs (rather than the volumes) of both halves match their
+ * weights.
  */
 template<int DIM>
 class RecursiveBisectionPartition : public Partition<DIM>
@@ -20,6 +25,7 @@ public:
     friend class RecursiveBisectionPartitionTest;
     typedef std::vector<std::size_t> SizeTVec;
     typedef typename Partition<DIM>::AdjacencyPtr AdjacencyPtr;
+    typedef typename Partition<DIM>::CellCostsPtr CellCostsPtr;
 
     inline explicit RecursiveBisectionPartition(
         const Coord<DIM>& origin = Coord<DIM>(),
@@ -40,23 +46,52 @@ public:
 
     inline Region<DIM> getRegion(const std::size_t i) const
     {
-        CoordBox<DIM> cuboid = searchNodeCuboid(
+        Region<DIM> r;
+
+        if (costs) {
+            r << cuboids[i];
+            return r;
+        }
+
+        r << searchNodeCuboid(
             startOffsets.begin(),
             startOffsets.end() - 1,
             startOffsets.begin() + i,
             CoordBox<DIM>(origin, dimensions));
-
-        Region<DIM> r;
-        r << cuboid;
         return r;
     }
 
+    /**
+     * Evaluating the costs requires sweeps over the domain, so we
+     * compute all nodes' cuboids in one go.
+     */
+    virtual void setCellCosts(const CellCostsPtr& newCosts)
+    {
+        costs = newCosts;
+        cuboids.resize(startOffsets.size() - 1);
+
+        CoordBox<DIM> box(origin, dimensions);
+        computeAllCuboids(
+            startOffsets.begin(),
+            startOffsets.end() - 1,
+            box,
+            accumulateSliceCosts(box));
+    }
+
 private:
     using Partition<DIM>::startOffsets;
 
+    /**
+     * Accumulated costs of the slices of a box, one LoadVec per
+     * dimension.
+     */
+    typedef std::vector<LoadBalancer::LoadVec> SliceCosts;
+
     Coord<DIM> origin;
     Coord<DIM> dimensions;
     Coord<DIM> dimWeights;
+    CellCostsPtr costs;
+    std::vector<CoordBox<DIM> > cuboids;
 
     /**
      * returns the CoordBox which belongs to the node whose weight is
@@ -74,6 +109,51 @@ private:
             return box;
         }
 
+        CoordBox<DIM> newBoxes[2];
+        SizeTVec::const_iterator approxMiddle = bisect(begin, end, box, newBoxes);
+
+        if (*node < *approxMiddle) {
+            return searchNodeCuboid(begin, approxMiddle, node, newBoxes[0]);
+        } else {
+            return searchNodeCuboid(approxMiddle, end, node, newBoxes[1]);
+        }
+    }
+
+    void computeAllCuboids(
+        const SizeTVec::const_iterator& begin,
+        const SizeTVec::const_iterator& end,
+        const CoordBox<DIM>& box,
+        const SliceCosts& sliceCosts)
+    {
+        if (std::distance(begin, end) == 1) {
+            cuboids[begin - startOffsets.begin()] = box;
+            return;
+        }
+
+        CoordBox<DIM> newBoxes[2];
+        SliceCosts newSliceCosts[2];
+        SizeTVec::const_iterator approxMiddle = bisect(begin, end, box, newBoxes, &sliceCosts);
+        if ((std::distance(begin, approxMiddle) > 1) || (std::distance(approxMiddle, end) > 1)) {
+            splitSliceCosts(newBoxes, box, sliceCosts, newSliceCosts);
+        }
+
+        computeAllCuboids(begin, approxMiddle, newBoxes[0], newSliceCosts[0]);
+        computeAllCuboids(approxMiddle, end, newBoxes[1], newSliceCosts[1]);
+    }
+
+    /**
+     * Splits the nodes from begin to end into two groups of roughly
+     * equal weight, returns the start of the second group. newBoxes
+     * will receive the corresponding halves of box. If sliceCosts
+     * are given, the cut will be placed by cost rather than volume.
+     */
+    SizeTVec::const_iterator bisect(
+        const SizeTVec::const_iterator& begin,
+        const SizeTVec::const_iterator& end,
+        const CoordBox<DIM>& box,
+        CoordBox<DIM> *newBoxes,
+        const SliceCosts *sliceCosts = 0) const
+    {
         std::size_t halfWeight = (*begin + *end) / 2;
 
         SizeTVec::const_iterator approxMiddle = std::lower_bound(
@@ -90,20 +170,16 @@ private:
         }
 
         double ratio = 1.0 * (*approxMiddle - *begin) / (*end - *begin);
-        CoordBox<DIM> newBoxes[2];
-        splitBox(newBoxes, box, ratio);
+        splitBox(newBoxes, box, ratio, sliceCosts);
 
-        if (*node < *approxMiddle) {
-            return searchNodeCuboid(begin, approxMiddle, node, newBoxes[0]);
-        } else {
-            return searchNodeCuboid(approxMiddle, end, node, newBoxes[1]);
-        }
+        return approxMiddle;
     }
 
     inline void splitBox(
         CoordBox<DIM> *newBoxes,
         const CoordBox<DIM>& oldBox,
-        double ratio) const
+        double ratio,
+        const SliceCosts *sliceCosts) const
     {
         newBoxes[0] = oldBox;
         newBoxes[1] = oldBox;
@@ -116,12 +192,79 @@ private:
             }
         }
 
-        int offset = round(ratio * dim[longestDim]);
+        int offset = sliceCosts ?
+            costWeightedOffset((*sliceCosts)[longestDim], ratio) :
+            int(round(ratio * dim[longestDim]));
         int remainder = dim[longestDim] - offset;
         newBoxes[0].dimensions[longestDim] = offset;
         newBoxes[1].dimensions[longestDim] = remainder;
         newBoxes[1].origin[longestDim] += offset;
     }
+
+    /**
+     * Returns the number of slices which hold a fraction of ratio of
+     * the accumulated costs.
+     */
+    int costWeightedOffset(const LoadBalancer::LoadVec& sliceCosts, double ratio) const
+    {
+        LoadBalancer::LoadVec shares;
+        shares << ratio
+               << 1.0 - ratio;
+        return int(LoadBalancer::initialWeights(sliceCosts, shares)[0]);
+    }
+
+    /**
+     * Sweeps box once to accumulate its slice costs along all
+     * dimensions.
+     */
+    SliceCosts accumulateSliceCosts(const CoordBox<DIM>& box) const
+    {
+        SliceCosts ret(DIM);
+        for (int d = 0; d < DIM; ++d) {
+            ret[d].resize(box.dimensions[d], 0);
+        }
+
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            double cost = costs->cost(*i);
+            for (int d = 0; d < DIM; ++d) {
+                ret[d][(*i)[d] - box.origin[d]] += cost;
+            }
+        }
+
+        return ret;
+    }
+
+    /**
+     * Derives the slice costs of both halves of oldBox from its own:
+     * along the split dimension they're just subranges. For the
+     * other dimensions only the smaller half needs to be swept, the
+     * larger one gets the remainder.
+     */
+    void splitSliceCosts(
+        const CoordBox<DIM> *newBoxes,
+        const CoordBox<DIM>& oldBox,
+        const SliceCosts& sliceCosts,
+        SliceCosts *newSliceCosts) const
+    {
+        int smaller = (newBoxes[0].size() <= newBoxes[1].size()) ? 0 : 1;
+        int larger = 1 - smaller;
+        newSliceCosts[smaller] = accumulateSliceCosts(newBoxes[smaller]);
+        newSliceCosts[larger].resize(DIM);
+
+        for (int d = 0; d < DIM; ++d) {
+            if (newBoxes[smaller].dimensions[d] != oldBox.dimensions[d]) {
+                LoadBalancer::LoadVec::const_iterator begin =
+                    sliceCosts[d].begin() + (newBoxes[larger].origin[d] - oldBox.origin[d]);
+                newSliceCosts[larger][d].assign(begin, begin + newBoxes[larger].dimensions[d]);
+                continue;
+            }
+
+            newSliceCosts[larger][d] = sliceCosts[d];
+            for (std::size_t i = 0; i < sliceCosts[d].size(); ++i) {
+                newSliceCosts[larger][d][i] -= newSliceCosts[smaller][d][i];
+            }
+        }
+    }
 };
 
 template<typename _CharT, typename _Traits, int _Dim>
@@ -5,6 +5,9 @@
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/partitions/partition.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace LibGeoDecomp {
 
 enum SpaceFillingCurveSublevelState {TRIVIAL, CACHED};
@@ -65,8 +68,98 @@ public:
     inline SpaceFillingCurve(
         const long& offset,
         const std::vector<std::size_t>& weights) :
-        Partition<DIM>(offset, weights)
+        Partition<DIM>(offset, weights),
+        shares(weights)
     {}
+
+protected:
+    using Partition<DIM>::startOffsets;
+    using Partition<DIM>::weights;
+
+    // the weights as passed in by the user. splitByCellCosts()
+    // overwrites weights with the resulting number of cells per node:
+    std::vector<std::size_t> shares;
+
+    /**
+     * Orders Streaks the way Region stores them (i.e. the last
+     * dimension is the most significant one).
+     */
+    class StreakComparator
+    {
+    public:
+        inline bool operator()(const Streak<DIM>& a, const Streak<DIM>& b) const
+        {
+            for (int d = DIM - 1; d >= 0; --d) {
+                if (a.origin[d] != b.origin[d]) {
+                    return a.origin[d] < b.origin[d];
+                }
+            }
+
+            return false;
+        }
+    };
+
+    /**
+     * Builds a Region from disjoint Streaks, which may be given in
+     * any order. Sorting them first lets the Region append them at
+     * its end instead of inserting them somewhere in the middle.
+     */
+    static Region<DIM> streaksToRegion(std::vector<Streak<DIM> > *streaks)
+    {
+        std::sort(streaks->begin(), streaks->end(), StreakComparator());
+        return Region<DIM>(streaks->begin(), streaks->end());
+    }
+
+    /**
+     * Moves the start offsets along the curve so that each node's
+     * share of the accumulated cell costs matches its share of the
+     * weights. begin needs to point to the first cell of the curve
+     * segment covered by the Partition. A cell is assigned to the
+     * next node if more than half of its cost would exceed the
+     * current node's share. Walks the curve twice but doesn't need
+     * to store any per-cell data. Afterwards getWeights() yields the
+     * number of cells assigned to each node, so LoadBalancers see
+     * the actual decomposition.
+     */
+    template<typename ITERATOR>
+    void splitByCellCosts(const ITERATOR& begin, const CellCosts<DIM>& costs)
+    {
+        std::size_t numCells = startOffsets.back() - startOffsets.front();
+        double totalWeight = startOffsets.back() - startOffsets.front();
+        if (numCells == 0) {
+            return;
+        }
+
+        double totalCost = 0;
+        ITERATOR iter = begin;
+        for (std::size_t i = 0; i < numCells; ++i, ++iter) {
+            totalCost += costs.cost(*iter);
+        }
+
+        std::size_t node = 0;
+        double accumulatedWeight = shares[0];
+        double accumulatedCost = 0;
+        iter = begin;
+        for (std::size_t i = 0; i < numCells; ++i, ++iter) {
+            double cost = costs.cost(*iter);
+            while ((node < (shares.size() - 1)) &&
+                   ((accumulatedCost + 0.5 * cost) > (totalCost * accumulatedWeight / totalWeight))) {
+                ++node;
+                startOffsets[node] = startOffsets.front() + i;
+                accumulatedWeight += shares[node];
+            }
+
+            accumulatedCost += cost;
+        }
+
+        for (++node; node < shares.size(); ++node) {
+            startOffsets[node] = startOffsets.back();
+        }
+
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            weights[i] = startOffsets[i + 1] - startOffsets[i];
+        }
+    }
 };
 
 }
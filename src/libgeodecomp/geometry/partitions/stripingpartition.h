@@ -23,6 +23,7 @@ public:
     const static int DIM = DIMENSIONS;
     typedef typename CoordBox<DIM>::Iterator Iterator;
     typedef typename Partition<DIM>::AdjacencyPtr AdjacencyPtr;
+    typedef typename Partition<DIM>::CellCostsPtr CellCostsPtr;
 
     explicit StripingPartition(
         const Coord<DIM>& origin = Coord<DIM>(),
@@ -67,6 +68,11 @@ public:
         return Iterator(origin, cursor, dimensions);
     }
 
+    virtual void setCellCosts(const CellCostsPtr& costs)
+    {
+        this->splitByCellCosts((*this)[startOffsets.front()], *costs);
+    }
+
 
 private:
     using SpaceFillingCurve<DIMENSIONS>::startOffsets;
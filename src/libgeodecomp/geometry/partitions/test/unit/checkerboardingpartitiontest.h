@@ -7,6 +7,18 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+/**
+ * Cells left of x = 5 are three times as expensive as the others.
+ */
+class CheckerboardingPartitionTestCosts : public CellCosts<2>
+{
+public:
+    double cost(const Coord<2>& coord) const
+    {
+        return (coord.x() < 5) ? 3 : 1;
+    }
+};
+
 class CheckerboardingPartitionTest : public CxxTest::TestSuite
 {
 public:
@@ -95,6 +107,28 @@ public:
         }
     }
 
+    void testCellCosts()
+    {
+        std::vector<std::size_t> weights(4, 100);
+        CheckerboardingPartition<2> p(Coord<2>(), Coord<2>(20, 20), 0, weights);
+        p.setCellCosts(CheckerboardingPartition<2>::CellCostsPtr(new CheckerboardingPartitionTestCosts));
+
+        // the expensive columns make up half of the total costs:
+        Region<2> expected0;
+        Region<2> expected1;
+        Region<2> expected2;
+        Region<2> expected3;
+        expected0 << CoordBox<2>(Coord<2>(0,  0), Coord<2>( 5, 10));
+        expected1 << CoordBox<2>(Coord<2>(5,  0), Coord<2>(15, 10));
+        expected2 << CoordBox<2>(Coord<2>(0, 10), Coord<2>( 5, 10));
+        expected3 << CoordBox<2>(Coord<2>(5, 10), Coord<2>(15, 10));
+
+        TS_ASSERT_EQUALS(expected0, p.getRegion(0));
+        TS_ASSERT_EQUALS(expected1, p.getRegion(1));
+        TS_ASSERT_EQUALS(expected2, p.getRegion(2));
+        TS_ASSERT_EQUALS(expected3, p.getRegion(3));
+    }
+
     void test3DwithNonEvenDivisions()
     {
         Coord<3> origin(10, 20, 30);
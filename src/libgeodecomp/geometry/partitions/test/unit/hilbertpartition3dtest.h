@@ -0,0 +1,135 @@
+#include <libgeodecomp/geometry/partitions/hilbertpartition3d.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class HilbertPartition3DTest : public CxxTest::TestSuite
+{
+public:
+    typedef std::vector<Coord<3> > CoordVector;
+
+    void testSimple()
+    {
+        HilbertPartition3D partition(Coord<3>(1, 2, 3), Coord<3>(2, 2, 2));
+
+        CoordVector expected;
+        expected << Coord<3>(1, 2, 3)
+                 << Coord<3>(1, 3, 3)
+                 << Coord<3>(1, 3, 4)
+                 << Coord<3>(1, 2, 4)
+                 << Coord<3>(2, 2, 4)
+                 << Coord<3>(2, 3, 4)
+                 << Coord<3>(2, 3, 3)
+                 << Coord<3>(2, 2, 3);
+
+        TS_ASSERT_EQUALS(expected, iterate(partition));
+    }
+
+    void testContinuity()
+    {
+        // for cubes with powers of two as edge lengths, the curve
+        // moves only one step at a time:
+        for (int length = 1; length <= 16; length *= 2) {
+            HilbertPartition3D partition(Coord<3>(-3, 4, 1), Coord<3>::diagonal(length));
+            CoordVector coords = iterate(partition);
+            TS_ASSERT_EQUALS(std::size_t(length * length * length), coords.size());
+
+            for (std::size_t i = 1; i < coords.size(); ++i) {
+                Coord<3> delta = coords[i] - coords[i - 1];
+                TS_ASSERT_EQUALS(1, std::abs(delta.x()) + std::abs(delta.y()) + std::abs(delta.z()));
+            }
+        }
+    }
+
+    void testCompleteness()
+    {
+        checkCompleteness(Coord<3>(5, 9, 3));
+        checkCompleteness(Coord<3>(17, 1, 2));
+        checkCompleteness(Coord<3>(1, 1, 30));
+    }
+
+    void testSquareBracketsOperatorVersusIteration()
+    {
+        HilbertPartition3D partition(Coord<3>(10, 20, 30), Coord<3>(7, 5, 6));
+        CoordVector coords = iterate(partition);
+
+        for (std::size_t i = 0; i < coords.size(); ++i) {
+            TS_ASSERT_EQUALS(coords[i], *partition[i]);
+        }
+        TS_ASSERT(partition.end() == partition[coords.size()]);
+    }
+
+    void testGetRegion()
+    {
+        Coord<3> origin(10, 20, 30);
+        Coord<3> dimensions(20, 13, 9);
+        std::vector<std::size_t> weights;
+        weights << 100
+                << 1
+                << 500
+                << 739
+                << 1000;
+        HilbertPartition3D partition(origin, dimensions, 0, weights);
+
+        Region<3> all;
+        std::size_t start = 0;
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            Region<3> expected(partition[start], partition[start + weights[i]]);
+            Region<3> actual = partition.getRegion(i);
+            TS_ASSERT_EQUALS(expected, actual);
+            TS_ASSERT_EQUALS(weights[i], actual.size());
+
+            all += actual;
+            start += weights[i];
+        }
+
+        Region<3> expected;
+        expected << CoordBox<3>(origin, dimensions);
+        TS_ASSERT_EQUALS(expected, all);
+    }
+
+    void testGetRegionUsesWholeOctants()
+    {
+        std::vector<std::size_t> weights(8, 32 * 32 * 32);
+        HilbertPartition3D partition(Coord<3>(), Coord<3>::diagonal(64), 0, weights);
+
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            Region<3> region = partition.getRegion(i);
+            TS_ASSERT_EQUALS(std::size_t(32 * 32), region.numStreaks());
+            TS_ASSERT_EQUALS(Coord<3>::diagonal(32), region.boundingBox().dimensions);
+        }
+    }
+
+private:
+    CoordVector iterate(const HilbertPartition3D& partition)
+    {
+        CoordVector ret;
+        for (HilbertPartition3D::Iterator i = partition.begin(); i != partition.end(); ++i) {
+            ret << *i;
+        }
+
+        return ret;
+    }
+
+    void checkCompleteness(const Coord<3>& dimensions)
+    {
+        Coord<3> origin(1, 2, 3);
+        HilbertPartition3D partition(origin, dimensions);
+        CoordVector actual = iterate(partition);
+
+        CoordVector expected;
+        CoordBox<3> box(origin, dimensions);
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            expected << *i;
+        }
+
+        sort(actual);
+        sort(expected);
+        TS_ASSERT_EQUALS(expected, actual);
+    }
+};
+
+}
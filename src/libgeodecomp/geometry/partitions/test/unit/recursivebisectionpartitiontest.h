@@ -6,6 +6,31 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+/**
+ * Cells left of x = 10 are four times as expensive as the others.
+ */
+class RecursiveBisectionPartitionTestCosts : public CellCosts<2>
+{
+public:
+    double cost(const Coord<2>& coord) const
+    {
+        return (coord.x() < 10) ? 4 : 1;
+    }
+};
+
+/**
+ * Costs which vary along two dimensions, so that cuts along x and y
+ * both depend on them.
+ */
+class RecursiveBisectionPartitionTestCosts3D : public CellCosts<3>
+{
+public:
+    double cost(const Coord<3>& coord) const
+    {
+        return ((coord.x() < 4) ? 5 : 1) * ((coord.y() < 3) ? 2 : 1);
+    }
+};
+
 class RecursiveBisectionPartitionTest : public CxxTest::TestSuite
 {
 public:
@@ -92,6 +117,39 @@ public:
         checkCuboid(weights, 3, Coord<2>(48, 16), Coord<2>(48, 16), dim, dimWeights);
     }
 
+    void testCellCosts()
+    {
+        std::vector<std::size_t> weights(4, 150);
+        RecursiveBisectionPartition<2> p(Coord<2>(), Coord<2>(30, 20), 0, weights);
+        p.setCellCosts(RecursiveBisectionPartition<2>::CellCostsPtr(new RecursiveBisectionPartitionTestCosts));
+
+        // the first cut can't be placed exactly (each slice of the
+        // expensive part costs 80), so the left half gets 640 out
+        // of 1200:
+        TS_ASSERT_EQUALS(genRegion(Coord<2>( 0,  0), Coord<2>( 8, 10)), p.getRegion(0));
+        TS_ASSERT_EQUALS(genRegion(Coord<2>( 0, 10), Coord<2>( 8, 10)), p.getRegion(1));
+        TS_ASSERT_EQUALS(genRegion(Coord<2>( 8,  0), Coord<2>( 8, 20)), p.getRegion(2));
+        TS_ASSERT_EQUALS(genRegion(Coord<2>(16,  0), Coord<2>(14, 20)), p.getRegion(3));
+    }
+
+    void testCellCostsOnDeeperTrees()
+    {
+        // cuts along both x and y rely on the slice costs derived
+        // from the parent boxes:
+        std::vector<std::size_t> weights(8, 240);
+        RecursiveBisectionPartition<3> p(Coord<3>(), Coord<3>(16, 12, 10), 0, weights);
+        p.setCellCosts(RecursiveBisectionPartition<3>::CellCostsPtr(new RecursiveBisectionPartitionTestCosts3D));
+
+        TS_ASSERT_EQUALS(genRegion(0, 0, 0, 3, 5,  5), p.getRegion(0));
+        TS_ASSERT_EQUALS(genRegion(0, 0, 5, 3, 5,  5), p.getRegion(1));
+        TS_ASSERT_EQUALS(genRegion(0, 5, 0, 3, 7,  5), p.getRegion(2));
+        TS_ASSERT_EQUALS(genRegion(0, 5, 5, 3, 7,  5), p.getRegion(3));
+        TS_ASSERT_EQUALS(genRegion(3, 0, 0, 5, 5, 10), p.getRegion(4));
+        TS_ASSERT_EQUALS(genRegion(3, 5, 0, 5, 7, 10), p.getRegion(5));
+        TS_ASSERT_EQUALS(genRegion(8, 0, 0, 8, 5, 10), p.getRegion(6));
+        TS_ASSERT_EQUALS(genRegion(8, 5, 0, 8, 7, 10), p.getRegion(7));
+    }
+
     void testDegradedDimensions()
     {
         std::vector<std::size_t> weights;
@@ -134,6 +192,14 @@ public:
                 CoordBox<2>(origin, dimensions)));
     }
 
+    Region<2> genRegion(const Coord<2>& origin, const Coord<2>& dimensions)
+    {
+        Region<2> r;
+        r << CoordBox<2>(origin, dimensions);
+
+        return r;
+    }
+
     Region<3> genRegion(int o1, int o2, int o3, int d1, int d2, int d3)
     {
         CoordBox<3> box(Coord<3>(o1, o2, o3), Coord<3>(d1, d2, d3));
@@ -6,6 +6,18 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+/**
+ * Cells left of x = 4 are three times as expensive as the others.
+ */
+class ZCurvePartitionTestCosts : public CellCosts<2>
+{
+public:
+    double cost(const Coord<2>& coord) const
+    {
+        return (coord.x() < 4) ? 3 : 1;
+    }
+};
+
 class ZCurvePartitionTest : public CxxTest::TestSuite
 {
 public:
@@ -186,10 +198,108 @@ public:
         largeTest(Coord<3>(50, 8, 8));
     }
 
+    void testCellCosts()
+    {
+        std::vector<std::size_t> weights(4, 16);
+        CoordBox<2> box(Coord<2>(), Coord<2>(8, 8));
+        ZCurvePartition<2> costPartition(box.origin, box.dimensions, 0, weights);
+        ZCurvePartition<2>::CellCostsPtr costs(new ZCurvePartitionTestCosts);
+        costPartition.setCellCosts(costs);
+        // must not depend on the previous invocation:
+        costPartition.setCellCosts(costs);
+
+        // total cost is 128, so each node should receive 32:
+        Region<2> all;
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            Region<2> region = costPartition.getRegion(i);
+            TS_ASSERT((all & region).empty());
+            all += region;
+
+            double sum = 0;
+            for (Region<2>::Iterator j = region.begin(); j != region.end(); ++j) {
+                sum += costs->cost(*j);
+            }
+            TS_ASSERT_LESS_THAN_EQUALS(30, sum);
+            TS_ASSERT_LESS_THAN_EQUALS(sum, 34);
+        }
+
+        Region<2> expected;
+        expected << box;
+        TS_ASSERT_EQUALS(expected, all);
+
+        // weights need to reflect the resulting decomposition:
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            TS_ASSERT_EQUALS(costPartition.getRegion(i).size(), costPartition.getWeights()[i]);
+            TS_ASSERT_EQUALS(
+                costPartition.startOffsets[i + 1] - costPartition.startOffsets[i],
+                costPartition.getWeights()[i]);
+        }
+
+        // the start offsets of the weights are to be preserved:
+        ZCurvePartition<2> offsetPartition(box.origin, box.dimensions, 32, std::vector<std::size_t>(2, 16));
+        offsetPartition.setCellCosts(costs);
+        TS_ASSERT_EQUALS(32, offsetPartition.startOffsets.front());
+        TS_ASSERT_EQUALS(43, offsetPartition.startOffsets[1]);
+        TS_ASSERT_EQUALS(64, offsetPartition.startOffsets.back());
+        std::vector<std::size_t> expectedWeights;
+        expectedWeights << 11
+                        << 21;
+        TS_ASSERT_EQUALS(expectedWeights, offsetPartition.getWeights());
+    }
+
+    void testGetRegionVersusIteration()
+    {
+        std::vector<std::size_t> weights;
+        weights << 7
+                << 1
+                << 300
+                << 1000
+                << 3000;
+
+        checkGetRegion(Coord<2>(10, 20), Coord<2>(37, 155), weights);
+        checkGetRegion(Coord<3>(10, 20, 30), Coord<3>(21, 13, 19), weights);
+        checkGetRegion(Coord<3>(0, 0, 0), Coord<3>(64, 1, 1), std::vector<std::size_t>(4, 16));
+    }
 
 private:
     ZCurvePartition<2> partition;
     CoordVector expected, actual;
+
+    /**
+     * Compares getRegion() against the cells enumerated by the
+     * curve. The remainder of the grid is assigned to an additional
+     * node.
+     */
+    template<int DIM>
+    void checkGetRegion(
+        const Coord<DIM>& origin,
+        const Coord<DIM>& dimensions,
+        std::vector<std::size_t> weights)
+    {
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            sum += weights[i];
+        }
+        weights << std::size_t(dimensions.prod()) - sum;
+
+        ZCurvePartition<DIM> partition(origin, dimensions, 0, weights);
+        Region<DIM> all;
+        std::size_t start = 0;
+
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            Region<DIM> expected(partition[start], partition[start + weights[i]]);
+            Region<DIM> actual = partition.getRegion(i);
+            TS_ASSERT_EQUALS(expected, actual);
+            TS_ASSERT_EQUALS(weights[i], actual.size());
+
+            all += actual;
+            start += weights[i];
+        }
+
+        Region<DIM> expected;
+        expected << CoordBox<DIM>(origin, dimensions);
+        TS_ASSERT_EQUALS(expected, all);
+    }
 };
 
 }
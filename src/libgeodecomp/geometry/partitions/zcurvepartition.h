@@ -32,6 +32,7 @@ public:
     typedef typename SharedPtr<CacheType>::Type Cache;
     typedef typename Topologies::Cube<DIM>::Topology Topology;
     typedef typename Partition<DIM>::AdjacencyPtr AdjacencyPtr;
+    typedef typename Partition<DIM>::CellCostsPtr CellCostsPtr;
 
     class Square
     {
@@ -302,11 +303,26 @@ public:
         return Iterator(origin);
     }
 
+    /**
+     * Rather than walking the curve cell by cell, this adds all
+     * (sub-)squares which are completely covered by the node's
+     * section of the curve as a whole.
+     */
     inline Region<DIM> getRegion(const std::size_t node) const
     {
-        return Region<DIM>(
-            (*this)[startOffsets[node + 0]],
-            (*this)[startOffsets[node + 1]]);
+        std::vector<Streak<DIM> > streaks;
+        collectStreaks(
+            &streaks,
+            origin,
+            dimensions,
+            startOffsets[node + 0],
+            startOffsets[node + 1]);
+        return SpaceFillingCurve<DIM>::streaksToRegion(&streaks);
+    }
+
+    virtual void setCellCosts(const CellCostsPtr& costs)
+    {
+        this->splitByCellCosts((*this)[startOffsets.front()], *costs);
     }
 
     static inline bool fillCaches()
@@ -343,6 +359,87 @@ private:
 
     Coord<DIM> origin;
     Coord<DIM> dimensions;
+
+    /**
+     * Adds the Streaks of the section [begin, end) of the curve
+     * through the square at squareOrigin to streaks. This follows
+     * the same recursion as Iterator::digDownRecursion().
+     */
+    void collectStreaks(
+        std::vector<Streak<DIM> > *streaks,
+        const Coord<DIM>& squareOrigin,
+        const Coord<DIM>& squareDimensions,
+        std::size_t begin,
+        std::size_t end) const
+    {
+        std::size_t size = 1;
+        for (int d = 0; d < DIM; ++d) {
+            size *= squareDimensions[d];
+        }
+        end = (std::min)(end, size);
+        if (begin >= end) {
+            return;
+        }
+
+        if ((begin == 0) && (end == size)) {
+            CoordBox<DIM> box(squareOrigin, squareDimensions);
+            for (typename CoordBox<DIM>::StreakIterator i = box.beginStreak(); i != box.endStreak(); ++i) {
+                *streaks << *i;
+            }
+            return;
+        }
+
+        if (Iterator::hasTrivialDimensions(squareDimensions)) {
+            // a line which is traversed along its last non-trivial
+            // dimension, just as in Iterator::digDownTrivial():
+            int dirDim = 0;
+            for (int d = 1; d < DIM; ++d) {
+                if (squareDimensions[d] > 1) {
+                    dirDim = d;
+                }
+            }
+
+            CoordBox<DIM> box(squareOrigin, squareDimensions);
+            box.origin[dirDim] += begin;
+            box.dimensions[dirDim] = end - begin;
+            for (typename CoordBox<DIM>::StreakIterator i = box.beginStreak(); i != box.endStreak(); ++i) {
+                *streaks << *i;
+            }
+            return;
+        }
+
+        Coord<DIM> halfDimensions = squareDimensions / 2;
+        Coord<DIM> remainingDimensions = squareDimensions - halfDimensions;
+        std::size_t offset = 0;
+
+        for (int i = 0; (i < Iterator::NUM_QUADRANTS) && (offset < end); ++i) {
+            std::bitset<DIM> quadrantShift(i);
+            Coord<DIM> quadrantOrigin = squareOrigin;
+            Coord<DIM> quadrantDim;
+            std::size_t quadrantSize = 1;
+
+            for (int d = 0; d < DIM; ++d) {
+                if (quadrantShift[d]) {
+                    quadrantOrigin[d] += halfDimensions[d];
+                    quadrantDim[d] = remainingDimensions[d];
+                } else {
+                    quadrantDim[d] = halfDimensions[d];
+                }
+                quadrantSize *= quadrantDim[d];
+            }
+
+            if ((quadrantSize > 0) && (begin < (offset + quadrantSize))) {
+                collectStreaks(
+                    streaks,
+                    quadrantOrigin,
+                    quadrantDim,
+                    (begin > offset) ? (begin - offset) : 0,
+                    end - offset);
+            }
+
+            offset += quadrantSize;
+        }
+    }
 };
 
 template<int DIM>
@@ -765,7 +765,7 @@ public:
         StreakIterator end = endStreak(xOffset, radii[0] * 2);
         // expansion in X dimension is a simple 1-pass operation:
         for (StreakIterator i = beginStreak(xOffset, radii[0] * 2); i != end; ++i) {
-            accumulator << *i;
+            accumulator.appendStreak(*i);
         }
 
         // expand into other dimensions, one after another
@@ -859,7 +859,8 @@ public:
 
     /**
      * does the same as expand, but reads adjacent indices out of
-     * an adjacency list
+     * an adjacency list. Neighbors are retrieved per Streak (see
+     * Adjacency::getNeighborsOfRange()).
      */
     template<typename ADJACENCY>
     inline Region expandWithAdjacency(
@@ -882,15 +883,13 @@ public:
             for (RegionStreakIterator<DIM, Region<DIM> > streak = newCoords.beginStreak();
                  streak != newCoords.endStreak();
                  ++streak) {
-                for (int x = streak->origin.x(); x < streak->endX; ++x) {
-                    neighbors.clear();
-                    adjacency.getNeighbors(x, &neighbors);
-
-                    for (std::vector<int>::const_iterator i = neighbors.begin(); i != neighbors.end(); ++i) {
-                        Coord<DIM> c(*i);
-                        if (ret.count(c) == 0) {
-                            add << c;
-                        }
+                neighbors.clear();
+                adjacency.getNeighborsOfRange(streak->origin.x(), streak->endX, &neighbors);
+
+                for (std::vector<int>::const_iterator i = neighbors.begin(); i != neighbors.end(); ++i) {
+                    Coord<DIM> c(*i);
+                    if (ret.count(c) == 0) {
+                        add << c;
                     }
                 }
             }
@@ -981,7 +980,7 @@ public:
         for (typename CoordBox<DIM>::StreakIterator i = box.beginStreak();
              i != box.endStreak();
              ++i) {
-            buf << *i;
+            buf.appendStreak(*i);
         }
 
         Region mergeBuf;
@@ -1020,7 +1019,7 @@ public:
         for (typename CoordBox<DIM>::StreakIterator i = box.beginStreak();
              i != box.endStreak();
              ++i) {
-            boxRegion << *i;
+            boxRegion.appendStreak(*i);
         }
         *this -= boxRegion;
 
@@ -1052,6 +1051,7 @@ public:
             return *this;
         }
 
+        ret.reserve(*this);
         StreakIterator myIter = beginStreak();
         StreakIterator otherIter = other.beginStreak();
 
@@ -1065,12 +1065,12 @@ public:
                 int intersectionOriginX = (max)(cursor.origin.x(), otherIter->origin.x());
                 int intersectionEndX = (min)(cursor.endX, otherIter->endX);
 
-                ret << Streak<DIM>(cursor.origin, intersectionOriginX);
+                ret.appendStreak(Streak<DIM>(cursor.origin, intersectionOriginX));
                 cursor.origin.x() = intersectionEndX;
             }
 
             if (RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(cursor, *otherIter)) {
-                ret << cursor;
+                ret.appendStreak(cursor);
                 ++myIter;
 
                 if (myIter == myEnd) {
@@ -1087,11 +1087,11 @@ public:
         }
 
         // don't loose the remainder
-        ret << cursor;
+        ret.appendStreak(cursor);
         if (myIter != myEnd) {
             ++myIter;
             for (; myIter != myEnd; ++myIter) {
-                ret << *myIter;
+                ret.appendStreak(*myIter);
             }
         }
 
@@ -1112,6 +1112,13 @@ public:
         using std::max;
         using std::min;
         Region ret;
+        if (empty() || other.empty()) {
+            return ret;
+        }
+
+        // usually the intersection isn't much larger than the smaller
+        // operand, so reserving its size avoids most reallocations:
+        ret.reserve((numStreaks() < other.numStreaks()) ? *this : other);
         StreakIterator myIter = beginStreak();
         StreakIterator otherIter = other.beginStreak();
 
@@ -1128,7 +1135,7 @@ public:
                 Streak<DIM> intersection = *myIter;
                 intersection.origin.x() = (max)(myIter->origin.x(), otherIter->origin.x());
                 intersection.endX = (min)(myIter->endX, otherIter->endX);
-                ret << intersection;
+                ret.appendStreak(intersection);
             }
 
             if (RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(*myIter, *otherIter)) {
@@ -1155,7 +1162,7 @@ public:
         // short cuts if one Region can be appended to the other;
         if (isAppendable(other)) {
             for (StreakIterator i = other.beginStreak(); i != other.endStreak(); ++i) {
-                *this << *i;
+                appendStreak(*i);
             }
 
             return;
@@ -1166,7 +1173,7 @@ public:
             *this = other;
 
             for (StreakIterator i = buf.beginStreak(); i != buf.endStreak(); ++i) {
-                *this << *i;
+                appendStreak(*i);
             }
 
             return;
@@ -1191,7 +1198,7 @@ public:
         if (isAppendable(other)) {
             Region ret = *this;
             for (StreakIterator i = other.beginStreak(); i != other.endStreak(); ++i) {
-                ret << *i;
+                ret.appendStreak(*i);
             }
 
             return ret;
@@ -1199,7 +1206,7 @@ public:
         if (other.isAppendable(*this)) {
             Region ret = other;
             for (StreakIterator i = beginStreak(); i != endStreak(); ++i) {
-                ret << *i;
+                ret.appendStreak(*i);
             }
 
             return ret;
@@ -1207,6 +1214,7 @@ public:
 
         // else: normal merge
         Region ret;
+        ret.reserve((numStreaks() > other.numStreaks()) ? *this : other);
 
         merge2way(
             ret,
@@ -1453,7 +1461,7 @@ private:
 
 #define LIBGEODECOMP_REGION_ADVANCE_ITERATOR(ITERATOR, END)     \
             if (*ITERATOR != lastInsert) {         \
-                ret << *ITERATOR;                  \
+                ret.appendStreak(*ITERATOR);       \
                 lastInsert = *ITERATOR;            \
             }                                      \
             ++ITERATOR;                            \
@@ -1479,6 +1487,63 @@ private:
         return RegionHelpers::RegionIntersectHelper<DIM - 1>::lessThan(*lastStreakIter, *other.beginStreak());
     }
 
+    /**
+     * Adds a Streak which doesn't precede any Streak already stored
+     * in the Region (in the order defined by
+     * RegionIntersectHelper::lessThan()). It may however overlap or
+     * touch the last Streaks of the current row, these get fused.
+     * All set operations generate their results in this order, so
+     * this spares them the binary searches of operator<<, which would
+     * otherwise dominate their run time: appending runs in amortized
+     * O(DIM).
+     */
+    inline void appendStreak(const Streak<DIM>& s)
+    {
+        if (s.endX <= s.origin.x()) {
+            return;
+        }
+        geometryCacheTainted = true;
+
+        // find the topmost level on which the Streak diverges from
+        // the last Streak in the Region:
+        int d = DIM - 1;
+        for (; d > 0; --d) {
+            if (indices[d].empty() || (indices[d].back().first != s.origin[d])) {
+                break;
+            }
+        }
+
+        if ((d > 0) || indices[0].empty()) {
+            for (; d > 0; --d) {
+                indices[d] << IntPair(s.origin[d], int(indices[d - 1].size()));
+            }
+            indices[0] << IntPair(s.origin.x(), s.endX);
+            return;
+        }
+
+        // same row: fuse with all Streaks we're overlapping or touching
+        const int rowLevel = (DIM > 1) ? 1 : 0;
+        std::size_t rowStart = (DIM > 1) ? std::size_t(indices[rowLevel].back().second) : 0;
+        IntPair streak(s.origin.x(), s.endX);
+        while ((indices[0].size() > rowStart) && (indices[0].back().second >= streak.first)) {
+            streak.first  = (std::min)(streak.first,  indices[0].back().first);
+            streak.second = (std::max)(streak.second, indices[0].back().second);
+            indices[0].pop_back();
+        }
+
+        indices[0] << streak;
+    }
+
+    /**
+     * Reserves as much memory as the given Region occupies.
+     */
+    inline void reserve(const Region<DIM>& other)
+    {
+        for (int d = 0; d < DIM; ++d) {
+            indices[d].reserve(other.indices[d].size());
+        }
+    }
+
     inline static void merge2way(
         Region& ret,
         const StreakIterator& beginA, const StreakIterator& endA,
@@ -1486,13 +1551,13 @@ private:
     {
         if (beginA == endA) {
             for (StreakIterator i = beginB; i != endB; ++i) {
-                ret << *i;
+                ret.appendStreak(*i);
             }
             return;
         }
         if (beginB == endB) {
             for (StreakIterator i = beginA; i != endA; ++i) {
-                ret << *i;
+                ret.appendStreak(*i);
             }
             return;
         }
@@ -1510,10 +1575,10 @@ private:
         }
 
         for (; iterA != endA; ++iterA) {
-            ret << *iterA;
+            ret.appendStreak(*iterA);
         }
         for (; iterB != endB; ++iterB) {
-            ret << *iterB;
+            ret.appendStreak(*iterB);
         }
     }
 
@@ -0,0 +1,100 @@
+#include <libgeodecomp/geometry/boundingboxtree.h>
+#include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class BoundingBoxTreeTest : public CxxTest::TestSuite
+{
+public:
+    void testEmpty()
+    {
+        BoundingBoxTree<2> tree;
+        TS_ASSERT_EQUALS(std::size_t(0), tree.size());
+        TS_ASSERT(tree.query(CoordBox<2>(Coord<2>(0, 0), Coord<2>(10, 10))).empty());
+    }
+
+    void testSkipsEmptyBoxes()
+    {
+        std::vector<CoordBox<2> > boxes;
+        boxes << CoordBox<2>(Coord<2>(0, 0), Coord<2>(5, 5))
+              << CoordBox<2>()
+              << CoordBox<2>(Coord<2>(2, 2), Coord<2>(0, 3))
+              << CoordBox<2>(Coord<2>(4, 4), Coord<2>(2, 2));
+        BoundingBoxTree<2> tree(boxes);
+        TS_ASSERT_EQUALS(std::size_t(2), tree.size());
+
+        std::vector<std::size_t> expected;
+        expected << 0 << 3;
+        TS_ASSERT_EQUALS(expected, tree.query(CoordBox<2>(Coord<2>(0, 0), Coord<2>(10, 10))));
+
+        expected.clear();
+        expected << 0;
+        TS_ASSERT_EQUALS(expected, tree.query(CoordBox<2>(Coord<2>(2, 2), Coord<2>(2, 2))));
+        TS_ASSERT(tree.query(CoordBox<2>(Coord<2>(2, 2), Coord<2>(0, 0))).empty());
+    }
+
+    void testGrid2D()
+    {
+        // a 10x10 grid of 3x3 tiles:
+        std::vector<CoordBox<2> > boxes;
+        for (int y = 0; y < 10; ++y) {
+            for (int x = 0; x < 10; ++x) {
+                boxes << CoordBox<2>(Coord<2>(x * 3, y * 3), Coord<2>(3, 3));
+            }
+        }
+        BoundingBoxTree<2> tree(boxes);
+        TS_ASSERT(tree.nodes.size() > 1);
+
+        std::vector<std::size_t> expected;
+        expected << 54 << 55 << 56
+                 << 64 << 65 << 66;
+        TS_ASSERT_EQUALS(expected, tree.query(CoordBox<2>(Coord<2>(14, 17), Coord<2>(5, 3))));
+
+        expected.clear();
+        expected << 99;
+        TS_ASSERT_EQUALS(expected, tree.query(CoordBox<2>(Coord<2>(29, 29), Coord<2>(100, 100))));
+        TS_ASSERT(tree.query(CoordBox<2>(Coord<2>(30, 0), Coord<2>(10, 100))).empty());
+    }
+
+    void testMatchesLinearSearch3D()
+    {
+        std::vector<CoordBox<3> > boxes;
+        for (int i = 0; i < 500; ++i) {
+            boxes << randomBox();
+        }
+        BoundingBoxTree<3> tree(boxes);
+
+        for (int i = 0; i < 100; ++i) {
+            CoordBox<3> box = randomBox();
+            std::vector<std::size_t> expected;
+            for (std::size_t j = 0; j < boxes.size(); ++j) {
+                if (boxes[j].intersects(box)) {
+                    expected << j;
+                }
+            }
+
+            TS_ASSERT_EQUALS(expected, tree.query(box));
+        }
+    }
+
+private:
+    CoordBox<3> randomBox()
+    {
+        Coord<3> origin(
+            Random::genUnsigned(100),
+            Random::genUnsigned(100),
+            Random::genUnsigned(100));
+        Coord<3> dim(
+            Random::genUnsigned(20),
+            Random::genUnsigned(20),
+            Random::genUnsigned(20));
+        return CoordBox<3>(origin, dim);
+    }
+};
+
+}
@@ -1,5 +1,7 @@
 #include <libgeodecomp/geometry/convexpolytope.h>
 
+#include <cmath>
+
 using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
@@ -81,6 +83,65 @@ public:
         TS_ASSERT_EQUALS(13, poly.getLimits()[1].neighborID);
         TS_ASSERT_EQUALS(24, poly.getLimits()[2].neighborID);
     }
+    void testCube3D()
+    {
+        ConvexPolytope<FloatCoord<3> > poly(FloatCoord<3>(200, 100, 300), FloatCoord<3>(1000, 1000, 1000));
+        TS_ASSERT_EQUALS(8, poly.getShape().size());
+
+        poly << std::make_pair(FloatCoord<3>(100, 100, 300), 1)
+             << std::make_pair(FloatCoord<3>(300, 100, 300), 2)
+             << std::make_pair(FloatCoord<3>(200,   0, 300), 3)
+             << std::make_pair(FloatCoord<3>(200, 200, 300), 4)
+             << std::make_pair(FloatCoord<3>(200, 100, 200), 5)
+             << std::make_pair(FloatCoord<3>(200, 100, 400), 6);
+        // too far away to matter:
+        poly << std::make_pair(FloatCoord<3>(400, 100, 300), 7);
+        poly.updateGeometryData();
+
+        TS_ASSERT_EQUALS(6, poly.getLimits().size());
+        for (std::size_t i = 0; i < poly.getLimits().size(); ++i) {
+            TS_ASSERT_EQUALS(int(i + 1), poly.getLimits()[i].neighborID);
+            TS_ASSERT_DELTA(100 * 100, poly.getLimits()[i].length, 1e-6);
+        }
+
+        TS_ASSERT_DELTA(100 * 100 * 100, poly.getVolume(), 1e-6);
+        TS_ASSERT_DELTA(100, poly.getDiameter(), 1e-9);
+
+        // corners are subject to rounding errors:
+        std::vector<FloatCoord<3> > shape = poly.getShape();
+        TS_ASSERT_EQUALS(8, shape.size());
+        for (int d = 0; d < 3; ++d) {
+            TS_ASSERT_DELTA(FloatCoord<3>(150,  50, 250)[d], shape.front()[d], 1e-9);
+            TS_ASSERT_DELTA(FloatCoord<3>(250, 150, 350)[d], shape.back()[d],  1e-9);
+        }
+
+        TS_ASSERT_EQUALS(true,  poly.includes(FloatCoord<3>(200, 100, 300)));
+        TS_ASSERT_EQUALS(true,  poly.includes(FloatCoord<3>(249, 149, 251)));
+        TS_ASSERT_EQUALS(false, poly.includes(FloatCoord<3>(251, 100, 300)));
+        TS_ASSERT_EQUALS(false, poly.includes(FloatCoord<3>(200, 100, 351)));
+    }
+
+    void testCornerCut3D()
+    {
+        // cutting a corner off a cube yields a tetrahedron-shaped gap:
+        ConvexPolytope<FloatCoord<3> > poly(FloatCoord<3>(10, 10, 10), FloatCoord<3>(60, 60, 60));
+        poly << std::make_pair(FloatCoord<3>(90, 90, 90), 1);
+        poly.updateGeometryData();
+
+        // the plane x + y + z = 150 cuts the edges at 30 from the corner:
+        double expectedVolume = 60 * 60 * 60 - 30.0 * 30 * 30 / 6;
+        TS_ASSERT_EQUALS(7, poly.getLimits().size());
+        TS_ASSERT_EQUALS(10, poly.getShape().size());
+        TS_ASSERT_DELTA(expectedVolume, poly.getVolume(), 1e-6);
+        TS_ASSERT_DELTA(std::sqrt(3.0) / 4 * 1800, poly.getLimits().back().length, 1e-6);
+        TS_ASSERT_EQUALS(1, poly.getLimits().back().neighborID);
+
+        // reset() needs to restore the full cube:
+        poly.reset(FloatCoord<3>(10, 10, 10), FloatCoord<3>(60, 60, 60));
+        poly.updateGeometryData();
+        TS_ASSERT_EQUALS(6, poly.getLimits().size());
+        TS_ASSERT_DELTA(60 * 60 * 60, poly.getVolume(), 1e-6);
+    }
 };
 
 }
@@ -0,0 +1,227 @@
+#include <libgeodecomp/geometry/csradjacency.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/regionbasedadjacency.h>
+#include <libgeodecomp/misc/random.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class CSRAdjacencyTest : public CxxTest::TestSuite
+{
+public:
+    void testBasic()
+    {
+        CSRAdjacency adjacency;
+        adjacency.insert(5, 3);
+        adjacency.insert(0, 6);
+        adjacency.insert(0, 2);
+        adjacency.insert(3, 9);
+        adjacency.insert(5, 1);
+        adjacency.insert(0, 4);
+        adjacency.insert(5, 2);
+        adjacency.insert(0, 0);
+        adjacency.insert(3, 0);
+        // duplicates are ignored:
+        adjacency.insert(0, 2);
+        adjacency.finalize();
+
+        TS_ASSERT_EQUALS(std::size_t(9), adjacency.size());
+        TS_ASSERT_EQUALS(6, adjacency.numNodes());
+
+        std::vector<int> expected;
+        std::vector<int> actual;
+        expected << 0 << 2 << 4 << 6;
+        adjacency.getNeighbors(0, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        expected.clear();
+        actual.clear();
+        adjacency.getNeighbors(1, &actual);
+        adjacency.getNeighbors(2, &actual);
+        adjacency.getNeighbors(4, &actual);
+        adjacency.getNeighbors(47, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        CSRAdjacency::Neighbors neighbors = adjacency.neighbors(3);
+        TS_ASSERT_EQUALS(std::size_t(2), neighbors.size());
+        TS_ASSERT_EQUALS(0, neighbors[0]);
+        TS_ASSERT_EQUALS(9, neighbors[1]);
+
+        neighbors = adjacency.neighbors(5);
+        expected.clear();
+        expected << 1 << 2 << 3;
+        TS_ASSERT_EQUALS(expected, std::vector<int>(neighbors.begin(), neighbors.end()));
+
+        TS_ASSERT(adjacency.neighbors(4).empty());
+        TS_ASSERT(adjacency.neighbors(-1).empty());
+        TS_ASSERT_THROWS(adjacency.insert(-1, 3), std::invalid_argument&);
+    }
+
+    void testGetNeighborsOfRange()
+    {
+        CSRAdjacency adjacency;
+        adjacency.insert(5, 3);
+        adjacency.insert(0, 6);
+        adjacency.insert(0, 2);
+        adjacency.insert(3, 9);
+        adjacency.insert(5, 1);
+        adjacency.insert(3, 0);
+        adjacency.finalize();
+
+        std::vector<int> expected;
+        std::vector<int> actual;
+        expected << 0 << 9 << 1 << 3;
+        adjacency.getNeighborsOfRange(1, 6, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        // neighbors are appended, ranges are clipped to existing nodes:
+        expected << 2 << 6 << 0 << 9 << 1 << 3;
+        adjacency.getNeighborsOfRange(-5, 100, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        adjacency.getNeighborsOfRange(1, 3, &actual);
+        adjacency.getNeighborsOfRange(4, 2, &actual);
+        adjacency.getNeighborsOfRange(47, 50, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+    }
+
+    void testGetRows()
+    {
+        CSRAdjacency adjacency;
+        adjacency.insert(5, 3);
+        adjacency.insert(0, 6);
+        adjacency.insert(0, 2);
+        adjacency.insert(3, 9);
+        adjacency.insert(5, 1);
+        adjacency.insert(3, 0);
+        adjacency.finalize();
+
+        std::vector<int> expectedOffsets;
+        std::vector<int> expectedNeighbors;
+        std::vector<int> actualOffsets;
+        std::vector<int> actualNeighbors;
+        expectedOffsets << 0 << 0 << 2 << 2 << 4 << 4 << 4;
+        expectedNeighbors << 0 << 9 << 1 << 3;
+        adjacency.getRows(2, 9, &actualOffsets, &actualNeighbors);
+        TS_ASSERT_EQUALS(expectedOffsets, actualOffsets);
+        TS_ASSERT_EQUALS(expectedNeighbors, actualNeighbors);
+
+        // rows are appended, offsets refer to the whole vector:
+        expectedOffsets << 4 << 6;
+        expectedNeighbors << 2 << 6;
+        adjacency.getRows(0, 2, &actualOffsets, &actualNeighbors);
+        TS_ASSERT_EQUALS(expectedOffsets, actualOffsets);
+        TS_ASSERT_EQUALS(expectedNeighbors, actualNeighbors);
+
+        // the default implementation yields the same layout:
+        std::vector<int> defaultOffsets;
+        std::vector<int> defaultNeighbors;
+        const Adjacency& base = adjacency;
+        base.Adjacency::getRows(2, 9, &defaultOffsets, &defaultNeighbors);
+        base.Adjacency::getRows(0, 2, &defaultOffsets, &defaultNeighbors);
+        TS_ASSERT_EQUALS(expectedOffsets, defaultOffsets);
+        TS_ASSERT_EQUALS(expectedNeighbors, defaultNeighbors);
+    }
+
+    void testQueriesRequireFinalize()
+    {
+        CSRAdjacency adjacency;
+        adjacency.insert(2, 5);
+        std::vector<int> neighbors;
+
+        TS_ASSERT_THROWS(adjacency.size(), std::logic_error&);
+        TS_ASSERT_THROWS(adjacency.getNeighbors(2, &neighbors), std::logic_error&);
+        TS_ASSERT_THROWS(adjacency.getNeighborsOfRange(0, 3, &neighbors), std::logic_error&);
+
+        adjacency.finalize();
+        adjacency.getNeighbors(2, &neighbors);
+        TS_ASSERT_EQUALS(std::vector<int>(1, 5), neighbors);
+    }
+
+    void testInsertAfterFinalize()
+    {
+        CSRAdjacency adjacency;
+        adjacency.insert(2, 5);
+        adjacency.insert(2, 3);
+        adjacency.finalize();
+        TS_ASSERT_EQUALS(std::size_t(2), adjacency.size());
+
+        adjacency.insert(7, 1);
+        adjacency.insert(2, 4);
+        adjacency.insert(2, 3);
+        adjacency.finalize();
+        TS_ASSERT_EQUALS(std::size_t(4), adjacency.size());
+        TS_ASSERT_EQUALS(8, adjacency.numNodes());
+
+        std::vector<int> expected;
+        std::vector<int> actual;
+        expected << 3 << 4 << 5;
+        adjacency.getNeighbors(2, &actual);
+        TS_ASSERT_EQUALS(expected, actual);
+
+        std::vector<int> expectedOffsets;
+        expectedOffsets << 0 << 0 << 0 << 3 << 3 << 3 << 3 << 3 << 4;
+        TS_ASSERT_EQUALS(expectedOffsets, adjacency.getOffsets());
+    }
+
+    void testEquivalenceWithRegionBasedAdjacency()
+    {
+        std::vector<std::pair<Coord<2>, double> > weights;
+        for (int i = 0; i < 5000; ++i) {
+            Coord<2> edge(Random::genUnsigned(1000), Random::genUnsigned(1000));
+            weights << std::make_pair(edge, 1.0);
+        }
+
+        SharedPtr<RegionBasedAdjacency>::Type regionBased = MakeAdjacency<RegionBasedAdjacency>(weights);
+        SharedPtr<CSRAdjacency>::Type csr = MakeAdjacency<CSRAdjacency>(weights);
+        TS_ASSERT_EQUALS(regionBased->size(), csr->size());
+
+        for (int node = 0; node < 1000; ++node) {
+            std::vector<int> expected;
+            std::vector<int> actual;
+            regionBased->getNeighbors(node, &expected);
+            csr->getNeighbors(node, &actual);
+            TS_ASSERT_EQUALS(expected, actual);
+        }
+
+        for (int node = 0; node < 1000; node += 100) {
+            std::vector<int> expected;
+            std::vector<int> actual;
+            regionBased->getNeighborsOfRange(node, node + 50, &expected);
+            csr->getNeighborsOfRange(node, node + 50, &actual);
+            TS_ASSERT_EQUALS(expected, actual);
+        }
+
+        Region<1> region;
+        region << Streak<1>(Coord<1>(100), 110)
+               << Streak<1>(Coord<1>(500), 503);
+        const Adjacency& adjacency = *csr;
+        for (unsigned width = 1; width < 4; ++width) {
+            TS_ASSERT_EQUALS(
+                region.expandWithAdjacency(width, *regionBased),
+                region.expandWithAdjacency(width, adjacency));
+        }
+    }
+
+    void testEdgeListConstructor()
+    {
+        std::vector<std::pair<int, int> > edges;
+        edges << std::make_pair(3, 1)
+              << std::make_pair(1, 3)
+              << std::make_pair(1, 2);
+
+        CSRAdjacency adjacency(edges);
+        TS_ASSERT_EQUALS(std::size_t(3), adjacency.size());
+        TS_ASSERT_EQUALS(4, adjacency.numNodes());
+
+        std::vector<int> expected;
+        expected << 2 << 3 << 1;
+        TS_ASSERT_EQUALS(expected, adjacency.getColumns());
+    }
+};
+
+}
@@ -1,6 +1,8 @@
 #include <libgeodecomp/geometry/partitionmanager.h>
 #include <libgeodecomp/geometry/partitions/recursivebisectionpartition.h>
 #include <libgeodecomp/geometry/partitions/stripingpartition.h>
+#include <libgeodecomp/geometry/partitions/unstructuredstripingpartition.h>
+#include <libgeodecomp/io/unstructuredtestinitializer.h>
 
 using namespace LibGeoDecomp;
 
@@ -275,6 +277,189 @@ public:
 
     }
 
+    void testGhostZoneFragmentsMatchFullExpansion()
+    {
+        typedef Topologies::Torus<2>::Topology Topology;
+        unsigned ghostZoneWidth = 3;
+        unsigned numNodes = 16;
+        CoordBox<2> box(Coord<2>(), Coord<2>(64, 48));
+        std::vector<std::size_t> weights(numNodes, box.dimensions.prod() / numNodes);
+        SharedPtr<Partition<2> >::Type partition(
+            new RecursiveBisectionPartition<2>(Coord<2>(), box.dimensions, 0, weights));
+        SharedPtr<AdjacencyManufacturer<2> >::Type dummyAdjacencyManufacturer(new DummyAdjacencyManufacturer<2>);
+
+        std::vector<CoordBox<2> > boundingBoxes;
+        std::vector<CoordBox<2> > expandedBoundingBoxes;
+        PartitionManager<Topology> reference;
+        reference.resetRegions(dummyAdjacencyManufacturer, box, partition, 0, ghostZoneWidth);
+        for (unsigned i = 0; i < numNodes; ++i) {
+            boundingBoxes << reference.getRegion(i, 0).boundingBox();
+            expandedBoundingBoxes << reference.getRegion(i, ghostZoneWidth).boundingBox();
+        }
+
+        for (unsigned rank = 0; rank < numNodes; ++rank) {
+            PartitionManager<Topology> partitionManager;
+            partitionManager.resetRegions(dummyAdjacencyManufacturer, box, partition, rank, ghostZoneWidth);
+            partitionManager.resetGhostZones(boundingBoxes, expandedBoundingBoxes);
+
+            PartitionManager<Topology>::RegionVecMap& outerFragments =
+                partitionManager.getOuterGhostZoneFragments();
+            PartitionManager<Topology>::RegionVecMap& innerFragments =
+                partitionManager.getInnerGhostZoneFragments();
+            Region<2> outerRim = partitionManager.getOuterRim();
+            Region<2> innerRim = partitionManager.rim(ghostZoneWidth);
+
+            for (unsigned node = 0; node < numNodes; ++node) {
+                if (node == rank) {
+                    continue;
+                }
+
+                Region<2> expectedOuter =
+                    reference.getRegion(rank, ghostZoneWidth) & reference.getRegion(node, 0);
+                Region<2> expectedInner =
+                    reference.getRegion(rank, 0) & reference.getRegion(node, ghostZoneWidth);
+                outerRim -= expectedOuter;
+                innerRim -= expectedInner;
+
+                TS_ASSERT_EQUALS(!expectedOuter.empty(), outerFragments.count(node) == 1);
+                TS_ASSERT_EQUALS(!expectedInner.empty(), innerFragments.count(node) == 1);
+                if (outerFragments.count(node) == 0) {
+                    continue;
+                }
+
+                for (unsigned i = 0; i <= ghostZoneWidth; ++i) {
+                    TS_ASSERT_EQUALS(
+                        reference.getRegion(rank, i) & reference.getRegion(node, 0),
+                        outerFragments[node][i]);
+                    TS_ASSERT_EQUALS(
+                        reference.getRegion(rank, 0) & reference.getRegion(node, i),
+                        innerFragments[node][i]);
+                }
+            }
+
+            TS_ASSERT_EQUALS(outerRim, partitionManager.getOuterOutgroupGhostZoneFragment());
+            TS_ASSERT_EQUALS(innerRim, partitionManager.getInnerOutgroupGhostZoneFragment());
+        }
+    }
+
+    void testUnstructuredGhostZoneFragmentsMatchFullExpansion()
+    {
+        typedef Topologies::Unstructured::Topology Topology;
+        unsigned ghostZoneWidth = 2;
+        unsigned numNodes = 6;
+        CoordBox<1> box(Coord<1>(), Coord<1>(300));
+        std::vector<std::size_t> weights(numNodes, box.dimensions.prod() / numNodes);
+        SharedPtr<Partition<1> >::Type partition(
+            new UnstructuredStripingPartition(Coord<1>(), box.dimensions, 0, weights));
+        SharedPtr<AdjacencyManufacturer<1> >::Type initializer(
+            new UnstructuredTestInitializer<UnstructuredTestCell<> >(box.dimensions.x(), 10, 0, 20));
+
+        std::vector<CoordBox<1> > boundingBoxes;
+        std::vector<CoordBox<1> > expandedBoundingBoxes;
+        PartitionManager<Topology> reference;
+        reference.resetRegions(initializer, box, partition, 0, ghostZoneWidth);
+        for (unsigned i = 0; i < numNodes; ++i) {
+            boundingBoxes << reference.getRegion(i, 0).boundingBox();
+            expandedBoundingBoxes << reference.getRegion(i, ghostZoneWidth).boundingBox();
+        }
+
+        for (unsigned rank = 0; rank < numNodes; ++rank) {
+            PartitionManager<Topology> partitionManager;
+            partitionManager.resetRegions(initializer, box, partition, rank, ghostZoneWidth);
+            partitionManager.resetGhostZones(boundingBoxes, expandedBoundingBoxes);
+
+            PartitionManager<Topology>::RegionVecMap& outerFragments =
+                partitionManager.getOuterGhostZoneFragments();
+            PartitionManager<Topology>::RegionVecMap& innerFragments =
+                partitionManager.getInnerGhostZoneFragments();
+            Region<1> ownRegion = reference.getRegion(rank, 0);
+            Region<1> ownVicinity = partitionManager.vicinity(ownRegion, ghostZoneWidth);
+
+            for (unsigned node = 0; node < numNodes; ++node) {
+                if (node == rank) {
+                    continue;
+                }
+
+                std::vector<Region<1> > clipped =
+                    partitionManager.clippedRegion(node, ownVicinity, ghostZoneWidth);
+                for (unsigned i = 0; i <= ghostZoneWidth; ++i) {
+                    Region<1> expectedOuter = reference.getRegion(rank, i) & reference.getRegion(node, 0);
+                    Region<1> expectedInner = ownRegion & reference.getRegion(node, i);
+                    TS_ASSERT_EQUALS(expectedInner, ownRegion & clipped[i]);
+
+                    if (outerFragments.count(node)) {
+                        TS_ASSERT_EQUALS(expectedOuter, outerFragments[node][i]);
+                    } else {
+                        TS_ASSERT(expectedOuter.empty());
+                    }
+                    if (innerFragments.count(node)) {
+                        TS_ASSERT_EQUALS(expectedInner, innerFragments[node][i]);
+                    } else {
+                        TS_ASSERT(expectedInner.empty());
+                    }
+                }
+            }
+        }
+    }
+
+    void testNeighborsWrapAroundTorus()
+    {
+        typedef Topologies::Torus<2>::Topology Topology;
+        unsigned ghostZoneWidth = 2;
+        unsigned numNodes = 8;
+        CoordBox<2> box(Coord<2>(), Coord<2>(32, 64));
+        std::vector<std::size_t> weights(numNodes, box.dimensions.prod() / numNodes);
+        SharedPtr<Partition<2> >::Type partition(
+            new StripingPartition<2>(Coord<2>(), box.dimensions, 0, weights));
+        SharedPtr<AdjacencyManufacturer<2> >::Type dummyAdjacencyManufacturer(new DummyAdjacencyManufacturer<2>);
+
+        std::vector<CoordBox<2> > boundingBoxes;
+        std::vector<CoordBox<2> > expandedBoundingBoxes;
+        PartitionManager<Topology> reference;
+        reference.resetRegions(dummyAdjacencyManufacturer, box, partition, 0, ghostZoneWidth);
+        for (unsigned i = 0; i < numNodes; ++i) {
+            boundingBoxes << reference.getRegion(i, 0).boundingBox();
+            expandedBoundingBoxes << reference.getRegion(i, ghostZoneWidth).boundingBox();
+        }
+
+        for (unsigned rank = 0; rank < numNodes; ++rank) {
+            PartitionManager<Topology> partitionManager;
+            partitionManager.resetRegions(dummyAdjacencyManufacturer, box, partition, rank, ghostZoneWidth);
+            partitionManager.resetGhostZones(boundingBoxes, expandedBoundingBoxes);
+
+            // stripes at the top and bottom edge are neighbors on the torus:
+            std::set<unsigned> expectedNeighbors;
+            expectedNeighbors << (rank + numNodes - 1) % numNodes;
+            expectedNeighbors << (rank + 1) % numNodes;
+            std::set<unsigned> actualNeighbors;
+            PartitionManager<Topology>::RegionVecMap& outerFragments =
+                partitionManager.getOuterGhostZoneFragments();
+            for (PartitionManager<Topology>::RegionVecMap::iterator i = outerFragments.begin();
+                 i != outerFragments.end();
+                 ++i) {
+                if (i->first != PartitionManager<Topology>::OUTGROUP) {
+                    actualNeighbors << i->first;
+                }
+            }
+            TS_ASSERT_EQUALS(expectedNeighbors, actualNeighbors);
+
+            // the index has to agree with a linear scan:
+            CoordBox<2> queryBox = partitionManager.getRegion(rank, ghostZoneWidth).boundingBox();
+            std::vector<std::size_t> expectedNodes;
+            std::vector<std::size_t> expectedExpandedNodes;
+            for (std::size_t i = 0; i < numNodes; ++i) {
+                if (boundingBoxes[i].intersects(queryBox)) {
+                    expectedNodes << i;
+                }
+                if (expandedBoundingBoxes[i].intersects(queryBox)) {
+                    expectedExpandedNodes << i;
+                }
+            }
+            TS_ASSERT_EQUALS(expectedNodes, partitionManager.findNodes(queryBox));
+            TS_ASSERT_EQUALS(expectedExpandedNodes, partitionManager.findNodesExpanded(queryBox));
+        }
+    }
+
 private:
     Coord<2> dimensions;
     unsigned offset;
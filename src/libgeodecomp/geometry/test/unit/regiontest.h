@@ -2,10 +2,14 @@
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/regionbasedadjacency.h>
 #include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/random.h>
 #include <libgeodecomp/storage/displacedgrid.h>
 
 #include <cxxtest/TestSuite.h>
 
+#include <algorithm>
+#include <iterator>
+#include <set>
 #include <unistd.h>
 
 using namespace LibGeoDecomp;
@@ -1568,6 +1572,82 @@ public:
         TS_ASSERT_EQUALS(r.indices[2].size(), std::size_t(0));
     }
 
+    void testAppendStreak()
+    {
+        Region<2> r;
+        r.appendStreak(Streak<2>(Coord<2>(10, 1), 20));
+        r.appendStreak(Streak<2>(Coord<2>(30, 1), 40));
+        r.appendStreak(Streak<2>(Coord<2>(45, 1), 45));
+        // fuses both Streaks in row 1:
+        r.appendStreak(Streak<2>(Coord<2>(15, 1), 50));
+        r.appendStreak(Streak<2>(Coord<2>(50, 1), 55));
+        r.appendStreak(Streak<2>(Coord<2>( 0, 3), 10));
+        r.appendStreak(Streak<2>(Coord<2>(20, 3), 30));
+
+        Region<2> expected;
+        expected << Streak<2>(Coord<2>(10, 1), 55)
+                 << Streak<2>(Coord<2>( 0, 3), 10)
+                 << Streak<2>(Coord<2>(20, 3), 30);
+
+        TS_ASSERT_EQUALS(expected, r);
+        TS_ASSERT_EQUALS(expected.size(), r.size());
+        TS_ASSERT_EQUALS(expected.boundingBox(), r.boundingBox());
+
+        Region<3> r3;
+        r3.appendStreak(Streak<3>(Coord<3>(1, 2, 3), 5));
+        r3.appendStreak(Streak<3>(Coord<3>(0, 3, 3), 5));
+        r3.appendStreak(Streak<3>(Coord<3>(0, 0, 4), 5));
+        r3.appendStreak(Streak<3>(Coord<3>(4, 0, 4), 9));
+
+        Region<3> expected3;
+        expected3 << Streak<3>(Coord<3>(1, 2, 3), 5)
+                  << Streak<3>(Coord<3>(0, 3, 3), 5)
+                  << Streak<3>(Coord<3>(0, 0, 4), 9);
+
+        TS_ASSERT_EQUALS(expected3, r3);
+    }
+
+    void testSetOperationsMatchCoordinateSets()
+    {
+        for (int i = 0; i < 20; ++i) {
+            Region<3> a = randomRegion();
+            Region<3> b = randomRegion();
+            std::set<Coord<3> > setA(a.begin(), a.end());
+            std::set<Coord<3> > setB(b.begin(), b.end());
+
+            std::set<Coord<3> > intersection;
+            std::set<Coord<3> > difference;
+            std::set<Coord<3> > sum;
+            std::set_intersection(
+                setA.begin(), setA.end(), setB.begin(), setB.end(),
+                std::inserter(intersection, intersection.begin()));
+            std::set_difference(
+                setA.begin(), setA.end(), setB.begin(), setB.end(),
+                std::inserter(difference, difference.begin()));
+            std::set_union(
+                setA.begin(), setA.end(), setB.begin(), setB.end(),
+                std::inserter(sum, sum.begin()));
+
+            std::set<Coord<3> > expansion;
+            for (std::set<Coord<3> >::iterator j = setA.begin(); j != setA.end(); ++j) {
+                CoordBox<3> box(*j - Coord<3>::diagonal(1), Coord<3>::diagonal(3));
+                for (CoordBox<3>::Iterator k = box.begin(); k != box.end(); ++k) {
+                    expansion.insert(*k);
+                }
+            }
+
+            TS_ASSERT_EQUALS(toRegion(intersection), a & b);
+            TS_ASSERT_EQUALS(toRegion(difference),   a - b);
+            TS_ASSERT_EQUALS(toRegion(sum),          a + b);
+            TS_ASSERT_EQUALS(toRegion(expansion),    a.expand(1));
+
+            Region<3> accumulator = a;
+            accumulator += b;
+            TS_ASSERT_EQUALS(toRegion(sum), accumulator);
+            TS_ASSERT_EQUALS(sum.size(), accumulator.size());
+        }
+    }
+
     void testMerge2way()
     {
         Region<2> r1;
@@ -2259,6 +2339,27 @@ public:
     }
 
 private:
+    Region<3> randomRegion()
+    {
+        Region<3> ret;
+        for (int i = 0; i < 40; ++i) {
+            Coord<3> origin(Random::genUnsigned(20), Random::genUnsigned(8), Random::genUnsigned(8));
+            ret << Streak<3>(origin, origin.x() + 1 + Random::genUnsigned(10));
+        }
+
+        return ret;
+    }
+
+    Region<3> toRegion(const std::set<Coord<3> >& coords)
+    {
+        Region<3> ret;
+        for (std::set<Coord<3> >::const_iterator i = coords.begin(); i != coords.end(); ++i) {
+            ret << *i;
+        }
+
+        return ret;
+    }
+
     Region<2> c;
     CoordVector bigInsertOrdered;
     CoordVector bigInsertShuffled;
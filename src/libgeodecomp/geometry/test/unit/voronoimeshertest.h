@@ -68,6 +68,68 @@ public:
     int cellCounter;
 };
 
+class DummyCell3D
+{
+public:
+    class API :
+        public APITraits::HasCubeTopology<3>,
+        public APITraits::HasCoordType<FloatCoord<3> >
+    {};
+
+    explicit DummyCell3D(const FloatCoord<3>& center = FloatCoord<3>(0, 0, 0), int id = -1) :
+        center(center),
+        id(id),
+        area(0)
+    {}
+
+    void setArea(const double newArea)
+    {
+        area = newArea;
+    }
+
+    void setShape(const std::vector<FloatCoord<3> > newShape)
+    {
+        shape = newShape;
+    }
+
+    void pushNeighbor(const int id, const double boundaryArea, const FloatCoord<3> dir)
+    {
+        neighborIDs << id;
+        neighborBoundaryAreas << boundaryArea;
+    }
+
+    std::size_t numberOfNeighbors() const
+    {
+        return neighborIDs.size();
+    }
+
+    FloatCoord<3> center;
+    int id;
+    double area;
+    std::vector<FloatCoord<3> > shape;
+    std::vector<int> neighborIDs;
+    std::vector<double> neighborBoundaryAreas;
+};
+
+typedef ContainerCell<DummyCell3D, 30> ContainerCellType3D;
+
+class MockMesher3D : public VoronoiMesher<ContainerCellType3D>
+{
+public:
+    MockMesher3D(const Coord<3>& gridDim, const FloatCoord<3>& quadrantSize, double minCellDistance) :
+        VoronoiMesher<ContainerCellType3D>(gridDim, quadrantSize, minCellDistance),
+        cellCounter(1)
+    {}
+
+    virtual void addCell(ContainerCellType3D *container, const FloatCoord<DIM>& center)
+    {
+        int id = cellCounter++;
+        container->insert(id, DummyCell3D(center, id));
+    }
+
+    int cellCounter;
+};
+
 class VoronoiMesherTest : public CxxTest::TestSuite
 {
 public:
@@ -128,6 +190,79 @@ public:
         }
     }
 
+    void testFillGeometryData3D()
+    {
+        Coord<3> dim(3, 2, 2);
+        CoordBox<3> box(Coord<3>(), dim);
+        FloatCoord<3> quadrantSize(100, 100, 100);
+        Grid<ContainerCellType3D, Topologies::Cube<3>::Topology> grid(dim);
+        MockMesher3D mesher(dim, quadrantSize, 1);
+
+        // a regular lattice of cube-shaped elements with edge length 50:
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            CoordBox<3> subBox(Coord<3>(), Coord<3>::diagonal(2));
+            for (CoordBox<3>::Iterator j = subBox.begin(); j != subBox.end(); ++j) {
+                FloatCoord<3> realPos = quadrantSize.scale(*i) + FloatCoord<3>(*j) * 50 + FloatCoord<3>(25, 25, 25);
+                mesher.addCell(&grid[*i], realPos);
+            }
+        }
+
+        mesher.fillGeometryData(&grid);
+
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            const ContainerCellType3D& cell = grid[*i];
+            TS_ASSERT_EQUALS(cell.size(), std::size_t(8));
+
+            for (ContainerCellType3D::const_iterator j = cell.begin(); j != cell.end(); ++j) {
+                TS_ASSERT_EQUALS(j->shape.size(), std::size_t(8));
+                TS_ASSERT_DELTA(j->area, 50 * 50 * 50, 1e-6);
+                TS_ASSERT_EQUALS(j->neighborIDs.size(), std::size_t(6));
+
+                for (std::size_t k = 0; k < j->neighborIDs.size(); ++k) {
+                    TS_ASSERT_DIFFERS(j->id, j->neighborIDs[k]);
+                    TS_ASSERT_DELTA(j->neighborBoundaryAreas[k], 50 * 50, 1e-6);
+                }
+            }
+        }
+    }
+
+    void testFillGeometryDataViaGridBase()
+    {
+        Coord<2> dim(4, 3);
+        FloatCoord<2> quadrantSize(100, 100);
+        Grid<ContainerCellType> grid1(dim);
+        Grid<ContainerCellType> grid2(dim);
+        MockMesher mesher1(dim, quadrantSize, 20);
+        MockMesher mesher2(dim, quadrantSize, 20);
+
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                mesher1.addRandomCells(&grid1, Coord<2>(x, y), 40);
+                mesher2.addRandomCells(&grid2, Coord<2>(x, y), 40);
+            }
+        }
+
+        GridBase<ContainerCellType, 2>& gridBase = grid2;
+        mesher1.fillGeometryData(&grid1);
+        mesher2.fillGeometryData(&gridBase);
+
+        CoordBox<2> box(Coord<2>(), dim);
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            const ContainerCellType& cell1 = grid1[*i];
+            const ContainerCellType& cell2 = grid2[*i];
+            TS_ASSERT_EQUALS(cell1.size(), cell2.size());
+
+            for (std::size_t j = 0; j < cell1.size(); ++j) {
+                const DummyCell& element1 = cell1.begin()[j];
+                const DummyCell& element2 = cell2.begin()[j];
+                TS_ASSERT(element1.area > 0);
+                TS_ASSERT_EQUALS(element1.area,        element2.area);
+                TS_ASSERT_EQUALS(element1.shape,       element2.shape);
+                TS_ASSERT_EQUALS(element1.neighborIDs, element2.neighborIDs);
+            }
+        }
+    }
+
     void testAddRandomCells()
     {
         Coord<2> dim(7, 3);
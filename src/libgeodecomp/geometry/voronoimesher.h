@@ -1,15 +1,19 @@
 #ifndef LIBGEODECOMP_GEOMETRY_VORONOIMESHER_H
 #define LIBGEODECOMP_GEOMETRY_VORONOIMESHER_H
 
+#include <libgeodecomp/config.h>
 #include <libgeodecomp/geometry/convexpolytope.h>
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/plane.h>
 #include <libgeodecomp/io/logger.h>
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/misc/random.h>
-#include <libgeodecomp/storage/gridbase.h>
+#include <libgeodecomp/storage/grid.h>
+
 #include <algorithm>
 #include <set>
+#include <stdexcept>
+#include <string>
 
 namespace LibGeoDecomp {
 
@@ -77,58 +81,124 @@ public:
         }
     };
 
+    /**
+     * Computes shape, area and neighbors of all elements. Generic
+     * grids are copied into a Grid once and written back
+     * afterwards, for Grid itself see the overload below.
+     */
     void fillGeometryData(GridType *grid)
     {
         CoordBox<DIM> box = grid->boundingBox();
+        Grid<ContainerCellType, Topology> buffer(*grid);
+        fillGeometryData(&buffer);
+
+        Region<DIM> region;
+        region << box;
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            grid->set(*i, &buffer[i->origin - box.origin]);
+        }
+    }
+
+    /**
+     * Meshes the grid in place. Container cells are distributed
+     * among all OpenMP threads, each of which reuses a single
+     * ConvexPolytope. Elements are intersected with all elements in
+     * the 3^DIM surrounding container cells.
+     */
+    template<typename TOPOLOGY>
+    void fillGeometryData(Grid<ContainerCellType, TOPOLOGY> *grid)
+    {
+        const Grid<ContainerCellType, TOPOLOGY>& neighbors = *grid;
+        CoordBox<DIM> box = grid->boundingBox();
+        CoordBox<DIM> stencil(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
         FloatCoord<DIM> simSpaceDim = quadrantSize.scale(box.dimensions);
+        long numContainers = static_cast<long>(box.size());
+
         // statistics:
         std::size_t maxShape = 0;
         std::size_t maxNeighbors = 0;
         std::size_t maxCells = 0;
         double maxDiameter = 0;
+        // exceptions must not escape the parallel region:
+        std::string error;
 
-        for (typename CoordBox<DIM>::Iterator iter = box.begin(); iter != box.end(); ++iter) {
-            Coord<2> containerCoord = *iter;
-            ContainerCellType container = grid->get(containerCoord);
-            maxCells = (std::max)(maxCells, container.size());
-
-            for (typename ContainerCellType::Iterator i = container.begin(); i != container.end(); ++i) {
-                Cargo& cell = *i;
-                ElementType e(cell.center, simSpaceDim);
-                for (int y = -1; y < 2; ++y) {
-                    for (int x = -1; x < 2; ++x) {
-                        ContainerCellType container2 =
-                            grid->get(containerCoord + Coord<2>(x, y));
-                        for (typename ContainerCellType::Iterator j = container2.begin();
-                             j != container2.end();
-                             ++j) {
-                            if (cell.center != j->center) {
-                                e << std::make_pair(j->center, i->id);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            ElementType e;
+            std::size_t localMaxShape = 0;
+            std::size_t localMaxNeighbors = 0;
+            std::size_t localMaxCells = 0;
+            double localMaxDiameter = 0;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(dynamic)
+#endif
+            for (long index = 0; index < numContainers; ++index) {
+                Coord<DIM> containerCoord = box.origin + box.dimensions.indexToCoord(index);
+                ContainerCellType& container = (*grid)[containerCoord];
+                localMaxCells = (std::max)(localMaxCells, container.size());
+
+                try {
+                    for (typename ContainerCellType::Iterator i = container.begin(); i != container.end(); ++i) {
+                        Cargo& cell = *i;
+                        e.reset(cell.center, simSpaceDim);
+
+                        for (typename CoordBox<DIM>::Iterator offset = stencil.begin();
+                             offset != stencil.end();
+                             ++offset) {
+                            const ContainerCellType& container2 = neighbors[containerCoord + *offset];
+                            for (typename ContainerCellType::const_iterator j = container2.begin();
+                                 j != container2.end();
+                                 ++j) {
+                                if (cell.center != j->center) {
+                                    e << std::make_pair(j->center, j->id);
+                                }
                             }
                         }
-                    }
-                }
 
-                e.updateGeometryData();
-                if (e.getDiameter() > quadrantSize.minElement()) {
-                    throw std::logic_error("element geometry too large for container cell");
-                }
+                        e.updateGeometryData();
+                        if (e.getDiameter() > quadrantSize.minElement()) {
+                            throw std::logic_error("element geometry too large for container cell");
+                        }
+
+                        cell.setArea(e.getVolume());
+                        cell.setShape(e.getShape());
 
-                cell.setArea(e.getVolume());
-                cell.setShape(e.getShape());
+                        for (typename std::vector<EquationType>::const_iterator l = e.getLimits().begin();
+                             l != e.getLimits().end();
+                             ++l) {
+                            cell.pushNeighbor(l->neighborID, l->length, l->dir);
+                        }
 
-                for (typename std::vector<EquationType>::const_iterator l = e.getLimits().begin();
-                     l != e.getLimits().end();
-                     ++l) {
-                    cell.pushNeighbor(l->neighborID, l->length, l->dir);
+                        localMaxShape     = (std::max)(localMaxShape,     cell.shape.size());
+                        localMaxNeighbors = (std::max)(localMaxNeighbors, cell.numberOfNeighbors());
+                        localMaxDiameter  = (std::max)(localMaxDiameter,  e.getDiameter());
+                    }
+                } catch (const std::exception& exception) {
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical
+#endif
+                    if (error.empty()) {
+                        error = exception.what();
+                    }
                 }
+            }
 
-                maxShape     = (std::max)(maxShape,     cell.shape.size());
-                maxNeighbors = (std::max)(maxNeighbors, cell.numberOfNeighbors());
-                maxDiameter  = (std::max)(maxDiameter,  e.getDiameter());
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp critical
+#endif
+            {
+                maxShape     = (std::max)(maxShape,     localMaxShape);
+                maxNeighbors = (std::max)(maxNeighbors, localMaxNeighbors);
+                maxCells     = (std::max)(maxCells,     localMaxCells);
+                maxDiameter  = (std::max)(maxDiameter,  localMaxDiameter);
             }
+        }
 
-            grid->set(containerCoord, container);
+        if (!error.empty()) {
+            throw std::logic_error(error);
         }
 
         LOG(DBG,
@@ -0,0 +1,369 @@
+#ifndef LIBGEODECOMP_IO_ASYNCWRITER_H
+#define LIBGEODECOMP_IO_ASYNCWRITER_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_CPP14
+
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/storage/gridtypeselector.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * AsyncWriter decorates a ParallelWriter so that its output is
+ * written by a background thread. The simulation thread merely
+ * copies the valid region into a (pooled) buffer; the delegate is
+ * then called back with a grid reconstructed from that buffer while
+ * the simulation continues with the next time steps.
+ *
+ * At most capacity time steps may be queued. Once the queue is full
+ * the Policy decides what happens to further output:
+ *
+ * - BLOCK waits until the writer thread has caught up,
+ * - DROP discards the new time step,
+ * - COALESCE replaces the most recently queued time step with the
+ *   new one, so the output always reflects the latest state.
+ *
+ * Events other than WRITER_STEP_FINISHED are never discarded and
+ * WRITER_ALL_DONE blocks until all output has been written.
+ *
+ * DROP and COALESCE are decided from each rank's local queue, so
+ * they can't be used with collective delegates (see
+ * ParallelWriter::isCollective()): ranks would skip different time
+ * steps and their collective calls would no longer match.
+ *
+ * Delegates which communicate via MPI (e.g. BOVWriter) require MPI
+ * to be initialized with MPI_THREAD_MULTIPLE as they'll be called
+ * from a thread other than the simulation's.
+ */
+template<typename CELL_TYPE>
+class AsyncWriter : public Clonable<ParallelWriter<CELL_TYPE>, AsyncWriter<CELL_TYPE> >
+{
+public:
+    typedef typename ParallelWriter<CELL_TYPE>::Topology Topology;
+    typedef typename ParallelWriter<CELL_TYPE>::GridType GridType;
+    typedef typename APITraits::SelectSoA<CELL_TYPE>::Value SupportsSoA;
+    typedef typename GridTypeSelector<CELL_TYPE, Topology, false, SupportsSoA>::Value StorageGridType;
+    typedef typename SerializationBuffer<CELL_TYPE>::BufferType BufferType;
+
+    using ParallelWriter<CELL_TYPE>::period;
+
+    static const int DIM = Topology::DIM;
+
+    enum Policy {
+        BLOCK,
+        DROP,
+        COALESCE
+    };
+
+    explicit AsyncWriter(
+        ParallelWriter<CELL_TYPE> *delegate,
+        std::size_t capacity = 2,
+        Policy policy = BLOCK) :
+        Clonable<ParallelWriter<CELL_TYPE>, AsyncWriter<CELL_TYPE> >(
+            delegate ? delegate->getPrefix() : "",
+            delegate ? delegate->getPeriod() : 1),
+        delegate(delegate),
+        capacity(capacity),
+        policy(policy),
+        droppingStep(false),
+        busy(false),
+        stopping(false)
+    {
+        if (delegate == 0) {
+            throw std::invalid_argument("delegate writer must not be null");
+        }
+        if (capacity == 0) {
+            throw std::invalid_argument("queue capacity must be positive");
+        }
+        if ((policy != BLOCK) && delegate->isCollective()) {
+            throw std::invalid_argument("collective delegates require the BLOCK policy");
+        }
+
+        thread = std::thread(&AsyncWriter::run, this);
+    }
+
+    ~AsyncWriter()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobAvailable.notify_one();
+        thread.join();
+    }
+
+    /**
+     * Copies get their own delegate and writer thread, queued time
+     * steps are not copied.
+     */
+    AsyncWriter(const AsyncWriter& other) :
+        Clonable<ParallelWriter<CELL_TYPE>, AsyncWriter<CELL_TYPE> >(other),
+        delegate(other.delegate->clone()),
+        capacity(other.capacity),
+        policy(other.policy),
+        droppingStep(false),
+        busy(false),
+        stopping(false)
+    {
+        thread = std::thread(&AsyncWriter::run, this);
+    }
+
+    virtual void setRegion(const Region<DIM>& newRegion)
+    {
+        flush();
+        ParallelWriter<CELL_TYPE>::setRegion(newRegion);
+        delegate->setRegion(newRegion);
+    }
+
+    virtual void stepFinished(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
+            return;
+        }
+
+        if (pending.empty()) {
+            droppingStep = (event == WRITER_STEP_FINISHED) && (policy == DROP) && queueFull();
+        }
+        if (droppingStep) {
+            droppingStep = !lastCall;
+            return;
+        }
+
+        pending.push_back(Part(acquireBuffer(), validRegion, globalDimensions, step, event, rank, lastCall, grid.getEdge()));
+        Part& part = pending.back();
+        SerializationBuffer<CELL_TYPE>::resize(&part.buffer, validRegion.size());
+        grid.saveRegion(&part.buffer, validRegion);
+
+        if (!lastCall) {
+            return;
+        }
+
+        enqueue(event);
+
+        if (event == WRITER_ALL_DONE) {
+            flush();
+        }
+    }
+
+    virtual bool isCollective() const
+    {
+        return delegate->isCollective();
+    }
+
+    /**
+     * Blocks until the writer thread has handed all queued time
+     * steps to the delegate. Rethrows exceptions raised by the
+     * delegate.
+     */
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [this]{ return queue.empty() && !busy; });
+        rethrow();
+    }
+
+private:
+    /**
+     * Snapshot of one invocation of stepFinished(). A time step may
+     * consist of multiple parts, the last of which has lastCall set.
+     */
+    class Part
+    {
+    public:
+        Part(
+            BufferType&& buffer,
+            const Region<DIM>& region,
+            const Coord<DIM>& globalDimensions,
+            unsigned step,
+            WriterEvent event,
+            std::size_t rank,
+            bool lastCall,
+            const CELL_TYPE& edge) :
+            buffer(std::move(buffer)),
+            region(region),
+            globalDimensions(globalDimensions),
+            step(step),
+            event(event),
+            rank(rank),
+            lastCall(lastCall),
+            edge(edge)
+        {}
+
+        BufferType buffer;
+        Region<DIM> region;
+        Coord<DIM> globalDimensions;
+        unsigned step;
+        WriterEvent event;
+        std::size_t rank;
+        bool lastCall;
+        CELL_TYPE edge;
+    };
+
+    typedef std::vector<Part> Job;
+
+    typename SharedPtr<ParallelWriter<CELL_TYPE> >::Type delegate;
+    std::size_t capacity;
+    Policy policy;
+    // only accessed by the simulation thread:
+    Job pending;
+    bool droppingStep;
+    // only accessed by the writer thread:
+    StorageGridType grid;
+    // guarded by mutex:
+    std::deque<Job> queue;
+    std::vector<BufferType> freeBuffers;
+    std::exception_ptr error;
+    bool busy;
+    bool stopping;
+
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobDone;
+    std::thread thread;
+
+    bool queueFull()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return queue.size() >= capacity;
+    }
+
+    BufferType acquireBuffer()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (freeBuffers.empty()) {
+            return BufferType();
+        }
+
+        BufferType ret = std::move(freeBuffers.back());
+        freeBuffers.pop_back();
+        return ret;
+    }
+
+    /**
+     * Caller needs to hold the lock.
+     */
+    void releaseBuffers(Job& job)
+    {
+        for (typename Job::iterator i = job.begin(); i != job.end(); ++i) {
+            freeBuffers.push_back(std::move(i->buffer));
+        }
+    }
+
+    /**
+     * Caller needs to hold the lock.
+     */
+    void rethrow()
+    {
+        if (error) {
+            std::exception_ptr e = error;
+            error = std::exception_ptr();
+            std::rethrow_exception(e);
+        }
+    }
+
+    void enqueue(WriterEvent event)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rethrow();
+
+            if ((queue.size() >= capacity) &&
+                (event == WRITER_STEP_FINISHED) &&
+                (policy == COALESCE) &&
+                (queue.back().front().event == WRITER_STEP_FINISHED)) {
+                releaseBuffers(queue.back());
+                queue.pop_back();
+            }
+
+            jobDone.wait(lock, [this]{ return queue.size() < capacity; });
+            queue.push_back(std::move(pending));
+        }
+
+        pending = Job();
+        jobAvailable.notify_one();
+    }
+
+    void run()
+    {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobAvailable.wait(lock, [this]{ return !queue.empty() || stopping; });
+                if (queue.empty()) {
+                    return;
+                }
+
+                job = std::move(queue.front());
+                queue.pop_front();
+                busy = true;
+            }
+            jobDone.notify_all();
+
+            std::exception_ptr failure;
+            try {
+                write(job);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                releaseBuffers(job);
+                if (failure) {
+                    error = failure;
+                }
+                busy = false;
+            }
+            jobDone.notify_all();
+        }
+    }
+
+    void write(Job& job)
+    {
+        for (typename Job::iterator i = job.begin(); i != job.end(); ++i) {
+            Region<DIM> gridRegion;
+            gridRegion << grid.boundingBox();
+            if (!(i->region - gridRegion).empty()) {
+                grid.resize((gridRegion + i->region).boundingBox());
+            }
+
+            grid.loadRegion(i->buffer, i->region);
+            grid.setEdge(i->edge);
+            delegate->stepFinished(
+                grid,
+                i->region,
+                i->globalDimensions,
+                i->step,
+                i->event,
+                i->rank,
+                i->lastCall);
+        }
+    }
+};
+
+}
+
+#endif
+
+#endif
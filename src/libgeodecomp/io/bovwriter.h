@@ -42,6 +42,7 @@ public:
         Clonable<ParallelWriter<CELL_TYPE>, BOVWriter<CELL_TYPE> >(prefix, period),
         selector(member, "var"),
         brickletDim(brickletDim),
+        comm(communicator),
         datatype(selector.mpiDatatype())
     {}
 
@@ -75,6 +76,19 @@ public:
         writeRegion(step, globalDimensions, grid, validRegion);
     }
 
+    virtual bool isCollective() const
+    {
+        return true;
+    }
+
+    /**
+     * Passes a hint to the MPI-IO layer, e.g. setHint("cb_nodes",
+     * "4") or setHint("striping_factor", "16").
+     */
+    void setHint(const std::string& key, const std::string& value)
+    {
+        mpiio.setHint(key, value);
+    }
 
 private:
     MPIIO<CELL_TYPE, Topology> mpiio;
@@ -140,33 +154,21 @@ private:
     {
         MPI_File file = mpiio.openFileForWrite(
             filename(step, "data"), comm);
-        MPI_Aint varLength = mpiio.getLength(datatype);
-        std::vector<char> buffer;
-
-        for (typename Region<DIM>::StreakIterator i = region.beginStreak();
-             i != region.endStreak();
-             ++i) {
-            // the coords need to be normalized because on torus
-            // topologies the coordnates may exceed the bounding box
-            // (especially negative coordnates may occurr).
-            Coord<DIM> coord = Topology::normalize(i->origin, dimensions);
-            int dataComponents = selector.arity();
-            MPI_Offset index = coord.toIndex(dimensions) * varLength * dataComponents;
-            MPI_File_seek(file, index, MPI_SEEK_SET);
-            int length = i->endX - i->origin.x();
-            std::size_t byteSize = length * selector.sizeOfExternal();
-
-            if (buffer.size() != byteSize) {
-                buffer.resize(byteSize);
-            }
+        std::vector<char> buffer(region.size() * selector.sizeOfExternal());
 
-            Region<DIM> tempRegion;
-            tempRegion << *i;
-            grid.saveMemberUnchecked(&buffer[0], MemoryLocation::HOST, selector, tempRegion);
-
-            MPI_File_write(file, &buffer[0], length, datatype, MPI_STATUS_IGNORE);
+        if (!buffer.empty()) {
+            grid.saveMemberUnchecked(&buffer[0], MemoryLocation::HOST, selector, region);
         }
 
+        mpiio.writeAll(
+            file,
+            region,
+            dimensions,
+            0,
+            datatype,
+            selector.arity(),
+            buffer.empty() ? 0 : &buffer[0]);
+
         MPI_File_close(&file);
     }
 };
@@ -0,0 +1,256 @@
+#ifndef LIBGEODECOMP_IO_CHROMETRACEWRITER_H
+#define LIBGEODECOMP_IO_CHROMETRACEWRITER_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_CPP14
+
+#include <libgeodecomp/io/ioexception.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/tracer.h>
+
+#ifdef LIBGEODECOMP_WITH_MPI
+#include <mpi.h>
+#endif
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Enables the Tracer for the duration of the simulation and
+ * periodically flushes the recorded events to a file per rank
+ * ("prefix.RANK.json"), which can be loaded into Chrome's
+ * about://tracing or Perfetto. Each event is shown as a slice per
+ * rank (pid) and thread (tid), annotated with nano step, region size
+ * and PatchType.
+ *
+ * Upon each flush the duration histograms of all ranks are
+ * aggregated (via MPI_Reduce on the given communicator) and written
+ * to "prefix.histogram" by rank 0, so slow phases or ranks can be
+ * spotted while the simulation is still running. All ranks need to
+ * use a ChromeTraceWriter with the same period.
+ */
+template<typename CELL_TYPE>
+class ChromeTraceWriter : public Clonable<ParallelWriter<CELL_TYPE>, ChromeTraceWriter<CELL_TYPE> >
+{
+public:
+    friend class ChromeTraceWriterTest;
+
+    using ParallelWriter<CELL_TYPE>::period;
+    using ParallelWriter<CELL_TYPE>::prefix;
+
+    typedef typename ParallelWriter<CELL_TYPE>::GridType GridType;
+    typedef typename ParallelWriter<CELL_TYPE>::Topology Topology;
+
+    static const int DIM = Topology::DIM;
+
+    explicit ChromeTraceWriter(
+        const std::string& prefix,
+        const unsigned period = 1,
+        const std::size_t capacity = Tracer::DEFAULT_CAPACITY
+#ifdef LIBGEODECOMP_WITH_MPI
+        , const MPI_Comm& communicator = MPI_COMM_WORLD
+#endif
+                               ) :
+        Clonable<ParallelWriter<CELL_TYPE>, ChromeTraceWriter<CELL_TYPE> >(prefix, period),
+        capacity(capacity),
+#ifdef LIBGEODECOMP_WITH_MPI
+        comm(communicator),
+#endif
+        rank(0),
+        eventsWritten(0)
+    {}
+
+    virtual void stepFinished(
+        const GridType& /* grid */,
+        const Region<DIM>& /* validRegion */,
+        const Coord<DIM>& /* globalDimensions */,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        if (!lastCall) {
+            return;
+        }
+
+        switch (event) {
+        case WRITER_INITIALIZED:
+            open(rank);
+            break;
+        case WRITER_STEP_FINISHED:
+            if ((step % period) == 0) {
+                flush();
+            }
+            break;
+        case WRITER_ALL_DONE:
+            Tracer::disable();
+            flush();
+            close();
+            break;
+        default:
+            throw std::invalid_argument("unknown event");
+        }
+    }
+
+    /**
+     * Each flush reduces the histograms of all ranks.
+     */
+    virtual bool isCollective() const
+    {
+        return true;
+    }
+
+private:
+    typedef typename SharedPtr<std::ofstream>::Type FilePtr;
+
+    std::size_t capacity;
+#ifdef LIBGEODECOMP_WITH_MPI
+    MPI_Comm comm;
+#endif
+    std::size_t rank;
+    std::string filename;
+    FilePtr file;
+    std::size_t eventsWritten;
+    std::vector<Tracer::Event> events;
+    TraceHistogram histogram;
+
+    void open(std::size_t newRank)
+    {
+        rank = newRank;
+        std::stringstream buf;
+        buf << prefix << "." << std::setfill('0') << std::setw(5) << rank << ".json";
+        filename = buf.str();
+
+        file.reset(new std::ofstream(filename.c_str()));
+        if (!file->good()) {
+            throw FileOpenException(filename);
+        }
+        *file << "[";
+
+        eventsWritten = 0;
+        histogram = TraceHistogram();
+        Tracer::setRank(static_cast<int>(rank));
+        // the Tracer is shared by all clones (e.g. one per
+        // UpdateGroup in the HPXSimulator). Enabling it again would
+        // discard the events which have already been recorded:
+        if (!Tracer::enabled()) {
+            Tracer::enable(capacity);
+        }
+    }
+
+    void flush()
+    {
+        if (!file) {
+            throw std::logic_error("ChromeTraceWriter was not initialized");
+        }
+
+        events.clear();
+        Tracer::drain(&events);
+
+        file->precision(3);
+        *file << std::fixed;
+        for (std::vector<Tracer::Event>::iterator i = events.begin(); i != events.end(); ++i) {
+            writeEvent(*i);
+            histogram.add(i->event, i->duration);
+        }
+        file->flush();
+
+        if (!file->good()) {
+            throw FileWriteException(filename);
+        }
+
+        writeHistogram(reduceHistogram());
+    }
+
+    void close()
+    {
+        *file << "\n]\n";
+        file->close();
+        file.reset();
+    }
+
+    void writeEvent(const Tracer::Event& event)
+    {
+        *file << (eventsWritten++ ? ",\n" : "\n")
+              << "{\"name\":\"" << ChronometerHelpers::EventToString()(event.event) << "\""
+              << ",\"cat\":\"libgeodecomp\",\"ph\":\"X\""
+              << ",\"ts\":" << (event.start * 1e6)
+              << ",\"dur\":" << (event.duration * 1e6)
+              << ",\"pid\":" << event.rank
+              << ",\"tid\":" << event.thread
+              << ",\"args\":{\"nano_step\":" << event.nanoStep
+              << ",\"region_size\":" << event.regionSize
+              << ",\"patch_type\":" << event.patchType << "}}";
+    }
+
+    /**
+     * Returns the sum of all ranks' histograms on rank 0.
+     */
+    TraceHistogram reduceHistogram()
+    {
+        TraceHistogram ret;
+
+#ifdef LIBGEODECOMP_WITH_MPI
+        int initialized;
+        MPI_Initialized(&initialized);
+        if (initialized) {
+            MPI_Reduce(
+                &histogram.rawCounts()[0],
+                &ret.rawCounts()[0],
+                static_cast<int>(ret.rawCounts().size()),
+                MPI_UNSIGNED_LONG_LONG,
+                MPI_SUM,
+                0,
+                comm);
+            return ret;
+        }
+#endif
+
+        ret += histogram;
+        return ret;
+    }
+
+    void writeHistogram(const TraceHistogram& globalHistogram)
+    {
+        if (rank != 0) {
+            return;
+        }
+
+        std::string histogramFilename = prefix + ".histogram";
+        std::ofstream outfile(histogramFilename.c_str());
+        if (!outfile.good()) {
+            throw FileOpenException(histogramFilename);
+        }
+
+        outfile << "# event, upper bucket limit [s], count (all ranks)\n";
+        for (std::size_t i = 0; i < Chronometer::NUM_INTERVALS; ++i) {
+            for (std::size_t j = 0; j < TraceHistogram::NUM_BUCKETS; ++j) {
+                unsigned long long count = globalHistogram.count(i, j);
+                if (count > 0) {
+                    outfile << ChronometerHelpers::EventToString()(i) << " "
+                            << TraceHistogram::bucketLimit(j) << " "
+                            << count << "\n";
+                }
+            }
+        }
+        outfile << "# dropped events (rank 0): " << Tracer::dropped() << "\n";
+
+        if (!outfile.good()) {
+            throw FileWriteException(histogramFilename);
+        }
+    }
+};
+
+}
+
+#endif
+
+#endif
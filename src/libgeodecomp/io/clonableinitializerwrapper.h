@@ -53,6 +53,7 @@ class ClonableInitializerWrapper : public ClonableInitializer<typename INITIALIZ
 public:
     typedef typename INITIALIZER::Cell Cell;
     typedef typename INITIALIZER::Topology Topology;
+    typedef typename ClonableInitializer<Cell>::CellCostsPtr CellCostsPtr;
     const static int DIM = Topology::DIM;
 
     /**
@@ -125,6 +126,11 @@ public:
         delegate.grid(target);
     }
 
+    virtual void initRegion(GridBase<Cell, DIM> *target, const Region<DIM>& region)
+    {
+        delegate.initRegion(target, region);
+    }
+
     virtual CoordBox<DIM> gridBox()
     {
         return delegate.gridBox();
@@ -145,6 +151,11 @@ public:
         return delegate.maxSteps();
     }
 
+    virtual CellCostsPtr getCellCosts() const
+    {
+        return delegate.getCellCosts();
+    }
+
     virtual ClonableInitializer<Cell> *clone() const
     {
         return new ClonableInitializerWrapper<INITIALIZER>(INITIALIZER(delegate));
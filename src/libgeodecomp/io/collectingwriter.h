@@ -10,6 +10,8 @@
 #include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/misc/sharedptr.h>
 
+#include <vector>
+
 namespace LibGeoDecomp {
 
 /**
@@ -17,6 +19,12 @@ namespace LibGeoDecomp {
  * together with a DistributedSimulator. Good for testing, but doesn't
  * scale, as all memory is concentrated on one node and IO is
  * serialized to that node. Use with care!
+ *
+ * By default all ranks' regions are collected with a single
+ * MPI_Gatherv, then the root posts non-blocking receives for all
+ * payloads and deserializes them in order of arrival, so that
+ * unpacking overlaps with the remaining transfers. The SERIAL mode
+ * retains the legacy rank-by-rank exchange.
  */
 template<typename CELL_TYPE>
 class CollectingWriter : public Clonable<ParallelWriter<CELL_TYPE>, CollectingWriter<CELL_TYPE> >
@@ -32,16 +40,23 @@ public:
 
     static const int DIM = Topology::DIM;
 
+    enum Mode {
+        GATHER,
+        SERIAL
+    };
+
     explicit CollectingWriter(
         Writer<CELL_TYPE> *writer,
         int root = 0,
         MPI_Comm communicator = MPI_COMM_WORLD,
-        MPI_Datatype mpiDatatype = SerializationBuffer<CELL_TYPE>::cellMPIDataType()) :
+        MPI_Datatype mpiDatatype = SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+        Mode mode = GATHER) :
         Clonable<ParallelWriter<CELL_TYPE>, CollectingWriter<CELL_TYPE> >("",  1),
         writer(writer),
         mpiLayer(communicator),
         root(root),
-        datatype(mpiDatatype)
+        datatype(mpiDatatype),
+        mode(mode)
     {
         if ((mpiLayer.rank() != root) && (writer != 0)) {
             throw std::invalid_argument("can't call back a writer on a node other than the root");
@@ -77,10 +92,120 @@ public:
                 globalGrid = StorageGridType(region);
             }
 
-            globalGrid.loadRegion(buffer, validRegion);
             globalGrid.setEdge(grid.getEdge());
         }
 
+        if (mode == GATHER) {
+            gatherRemoteRegions(validRegion);
+        } else {
+            collectRemoteRegionsSerially(validRegion);
+        }
+
+        mpiLayer.waitAll();
+
+        if (lastCall && (mpiLayer.rank() == root)) {
+            writer->stepFinished(globalGrid, step, event);
+        }
+    }
+
+    virtual bool isCollective() const
+    {
+        return true;
+    }
+
+private:
+    typename SharedPtr<Writer<CELL_TYPE> >::Type writer;
+    MPILayer mpiLayer;
+    int root;
+    StorageGridType globalGrid;
+    BufferType buffer;
+    std::vector<BufferType> receiveBuffers;
+    MPI_Datatype datatype;
+    Mode mode;
+
+    /**
+     * Ships all regions to the root in one collective. The payloads
+     * follow point-to-point, but the root receives them in whatever
+     * order they arrive and unpacks each one right away.
+     */
+    void gatherRemoteRegions(const Region<DIM>& validRegion)
+    {
+        std::vector<Streak<DIM> > streaks = validRegion.toVector();
+        std::vector<int> numStreaks = mpiLayer.gather(static_cast<int>(streaks.size()), root);
+
+        if (mpiLayer.rank() != root) {
+            std::vector<Streak<DIM> > unused;
+            mpiLayer.gatherV(streaks, numStreaks, root, unused);
+            if (buffer.size() > 0) {
+                mpiLayer.send(
+                    buffer.data(),
+                    root,
+                    buffer.size(),
+                    MPILayer::COLLECTING_WRITER,
+                    datatype);
+            }
+            return;
+        }
+
+        std::size_t totalStreaks = 0;
+        for (std::size_t i = 0; i < numStreaks.size(); ++i) {
+            totalStreaks += numStreaks[i];
+        }
+        std::vector<Streak<DIM> > allStreaks(totalStreaks);
+        mpiLayer.gatherV(streaks, numStreaks, root, allStreaks);
+
+        std::vector<Region<DIM> > regions(mpiLayer.size());
+        std::vector<MPI_Request> requests;
+        std::vector<int> senders;
+        receiveBuffers.resize(mpiLayer.size());
+
+        typename std::vector<Streak<DIM> >::iterator begin = allStreaks.begin();
+        for (int sender = 0; sender < mpiLayer.size(); ++sender) {
+            typename std::vector<Streak<DIM> >::iterator end = begin + numStreaks[sender];
+            if ((sender == root) || (begin == end)) {
+                begin = end;
+                continue;
+            }
+
+            regions[sender].load(begin, end);
+            begin = end;
+
+            BufferType& receiveBuffer = receiveBuffers[sender];
+            SerializationBuffer<CELL_TYPE>::resize(&receiveBuffer, regions[sender].size());
+            if (receiveBuffer.size() == 0) {
+                continue;
+            }
+
+            requests.push_back(MPI_Request());
+            senders.push_back(sender);
+            MPI_Irecv(
+                receiveBuffer.data(),
+                receiveBuffer.size(),
+                datatype,
+                sender,
+                MPILayer::COLLECTING_WRITER,
+                mpiLayer.communicator(),
+                &requests.back());
+        }
+
+        // the root's own share is unpacked while the remote payloads
+        // are still in flight:
+        globalGrid.loadRegion(buffer, validRegion);
+
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            int index;
+            MPI_Waitany(requests.size(), &requests[0], &index, MPI_STATUS_IGNORE);
+            int sender = senders[index];
+            globalGrid.loadRegion(receiveBuffers[sender], regions[sender]);
+        }
+    }
+
+    void collectRemoteRegionsSerially(const Region<DIM>& validRegion)
+    {
+        if (mpiLayer.rank() == root) {
+            globalGrid.loadRegion(buffer, validRegion);
+        }
+
         for (int sender = 0; sender < mpiLayer.size(); ++sender) {
             if (sender != root) {
                 if (mpiLayer.rank() == root) {
@@ -93,7 +218,7 @@ public:
                         sender,
                         buffer.size(),
                         MPILayer::COLLECTING_WRITER,
-                        SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+                        datatype);
                     mpiLayer.waitAll();
                     globalGrid.loadRegion(buffer, recvRegion);
                 }
@@ -104,25 +229,11 @@ public:
                         root,
                         buffer.size(),
                         MPILayer::COLLECTING_WRITER,
-                        SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+                        datatype);
                 }
             }
         }
-
-        mpiLayer.waitAll();
-
-        if (lastCall && (mpiLayer.rank() == root)) {
-            writer->stepFinished(globalGrid, step, event);
-        }
     }
-
-private:
-    typename SharedPtr<Writer<CELL_TYPE> >::Type writer;
-    MPILayer mpiLayer;
-    int root;
-    StorageGridType globalGrid;
-    BufferType buffer;
-    MPI_Datatype datatype;
 };
 
 }
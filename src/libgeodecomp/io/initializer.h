@@ -3,6 +3,7 @@
 
 #include <libgeodecomp/config.h>
 #include <libgeodecomp/geometry/adjacencymanufacturer.h>
+#include <libgeodecomp/geometry/cellcosts.h>
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/misc/random.h>
 #include <libgeodecomp/storage/gridbase.h>
@@ -25,6 +26,7 @@ public:
     typedef typename APITraits::SelectTopology<CELL>::Value Topology;
     typedef CELL Cell;
     typedef typename SharedPtr<Adjacency>::Type AdjacencyPtr;
+    typedef typename SharedPtr<CellCosts<Topology::DIM> >::Type CellCostsPtr;
 
     static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL>::VALUE;
     static const int DIM = Topology::DIM;
@@ -37,6 +39,17 @@ public:
      */
     virtual void grid(GridBase<CELL, DIM> *target) = 0;
 
+    /**
+     * Initializes only those cells of target which lie within
+     * region, plus its edge cell. Simulators call this if they don't
+     * need the remainder of the grid's bounding box initialized.
+     * Overriding this is optional, the default falls back to grid().
+     */
+    virtual void initRegion(GridBase<CELL, DIM> *target, const Region<DIM>& /* region */)
+    {
+        grid(target);
+    }
+
     /**
      * Allows a Simulator to discover the extent of the whole
      * simulation. Usually Simulations will use 0 as the origin, but
@@ -109,6 +122,18 @@ public:
         return AdjacencyPtr();
     }
 
+    /**
+     * Models whose cells differ significantly in their computational
+     * cost may return an estimate of these costs here. Simulators
+     * will then hand it to their Partition for the initial domain
+     * decomposition (see Partition::setCellCosts()). The default
+     * (a null pointer) treats all cells as equally expensive.
+     */
+    virtual CellCostsPtr getCellCosts() const
+    {
+        return CellCostsPtr();
+    }
+
 private:
     template<typename TOPOLOGY>
     void checkTopologyIfAdjacencyIsNeeded(const TOPOLOGY /* unused */) const
@@ -9,11 +9,22 @@
 #include <libgeodecomp/communication/typemaps.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/loadbalancer/randombalancer.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#include <algorithm>
+#include <map>
 
 namespace LibGeoDecomp {
 
 /**
  * Utility class which bundles common MPI-based input/output code.
+ *
+ * Writes are collective: each process describes its Region via a
+ * file view and all data is written in a single MPI_File_write_all()
+ * call, which allows the MPI implementation to aggregate the many
+ * small, scattered Streaks into few large requests. Hints (e.g.
+ * "striping_factor" or "cb_nodes") may be passed to the MPI-IO layer
+ * via setHint().
  */
 template<
     typename CELL_TYPE,
@@ -111,6 +122,56 @@ public:
                            1, mpiDatatype,  MPI_STATUS_IGNORE);
         }
 
+        std::vector<CELL_TYPE> buffer(region.size());
+        std::size_t cursor = 0;
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak();
+             i != region.endStreak();
+             ++i) {
+            grid.get(*i, &buffer[cursor]);
+            cursor += i->length();
+        }
+
+        writeAll(
+            file,
+            region,
+            dimensions,
+            headerLength,
+            mpiDatatype,
+            1,
+            buffer.empty() ? 0 : &buffer[0]);
+
+        MPI_File_close(&file);
+    }
+
+    /**
+     * Collectively writes the data of region (packed in the order of
+     * region's Streaks in buffer) to file, whose payload starts at
+     * headerLength and holds elementsPerCell items of elementType per
+     * cell, laid out as a grid of the given dimensions. All
+     * processes which opened the file need to call this function,
+     * even if their Regions are empty.
+     */
+    template<int DIM>
+    void writeAll(
+        MPI_File file,
+        const Region<DIM>& region,
+        const Coord<DIM>& dimensions,
+        MPI_Offset headerLength,
+        const MPI_Datatype& elementType,
+        int elementsPerCell,
+        const void *buffer)
+    {
+        // Streaks are stored packed in the file, i.e. without the
+        // holes the datatype may have, but are spaced by the extent
+        // of the datatype. That's how files have always been written
+        // and what readRegion() expects.
+        MPI_Aint elementLength = getLength(elementType);
+        int elementSize;
+        MPI_Type_size(elementType, &elementSize);
+        std::vector<FileSegment> segments;
+        segments.reserve(region.numStreaks());
+        MPI_Aint bufferOffset = 0;
+
         for (typename Region<DIM>::StreakIterator i = region.beginStreak();
              i != region.endStreak();
              ++i) {
@@ -118,19 +179,70 @@ public:
             // topologies the coordnates may exceed the bounding box
             // (especially negative coordnates may occurr).
             Coord<DIM> coord = TOPOLOGY::normalize(i->origin, dimensions);
-            MPI_File_seek(
-                file,
-                offset(headerLength, coord, dimensions, cellLength),
-                MPI_SEEK_SET);
+            int length = i->length() * elementsPerCell;
+            MPI_Aint fileOffset = MPI_Aint(coord.toIndex(dimensions)) * elementsPerCell * elementLength;
 
-            int length = i->endX - i->origin.x();
-            std::vector<CELL_TYPE> vec(length);
-            grid.get(*i, &vec[0]);
+            segments << FileSegment(fileOffset, bufferOffset, length);
+            bufferOffset += length * elementLength;
+        }
 
-            MPI_File_write(file, &vec[0], length, mpiDatatype, MPI_STATUS_IGNORE);
+        // file views require ascending offsets, which normalization
+        // may have broken:
+        std::stable_sort(segments.begin(), segments.end());
+        std::vector<int> lengths;
+        std::vector<int> byteLengths;
+        std::vector<MPI_Aint> fileOffsets;
+        std::vector<MPI_Aint> bufferOffsets;
+
+        for (typename std::vector<FileSegment>::iterator i = segments.begin(); i != segments.end(); ++i) {
+            // fuse segments which are contiguous in memory and in
+            // the file (e.g. adjacent rows of a box) to keep the
+            // datatypes compact:
+            if (!lengths.empty() &&
+                ((fileOffsets.back()   + byteLengths.back())             == i->fileOffset) &&
+                ((bufferOffsets.back() + lengths.back() * elementLength) == i->bufferOffset)) {
+                lengths.back() += i->length;
+                byteLengths.back() += i->length * elementSize;
+                continue;
+            }
+
+            lengths << i->length;
+            byteLengths << i->length * elementSize;
+            fileOffsets << i->fileOffset;
+            bufferOffsets << i->bufferOffset;
         }
 
-        MPI_File_close(&file);
+        MPI_Info info = createInfo();
+
+        if (lengths.empty()) {
+            MPI_File_set_view(file, headerLength, MPI_BYTE, MPI_BYTE, const_cast<char*>("native"), info);
+            MPI_File_write_all(file, const_cast<void*>(buffer), 0, elementType, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Datatype fileType;
+            MPI_Datatype memoryType;
+            MPI_Type_create_hindexed(lengths.size(), &byteLengths[0], &fileOffsets[0],   MPI_BYTE,    &fileType);
+            MPI_Type_create_hindexed(lengths.size(), &lengths[0],     &bufferOffsets[0], elementType, &memoryType);
+            MPI_Type_commit(&fileType);
+            MPI_Type_commit(&memoryType);
+
+            MPI_File_set_view(file, headerLength, MPI_BYTE, fileType, const_cast<char*>("native"), info);
+            MPI_File_write_all(file, const_cast<void*>(buffer), 1, memoryType, MPI_STATUS_IGNORE);
+
+            MPI_Type_free(&fileType);
+            MPI_Type_free(&memoryType);
+        }
+
+        freeInfo(&info);
+    }
+
+    /**
+     * Adds a hint which will be passed to MPI_File_open() and
+     * MPI_File_set_view(), e.g. setHint("cb_nodes", "8"). Unknown
+     * hints are ignored by MPI.
+     */
+    void setHint(const std::string& key, const std::string& value)
+    {
+        hints[key] = value;
     }
 
     MPI_File openFileForRead(
@@ -138,10 +250,12 @@ public:
         MPI_Comm comm)
     {
         MPI_File file;
+        MPI_Info info = createInfo();
         MPI_File_open(
             comm, const_cast<char*>(filename.c_str()),
-            MPI_MODE_RDONLY, MPI_INFO_NULL,
+            MPI_MODE_RDONLY, info,
             &file);
+        freeInfo(&info);
         MPI_File_set_errhandler(file, MPI_ERRORS_ARE_FATAL);
         return file;
     }
@@ -152,10 +266,12 @@ public:
         MPI_Comm comm)
     {
         MPI_File file;
+        MPI_Info info = createInfo();
         int res = MPI_File_open(
             comm, const_cast<char*>(filename.c_str()),
-            MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+            MPI_MODE_CREATE | MPI_MODE_WRONLY, info,
             &file);
+        freeInfo(&info);
 	if (res != 0) {
 	    char buf[MPI_MAX_ERROR_STRING];
 	    int length;
@@ -177,8 +293,54 @@ public:
     }
 
 private:
+    /**
+     * Location of a Streak's data in the file and in the send
+     * buffer, both in bytes.
+     */
+    class FileSegment
+    {
+    public:
+        FileSegment(MPI_Aint fileOffset, MPI_Aint bufferOffset, int length) :
+            fileOffset(fileOffset),
+            bufferOffset(bufferOffset),
+            length(length)
+        {}
+
+        bool operator<(const FileSegment& other) const
+        {
+            return fileOffset < other.fileOffset;
+        }
+
+        MPI_Aint fileOffset;
+        MPI_Aint bufferOffset;
+        int length;
+    };
+
     // fixme: use MPILayer for MPI-IO
     MPILayer mpiLayer;
+    std::map<std::string, std::string> hints;
+
+    MPI_Info createInfo() const
+    {
+        if (hints.empty()) {
+            return MPI_INFO_NULL;
+        }
+
+        MPI_Info info;
+        MPI_Info_create(&info);
+        for (std::map<std::string, std::string>::const_iterator i = hints.begin(); i != hints.end(); ++i) {
+            MPI_Info_set(info, const_cast<char*>(i->first.c_str()), const_cast<char*>(i->second.c_str()));
+        }
+
+        return info;
+    }
+
+    void freeInfo(MPI_Info *info) const
+    {
+        if (*info != MPI_INFO_NULL) {
+            MPI_Info_free(info);
+        }
+    }
 
     template<int DIM>
     MPI_Offset offset(
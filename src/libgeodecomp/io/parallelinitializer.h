@@ -0,0 +1,86 @@
+#ifndef LIBGEODECOMP_IO_PARALLELINITIALIZER_H
+#define LIBGEODECOMP_IO_PARALLELINITIALIZER_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/io/simpleinitializer.h>
+
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Base class for Initializers which can compute each cell
+ * independently of all others. Users only need to implement cell();
+ * grid() and initRegion() will then distribute the Streaks of the
+ * Region to be initialized among OpenMP threads.
+ *
+ * As cell() is called concurrently, it needs to be thread-safe. In
+ * particular it must not rely on the global random number generator
+ * (e.g. via seedRNG()).
+ */
+template<typename CELL>
+class ParallelInitializer : public SimpleInitializer<CELL>
+{
+public:
+    typedef typename SimpleInitializer<CELL>::Topology Topology;
+    const static int DIM = Topology::DIM;
+
+    explicit ParallelInitializer(
+        const Coord<DIM>& dimensions,
+        const unsigned steps = 300) :
+        SimpleInitializer<CELL>(dimensions, steps)
+    {}
+
+    /**
+     * Returns the initial state of the cell at the given coordinate.
+     */
+    virtual CELL cell(const Coord<DIM>& coord) const = 0;
+
+    virtual CELL edgeCell() const
+    {
+        return CELL();
+    }
+
+    virtual void grid(GridBase<CELL, DIM> *target)
+    {
+        initRegion(target, target->boundingRegion());
+    }
+
+    virtual void initRegion(GridBase<CELL, DIM> *target, const Region<DIM>& region)
+    {
+        target->setEdge(edgeCell());
+
+        std::vector<Streak<DIM> > streaks;
+        streaks.reserve(region.numStreaks());
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            streaks.push_back(*i);
+        }
+        int numStreaks = int(streaks.size());
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            std::vector<CELL> buffer;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(static)
+#endif
+            for (int i = 0; i < numStreaks; ++i) {
+                const Streak<DIM>& streak = streaks[i];
+                buffer.resize(std::size_t(streak.length()));
+
+                Coord<DIM> coord = streak.origin;
+                for (std::size_t j = 0; j < buffer.size(); ++j, ++coord.x()) {
+                    buffer[j] = cell(coord);
+                }
+
+                target->set(streak, &buffer[0]);
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -69,6 +69,11 @@ public:
         mpiLayer.waitAll();
     }
 
+    virtual bool isCollective() const
+    {
+        return true;
+    }
+
     void sendRecvGrid(int sender, int receiver, const GridType& grid, const Region<DIM>& validRegion, int step)
     {
         if (sender == mpiLayer.rank()) {
@@ -62,6 +62,11 @@ public:
             comm);
     }
 
+    virtual bool isCollective() const
+    {
+        return true;
+    }
+
 private:
     MPIIO<CELL_TYPE> mpiio;
     unsigned maxSteps;
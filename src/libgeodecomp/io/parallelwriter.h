@@ -98,6 +98,17 @@ public:
         std::size_t rank,
         bool lastCall) = 0;
 
+    /**
+     * Writers which communicate with their peers on other ranks
+     * within stepFinished() (e.g. via collective MPI IO) return
+     * true, so decorators know that they may not skip time steps
+     * independently on each rank.
+     */
+    virtual bool isCollective() const
+    {
+        return false;
+    }
+
     unsigned getPeriod() const
     {
         return period;
@@ -0,0 +1,600 @@
+#ifndef LIBGEODECOMP_IO_REDUCTIONWRITER_H
+#define LIBGEODECOMP_IO_REDUCTIONWRITER_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/io/writer.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/limits.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/storage/memorylocation.h>
+#include <libgeodecomp/storage/selector.h>
+
+#ifdef LIBGEODECOMP_WITH_MPI
+#include <mpi.h>
+#endif
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+class ReductionWriterTest;
+
+namespace ReductionWriterHelpers {
+
+/**
+ * The global results of all reductions registered with a
+ * ReductionWriter. Steerers (or any other code) may hold on to this
+ * object to read the latest values. In a distributed run the
+ * reduction of step t is started via non-blocking collectives when
+ * step t has been written and is completed lazily, i.e. upon the
+ * first query after that (typically by a Steerer at step t + 1) or
+ * when the reduction for the next output step starts. The
+ * reduction of the final step is completed right away, so no
+ * requests remain pending once the simulation is done.
+ */
+class Results
+{
+public:
+    friend class LibGeoDecomp::ReductionWriterTest;
+
+    enum Operation {SUM, MIN, MAX, CUSTOM};
+    typedef double (*Combiner)(double, double);
+
+    explicit Results(
+#ifdef LIBGEODECOMP_WITH_MPI
+        MPI_Comm communicator = MPI_COMM_WORLD
+#endif
+        ) :
+#ifdef LIBGEODECOMP_WITH_MPI
+        comm(communicator),
+        pending(false),
+        pendingStep(0),
+#endif
+        resultStep(0),
+        hasResult(false)
+    {}
+
+    ~Results()
+    {
+#ifdef LIBGEODECOMP_WITH_MPI
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized) {
+            complete();
+        }
+#endif
+    }
+
+    /**
+     * Returns the global value of the given reduction at step().
+     */
+    double operator[](const std::string& name)
+    {
+        std::map<std::string, std::size_t>::const_iterator i = indices.find(name);
+        if (i == indices.end()) {
+            throw std::invalid_argument("unknown reduction: " + name);
+        }
+
+        complete();
+        if (!hasResult) {
+            throw std::logic_error("no reduction results available yet");
+        }
+
+        return values[i->second];
+    }
+
+    /**
+     * Returns true once the first reduction has been started.
+     */
+    bool available() const
+    {
+        return hasResult
+#ifdef LIBGEODECOMP_WITH_MPI
+            || pending
+#endif
+            ;
+    }
+
+    /**
+     * The time step to which the current values belong.
+     */
+    unsigned step()
+    {
+        complete();
+        return resultStep;
+    }
+
+    std::size_t addReduction(const std::string& name, Operation operation, Combiner combiner)
+    {
+        if (indices.count(name)) {
+            throw std::invalid_argument("duplicate reduction: " + name);
+        }
+
+        std::size_t index = operations.size();
+        indices[name] = index;
+        operations.push_back(operation);
+        combiners.push_back(combiner);
+        values.push_back(0);
+
+        return index;
+    }
+
+    /**
+     * Combines the partial values of all ranks, unless global is
+     * false (e.g. when called from a serial Writer).
+     */
+    void start(unsigned step, const std::vector<double>& partials, bool global)
+    {
+        complete();
+
+#ifdef LIBGEODECOMP_WITH_MPI
+        int initialized;
+        MPI_Initialized(&initialized);
+        if (global && initialized) {
+            startMPI(step, partials);
+            return;
+        }
+#endif
+
+        values = partials;
+        resultStep = step;
+        hasResult = true;
+    }
+
+    /**
+     * Waits for pending non-blocking reductions.
+     */
+    void complete()
+    {
+#ifdef LIBGEODECOMP_WITH_MPI
+        if (!pending) {
+            return;
+        }
+
+        MPI_Waitall(static_cast<int>(requests.size()), &requests[0], MPI_STATUSES_IGNORE);
+        pending = false;
+
+        for (int op = SUM; op <= MAX; ++op) {
+            unpack(static_cast<Operation>(op), recvBuffers[op]);
+        }
+
+        // custom combiners need to be applied here as MPI can't
+        // capture them in an MPI_Op:
+        std::size_t numCustom = sendBuffers[CUSTOM].size();
+        for (std::size_t i = 0, c = 0; i < operations.size(); ++i) {
+            if (operations[i] != CUSTOM) {
+                continue;
+            }
+
+            double value = recvBuffers[CUSTOM][c];
+            for (std::size_t rank = 1; rank < (recvBuffers[CUSTOM].size() / numCustom); ++rank) {
+                value = combiners[i](value, recvBuffers[CUSTOM][rank * numCustom + c]);
+            }
+            values[i] = value;
+            ++c;
+        }
+
+        resultStep = pendingStep;
+        hasResult = true;
+#endif
+    }
+
+private:
+#ifdef LIBGEODECOMP_WITH_MPI
+    MPI_Comm comm;
+    bool pending;
+    unsigned pendingStep;
+    std::vector<MPI_Request> requests;
+    std::vector<double> sendBuffers[CUSTOM + 1];
+    std::vector<double> recvBuffers[CUSTOM + 1];
+#endif
+    std::map<std::string, std::size_t> indices;
+    std::vector<Operation> operations;
+    std::vector<Combiner> combiners;
+    std::vector<double> values;
+    unsigned resultStep;
+    bool hasResult;
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    /**
+     * Issues at most one collective per operation type, regardless
+     * of the number of reductions.
+     */
+    void startMPI(unsigned step, const std::vector<double>& partials)
+    {
+        requests.clear();
+        pendingStep = step;
+
+        for (int op = SUM; op <= CUSTOM; ++op) {
+            sendBuffers[op].clear();
+        }
+        for (std::size_t i = 0; i < operations.size(); ++i) {
+            sendBuffers[operations[i]].push_back(partials[i]);
+        }
+
+        MPI_Op mpiOps[] = {MPI_SUM, MPI_MIN, MPI_MAX};
+        for (int op = SUM; op <= MAX; ++op) {
+            std::vector<double>& sendBuffer = sendBuffers[op];
+            if (sendBuffer.empty()) {
+                continue;
+            }
+
+            recvBuffers[op].resize(sendBuffer.size());
+            requests.push_back(MPI_Request());
+#if MPI_VERSION >= 3
+            MPI_Iallreduce(
+                &sendBuffer[0], &recvBuffers[op][0], static_cast<int>(sendBuffer.size()),
+                MPI_DOUBLE, mpiOps[op], comm, &requests.back());
+#else
+            MPI_Allreduce(
+                &sendBuffer[0], &recvBuffers[op][0], static_cast<int>(sendBuffer.size()),
+                MPI_DOUBLE, mpiOps[op], comm);
+            requests.back() = MPI_REQUEST_NULL;
+#endif
+        }
+
+        std::vector<double>& sendBuffer = sendBuffers[CUSTOM];
+        if (!sendBuffer.empty()) {
+            int size;
+            MPI_Comm_size(comm, &size);
+            recvBuffers[CUSTOM].resize(sendBuffer.size() * size);
+            requests.push_back(MPI_Request());
+#if MPI_VERSION >= 3
+            MPI_Iallgather(
+                &sendBuffer[0], static_cast<int>(sendBuffer.size()), MPI_DOUBLE,
+                &recvBuffers[CUSTOM][0], static_cast<int>(sendBuffer.size()), MPI_DOUBLE,
+                comm, &requests.back());
+#else
+            MPI_Allgather(
+                &sendBuffer[0], static_cast<int>(sendBuffer.size()), MPI_DOUBLE,
+                &recvBuffers[CUSTOM][0], static_cast<int>(sendBuffer.size()), MPI_DOUBLE,
+                comm);
+            requests.back() = MPI_REQUEST_NULL;
+#endif
+        }
+
+        pending = !requests.empty();
+        if (!pending) {
+            resultStep = step;
+            hasResult = true;
+        }
+    }
+
+    void unpack(Operation op, const std::vector<double>& buffer)
+    {
+        for (std::size_t i = 0, c = 0; i < operations.size(); ++i) {
+            if (operations[i] == op) {
+                values[i] = buffer[c++];
+            }
+        }
+    }
+#endif
+};
+
+/**
+ * Folds one member of all cells within a region into a partial
+ * result.
+ */
+template<typename CELL>
+class Reduction
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL>::Value Topology;
+    typedef GridBase<CELL, Topology::DIM> GridType;
+    typedef Results::Combiner Combiner;
+
+    Reduction(Combiner combiner, double identity) :
+        combiner(combiner),
+        identity(identity)
+    {}
+
+    virtual ~Reduction()
+    {}
+
+    virtual double operator()(const GridType& grid, const Region<Topology::DIM>& region, double partial) = 0;
+
+    double getIdentity() const
+    {
+        return identity;
+    }
+
+protected:
+    Combiner combiner;
+    double identity;
+};
+
+/**
+ * Folds the member of all cells in a region. The region is split into
+ * chunks of about CHUNK_SIZE cells, each of which is extracted via a
+ * Selector (which works for AoS and SoA grids alike) into a small,
+ * thread-private buffer and folded right away, while the buffer is
+ * still in cache. Hence the grid is traversed only once. Chunks are
+ * distributed among threads, but their partials are combined in a
+ * fixed order, so results don't depend on the number of threads.
+ */
+template<typename CELL, typename MEMBER>
+class MemberReduction : public Reduction<CELL>
+{
+public:
+    typedef typename Reduction<CELL>::Topology Topology;
+    typedef typename Reduction<CELL>::GridType GridType;
+    typedef typename Reduction<CELL>::Combiner Combiner;
+    typedef typename Region<Topology::DIM>::StreakIterator StreakIterator;
+
+    using Reduction<CELL>::combiner;
+    using Reduction<CELL>::identity;
+
+    MemberReduction(
+        MEMBER CELL:: *member,
+        const std::string& name,
+        Combiner combiner,
+        double identity) :
+        Reduction<CELL>(combiner, identity),
+        selector(member, name)
+    {}
+
+    double operator()(const GridType& grid, const Region<Topology::DIM>& region, double partial)
+    {
+        if (region.empty()) {
+            return partial;
+        }
+
+        // chunks consist of whole streaks, so a chunk may exceed
+        // CHUNK_SIZE by the length of its last streak:
+        std::vector<StreakIterator> chunkBegins(1, region.beginStreak());
+        std::vector<long> chunkSizes;
+        long chunkSize = 0;
+        for (StreakIterator i = region.beginStreak(); i != region.endStreak();) {
+            chunkSize += i->length();
+            ++i;
+
+            if ((chunkSize >= CHUNK_SIZE) || (i == region.endStreak())) {
+                chunkBegins.push_back(i);
+                chunkSizes.push_back(chunkSize);
+                chunkSize = 0;
+            }
+        }
+
+        long numChunks = static_cast<long>(chunkSizes.size());
+        std::vector<double> chunkPartials(numChunks, identity);
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel if (numChunks > 1)
+#endif
+        {
+            std::vector<MEMBER> buffer;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(static)
+#endif
+            for (long c = 0; c < numChunks; ++c) {
+                buffer.resize(chunkSizes[c]);
+                grid.saveMember(&buffer[0], MemoryLocation::HOST, selector, chunkBegins[c], chunkBegins[c + 1]);
+
+                double chunkPartial = identity;
+                for (long i = 0; i < chunkSizes[c]; ++i) {
+                    chunkPartial = combiner(chunkPartial, static_cast<double>(buffer[i]));
+                }
+                chunkPartials[c] = chunkPartial;
+            }
+        }
+
+        for (long c = 0; c < numChunks; ++c) {
+            partial = combiner(partial, chunkPartials[c]);
+        }
+
+        return partial;
+    }
+
+private:
+    static const long CHUNK_SIZE = 1 << 12;
+
+    Selector<CELL> selector;
+};
+
+}
+
+/**
+ * Computes global reductions (sum, minimum, maximum or any
+ * associative user-defined operation) of cell members at every
+ * period-th time step. Unlike a Writer which collects the whole grid
+ * (e.g. via CollectingWriter), each rank only reduces its own part of
+ * the grid and then exchanges a single double per reduction via
+ * non-blocking collectives (all reductions share at most four
+ * messages). Results are available from results() -- e.g. for a
+ * Steerer implementing a convergence check -- one output step later:
+ *
+ *   ReductionWriter<Cell> *reductions = new ReductionWriter<Cell>(10);
+ *   reductions->addReduction("maxTemp", &Cell::temperature, ReductionWriter<Cell>::MAX);
+ *   ReductionWriter<Cell>::ResultsPtr results = reductions->results();
+ *   sim.addWriter(reductions);
+ *   sim.addSteerer(new ConvergenceChecker(10, results));
+ *
+ * Can be used with MonolithicSimulators (as a Writer, no
+ * communication) and DistributedSimulators (as a ParallelWriter).
+ */
+template<typename CELL_TYPE>
+class ReductionWriter :
+        public Clonable<Writer<CELL_TYPE>, ReductionWriter<CELL_TYPE> >,
+        public Clonable<ParallelWriter<CELL_TYPE>, ReductionWriter<CELL_TYPE> >
+{
+public:
+    typedef ReductionWriterHelpers::Results Results;
+    typedef typename SharedPtr<Results>::Type ResultsPtr;
+    typedef typename Writer<CELL_TYPE>::GridType WriterGridType;
+    typedef typename ParallelWriter<CELL_TYPE>::GridType ParallelWriterGridType;
+    typedef typename ParallelWriter<CELL_TYPE>::Topology Topology;
+    typedef ReductionWriterHelpers::Reduction<CELL_TYPE> ReductionType;
+    typedef typename SharedPtr<ReductionType>::Type ReductionPtr;
+    typedef Results::Combiner Combiner;
+
+    static const int DIM = Topology::DIM;
+    static const Results::Operation SUM = Results::SUM;
+    static const Results::Operation MIN = Results::MIN;
+    static const Results::Operation MAX = Results::MAX;
+
+    explicit ReductionWriter(
+        const unsigned period = 1
+#ifdef LIBGEODECOMP_WITH_MPI
+        , const MPI_Comm& communicator = MPI_COMM_WORLD
+#endif
+                             ) :
+        Clonable<Writer<CELL_TYPE>, ReductionWriter<CELL_TYPE> >("", period),
+        Clonable<ParallelWriter<CELL_TYPE>, ReductionWriter<CELL_TYPE> >("", period),
+        resultsPtr(new Results(
+#ifdef LIBGEODECOMP_WITH_MPI
+                       communicator
+#endif
+                       ))
+    {}
+
+    /**
+     * Reduces the given member with one of the built-in operations.
+     */
+    template<typename MEMBER>
+    void addReduction(const std::string& name, MEMBER CELL_TYPE:: *member, Results::Operation operation)
+    {
+        switch (operation) {
+        case SUM:
+            addReduction(name, member, operation, sum, 0);
+            break;
+        case MIN:
+            addReduction(name, member, operation, min, Limits<double>::getMax());
+            break;
+        case MAX:
+            addReduction(name, member, operation, max, -Limits<double>::getMax());
+            break;
+        default:
+            throw std::invalid_argument("use addReduction() with a combiner for custom reductions");
+        }
+    }
+
+    /**
+     * Reduces the given member with a user-defined combiner. The
+     * combiner needs to be associative and commutative, identity
+     * must be its neutral element.
+     */
+    template<typename MEMBER>
+    void addReduction(const std::string& name, MEMBER CELL_TYPE:: *member, Combiner combiner, double identity)
+    {
+        addReduction(name, member, Results::CUSTOM, combiner, identity);
+    }
+
+    ResultsPtr results() const
+    {
+        return resultsPtr;
+    }
+
+    virtual void stepFinished(const WriterGridType& grid, unsigned step, WriterEvent event)
+    {
+        if ((event == WRITER_STEP_FINISHED) && ((step % Writer<CELL_TYPE>::period) != 0)) {
+            return;
+        }
+
+        Region<DIM> region;
+        region << grid.boundingBox();
+        accumulate(grid, region, step);
+        finish(step, event, false);
+    }
+
+    virtual void stepFinished(
+        const ParallelWriterGridType& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& /* globalDimensions */,
+        unsigned step,
+        WriterEvent event,
+        std::size_t /* rank */,
+        bool lastCall)
+    {
+        if ((event == WRITER_STEP_FINISHED) && ((step % ParallelWriter<CELL_TYPE>::period) != 0)) {
+            return;
+        }
+
+        accumulate(grid, validRegion, step);
+        if (lastCall) {
+            finish(step, event, true);
+        }
+    }
+
+    virtual bool isCollective() const
+    {
+        return true;
+    }
+
+private:
+    /**
+     * Partial results are kept per time step: the HiParSimulator
+     * notifies us of the ghost zones of multiple time steps before
+     * the inner set of the first of these steps is reported.
+     */
+    typedef std::map<unsigned, std::vector<double> > PartialsMap;
+
+    ResultsPtr resultsPtr;
+    std::vector<ReductionPtr> reductions;
+    PartialsMap partials;
+
+    template<typename MEMBER>
+    void addReduction(
+        const std::string& name,
+        MEMBER CELL_TYPE:: *member,
+        Results::Operation operation,
+        Combiner combiner,
+        double identity)
+    {
+        resultsPtr->addReduction(name, operation, combiner);
+        reductions.push_back(ReductionPtr(
+                                 new ReductionWriterHelpers::MemberReduction<CELL_TYPE, MEMBER>(
+                                     member, name, combiner, identity)));
+    }
+
+    template<typename GRID_TYPE>
+    void accumulate(const GRID_TYPE& grid, const Region<DIM>& region, unsigned step)
+    {
+        typename PartialsMap::iterator stepPartials = partials.find(step);
+        if (stepPartials == partials.end()) {
+            stepPartials = partials.insert(std::make_pair(step, std::vector<double>(reductions.size()))).first;
+            for (std::size_t i = 0; i < reductions.size(); ++i) {
+                stepPartials->second[i] = reductions[i]->getIdentity();
+            }
+        }
+
+        for (std::size_t i = 0; i < reductions.size(); ++i) {
+            stepPartials->second[i] = (*reductions[i])(grid, region, stepPartials->second[i]);
+        }
+    }
+
+    void finish(unsigned step, WriterEvent event, bool global)
+    {
+        typename PartialsMap::iterator stepPartials = partials.find(step);
+        resultsPtr->start(step, stepPartials->second, global);
+        partials.erase(stepPartials);
+
+        // nobody might query the results before MPI gets finalized:
+        if (event == WRITER_ALL_DONE) {
+            resultsPtr->complete();
+        }
+    }
+
+    static double sum(double a, double b)
+    {
+        return a + b;
+    }
+
+    static double min(double a, double b)
+    {
+        return a < b ? a : b;
+    }
+
+    static double max(double a, double b)
+    {
+        return a > b ? a : b;
+    }
+};
+
+}
+
+#endif
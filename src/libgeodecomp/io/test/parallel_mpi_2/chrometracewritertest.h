@@ -0,0 +1,108 @@
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/io/chrometracewriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/hiparsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ChromeTraceWriterTest : public CxxTest::TestSuite
+{
+public:
+    void testHiParSimulator()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef HiParSimulator<TestCell<2>, ZCurvePartition<2> > SimulatorType;
+        MPILayer mpiLayer;
+        std::string prefix = TempFile::parallel("chrometrace");
+
+        SimulatorType sim(new TestInitializer<TestCell<2> >(Coord<2>(20, 25), 10));
+        sim.addWriter(new ChromeTraceWriter<TestCell<2> >(prefix, 4));
+        sim.run();
+        mpiLayer.barrier();
+
+        if (mpiLayer.rank() == 0) {
+            std::string trace0 = readFile(traceFilename(prefix, 0));
+            std::string trace1 = readFile(traceFilename(prefix, 1));
+            TS_ASSERT_EQUALS("}}\n]\n", trace0.substr(trace0.size() - 5));
+            TS_ASSERT_EQUALS("}}\n]\n", trace1.substr(trace1.size() - 5));
+            TS_ASSERT_EQUALS(0, countSubstrings(trace0, "\"pid\":1,"));
+            TS_ASSERT_EQUALS(0, countSubstrings(trace1, "\"pid\":0,"));
+
+            // the histogram aggregates the events of both ranks:
+            std::string histogram = readFile(prefix + ".histogram");
+            for (std::size_t i = 0; i < Chronometer::NUM_INTERVALS; ++i) {
+                std::string name = ChronometerHelpers::EventToString()(i);
+                std::string pattern = "\"name\":\"" + name + "\"";
+                int expected = countSubstrings(trace0, pattern) + countSubstrings(trace1, pattern);
+                TS_ASSERT_EQUALS(expected, sumCounts(histogram, name));
+            }
+            TS_ASSERT_LESS_THAN(0, sumCounts(histogram, "compute_time_inner"));
+            TS_ASSERT_LESS_THAN(0, sumCounts(histogram, "patch_providers_time"));
+
+            remove(traceFilename(prefix, 0).c_str());
+            remove(traceFilename(prefix, 1).c_str());
+            remove((prefix + ".histogram").c_str());
+        }
+#endif
+    }
+
+private:
+    std::string traceFilename(const std::string& prefix, int rank)
+    {
+        std::stringstream buf;
+        buf << prefix << ".0000" << rank << ".json";
+        return buf.str();
+    }
+
+    std::string readFile(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str());
+        std::stringstream buf;
+        buf << file.rdbuf();
+        return buf.str();
+    }
+
+    int countSubstrings(const std::string& haystack, const std::string& needle)
+    {
+        int ret = 0;
+        for (std::size_t pos = haystack.find(needle);
+             pos != std::string::npos;
+             pos = haystack.find(needle, pos + 1)) {
+            ++ret;
+        }
+
+        return ret;
+    }
+
+    int sumCounts(const std::string& histogram, const std::string& event)
+    {
+        int ret = 0;
+        std::stringstream buf(histogram);
+        std::string name;
+        double limit;
+        int count;
+        std::string line;
+
+        while (std::getline(buf, line)) {
+            std::stringstream lineBuf(line);
+            if ((lineBuf >> name >> limit >> count) && (name == event)) {
+                ret += count;
+            }
+        }
+
+        return ret;
+    }
+};
+
+}
@@ -57,6 +57,37 @@ public:
         }
     }
 
+    void testSerialMode()
+    {
+        TestInitializer<TestCell<3> > *init = new TestInitializer<TestCell<3> >();
+
+        LoadBalancer *balancer = MPILayer().rank()? 0 : new RandomBalancer;
+        StripingSimulator<TestCell<3> > sim(init, balancer);
+
+        MemoryWriter<TestCell<3> > *writer = 0;
+        if (MPILayer().rank() == 0) {
+            writer = new MemoryWriter<TestCell<3> >(3);
+        }
+
+        sim.addWriter(new CollectingWriter<TestCell<3> >(
+                          writer,
+                          0,
+                          MPI_COMM_WORLD,
+                          SerializationBuffer<TestCell<3> >::cellMPIDataType(),
+                          CollectingWriter<TestCell<3> >::SERIAL));
+        sim.run();
+
+        if (MPILayer().rank() == 0) {
+            int size = writer->getGrids().size();
+            TS_ASSERT(size > 0);
+
+            for (int i = 0; i < (size - 1); ++i) {
+                unsigned cycle = APITraits::SelectNanoSteps<TestCell<3> >::VALUE * i * 3;
+                TS_ASSERT_TEST_GRID(MemoryWriter<TestCell<3> >::GridType, writer->getGrids()[i], cycle);
+            }
+        }
+    }
+
     void testSoA()
     {
         TestInitializer<TestCellSoA> *init = new TestInitializer<TestCellSoA>();
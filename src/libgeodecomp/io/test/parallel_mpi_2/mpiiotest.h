@@ -79,6 +79,62 @@ public:
             }
         }
     }
+
+    void testCollectiveWriteOfInterleavedRegions()
+    {
+        typedef Topologies::Torus<3>::Topology Topology;
+        MPIIO<double, Topology> mpiio;
+        mpiio.setHint("cb_nodes", "1");
+        mpiio.setHint("romio_cb_write", "enable");
+
+        Coord<3> dim(6, 4, 5);
+        int rank = MPILayer().rank();
+        std::string filename = TempFile::parallel("mpiio_interleaved");
+
+        Grid<double, Topology> grid1(dim, -2);
+        for (CoordBox<3>::Iterator i = grid1.boundingBox().begin(); i != grid1.boundingBox().end(); ++i) {
+            grid1[*i] = i->z() * 100 + i->y() * 10 + i->x();
+        }
+
+        // each rank takes every other row, the last plane is
+        // addressed via negative coordinates to check that
+        // normalization keeps the file view ordered:
+        Region<3> region;
+        for (int z = 0; z < dim.z(); ++z) {
+            for (int y = 0; y < dim.y(); ++y) {
+                if (((y + z) % 2) != rank) {
+                    continue;
+                }
+
+                int actualZ = (z == (dim.z() - 1)) ? -1 : z;
+                region << Streak<3>(Coord<3>(0, y, actualZ), 2)
+                       << Streak<3>(Coord<3>(3, y, actualZ), dim.x());
+            }
+
+            // the gaps are filled by the other rank:
+            if (rank == (z % 2)) {
+                for (int y = 0; y < dim.y(); ++y) {
+                    region << Coord<3>(2, y, z);
+                }
+            }
+        }
+        mpiio.writeRegion(grid1, dim, 7, 8, filename, region);
+
+        Grid<double, Topology> grid2(dim, -1);
+        region.clear();
+        region << grid2.boundingBox();
+        mpiio.readRegion(&grid2, filename, region);
+
+        // every cell has been written by exactly one rank:
+        for (CoordBox<3>::Iterator i = grid2.boundingBox().begin(); i != grid2.boundingBox().end(); ++i) {
+            TS_ASSERT_EQUALS(i->z() * 100 + i->y() * 10 + i->x(), grid2[*i]);
+        }
+
+        MPILayer().barrier();
+        if (rank == 0) {
+            unlink(filename.c_str());
+        }
+    }
 };
 
 }
@@ -0,0 +1,134 @@
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/io/reductionwriter.h>
+#include <libgeodecomp/io/steerer.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/hiparsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Checks on each rank that the global results it reads are consistent.
+ */
+class ReductionChecker : public Steerer<TestCell<2> >
+{
+public:
+    typedef ReductionWriter<TestCell<2> >::ResultsPtr ResultsPtr;
+
+    ReductionChecker(ResultsPtr results, std::vector<unsigned> *resultSteps) :
+        Steerer<TestCell<2> >(1),
+        results(results),
+        resultSteps(resultSteps)
+    {}
+
+    virtual void nextStep(
+        GridType *grid,
+        const Region<Topology::DIM>& validRegion,
+        const CoordType& globalDimensions,
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        bool lastCall,
+        SteererFeedback *feedback)
+    {
+        if (!lastCall || !results->available()) {
+            return;
+        }
+
+        unsigned resultStep = results->step();
+        TS_ASSERT(resultStep <= step);
+        TS_ASSERT_EQUALS(500 * 501 / 2, (*results)["sum"]);
+        TS_ASSERT_EQUALS(1,   (*results)["min"]);
+        TS_ASSERT_EQUALS(500, (*results)["max"]);
+        TS_ASSERT_EQUALS(resultStep * 27, (*results)["minCycle"]);
+        TS_ASSERT_EQUALS(resultStep * 27, (*results)["maxCycle"]);
+        resultSteps->push_back(resultStep);
+    }
+
+private:
+    ResultsPtr results;
+    std::vector<unsigned> *resultSteps;
+};
+
+class ReductionWriterTest : public CxxTest::TestSuite
+{
+public:
+    static double maxCombiner(double a, double b)
+    {
+        return a > b ? a : b;
+    }
+
+    void testHiParSimulator()
+    {
+        typedef HiParSimulator<TestCell<2>, ZCurvePartition<2> > SimulatorType;
+        MPILayer mpiLayer;
+        int maxSteps = 10;
+        std::vector<unsigned> resultSteps;
+
+        SimulatorType sim(new TestInitializer<TestCell<2> >(Coord<2>(20, 25), maxSteps));
+        ReductionWriter<TestCell<2> > *writer = new ReductionWriter<TestCell<2> >(2);
+        writer->addReduction("sum",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::SUM);
+        writer->addReduction("min",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::MIN);
+        writer->addReduction("max",      &TestCell<2>::testValue,    maxCombiner, -1);
+        writer->addReduction("minCycle", &TestCell<2>::cycleCounter, ReductionWriter<TestCell<2> >::MIN);
+        writer->addReduction("maxCycle", &TestCell<2>::cycleCounter, ReductionWriter<TestCell<2> >::MAX);
+        ReductionWriter<TestCell<2> >::ResultsPtr results = writer->results();
+
+        sim.addWriter(writer);
+        sim.addSteerer(new ReductionChecker(results, &resultSteps));
+        sim.run();
+
+        // the final reduction must not be left pending until the
+        // next query:
+        TS_ASSERT(!results->pending);
+
+        TS_ASSERT_EQUALS(unsigned(maxSteps), results->step());
+        TS_ASSERT_EQUALS(500 * 501 / 2, (*results)["sum"]);
+        TS_ASSERT_EQUALS(maxSteps * 27, (*results)["maxCycle"]);
+
+        TS_ASSERT_LESS_THAN(0, resultSteps.size());
+        for (std::size_t i = 0; i < resultSteps.size(); ++i) {
+            TS_ASSERT_EQUALS(0, resultSteps[i] % 2);
+        }
+    }
+
+    void testHiParSimulatorWithWideGhostZones()
+    {
+        // the ghost zones of steps t + 1 to t + 3 are reported before
+        // the inner set of step t + 1. These must not be mixed up:
+        typedef HiParSimulator<TestCell<2>, ZCurvePartition<2> > SimulatorType;
+        int maxSteps = 10;
+        unsigned ghostZoneWidth = 3;
+        std::vector<unsigned> resultSteps;
+
+        SimulatorType sim(
+            new TestInitializer<TestCell<2> >(Coord<2>(20, 25), maxSteps),
+            0,
+            1000,
+            ghostZoneWidth);
+        ReductionWriter<TestCell<2> > *writer = new ReductionWriter<TestCell<2> >(1);
+        writer->addReduction("sum",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::SUM);
+        writer->addReduction("min",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::MIN);
+        writer->addReduction("max",      &TestCell<2>::testValue,    maxCombiner, -1);
+        writer->addReduction("minCycle", &TestCell<2>::cycleCounter, ReductionWriter<TestCell<2> >::MIN);
+        writer->addReduction("maxCycle", &TestCell<2>::cycleCounter, ReductionWriter<TestCell<2> >::MAX);
+        ReductionWriter<TestCell<2> >::ResultsPtr results = writer->results();
+
+        sim.addWriter(writer);
+        sim.addSteerer(new ReductionChecker(results, &resultSteps));
+        sim.run();
+
+        TS_ASSERT_EQUALS(unsigned(maxSteps), results->step());
+        TS_ASSERT_EQUALS(500 * 501 / 2, (*results)["sum"]);
+        TS_ASSERT_EQUALS(maxSteps * 27, (*results)["minCycle"]);
+        TS_ASSERT_EQUALS(maxSteps * 27, (*results)["maxCycle"]);
+        TS_ASSERT_LESS_THAN(std::size_t(0), resultSteps.size());
+    }
+};
+
+}
@@ -0,0 +1,258 @@
+#include <libgeodecomp/io/asyncwriter.h>
+#include <libgeodecomp/io/mockwriter.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+
+#include <cxxtest/TestSuite.h>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <condition_variable>
+#include <mutex>
+#endif
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+
+/**
+ * Records the steps and cell values it's being handed. Optionally
+ * stalls in stepFinished() until released so that tests can fill the
+ * AsyncWriter's queue deterministically.
+ */
+class GatedWriter : public Clonable<ParallelWriter<TestCell<2> >, GatedWriter>
+{
+public:
+    typedef ParallelWriter<TestCell<2> >::GridType GridType;
+
+    class State
+    {
+    public:
+        State() :
+            closed(false),
+            calls(0)
+        {}
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool closed;
+        int calls;
+        std::vector<unsigned> steps;
+        std::vector<double> values;
+    };
+
+    explicit GatedWriter(SharedPtr<State>::Type state, bool collective = false) :
+        Clonable<ParallelWriter<TestCell<2> >, GatedWriter>("", 1),
+        state(state),
+        collective(collective)
+    {}
+
+    void stepFinished(
+        const GridType& grid,
+        const Region<2>& validRegion,
+        const Coord<2>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        ++state->calls;
+        state->changed.notify_all();
+        state->changed.wait(lock, [this]{ return !state->closed; });
+
+        state->steps.push_back(step);
+        for (Region<2>::Iterator i = validRegion.begin(); i != validRegion.end(); ++i) {
+            state->values.push_back(grid.get(*i).testValue);
+        }
+    }
+
+    bool isCollective() const
+    {
+        return collective;
+    }
+
+private:
+    SharedPtr<State>::Type state;
+    bool collective;
+};
+
+#endif
+
+class AsyncWriterTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        grid = DisplacedGrid<TestCell<2> >(CoordBox<2>(Coord<2>(10, 20), Coord<2>(5, 4)));
+        for (int y = 20; y < 24; ++y) {
+            for (int x = 10; x < 15; ++x) {
+                grid.set(Coord<2>(x, y), TestCell<2>(Coord<2>(x, y), Coord<2>(5, 4), 0, 100 * y + x));
+            }
+        }
+
+        left  << CoordBox<2>(Coord<2>(10, 20), Coord<2>(2, 4));
+        right << CoordBox<2>(Coord<2>(12, 20), Coord<2>(3, 4));
+#endif
+    }
+
+    void testEventsArePassedOnInOrder()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        SharedPtr<MockWriter<>::EventsStore>::Type events(new MockWriter<>::EventsStore);
+        AsyncWriter<TestCell<2> > writer(new MockWriter<>(events, 2), 1);
+        TS_ASSERT_EQUALS(2, writer.getPeriod());
+
+        writer.stepFinished(grid, left,  Coord<2>(30, 30), 0, WRITER_INITIALIZED,   0, true);
+        writer.stepFinished(grid, left,  Coord<2>(30, 30), 1, WRITER_STEP_FINISHED, 0, true);
+        writer.stepFinished(grid, left,  Coord<2>(30, 30), 2, WRITER_STEP_FINISHED, 0, false);
+        writer.stepFinished(grid, right, Coord<2>(30, 30), 2, WRITER_STEP_FINISHED, 0, true);
+        writer.stepFinished(grid, left,  Coord<2>(30, 30), 4, WRITER_STEP_FINISHED, 0, true);
+        writer.stepFinished(grid, left,  Coord<2>(30, 30), 5, WRITER_ALL_DONE,      0, true);
+
+        MockWriter<>::EventsStore expected;
+        typedef MockWriter<>::Event Event;
+        expected << Event(0, WRITER_INITIALIZED,   0, true)
+                 << Event(2, WRITER_STEP_FINISHED, 0, false)
+                 << Event(2, WRITER_STEP_FINISHED, 0, true)
+                 << Event(4, WRITER_STEP_FINISHED, 0, true)
+                 << Event(5, WRITER_ALL_DONE,      0, true);
+        TS_ASSERT_EQUALS(expected, *events);
+#endif
+    }
+
+    void testOutputIsSnapshot()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        SharedPtr<GatedWriter::State>::Type state(new GatedWriter::State);
+        state->closed = true;
+        AsyncWriter<TestCell<2> > writer(new GatedWriter(state));
+
+        writer.stepFinished(grid, left, Coord<2>(30, 30), 0, WRITER_STEP_FINISHED, 0, true);
+        for (Region<2>::Iterator i = left.begin(); i != left.end(); ++i) {
+            grid[*i].testValue = -1;
+        }
+
+        open(state);
+        writer.flush();
+
+        TS_ASSERT_EQUALS(std::size_t(8), state->values.size());
+        std::size_t index = 0;
+        for (Region<2>::Iterator i = left.begin(); i != left.end(); ++i) {
+            TS_ASSERT_EQUALS(100 * i->y() + i->x(), state->values[index++]);
+        }
+#endif
+    }
+
+    void testBlock()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::vector<unsigned> expected;
+        expected << 0 << 1 << 2;
+        TS_ASSERT_EQUALS(expected, overflowQueue(AsyncWriter<TestCell<2> >::BLOCK));
+#endif
+    }
+
+    void testDrop()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::vector<unsigned> expected;
+        expected << 0 << 1;
+        TS_ASSERT_EQUALS(expected, overflowQueue(AsyncWriter<TestCell<2> >::DROP));
+#endif
+    }
+
+    void testCoalesce()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::vector<unsigned> expected;
+        expected << 0 << 2;
+        TS_ASSERT_EQUALS(expected, overflowQueue(AsyncWriter<TestCell<2> >::COALESCE));
+#endif
+    }
+
+    void testCollectiveDelegatesMayNotSkipSteps()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef AsyncWriter<TestCell<2> > WriterType;
+        SharedPtr<GatedWriter::State>::Type state(new GatedWriter::State);
+
+        TS_ASSERT_THROWS(WriterType(new GatedWriter(state, true), 1, WriterType::DROP), std::invalid_argument&);
+        TS_ASSERT_THROWS(WriterType(new GatedWriter(state, true), 1, WriterType::COALESCE), std::invalid_argument&);
+
+        WriterType writer(new GatedWriter(state, true), 1, WriterType::BLOCK);
+        TS_ASSERT(writer.isCollective());
+        TS_ASSERT(!WriterType(new GatedWriter(state), 1, WriterType::DROP).isCollective());
+#endif
+    }
+
+    void testClone()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        SharedPtr<GatedWriter::State>::Type state(new GatedWriter::State);
+        AsyncWriter<TestCell<2> > writer(new GatedWriter(state), 1);
+        SharedPtr<ParallelWriter<TestCell<2> > >::Type clone(writer.clone());
+
+        writer.stepFinished(grid, left, Coord<2>(30, 30), 0, WRITER_STEP_FINISHED, 0, true);
+        clone->stepFinished(grid, left, Coord<2>(30, 30), 1, WRITER_STEP_FINISHED, 0, true);
+        writer.flush();
+        dynamic_cast<AsyncWriter<TestCell<2> >&>(*clone).flush();
+
+        // both share the delegate's state, but run their own threads:
+        std::vector<unsigned> steps = state->steps;
+        sort(steps);
+        std::vector<unsigned> expected;
+        expected << 0 << 1;
+        TS_ASSERT_EQUALS(expected, steps);
+#endif
+    }
+
+private:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    DisplacedGrid<TestCell<2> > grid;
+    Region<2> left;
+    Region<2> right;
+
+    void open(SharedPtr<GatedWriter::State>::Type state)
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->closed = false;
+        state->changed.notify_all();
+    }
+
+    /**
+     * Stalls the writer thread on step 0, fills the queue with step 1
+     * and then attempts to add step 2.
+     */
+    std::vector<unsigned> overflowQueue(AsyncWriter<TestCell<2> >::Policy policy)
+    {
+        SharedPtr<GatedWriter::State>::Type state(new GatedWriter::State);
+        state->closed = true;
+        AsyncWriter<TestCell<2> > writer(new GatedWriter(state), 1, policy);
+
+        writer.stepFinished(grid, left, Coord<2>(30, 30), 0, WRITER_STEP_FINISHED, 0, true);
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->changed.wait(lock, [state]{ return state->calls > 0; });
+        }
+        writer.stepFinished(grid, left, Coord<2>(30, 30), 1, WRITER_STEP_FINISHED, 0, true);
+
+        if (policy == AsyncWriter<TestCell<2> >::BLOCK) {
+            // the writer thread needs to be released before the third
+            // step will be accepted:
+            open(state);
+        }
+        writer.stepFinished(grid, left, Coord<2>(30, 30), 2, WRITER_STEP_FINISHED, 0, true);
+
+        open(state);
+        writer.flush();
+        return state->steps;
+    }
+#endif
+};
+
+}
@@ -0,0 +1,164 @@
+#include <libgeodecomp/io/asyncwriter.h>
+#include <libgeodecomp/io/chrometracewriter.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+
+#include <cxxtest/TestSuite.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ChromeTraceWriterTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        prefix = TempFile::serial("chrometrace");
+#endif
+    }
+
+    void tearDown()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        Tracer::disable();
+        remove((prefix + ".00000.json").c_str());
+        remove((prefix + ".00001.json").c_str());
+        remove((prefix + ".histogram").c_str());
+#endif
+    }
+
+    void testBasic()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef DisplacedGrid<TestCell<2> > GridType;
+        GridType grid(CoordBox<2>(Coord<2>(), Coord<2>(4, 4)));
+        Region<2> region;
+        region << grid.boundingBox();
+        Coord<2> dim(4, 4);
+        Chronometer chrono;
+
+        ChromeTraceWriter<TestCell<2> > writer(prefix, 2);
+        writer.stepFinished(grid, region, dim, 0, WRITER_INITIALIZED, 0, true);
+        TS_ASSERT(Tracer::enabled());
+
+        Tracer::setContext(10, 16, 1);
+        {
+            TimePatchProviders t(&chrono);
+        }
+        // only every second step triggers a flush, so this event
+        // will be written with the final flush below:
+        writer.stepFinished(grid, region, dim, 1, WRITER_STEP_FINISHED, 0, true);
+        Tracer::setContext(11);
+        {
+            TimeComputeInner t(&chrono);
+        }
+        writer.stepFinished(grid, region, dim, 2, WRITER_STEP_FINISHED, 0, false);
+        writer.stepFinished(grid, region, dim, 2, WRITER_STEP_FINISHED, 0, true);
+        TS_ASSERT_EQUALS(std::size_t(2), writer.eventsWritten);
+
+        {
+            TimeComputeInner t(&chrono);
+        }
+        writer.stepFinished(grid, region, dim, 3, WRITER_ALL_DONE, 0, true);
+        TS_ASSERT(!Tracer::enabled());
+
+        std::string trace = readFile(prefix + ".00000.json");
+        TS_ASSERT_EQUALS("[\n{\"name\":\"patch_providers_time\"", trace.substr(0, 32));
+        TS_ASSERT_EQUALS("}}\n]\n", trace.substr(trace.size() - 5));
+        TS_ASSERT_EQUALS(3, countSubstrings(trace, "\"ph\":\"X\""));
+        TS_ASSERT_EQUALS(2, countSubstrings(trace, "\"name\":\"compute_time_inner\""));
+        TS_ASSERT_EQUALS(1, countSubstrings(trace, "\"args\":{\"nano_step\":10,\"region_size\":16,\"patch_type\":1}"));
+        TS_ASSERT_EQUALS(2, countSubstrings(trace, "\"args\":{\"nano_step\":11,\"region_size\":0,\"patch_type\":-1}"));
+
+        std::string histogram = readFile(prefix + ".histogram");
+        TS_ASSERT_EQUALS(1, countSubstrings(histogram, "\npatch_providers_time "));
+        TS_ASSERT_EQUALS(1, countSubstrings(histogram, "# dropped events (rank 0): 0\n"));
+#endif
+    }
+
+    void testStepFinishedWithoutInitialization()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        DisplacedGrid<TestCell<2> > grid(CoordBox<2>(Coord<2>(), Coord<2>(4, 4)));
+        ChromeTraceWriter<TestCell<2> > writer(prefix, 1);
+
+        TS_ASSERT_THROWS(
+            writer.stepFinished(grid, Region<2>(), Coord<2>(4, 4), 1, WRITER_STEP_FINISHED, 0, true),
+            std::logic_error&);
+#endif
+    }
+
+    void testClonesDontDiscardEvents()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        DisplacedGrid<TestCell<2> > grid(CoordBox<2>(Coord<2>(), Coord<2>(4, 4)));
+        Region<2> region;
+        region << grid.boundingBox();
+        Coord<2> dim(4, 4);
+        Chronometer chrono;
+
+        ChromeTraceWriter<TestCell<2> > writer(prefix, 1);
+        SharedPtr<ParallelWriter<TestCell<2> > >::Type clone(writer.clone());
+        writer.stepFinished(grid, region, dim, 0, WRITER_INITIALIZED, 0, true);
+        {
+            TimeComputeInner t(&chrono);
+        }
+
+        clone->stepFinished(grid, region, dim, 0, WRITER_INITIALIZED, 1, true);
+        writer.stepFinished(grid, region, dim, 1, WRITER_STEP_FINISHED, 0, true);
+        TS_ASSERT_EQUALS(std::size_t(1), writer.eventsWritten);
+
+        clone->stepFinished(grid, region, dim, 2, WRITER_ALL_DONE, 1, true);
+        writer.stepFinished(grid, region, dim, 2, WRITER_ALL_DONE, 0, true);
+#endif
+    }
+
+    void testAsyncWriterRequiresBlockPolicy()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef AsyncWriter<TestCell<2> > WriterType;
+
+        TS_ASSERT(ChromeTraceWriter<TestCell<2> >(prefix, 1).isCollective());
+        TS_ASSERT_THROWS(
+            WriterType(new ChromeTraceWriter<TestCell<2> >(prefix, 1), 1, WriterType::DROP),
+            std::invalid_argument&);
+        TS_ASSERT_THROWS(
+            WriterType(new ChromeTraceWriter<TestCell<2> >(prefix, 1), 1, WriterType::COALESCE),
+            std::invalid_argument&);
+        WriterType writer(new ChromeTraceWriter<TestCell<2> >(prefix, 1), 1, WriterType::BLOCK);
+        TS_ASSERT(writer.isCollective());
+#endif
+    }
+
+private:
+    std::string prefix;
+
+    std::string readFile(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str());
+        std::stringstream buf;
+        buf << file.rdbuf();
+        return buf.str();
+    }
+
+    int countSubstrings(const std::string& haystack, const std::string& needle)
+    {
+        int ret = 0;
+        for (std::size_t pos = haystack.find(needle);
+             pos != std::string::npos;
+             pos = haystack.find(needle, pos + 1)) {
+            ++ret;
+        }
+
+        return ret;
+    }
+};
+
+}
@@ -0,0 +1,75 @@
+#include <libgeodecomp/io/parallelinitializer.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Yields the same grids as TestInitializer.
+ */
+class ParallelTestInitializer : public ParallelInitializer<TestCell<2> >
+{
+public:
+    explicit ParallelTestInitializer(const Coord<2>& dimensions) :
+        ParallelInitializer<TestCell<2> >(dimensions, 10)
+    {}
+
+    TestCell<2> cell(const Coord<2>& coord) const
+    {
+        return TestCell<2>(coord, dimensions, 0, 1 + coord.toIndex(dimensions));
+    }
+
+    TestCell<2> edgeCell() const
+    {
+        TestCell<2> ret(Coord<2>::diagonal(-1), dimensions);
+        ret.isEdgeCell = true;
+        return ret;
+    }
+};
+
+class ParallelInitializerTest : public CxxTest::TestSuite
+{
+public:
+    void testGridMatchesSerialInitialization()
+    {
+        Coord<2> dim(97, 31);
+        Grid<TestCell<2> > expected(dim);
+        Grid<TestCell<2> > actual(dim);
+
+        TestInitializer<TestCell<2> >(dim).grid(&expected);
+        ParallelTestInitializer(dim).grid(&actual);
+
+        TS_ASSERT_EQUALS(expected, actual);
+        TS_ASSERT_EQUALS(expected.getEdge(), actual.getEdge());
+    }
+
+    void testInitRegion()
+    {
+        Coord<2> dim(20, 10);
+        Grid<TestCell<2> > grid(dim);
+        Region<2> region;
+        region << Streak<2>(Coord<2>(2, 3), 15)
+               << Streak<2>(Coord<2>(0, 4), 20)
+               << Streak<2>(Coord<2>(5, 9), 6);
+
+        ParallelTestInitializer init(dim);
+        Initializer<TestCell<2> >& base = init;
+        base.initRegion(&grid, region);
+
+        TS_ASSERT(grid.getEdge().edgeCell());
+        for (CoordBox<2>::Iterator i = grid.boundingBox().begin(); i != grid.boundingBox().end(); ++i) {
+            if (region.count(*i)) {
+                TS_ASSERT_EQUALS(init.cell(*i), grid[*i]);
+            } else {
+                TS_ASSERT_EQUALS(TestCell<2>(), grid[*i]);
+            }
+        }
+    }
+};
+
+}
@@ -0,0 +1,160 @@
+#include <libgeodecomp/io/reductionwriter.h>
+#include <libgeodecomp/io/steerer.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/serialsimulator.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Records the reduction results it sees at each step.
+ */
+class ReductionRecorder : public Steerer<TestCell<2> >
+{
+public:
+    typedef ReductionWriter<TestCell<2> >::ResultsPtr ResultsPtr;
+
+    ReductionRecorder(unsigned period, ResultsPtr results) :
+        Steerer<TestCell<2> >(period),
+        results(results)
+    {}
+
+    virtual void nextStep(
+        GridType *grid,
+        const Region<Topology::DIM>& validRegion,
+        const CoordType& globalDimensions,
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        bool lastCall,
+        SteererFeedback *feedback)
+    {
+        if (!lastCall || !results->available()) {
+            return;
+        }
+
+        steps.push_back(step);
+        resultSteps.push_back(results->step());
+        maxCycles.push_back((*results)["maxCycle"]);
+    }
+
+    std::vector<unsigned> steps;
+    std::vector<unsigned> resultSteps;
+    std::vector<double> maxCycles;
+
+private:
+    ResultsPtr results;
+};
+
+class ReductionWriterTest : public CxxTest::TestSuite
+{
+public:
+    static double product(double a, double b)
+    {
+        return a * b;
+    }
+
+    void testBasic()
+    {
+        Grid<TestCell<2> > grid(Coord<2>(4, 3));
+        for (int y = 0; y < 3; ++y) {
+            for (int x = 0; x < 4; ++x) {
+                grid[Coord<2>(x, y)].testValue = 1 + x + 4 * y;
+                grid[Coord<2>(x, y)].cycleCounter = 10 - x;
+            }
+        }
+
+        ReductionWriter<TestCell<2> > writer(1);
+        writer.addReduction("sum",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::SUM);
+        writer.addReduction("min",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::MIN);
+        writer.addReduction("maxCycle", &TestCell<2>::cycleCounter, ReductionWriter<TestCell<2> >::MAX);
+        writer.addReduction("product",  &TestCell<2>::testValue,    product, 1.0);
+        ReductionWriter<TestCell<2> >::ResultsPtr results = writer.results();
+
+        TS_ASSERT(!results->available());
+        TS_ASSERT_THROWS((*results)["sum"], std::logic_error&);
+        TS_ASSERT_THROWS((*results)["foo"], std::invalid_argument&);
+        TS_ASSERT_THROWS(
+            writer.addReduction("sum", &TestCell<2>::testValue, ReductionWriter<TestCell<2> >::MAX),
+            std::invalid_argument&);
+
+        writer.stepFinished(grid, 5, WRITER_STEP_FINISHED);
+        TS_ASSERT(results->available());
+        TS_ASSERT_EQUALS(5, results->step());
+        TS_ASSERT_EQUALS(78,        (*results)["sum"]);
+        TS_ASSERT_EQUALS(1,         (*results)["min"]);
+        TS_ASSERT_EQUALS(10,        (*results)["maxCycle"]);
+        TS_ASSERT_EQUALS(479001600, (*results)["product"]);
+    }
+
+    void testParallelWriterInterfaceAccumulatesUntilLastCall()
+    {
+        Grid<TestCell<2> > grid(Coord<2>(4, 3));
+        for (int y = 0; y < 3; ++y) {
+            for (int x = 0; x < 4; ++x) {
+                grid[Coord<2>(x, y)].testValue = 1 + x + 4 * y;
+            }
+        }
+
+        Region<2> region1;
+        Region<2> region2;
+        region1 << Streak<2>(Coord<2>(0, 0), 4);
+        region2 << Streak<2>(Coord<2>(0, 1), 4)
+                << Streak<2>(Coord<2>(0, 2), 4);
+
+        // a clone shares its results with the original:
+        ReductionWriter<TestCell<2> > original(2);
+        original.addReduction("sum", &TestCell<2>::testValue, ReductionWriter<TestCell<2> >::SUM);
+        ParallelWriter<TestCell<2> > *writer = original.Clonable<ParallelWriter<TestCell<2> >, ReductionWriter<TestCell<2> > >::clone();
+        ReductionWriter<TestCell<2> >::ResultsPtr results = original.results();
+
+        // skipped due to period:
+        writer->stepFinished(grid, region1, Coord<2>(4, 3), 3, WRITER_STEP_FINISHED, 0, true);
+        TS_ASSERT(!results->available());
+
+        writer->stepFinished(grid, region1, Coord<2>(4, 3), 4, WRITER_STEP_FINISHED, 0, false);
+        TS_ASSERT(!results->available());
+        writer->stepFinished(grid, region2, Coord<2>(4, 3), 4, WRITER_STEP_FINISHED, 0, true);
+        TS_ASSERT_EQUALS(4, results->step());
+        TS_ASSERT_EQUALS(78, (*results)["sum"]);
+
+        writer->stepFinished(grid, region2, Coord<2>(4, 3), 6, WRITER_STEP_FINISHED, 0, true);
+        TS_ASSERT_EQUALS(6, results->step());
+        TS_ASSERT_EQUALS(68, (*results)["sum"]);
+
+        delete writer;
+    }
+
+    void testSerialSimulator()
+    {
+        int maxSteps = 10;
+        SerialSimulator<TestCell<2> > sim(new TestInitializer<TestCell<2> >(Coord<2>(20, 25), maxSteps));
+        ReductionWriter<TestCell<2> > *writer = new ReductionWriter<TestCell<2> >(2);
+        writer->addReduction("sum",      &TestCell<2>::testValue,    ReductionWriter<TestCell<2> >::SUM);
+        writer->addReduction("maxCycle", &TestCell<2>::cycleCounter, ReductionWriter<TestCell<2> >::MAX);
+        ReductionWriter<TestCell<2> >::ResultsPtr results = writer->results();
+        ReductionRecorder *recorder = new ReductionRecorder(1, results);
+
+        sim.addWriter(writer);
+        sim.addSteerer(recorder);
+        sim.run();
+
+        TS_ASSERT_EQUALS(unsigned(maxSteps), results->step());
+        TS_ASSERT_EQUALS(500 * 501 / 2, (*results)["sum"]);
+        TS_ASSERT_EQUALS(maxSteps * 27, (*results)["maxCycle"]);
+
+        TS_ASSERT_LESS_THAN(0, recorder->steps.size());
+        for (std::size_t i = 0; i < recorder->steps.size(); ++i) {
+            // steerers see the results of the latest output step:
+            TS_ASSERT_EQUALS(recorder->steps[i] - recorder->steps[i] % 2, recorder->resultSteps[i]);
+            TS_ASSERT_EQUALS(recorder->resultSteps[i] * 27, recorder->maxCycles[i]);
+        }
+    }
+};
+
+}
@@ -23,6 +23,7 @@ public:
     friend class SimulationFactoryWithCudaTest;
 
     using typename Initializer<CELL>::AdjacencyPtr;
+    using typename Initializer<CELL>::CellCostsPtr;
 
     typedef typename Initializer<CELL>::Topology Topology;
     const static int DIM = Topology::DIM;
@@ -56,6 +57,11 @@ public:
         proxyObj->grid(target);
     }
 
+    virtual void initRegion(GridBase<CELL,DIM> *target, const Region<DIM>& region) override
+    {
+        proxyObj->initRegion(target, region);
+    }
+
     virtual Coord<DIM> gridDimensions() const override
     {
         return proxyObj->gridDimensions();
@@ -85,6 +91,11 @@ public:
         return proxyObj->getAdjacency(region);
     }
 
+    virtual CellCostsPtr getCellCosts() const override
+    {
+        return proxyObj->getCellCosts();
+    }
+
     //--------------- inherited functions from Clonableinitializer --------------
     virtual ClonableInitializer<CELL> *clone() const override
     {
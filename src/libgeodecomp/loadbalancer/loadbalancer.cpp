@@ -26,5 +26,35 @@ LoadBalancer::WeightVec LoadBalancer::initialWeights(std::size_t items, const Lo
     return ret;
 }
 
+LoadBalancer::WeightVec LoadBalancer::initialWeights(const LoadBalancer::LoadVec& itemCosts, const LoadBalancer::LoadVec& rankSpeeds)
+{
+    std::size_t size = rankSpeeds.size();
+    if (size == 0) {
+        throw std::invalid_argument("Can't gather weights for 0 nodes.");
+    }
+
+    double totalCost = sum(itemCosts);
+    double totalSpeed = sum(rankSpeeds);
+    LoadBalancer::WeightVec ret(size, 0);
+
+    std::size_t rank = 0;
+    double partialSpeed = rankSpeeds[0];
+    double partialCost = 0.0;
+    for (std::size_t i = 0; i < itemCosts.size(); ++i) {
+        // an item is handed to the next rank if the bigger part of
+        // its cost would exceed the current rank's share:
+        while ((rank < (size - 1)) &&
+               ((partialCost + 0.5 * itemCosts[i]) > (totalCost * partialSpeed / totalSpeed))) {
+            ++rank;
+            partialSpeed += rankSpeeds[rank];
+        }
+
+        ++ret[rank];
+        partialCost += itemCosts[i];
+    }
+
+    return ret;
+}
+
 }
 
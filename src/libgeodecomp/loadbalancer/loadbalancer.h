@@ -58,6 +58,16 @@ public:
      */
     static WeightVec initialWeights(std::size_t items, const LoadVec& rankSpeeds);
 
+    /**
+     * Same as above, but for work items of varying cost (e.g. cells
+     * with different computational intensity, see CellCosts):
+     * itemCosts[i] is the cost of the i-th item. The items are
+     * assigned in order, so that each rank receives a contiguous
+     * sequence whose accumulated cost is proportional to its speed.
+     * The return value still counts items, not costs.
+     */
+    static WeightVec initialWeights(const LoadVec& itemCosts, const LoadVec& rankSpeeds);
+
 };
 
 }
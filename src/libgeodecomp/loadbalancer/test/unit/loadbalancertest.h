@@ -106,6 +106,42 @@ public:
         std::vector<double> speeds;
         TS_ASSERT_THROWS(balancer.initialWeights(6, speeds), std::invalid_argument&);
     }
+
+    void testInitialWeightsWithItemCosts()
+    {
+        TestLoadBalancer balancer;
+
+        std::vector<double> speeds;
+        speeds << 0.5
+               << 0.5
+               << 0.5;
+
+        std::vector<double> costs;
+        costs << 1
+              << 1
+              << 1
+              << 1
+              << 4
+              << 4;
+
+        std::vector<std::size_t> expectedWeights;
+        expectedWeights << 4
+                        << 1
+                        << 1;
+        TS_ASSERT_EQUALS(expectedWeights, balancer.initialWeights(costs, speeds));
+
+        speeds.clear();
+        speeds << 1
+               << 3;
+        costs = std::vector<double>(8, 2.0);
+        expectedWeights.clear();
+        expectedWeights << 2
+                        << 6;
+        TS_ASSERT_EQUALS(expectedWeights, balancer.initialWeights(costs, speeds));
+
+        speeds.clear();
+        TS_ASSERT_THROWS(balancer.initialWeights(costs, speeds), std::invalid_argument&);
+    }
 };
 
 }
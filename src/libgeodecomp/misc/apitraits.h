@@ -1138,6 +1138,46 @@ public:
 
     // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 
+    template<typename CELL, typename HAS_INCREMENTAL_MIGRATION = void>
+    class SelectIncrementalMigration
+    {
+    public:
+        typedef FalseType Value;
+    };
+
+    template<typename CELL>
+    class SelectIncrementalMigration<CELL, typename CELL::API::SupportsIncrementalMigration>
+    {
+    public:
+        typedef TrueType Value;
+    };
+
+    /**
+     * By default BoxCell rebuilds its particle list in each time step
+     * by testing all particles of all neighboring containers. Particles
+     * flagged with this trait are instead binned by their owning
+     * container at the end of each time step: particles which remain
+     * within the container stay put, those which left it are grouped
+     * by the neighbor they moved into, and neighbors only pick up the
+     * group destined for them. For mostly static particle sets this
+     * saves the bulk of the position checks.
+     *
+     * This assumes that all containers are of equal size and that
+     * adjacent containers share their faces, i.e. the neighbor at
+     * offset o covers origin + o * dimension. On periodic topologies
+     * (e.g. Torus) this doesn't hold at the boundary: particles
+     * which the model wraps around it match none of the neighbors
+     * and are searched exhaustively by all of them. This is correct,
+     * but yields no savings for these particles.
+     */
+    class HasIncrementalMigration
+    {
+    public:
+        typedef void SupportsIncrementalMigration;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
     template<typename CELL, typename HAS_TEMPLATE_NAME = void>
     class SelectMessageType
     {
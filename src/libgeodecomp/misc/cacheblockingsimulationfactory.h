@@ -18,13 +18,17 @@ public:
     using SimulationFactory<CELL>::addSteerers;
     using SimulationFactory<CELL>::addWriters;
     typedef typename SimulationFactory<CELL>::InitPtr InitPtr;
+    typedef typename APITraits::SelectTopology<CELL>::Value Topology;
+    static const int DIM = Topology::DIM;
 
     explicit
     CacheBlockingSimulationFactory<CELL>(InitPtr initializer):
         SimulationFactory<CELL>(initializer)
     {
-        SimulationFactory<CELL>::parameterSet.addParameter("WavefrontWidth", 10, 1000);
-        SimulationFactory<CELL>::parameterSet.addParameter("WavefrontHeight",10, 1000);
+        // the wavefront spans all but the last axis:
+        for (int d = 0; d < (DIM - 1); ++d) {
+            SimulationFactory<CELL>::parameterSet.addParameter(wavefrontParameter(d), 10, 1000);
+        }
         SimulationFactory<CELL>::parameterSet.addParameter("PipelineLength",  1,   30);
     }
 
@@ -38,11 +42,13 @@ protected:
         typename SharedPtr<ClonableInitializer<CELL> >::Type initializer,
         const SimulationParameters& params) const
     {
-        int pipelineLength  = params["PipelineLength"];
-        int wavefrontWidth  = params["WavefrontWidth"];
-        int wavefrontHeight = params["WavefrontHeight"];
+        int pipelineLength = params["PipelineLength"];
+
+        Coord<DIM - 1> wavefrontDim;
+        for (int d = 0; d < (DIM - 1); ++d) {
+            wavefrontDim[d] = params[wavefrontParameter(d)];
+        }
 
-        Coord<2> wavefrontDim(wavefrontWidth, wavefrontHeight);
         CacheBlockingSimulator<CELL> *sim =
             new CacheBlockingSimulator<CELL>(
                 initializer->clone(),
@@ -54,6 +60,12 @@ protected:
 
         return sim;
     }
+
+private:
+    static std::string wavefrontParameter(int dimension)
+    {
+        return dimension == 0 ? "WavefrontWidth" : "WavefrontHeight";
+    }
 };
 
 }
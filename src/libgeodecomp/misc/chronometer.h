@@ -2,6 +2,7 @@
 #define LIBGEODECOMP_MISC_CHRONOMETER_H
 
 #include <libgeodecomp/misc/scopedtimer.h>
+#include <libgeodecomp/misc/tracer.h>
 #include <libgeodecomp/storage/fixedarray.h>
 
 #include <iomanip>
@@ -134,7 +135,9 @@ public:
                                                                     \
         ~CLASS_NAME()                                               \
         {                                                           \
+            double start = t;                                       \
             t = elapsed();                                          \
+            Tracer::record(ID, start, t);                           \
         }                                                           \
     };
 }
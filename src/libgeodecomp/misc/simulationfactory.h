@@ -4,11 +4,174 @@
 #include <libgeodecomp/io/clonableinitializer.h>
 #include <libgeodecomp/io/logger.h>
 #include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/io/steerer.h>
+#include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/misc/optimizer.h>
+#include <libgeodecomp/misc/scopedtimer.h>
 #include <libgeodecomp/misc/simulationparameters.h>
 
 namespace LibGeoDecomp {
 
+namespace SimulationFactoryHelpers {
+
+/**
+ * Forwards to the wrapped Initializer, but ends the simulation
+ * after the given number of steps. Used for trial runs.
+ */
+template<typename CELL>
+class TrialInitializer : public ClonableInitializer<CELL>
+{
+public:
+    typedef typename Initializer<CELL>::AdjacencyPtr AdjacencyPtr;
+    typedef typename Initializer<CELL>::CellCostsPtr CellCostsPtr;
+    typedef typename SharedPtr<ClonableInitializer<CELL> >::Type InitPtr;
+    static const int DIM = Initializer<CELL>::DIM;
+
+    TrialInitializer(InitPtr delegate, unsigned steps) :
+        delegate(delegate),
+        steps(steps)
+    {}
+
+    ClonableInitializer<CELL> *clone() const
+    {
+        return new TrialInitializer(InitPtr(delegate->clone()), steps);
+    }
+
+    void grid(GridBase<CELL, DIM> *target)
+    {
+        delegate->grid(target);
+    }
+
+    void initRegion(GridBase<CELL, DIM> *target, const Region<DIM>& region)
+    {
+        delegate->initRegion(target, region);
+    }
+
+    CoordBox<DIM> gridBox()
+    {
+        return delegate->gridBox();
+    }
+
+    Coord<DIM> gridDimensions() const
+    {
+        return delegate->gridDimensions();
+    }
+
+    unsigned startStep() const
+    {
+        return delegate->startStep();
+    }
+
+    unsigned maxSteps() const
+    {
+        return delegate->startStep() + steps;
+    }
+
+    AdjacencyPtr getAdjacency(const Region<DIM>& region) const
+    {
+        return delegate->getAdjacency(region);
+    }
+
+    CellCostsPtr getCellCosts() const
+    {
+        return delegate->getCellCosts();
+    }
+
+private:
+    InitPtr delegate;
+    unsigned steps;
+};
+
+/**
+ * Measures the wall clock time of a trial run. Timing starts with
+ * the first step past the warm-up phase. Runs which take longer
+ * than the time limit are aborted.
+ */
+template<typename CELL>
+class TrialSteerer : public Steerer<CELL>
+{
+public:
+    typedef typename Steerer<CELL>::SteererFeedback SteererFeedback;
+    typedef typename Steerer<CELL>::GridType GridType;
+    typedef typename Steerer<CELL>::CoordType CoordType;
+    typedef typename Steerer<CELL>::Topology Topology;
+
+    /**
+     * Shared between the steerer and its clones, so results can be
+     * read back after the simulator has been destroyed.
+     */
+    class State
+    {
+    public:
+        State(unsigned firstMeasuredStep, double timeLimit) :
+            firstMeasuredStep(firstMeasuredStep),
+            timeLimit(timeLimit),
+            startStep(0),
+            startTime(-1),
+            elapsedTime(0),
+            measuredSteps(0),
+            aborted(false)
+        {}
+
+        unsigned firstMeasuredStep;
+        double timeLimit;
+        unsigned startStep;
+        double startTime;
+        double elapsedTime;
+        unsigned measuredSteps;
+        bool aborted;
+    };
+
+    typedef typename SharedPtr<State>::Type StatePtr;
+
+    TrialSteerer(unsigned period, StatePtr state) :
+        Steerer<CELL>(period),
+        state(state)
+    {}
+
+    Steerer<CELL> *clone() const
+    {
+        return new TrialSteerer(*this);
+    }
+
+    void nextStep(
+        GridType * /* unused: grid */,
+        const Region<Topology::DIM>& /* unused: validRegion */,
+        const CoordType& /* unused: globalDimensions */,
+        unsigned step,
+        SteererEvent event,
+        std::size_t /* unused: rank */,
+        bool lastCall,
+        SteererFeedback *feedback)
+    {
+        if (!lastCall) {
+            return;
+        }
+
+        double now = ScopedTimer::time();
+        if (state->startTime < 0) {
+            if (step >= state->firstMeasuredStep) {
+                state->startStep = step;
+                state->startTime = now;
+            }
+            return;
+        }
+
+        state->elapsedTime = now - state->startTime;
+        state->measuredSteps = step - state->startStep;
+
+        if ((event != STEERER_ALL_DONE) && (state->elapsedTime > state->timeLimit)) {
+            state->aborted = true;
+            feedback->endSimulation();
+        }
+    }
+
+private:
+    StatePtr state;
+};
+
+}
+
 /**
  * A SimulationFactory sets up all objects (e.g. Writers and
  * Steerers) necessary for conducting a simulation.
@@ -27,7 +190,11 @@ public:
 
     explicit
     SimulationFactory(InitPtr initializer) :
-        initializer(initializer)
+        initializer(initializer),
+        trialSteps(0),
+        warmUpSteps(0),
+        checkPeriod(1),
+        bestTrialTime(Limits<double>::getMax())
     {}
 
     virtual ~SimulationFactory()
@@ -58,8 +225,38 @@ public:
         return sim;
     }
 
+    /**
+     * Enables trial mode: evaluating a parameter set via
+     * operator()(params) will then run only warmUpSteps + trialSteps
+     * time steps on a copy of the initializer, without any Writers
+     * or Steerers. Only the trialSteps after the warm-up are timed,
+     * checking every checkPeriod steps whether the run has already
+     * taken longer than the fastest trial so far. Such runs are
+     * aborted early. Passing 0 trialSteps disables trial mode.
+     */
+    void setTrialSteps(unsigned newTrialSteps, unsigned newWarmUpSteps = 0, unsigned newCheckPeriod = 1)
+    {
+        if (newCheckPeriod == 0) {
+            throw std::invalid_argument("checkPeriod must be positive");
+        }
+
+        trialSteps = newTrialSteps;
+        warmUpSteps = newWarmUpSteps;
+        checkPeriod = newCheckPeriod;
+        bestTrialTime = Limits<double>::getMax();
+    }
+
+    unsigned getTrialSteps() const
+    {
+        return trialSteps;
+    }
+
     virtual double operator()(const SimulationParameters& params)
     {
+        if (trialSteps > 0) {
+            return runTrial(params);
+        }
+
         typename SharedPtr<Simulator<CELL> >::Type sim(buildSimulator(initializer, params));
         Chronometer chrono;
 
@@ -82,13 +279,60 @@ protected:
     ParallelWritersVec parallelWriters;
     WritersVec writers;
     SteerersVec steerers;
+    unsigned trialSteps;
+    unsigned warmUpSteps;
+    unsigned checkPeriod;
+    double bestTrialTime;
 
     virtual Simulator<CELL> *buildSimulator(
         InitPtr initializer,
         const SimulationParameters& params) const = 0;
 
+    /**
+     * Fitness is the negated wall clock time, extrapolated to
+     * trialSteps for aborted runs.
+     */
+    double runTrial(const SimulationParameters& params)
+    {
+        typedef SimulationFactoryHelpers::TrialSteerer<CELL> TrialSteererType;
+        typedef SimulationFactoryHelpers::TrialInitializer<CELL> TrialInitializerType;
+
+        InitPtr trialInitializer(
+            new TrialInitializerType(InitPtr(initializer->clone()), warmUpSteps + trialSteps));
+
+        typename TrialSteererType::StatePtr state(
+            new typename TrialSteererType::State(
+                trialInitializer->startStep() + warmUpSteps,
+                bestTrialTime));
+
+        typename SharedPtr<Simulator<CELL> >::Type sim(buildSimulator(trialInitializer, params));
+        sim->addSteerer(new TrialSteererType(checkPeriod, state));
+        sim->run();
+
+        if (state->measuredSteps == 0) {
+            return -Limits<double>::getMax();
+        }
+
+        double time = state->elapsedTime / state->measuredSteps * trialSteps;
+        if (!state->aborted) {
+            bestTrialTime = (std::min)(bestTrialTime, time);
+        }
+
+        LOG(Logger::DBG, "trial run took " << state->elapsedTime << "s for "
+            << state->measuredSteps << " steps, aborted: " << state->aborted);
+        return -time;
+    }
+
+    /**
+     * Writers and Steerers are skipped during trial runs as these
+     * runs don't cover the whole simulation.
+     */
     void addSteerers(MonolithicSimulator<CELL> *simulator) const
     {
+        if (trialSteps > 0) {
+            return;
+        }
+
         for (typename SteerersVec::const_iterator i = steerers.begin(); i != steerers.end(); ++i) {
             simulator->addSteerer((*i)->clone());
         }
@@ -96,16 +340,24 @@ protected:
 
     void addWriters(MonolithicSimulator<CELL> *simulator) const
     {
+        if (trialSteps > 0) {
+            return;
+        }
+
+        // simulators take ownership of their writers and we may
+        // build multiple simulators (e.g. while auto-tuning):
         for (typename WritersVec::const_iterator i = writers.begin(); i != writers.end(); ++i) {
-            // fixme: we should clone here
-            simulator->addWriter(&**i);
+            simulator->addWriter((*i)->clone());
         }
     }
     void addWriters(DistributedSimulator<CELL> *simulator) const
     {
+        if (trialSteps > 0) {
+            return;
+        }
+
         for (typename ParallelWritersVec::const_iterator i = parallelWriters.begin(); i != parallelWriters.end(); ++i) {
-            // fixme: we should clone here
-            simulator->addWriter(&**i);
+            simulator->addWriter((*i)->clone());
         }
     }
 };
@@ -0,0 +1,77 @@
+#include <libgeodecomp/io/clonableinitializerwrapper.h>
+#include <libgeodecomp/io/parallelmemorywriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/loadbalancer/noopbalancer.h>
+#include <libgeodecomp/misc/simulationfactory.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/stripingsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class StripingSimulationFactory : public SimulationFactory<TestCell<2> >
+{
+public:
+    typedef SimulationFactory<TestCell<2> >::ParallelWritersVec ParallelWritersVec;
+
+    explicit StripingSimulationFactory(InitPtr initializer) :
+        SimulationFactory<TestCell<2> >(initializer)
+    {}
+
+    std::string name() const
+    {
+        return "StripingSimulator";
+    }
+
+    const ParallelWritersVec& getParallelWriters() const
+    {
+        return parallelWriters;
+    }
+
+protected:
+    Simulator<TestCell<2> > *buildSimulator(
+        InitPtr initializer,
+        const SimulationParameters& /* unused: params */) const
+    {
+        StripingSimulator<TestCell<2> > *sim = new StripingSimulator<TestCell<2> >(
+            initializer->clone(),
+            new NoOpBalancer());
+        addWriters(sim);
+
+        return sim;
+    }
+};
+
+class DistributedSimulationFactoryTest : public CxxTest::TestSuite
+{
+public:
+    void testWritersAreClonedForEachRun()
+    {
+        StripingSimulationFactory::InitPtr init(
+            ClonableInitializerWrapper<TestInitializer<TestCell<2> > >::wrap(
+                TestInitializer<TestCell<2> >(Coord<2>(20, 10), 5, 0)));
+        StripingSimulationFactory factory(init);
+        factory.addWriter(ParallelMemoryWriter<TestCell<2> >(1));
+
+        // simulators used to take ownership of the factory's own
+        // writer, so the second run accessed a deleted object:
+        for (int i = 0; i < 2; ++i) {
+            TS_ASSERT(factory(factory.parameters()) <= 0);
+        }
+
+        factory.setTrialSteps(2);
+        for (int i = 0; i < 2; ++i) {
+            TS_ASSERT(factory(factory.parameters()) < 0);
+        }
+
+        ParallelMemoryWriter<TestCell<2> > *writer =
+            dynamic_cast<ParallelMemoryWriter<TestCell<2> >*>(&*factory.getParallelWriters()[0]);
+        TS_ASSERT(writer != 0);
+        TS_ASSERT(writer->getGrids().empty());
+    }
+};
+
+}
@@ -84,16 +84,15 @@ public:
 
     void testCacheBlockingFitness()
     {
-        // fixme
-        return;
-
 #ifdef LIBGEODECOMP_WITH_THREADS
 #ifdef LIBGEODECOMP_WITH_CPP14
         for (int i = 1; i <= 2; ++i) {
-            cFab->parameterSet["PipelineLength"].setValue(1);
+            cFab->parameterSet["PipelineLength"].setValue(i * 2);
             cFab->parameterSet["WavefrontWidth"].setValue(100);
             cFab->parameterSet["WavefrontHeight"].setValue(40);
             double fitness = cFab->operator()(cFab->parameterSet);
+            // fitness is the negated wall clock time:
+            TS_ASSERT(fitness < 0);
         }
 #endif
 #endif
@@ -131,9 +130,6 @@ public:
 
     void testAddWriterToCacheBlockingSimulationFactory()
     {
-        // fixme
-        return;
-
 #ifdef LIBGEODECOMP_WITH_CPP14
 #ifdef LIBGEODECOMP_WITH_THREADS
         std::ostringstream buf;
@@ -145,6 +141,27 @@ public:
 #endif
     }
 
+    void testTrialRunsSkipWriters()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::ostringstream buf;
+        Writer<SimFabTestCell> *writer = new TracingWriter<SimFabTestCell>(1, 100, 0, buf);
+        fab->addWriter(*writer);
+        delete writer;
+
+        fab->setTrialSteps(3, 1);
+        TS_ASSERT_EQUALS(3, fab->getTrialSteps());
+        double fitness = fab->operator()(fab->parameterSet);
+        // fitness is the negated (extrapolated) wall clock time:
+        TS_ASSERT(fitness < 0);
+        TS_ASSERT(buf.str().empty());
+        // trials must not alter the user's initializer:
+        TS_ASSERT_EQUALS(maxSteps, initializerProxy->maxSteps());
+
+        TS_ASSERT_THROWS(fab->setTrialSteps(3, 1, 0), std::invalid_argument&);
+#endif
+    }
+
 private:
 
 #ifdef LIBGEODECOMP_WITH_CPP14
@@ -203,6 +203,41 @@ public:
         std::string expected = "SimulationParameters(\n  bar => Interval([2, 4], 0)\n  foo => Interval([1, 5], 0)\n)\n";
         TS_ASSERT_EQUALS(expected, buf.str());
     }
+
+    void testGetNames()
+    {
+        std::vector<int> values;
+        values << 1
+               << 2
+               << 4;
+
+        SimulationParameters params;
+        params.addParameter("foo", 1, 5);
+        params.addParameter("bar", values);
+
+        std::vector<std::string> expected;
+        expected << "bar"
+                 << "foo";
+        TS_ASSERT_EQUALS(expected, params.getNames());
+    }
+
+    void testDiscreteSetSetValue()
+    {
+        std::vector<int> values;
+        values << 1
+               << 2
+               << 4;
+
+        SimulationParameters params;
+        params.addParameter("bar", values);
+
+        params["bar"].setValue(2);
+        TS_ASSERT_EQUALS(2, params["bar"].getValue());
+        TS_ASSERT(params["bar"] == 4);
+
+        params["bar"].setValue(7);
+        TS_ASSERT_EQUALS(2, params["bar"].getValue());
+    }
 };
 
 }
@@ -0,0 +1,189 @@
+#include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/tracer.h>
+
+#include <cxxtest/TestSuite.h>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <map>
+#include <set>
+#include <thread>
+#endif
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class TracerTest : public CxxTest::TestSuite
+{
+public:
+    void tearDown()
+    {
+        Tracer::disable();
+    }
+
+    void testDisabledByDefault()
+    {
+        std::vector<Tracer::Event> events;
+        TS_ASSERT(!Tracer::enabled());
+
+        Tracer::record(TimeCompute::ID, 1.0, 2.0);
+        TS_ASSERT_EQUALS(std::size_t(0), Tracer::drain(&events));
+        TS_ASSERT(events.empty());
+    }
+
+    void testRecordWithContext()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::vector<Tracer::Event> events;
+        Tracer::enable(16);
+        Tracer::setRank(3);
+
+        Tracer::setContext(47, 11, 2);
+        Tracer::record(TimePatchProviders::ID, 1.5, 0.25);
+        Tracer::setContext(48);
+        Tracer::record(TimeComputeInner::ID, 2.5, 0.5);
+
+        TS_ASSERT_EQUALS(std::size_t(2), Tracer::drain(&events));
+        TS_ASSERT_EQUALS(std::size_t(2), events.size());
+
+        TS_ASSERT_EQUALS(int(TimePatchProviders::ID), events[0].event);
+        TS_ASSERT_EQUALS(2,    events[0].patchType);
+        TS_ASSERT_EQUALS(3,    events[0].rank);
+        TS_ASSERT_EQUALS(47,   events[0].nanoStep);
+        TS_ASSERT_EQUALS(std::size_t(11), events[0].regionSize);
+        TS_ASSERT_EQUALS(1.5,  events[0].start);
+        TS_ASSERT_EQUALS(0.25, events[0].duration);
+
+        TS_ASSERT_EQUALS(int(TimeComputeInner::ID), events[1].event);
+        TS_ASSERT_EQUALS(-1, events[1].patchType);
+        TS_ASSERT_EQUALS(48, events[1].nanoStep);
+        TS_ASSERT_EQUALS(std::size_t(0), events[1].regionSize);
+
+        // buffers are emptied by drain():
+        TS_ASSERT_EQUALS(std::size_t(0), Tracer::drain(&events));
+        Tracer::setRank(0);
+#endif
+    }
+
+    void testChronometerTimersAreRecorded()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::vector<Tracer::Event> events;
+        Chronometer chrono;
+        Tracer::enable(16);
+        double before = ScopedTimer::time();
+        {
+            TimeComputeGhost t(&chrono);
+            ScopedTimer::busyWait(1000);
+        }
+        double after = ScopedTimer::time();
+        // addTime() lacks a start time and hence isn't traced:
+        chrono.addTime<TimeInput>(1.0);
+
+        Tracer::drain(&events);
+        TS_ASSERT_EQUALS(std::size_t(1), events.size());
+        TS_ASSERT_EQUALS(int(TimeComputeGhost::ID), events[0].event);
+        TS_ASSERT_LESS_THAN_EQUALS(before, events[0].start);
+        TS_ASSERT_LESS_THAN_EQUALS(events[0].start + events[0].duration, after);
+        TS_ASSERT_EQUALS(chrono.interval<TimeComputeGhost>(), events[0].duration);
+#endif
+    }
+
+    void testFullBuffersDropEvents()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::vector<Tracer::Event> events;
+        Tracer::enable(4);
+
+        for (int i = 0; i < 10; ++i) {
+            Tracer::setContext(i);
+            Tracer::record(TimeCompute::ID, i, 1);
+        }
+        TS_ASSERT_EQUALS(std::size_t(6), Tracer::dropped());
+
+        Tracer::drain(&events);
+        TS_ASSERT_EQUALS(std::size_t(4), events.size());
+        TS_ASSERT_EQUALS(3, events.back().nanoStep);
+
+        // after draining there is room again:
+        Tracer::record(TimeCompute::ID, 10, 1);
+        TS_ASSERT_EQUALS(std::size_t(1), Tracer::drain(&events));
+        TS_ASSERT_EQUALS(std::size_t(6), Tracer::dropped());
+#endif
+    }
+
+    void testThreadsUseSeparateBuffers()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        const int numThreads = 4;
+        const int numEvents = 1000;
+        Tracer::enable(numEvents);
+
+        std::vector<Tracer::Event> events;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t) {
+            threads.push_back(std::thread([t]{
+                        for (int i = 0; i < numEvents; ++i) {
+                            Tracer::setContext(t);
+                            Tracer::record(TimeCompute::ID, i, 1);
+                        }
+                    }));
+        }
+        // draining concurrently to recording is fine:
+        Tracer::drain(&events);
+        for (int t = 0; t < numThreads; ++t) {
+            threads[t].join();
+        }
+        Tracer::drain(&events);
+
+        TS_ASSERT_EQUALS(std::size_t(numThreads * numEvents), events.size());
+        TS_ASSERT_EQUALS(std::size_t(0), Tracer::dropped());
+
+        // contexts are kept per thread, so each thread's events
+        // carry a unique nano step:
+        std::map<int, long> nanoSteps;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            if (nanoSteps.count(events[i].thread) == 0) {
+                nanoSteps[events[i].thread] = events[i].nanoStep;
+            }
+            TS_ASSERT_EQUALS(nanoSteps[events[i].thread], events[i].nanoStep);
+        }
+        TS_ASSERT_EQUALS(std::size_t(numThreads), nanoSteps.size());
+
+        std::set<long> uniqueNanoSteps;
+        for (std::map<int, long>::iterator i = nanoSteps.begin(); i != nanoSteps.end(); ++i) {
+            uniqueNanoSteps.insert(i->second);
+        }
+        TS_ASSERT_EQUALS(std::size_t(numThreads), uniqueNanoSteps.size());
+#endif
+    }
+
+    void testHistogram()
+    {
+        TraceHistogram histogram;
+        histogram.add(TimeCompute::ID, 0.5e-6);
+        histogram.add(TimeCompute::ID, 1.5e-6);
+        histogram.add(TimeCompute::ID, 3e-6);
+        histogram.add(TimeCompute::ID, 3.9e-6);
+        histogram.add(TimeInput::ID, 1e6);
+
+        TS_ASSERT_EQUALS(1ULL, histogram.count(TimeCompute::ID, 0));
+        TS_ASSERT_EQUALS(1ULL, histogram.count(TimeCompute::ID, 1));
+        TS_ASSERT_EQUALS(2ULL, histogram.count(TimeCompute::ID, 2));
+        TS_ASSERT_EQUALS(4ULL, histogram.count(TimeCompute::ID));
+        TS_ASSERT_EQUALS(1ULL, histogram.count(TimeInput::ID, TraceHistogram::NUM_BUCKETS - 1));
+        TS_ASSERT_EQUALS(0ULL, histogram.count(TimeOutput::ID));
+
+        TS_ASSERT_EQUALS(1e-6, TraceHistogram::bucketLimit(0));
+        TS_ASSERT_EQUALS(4e-6, TraceHistogram::bucketLimit(2));
+
+        TraceHistogram sum;
+        sum += histogram;
+        sum += histogram;
+        TS_ASSERT_EQUALS(8ULL, sum.count(TimeCompute::ID));
+
+        TS_ASSERT_THROWS(histogram.add(TraceHistogram::MAX_EVENTS, 1), std::invalid_argument&);
+    }
+};
+
+}
@@ -0,0 +1,127 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/tuningcache.h>
+
+#include <cstdio>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class TuningCacheTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        filename = TempFile::serial("tuningcache");
+    }
+
+    void tearDown()
+    {
+        remove(filename.c_str());
+    }
+
+    void testStoreAndReload()
+    {
+        SimulationParameters params = buildParams();
+        params["x"].setValue(7);
+        params["y"].setValue(2);
+
+        TuningCache::Entry entry("CacheBlockingSimulation", -1.25);
+        entry.setParameters(params);
+        {
+            TuningCache cache(filename);
+            TS_ASSERT_EQUALS(std::size_t(0), cache.size());
+            cache.store("foo", entry);
+        }
+
+        TuningCache cache(filename);
+        TS_ASSERT_EQUALS(std::size_t(1), cache.size());
+
+        TuningCache::Entry loaded;
+        TS_ASSERT(cache.lookup("foo", &loaded));
+        TS_ASSERT_EQUALS("CacheBlockingSimulation", loaded.simulator);
+        TS_ASSERT_EQUALS(-1.25, loaded.fitness);
+        TS_ASSERT_EQUALS(entry.values, loaded.values);
+
+        SimulationParameters restored = buildParams();
+        loaded.applyParameters(&restored);
+        TS_ASSERT_EQUALS(7, restored["x"].getValue());
+        TS_ASSERT_EQUALS(2, restored["y"].getValue());
+        TS_ASSERT(restored["y"] == 5);
+    }
+
+    void testMissingKey()
+    {
+        TuningCache cache(filename);
+        cache.store("foo", TuningCache::Entry("SerialSimulation", -1));
+
+        TuningCache::Entry entry("unchanged", 4711);
+        TS_ASSERT(!cache.lookup("bar", &entry));
+        TS_ASSERT_EQUALS("unchanged", entry.simulator);
+        TS_ASSERT_EQUALS(4711, entry.fitness);
+    }
+
+    void testOverwrite()
+    {
+        {
+            TuningCache cache(filename);
+            cache.store("foo", TuningCache::Entry("SerialSimulation", -3));
+            cache.store("bar", TuningCache::Entry("SerialSimulation", -4));
+            cache.store("foo", TuningCache::Entry("CacheBlockingSimulation", -2));
+        }
+
+        TuningCache cache(filename);
+        TS_ASSERT_EQUALS(std::size_t(2), cache.size());
+
+        TuningCache::Entry entry;
+        TS_ASSERT(cache.lookup("foo", &entry));
+        TS_ASSERT_EQUALS("CacheBlockingSimulation", entry.simulator);
+        TS_ASSERT_EQUALS(-2, entry.fitness);
+    }
+
+    void testKey()
+    {
+        std::string key1 = TuningCache::key<int>(Coord<2>(10, 20));
+        std::string key2 = TuningCache::key<int>(Coord<2>(20, 10));
+        std::string key3 = TuningCache::key<double>(Coord<2>(10, 20));
+
+        TS_ASSERT_EQUALS(key1, TuningCache::key<int>(Coord<2>(10, 20)));
+        TS_ASSERT_DIFFERS(key1, key2);
+        TS_ASSERT_DIFFERS(key1, key3);
+        TS_ASSERT_EQUALS(std::string::npos, key1.find('\t'));
+        TS_ASSERT_EQUALS(std::string::npos, key1.find('\n'));
+    }
+
+    void testApplyParametersIgnoresUnknownNames()
+    {
+        TuningCache::Entry entry;
+        entry.values["x"] = 3;
+        entry.values["z"] = 9;
+
+        SimulationParameters params = buildParams();
+        entry.applyParameters(&params);
+        TS_ASSERT_EQUALS(3, params["x"].getValue());
+        TS_ASSERT_EQUALS(0, params["y"].getValue());
+    }
+
+private:
+    std::string filename;
+
+    SimulationParameters buildParams()
+    {
+        std::vector<int> values;
+        values << 1
+               << 3
+               << 5;
+
+        SimulationParameters params;
+        params.addParameter("x", 0, 10);
+        params.addParameter("y", values);
+
+        return params;
+    }
+};
+
+}
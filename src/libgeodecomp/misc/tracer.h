@@ -0,0 +1,442 @@
+#ifndef LIBGEODECOMP_MISC_TRACER_H
+#define LIBGEODECOMP_MISC_TRACER_H
+
+#include <libgeodecomp/config.h>
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <atomic>
+#include <memory>
+#endif
+
+namespace LibGeoDecomp {
+
+/**
+ * Counts events per event ID in logarithmically spaced duration
+ * buckets: bucket 0 holds all events shorter than one microsecond,
+ * bucket i > 0 those in [2^(i-1), 2^i) microseconds. The last bucket
+ * also receives all longer events. Histograms are additive, which
+ * makes them cheap to aggregate across threads and ranks.
+ */
+class TraceHistogram
+{
+public:
+    static const std::size_t MAX_EVENTS = 20;
+    static const std::size_t NUM_BUCKETS = 32;
+
+    TraceHistogram() :
+        counts(MAX_EVENTS * NUM_BUCKETS, 0)
+    {}
+
+    inline void add(std::size_t event, double duration)
+    {
+        if (event >= MAX_EVENTS) {
+            throw std::invalid_argument("event ID exceeds TraceHistogram::MAX_EVENTS");
+        }
+
+        counts[event * NUM_BUCKETS + bucket(duration)] += 1;
+    }
+
+    TraceHistogram& operator+=(const TraceHistogram& other)
+    {
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += other.counts[i];
+        }
+
+        return *this;
+    }
+
+    inline unsigned long long count(std::size_t event, std::size_t bucket) const
+    {
+        return counts[event * NUM_BUCKETS + bucket];
+    }
+
+    /**
+     * Total number of events with the given ID.
+     */
+    unsigned long long count(std::size_t event) const
+    {
+        unsigned long long ret = 0;
+        for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+            ret += count(event, i);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Upper (exclusive) bound of the bucket in seconds.
+     */
+    static double bucketLimit(std::size_t bucket)
+    {
+        return std::ldexp(1e-6, static_cast<int>(bucket));
+    }
+
+    static std::size_t bucket(double duration)
+    {
+        std::size_t ret = 0;
+        for (double limit = 1e-6; (duration >= limit) && (ret < (NUM_BUCKETS - 1)); limit *= 2) {
+            ++ret;
+        }
+
+        return ret;
+    }
+
+    /**
+     * Raw access for reductions (e.g. via MPI).
+     */
+    std::vector<unsigned long long>& rawCounts()
+    {
+        return counts;
+    }
+
+private:
+    std::vector<unsigned long long> counts;
+};
+
+/**
+ * Tracer records a timeline of the intervals measured by the
+ * Chronometer's timers (TimeCompute, TimePatchProviders etc.). Each
+ * thread writes to its own fixed-size ring buffer, so recording an
+ * event requires neither locks nor allocations. A single consumer
+ * (typically the ChromeTraceWriter) periodically drains all buffers
+ * via drain(). Events which don't fit into a full buffer are dropped
+ * and counted (see dropped()).
+ *
+ * Events carry the thread's context at the time of recording: the
+ * nano step and size of the region being processed and the
+ * PatchType (-1 for computations). Steppers update it via
+ * setContext(). While tracing is disabled (the default) recording
+ * boils down to a single relaxed atomic load.
+ *
+ * Requires C++14 support (LIBGEODECOMP_WITH_CPP14) for atomics and
+ * thread_local storage, otherwise tracing is unavailable and enable()
+ * will throw.
+ */
+class Tracer
+{
+public:
+    /**
+     * One recorded interval, start and duration in seconds as
+     * returned by ScopedTimer::time().
+     */
+    class Event
+    {
+    public:
+        int event;
+        int patchType;
+        int rank;
+        int thread;
+        long nanoStep;
+        std::size_t regionSize;
+        double start;
+        double duration;
+    };
+
+    static const std::size_t MAX_THREADS = 256;
+    static const std::size_t DEFAULT_CAPACITY = 1 << 16;
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+
+    /**
+     * Starts recording with capacity events per thread. Any
+     * previously buffered events are discarded. Must not be called
+     * while other threads are recording.
+     */
+    static void enable(std::size_t capacity = DEFAULT_CAPACITY)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("Tracer capacity must be positive");
+        }
+
+        State& s = state();
+        s.active.store(false, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < MAX_THREADS; ++i) {
+            s.registry[i].store(0, std::memory_order_relaxed);
+            s.buffers[i].reset();
+        }
+        s.numBuffers.store(0, std::memory_order_relaxed);
+        s.dropped.store(0, std::memory_order_relaxed);
+        s.capacity = capacity;
+        ++s.generation;
+        s.active.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Stops recording. Buffered events can still be drained.
+     */
+    static void disable()
+    {
+        state().active.store(false, std::memory_order_release);
+    }
+
+    static inline bool enabled()
+    {
+        return state().active.load(std::memory_order_relaxed);
+    }
+
+    static void setRank(int rank)
+    {
+        state().rank = rank;
+    }
+
+    static inline void setContext(long nanoStep, std::size_t regionSize = 0, int patchType = -1)
+    {
+        ThreadContext& c = context();
+        c.nanoStep = nanoStep;
+        c.regionSize = regionSize;
+        c.patchType = patchType;
+    }
+
+    /**
+     * Convenience overload which only computes the Region's size if
+     * tracing is enabled.
+     */
+    template<template<int> class REGION, int DIM>
+    static inline void setContext(long nanoStep, const REGION<DIM>& region, int patchType = -1)
+    {
+        if (enabled()) {
+            setContext(nanoStep, region.size(), patchType);
+        }
+    }
+
+    static inline void record(int event, double start, double duration)
+    {
+        if (!enabled()) {
+            return;
+        }
+
+        ThreadContext& c = context();
+        RingBuffer *buffer = threadBuffer(&c);
+        if (buffer == 0) {
+            state().dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Event e;
+        e.event = event;
+        e.patchType = c.patchType;
+        e.rank = state().rank;
+        e.thread = c.thread;
+        e.nanoStep = c.nanoStep;
+        e.regionSize = c.regionSize;
+        e.start = start;
+        e.duration = duration;
+
+        if (!buffer->push(e)) {
+            state().dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Moves all buffered events to target. Only one thread may drain
+     * at a time, but it may do so concurrently to recording threads.
+     * Returns the number of events appended.
+     */
+    static std::size_t drain(std::vector<Event> *target)
+    {
+        State& s = state();
+        std::size_t ret = 0;
+        std::size_t numBuffers = s.numBuffers.load(std::memory_order_acquire);
+        if (numBuffers > MAX_THREADS) {
+            numBuffers = MAX_THREADS;
+        }
+
+        for (std::size_t i = 0; i < numBuffers; ++i) {
+            RingBuffer *buffer = s.registry[i].load(std::memory_order_acquire);
+            if (buffer != 0) {
+                ret += buffer->drain(target);
+            }
+        }
+
+        return ret;
+    }
+
+    /**
+     * Number of events lost due to full buffers since enable().
+     */
+    static std::size_t dropped()
+    {
+        return state().dropped.load(std::memory_order_relaxed);
+    }
+
+#else
+
+    static void enable(std::size_t /* capacity */ = DEFAULT_CAPACITY)
+    {
+        throw std::logic_error("Tracer requires C++14 support");
+    }
+
+    static void disable()
+    {}
+
+    static inline bool enabled()
+    {
+        return false;
+    }
+
+    static void setRank(int /* rank */)
+    {}
+
+    static inline void setContext(long /* nanoStep */, std::size_t /* regionSize */ = 0, int /* patchType */ = -1)
+    {}
+
+    template<template<int> class REGION, int DIM>
+    static inline void setContext(long /* nanoStep */, const REGION<DIM>& /* region */, int /* patchType */ = -1)
+    {}
+
+    static inline void record(int /* event */, double /* start */, double /* duration */)
+    {}
+
+    static std::size_t drain(std::vector<Event> * /* target */)
+    {
+        return 0;
+    }
+
+    static std::size_t dropped()
+    {
+        return 0;
+    }
+
+#endif
+
+private:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    /**
+     * Single producer, single consumer queue: only the owning thread
+     * advances head, only the draining thread advances tail.
+     */
+    class RingBuffer
+    {
+    public:
+        explicit RingBuffer(std::size_t capacity) :
+            events(capacity),
+            head(0),
+            tail(0)
+        {}
+
+        inline bool push(const Event& event)
+        {
+            std::size_t h = head.load(std::memory_order_relaxed);
+            std::size_t t = tail.load(std::memory_order_acquire);
+            if ((h - t) == events.size()) {
+                return false;
+            }
+
+            events[h % events.size()] = event;
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t drain(std::vector<Event> *target)
+        {
+            std::size_t t = tail.load(std::memory_order_relaxed);
+            std::size_t h = head.load(std::memory_order_acquire);
+
+            for (std::size_t i = t; i != h; ++i) {
+                target->push_back(events[i % events.size()]);
+            }
+            tail.store(h, std::memory_order_release);
+
+            return h - t;
+        }
+
+    private:
+        std::vector<Event> events;
+        std::atomic<std::size_t> head;
+        std::atomic<std::size_t> tail;
+    };
+
+    class ThreadContext
+    {
+    public:
+        ThreadContext() :
+            buffer(0),
+            generation(0),
+            thread(-1),
+            patchType(-1),
+            nanoStep(-1),
+            regionSize(0)
+        {}
+
+        RingBuffer *buffer;
+        unsigned generation;
+        int thread;
+        int patchType;
+        long nanoStep;
+        std::size_t regionSize;
+    };
+
+    class State
+    {
+    public:
+        State() :
+            active(false),
+            numBuffers(0),
+            dropped(0),
+            capacity(DEFAULT_CAPACITY),
+            generation(0),
+            rank(0)
+        {
+            for (std::size_t i = 0; i < MAX_THREADS; ++i) {
+                registry[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<bool> active;
+        std::atomic<std::size_t> numBuffers;
+        std::atomic<std::size_t> dropped;
+        std::atomic<RingBuffer*> registry[MAX_THREADS];
+        std::unique_ptr<RingBuffer> buffers[MAX_THREADS];
+        std::size_t capacity;
+        unsigned generation;
+        int rank;
+    };
+
+    static State& state()
+    {
+        static State s;
+        return s;
+    }
+
+    static ThreadContext& context()
+    {
+        static thread_local ThreadContext c;
+        return c;
+    }
+
+    /**
+     * Returns the calling thread's buffer, claims a new slot upon the
+     * thread's first event after enable(). Returns 0 if all slots
+     * are taken.
+     */
+    static inline RingBuffer *threadBuffer(ThreadContext *c)
+    {
+        State& s = state();
+        if (c->generation == s.generation) {
+            return c->buffer;
+        }
+
+        std::size_t slot = s.numBuffers.fetch_add(1, std::memory_order_relaxed);
+        c->generation = s.generation;
+        c->buffer = 0;
+        c->thread = static_cast<int>(slot);
+
+        if (slot < MAX_THREADS) {
+            s.buffers[slot].reset(new RingBuffer(s.capacity));
+            c->buffer = s.buffers[slot].get();
+            s.registry[slot].store(c->buffer, std::memory_order_release);
+        }
+
+        return c->buffer;
+    }
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+#ifndef LIBGEODECOMP_MISC_TUNINGCACHE_H
+#define LIBGEODECOMP_MISC_TUNINGCACHE_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/io/ioexception.h>
+#include <libgeodecomp/misc/simulationparameters.h>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+namespace LibGeoDecomp {
+
+/**
+ * Persists the results of auto-tuning runs on disk, so that later
+ * runs of the same model on the same machine can skip the tuning and
+ * start with the best configuration right away. Results are keyed by
+ * cell type, grid size, thread count and CPU model (see key()).
+ *
+ * The file holds one result per line, fields are separated by tabs:
+ * key, simulator name, fitness and the parameters as name=value
+ * pairs. Values are those reported by getValue() of the respective
+ * parameter and are restored via setValue().
+ */
+class TuningCache
+{
+public:
+    /**
+     * The tuning result for one key.
+     */
+    class Entry
+    {
+    public:
+        explicit Entry(
+            const std::string& simulator = "",
+            double fitness = 0) :
+            simulator(simulator),
+            fitness(fitness)
+        {}
+
+        /**
+         * Stores the values of all parameters in params.
+         */
+        void setParameters(const SimulationParameters& params)
+        {
+            values.clear();
+            std::vector<std::string> names = params.getNames();
+            for (std::vector<std::string>::iterator i = names.begin(); i != names.end(); ++i) {
+                values[*i] = params[*i].getValue();
+            }
+        }
+
+        /**
+         * Sets the parameters in params to the stored values.
+         * Parameters without a stored value remain unchanged.
+         */
+        void applyParameters(SimulationParameters *params) const
+        {
+            std::vector<std::string> names = params->getNames();
+            for (std::vector<std::string>::iterator i = names.begin(); i != names.end(); ++i) {
+                std::map<std::string, double>::const_iterator value = values.find(*i);
+                if (value != values.end()) {
+                    (*params)[*i].setValue(value->second);
+                }
+            }
+        }
+
+        std::string simulator;
+        double fitness;
+        std::map<std::string, double> values;
+    };
+
+    explicit TuningCache(const std::string& filename) :
+        filename(filename)
+    {
+        load();
+    }
+
+    /**
+     * Builds a key which identifies simulations of CELL on a grid of
+     * the given size on the current machine.
+     */
+    template<typename CELL, int DIM>
+    static std::string key(const Coord<DIM>& gridDimensions)
+    {
+        std::stringstream buf;
+        buf << typeid(CELL).name() << " "
+            << gridDimensions << " "
+            << threads() << " threads "
+            << cpuModel();
+
+        return buf.str();
+    }
+
+    /**
+     * Returns true and sets entry if a result for key exists.
+     */
+    bool lookup(const std::string& key, Entry *entry) const
+    {
+        std::map<std::string, Entry>::const_iterator i = entries.find(key);
+        if (i == entries.end()) {
+            return false;
+        }
+
+        *entry = i->second;
+        return true;
+    }
+
+    /**
+     * Adds (or replaces) the result for key and rewrites the file.
+     */
+    void store(const std::string& key, const Entry& entry)
+    {
+        entries[key] = entry;
+        save();
+    }
+
+    std::size_t size() const
+    {
+        return entries.size();
+    }
+
+private:
+    std::string filename;
+    std::map<std::string, Entry> entries;
+
+    static int threads()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    static std::string cpuModel()
+    {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 10, "model name") != 0) {
+                continue;
+            }
+
+            std::size_t pos = line.find(':');
+            if (pos != std::string::npos) {
+                return line.substr(line.find_first_not_of(' ', pos + 1));
+            }
+        }
+
+        return "unknown CPU";
+    }
+
+    void load()
+    {
+        // a missing file simply means that nothing has been tuned yet:
+        std::ifstream file(filename.c_str());
+        std::string line;
+
+        while (std::getline(file, line)) {
+            std::vector<std::string> fields;
+            std::stringstream lineBuf(line);
+            std::string field;
+            while (std::getline(lineBuf, field, '\t')) {
+                fields.push_back(field);
+            }
+            if (fields.size() < 3) {
+                continue;
+            }
+
+            Entry entry(fields[1]);
+            std::stringstream fitnessBuf(fields[2]);
+            fitnessBuf >> entry.fitness;
+
+            for (std::size_t i = 3; i < fields.size(); ++i) {
+                std::size_t pos = fields[i].find('=');
+                if (pos == std::string::npos) {
+                    continue;
+                }
+
+                std::stringstream valueBuf(fields[i].substr(pos + 1));
+                valueBuf >> entry.values[fields[i].substr(0, pos)];
+            }
+
+            entries[fields[0]] = entry;
+        }
+    }
+
+    void save() const
+    {
+        std::ofstream file(filename.c_str());
+        if (!file.good()) {
+            throw FileOpenException(filename);
+        }
+
+        file.precision(17);
+        for (std::map<std::string, Entry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+            file << i->first << "\t" << i->second.simulator << "\t" << i->second.fitness;
+
+            for (std::map<std::string, double>::const_iterator j = i->second.values.begin();
+                 j != i->second.values.end();
+                 ++j) {
+                file << "\t" << j->first << "=" << j->second;
+            }
+            file << "\n";
+        }
+
+        if (!file.good()) {
+            throw FileWriteException(filename);
+        }
+    }
+};
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 #include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/misc/serialsimulationfactory.h>
 #include <libgeodecomp/misc/simulationparameters.h>
+#include <libgeodecomp/misc/tuningcache.h>
 #include <libgeodecomp/io/initializer.h>
 #include <libgeodecomp/io/varstepinitializerproxy.h>
 #include <libgeodecomp/io/logger.h>
@@ -54,6 +55,13 @@ public:
  * and suitable parameters for the given simulation model and
  * hardware.
  *
+ * By default each candidate is evaluated by running the whole
+ * simulation (with the number of steps normalized to a short
+ * duration). setTrialSteps() limits evaluations to a few time steps
+ * instead and aborts candidates early once they're slower than the
+ * best one so far. With setTuningCache() the result is stored on
+ * disk and later runs on the same machine skip the tuning.
+ *
  * fixme: shouldn't we inherit from Monolithic- or DistributedSimulator?
  */
 template<typename CELL_TYPE, typename OPTIMIZER_TYPE>
@@ -79,11 +87,27 @@ public:
 
     void addSteerer(const Steerer<CELL_TYPE> *steerer);
 
+    /**
+     * Evaluate candidates via trial runs of trialSteps time steps,
+     * following warmUpSteps untimed steps. See
+     * SimulationFactory::setTrialSteps().
+     */
+    void setTrialSteps(unsigned trialSteps, unsigned warmUpSteps = 0, unsigned checkPeriod = 1);
+
+    /**
+     * Read tuning results from and store them in the given file.
+     */
+    void setTuningCache(const std::string& filename);
+
     void run();
 
 private:
     std::map<const std::string, SimulationPtr> simulations;
     unsigned optimizationSteps; // maximum number of Steps for the optimizer
+    unsigned trialSteps;
+    unsigned warmUpSteps;
+    unsigned checkPeriod;
+    typename SharedPtr<TuningCache>::Type tuningCache;
     typename SharedPtr<VarStepInitializerProxy<CELL_TYPE> >::Type varStepInitializer;
     std::vector<typename SharedPtr<ParallelWriter<CELL_TYPE> >::Type> parallelWriters;
     std::vector<typename SharedPtr<Writer<CELL_TYPE> >::Type> writers;
@@ -116,6 +140,14 @@ private:
 
     void prepareSimulations();
 
+    void setTrialMode(bool enabled);
+
+    std::string tuningCacheKey() const;
+
+    bool loadFromTuningCache(std::string *bestSimulation);
+
+    void storeInTuningCache(const std::string& bestSimulation);
+
     SimulationPtr getSimulation(const std::string& simulatorName)
     {
         if (simulations.find(simulatorName) == simulations.end()) {
@@ -129,6 +161,9 @@ private:
 template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
 AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::AutoTuningSimulator(Initializer<CELL_TYPE> *initializer, unsigned optimizationSteps):
     optimizationSteps(optimizationSteps),
+    trialSteps(0),
+    warmUpSteps(0),
+    checkPeriod(1),
     varStepInitializer(new VarStepInitializerProxy<CELL_TYPE>(initializer))
 {
     addSimulation(SerialSimulationFactory<CELL_TYPE>(varStepInitializer));
@@ -162,6 +197,27 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::addSteerer(const Steerer<CE
     steerers.push_back(SteererPtr(steerer));
 }
 
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::setTrialSteps(
+    unsigned newTrialSteps,
+    unsigned newWarmUpSteps,
+    unsigned newCheckPeriod)
+{
+    if (newCheckPeriod == 0) {
+        throw std::invalid_argument("checkPeriod must be positive");
+    }
+
+    trialSteps = newTrialSteps;
+    warmUpSteps = newWarmUpSteps;
+    checkPeriod = newCheckPeriod;
+}
+
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::setTuningCache(const std::string& filename)
+{
+    tuningCache.reset(new TuningCache(filename));
+}
+
 template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
 void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::run()
 {
@@ -172,13 +228,25 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::run()
     unsigned defaultInitializerSteps = 5;
 
     prepareSimulations();
-    if (!normalizeSteps(fitnessGoal, defaultInitializerSteps)) {
+
+    std::string best;
+    if (loadFromTuningCache(&best)) {
+        runToCompletion(best);
+        return;
+    }
+
+    if (trialSteps > 0) {
+        setTrialMode(true);
+    } else if (!normalizeSteps(fitnessGoal, defaultInitializerSteps)) {
         LOG(Logger::WARN, "normalize Steps was not successful, default step number will be used");
         varStepInitializer->setMaxSteps(defaultInitializerSteps);
     }
 
     runTest();
-    std::string best = getBestSim();
+    best = getBestSim();
+    storeInTuningCache(best);
+
+    setTrialMode(false);
     runToCompletion(best);
 }
 
@@ -186,7 +254,7 @@ template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
 std::string AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::getBestSim()
 {
     std::string bestSimulation;
-    double tmpFitness = Limits<double>::getMin();
+    double tmpFitness = -Limits<double>::getMax();
     typedef typename std::map<const std::string, SimulationPtr>::iterator IterType;
 
     for (IterType iter = simulations.begin(); iter != simulations.end(); iter++) {
@@ -215,7 +283,7 @@ unsigned AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::normalizeSteps(double g
         throw std::invalid_argument("startSteps needs to be grater than zero");
     }
 
-    SimulationPtr simulation = getSimulation("SerialSimulation");
+    SimulationPtr simulation = getSimulation("SerialSimulator");
     SimFactoryPtr factory = simulation->simulationFactory;
     unsigned steps = startStepNum;
     unsigned oldSteps = startStepNum;
@@ -260,6 +328,60 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::runTest()
     }
 }
 
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::setTrialMode(bool enabled)
+{
+    typedef typename std::map<const std::string, SimulationPtr>::iterator IterType;
+
+    for (IterType iter = simulations.begin(); iter != simulations.end(); iter++) {
+        iter->second->simulationFactory->setTrialSteps(
+            enabled ? trialSteps : 0,
+            warmUpSteps,
+            checkPeriod);
+    }
+}
+
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+std::string AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::tuningCacheKey() const
+{
+    return TuningCache::key<CELL_TYPE>(varStepInitializer->gridDimensions());
+}
+
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+bool AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::loadFromTuningCache(std::string *bestSimulation)
+{
+    TuningCache::Entry entry;
+    if (!tuningCache || !tuningCache->lookup(tuningCacheKey(), &entry)) {
+        return false;
+    }
+
+    if (simulations.find(entry.simulator) == simulations.end()) {
+        LOG(Logger::WARN, "ignoring tuning cache entry for unknown simulator " << entry.simulator);
+        return false;
+    }
+
+    SimulationPtr simulation = getSimulation(entry.simulator);
+    entry.applyParameters(&simulation->parameters);
+    simulation->fitness = entry.fitness;
+    *bestSimulation = entry.simulator;
+
+    LOG(Logger::INFO, "using tuned " << entry.simulator << " from tuning cache");
+    return true;
+}
+
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::storeInTuningCache(const std::string& bestSimulation)
+{
+    if (!tuningCache) {
+        return;
+    }
+
+    SimulationPtr simulation = getSimulation(bestSimulation);
+    TuningCache::Entry entry(bestSimulation, simulation->fitness);
+    entry.setParameters(simulation->parameters);
+    tuningCache->store(tuningCacheKey(), entry);
+}
+
 template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
 void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::prepareSimulations()
 {
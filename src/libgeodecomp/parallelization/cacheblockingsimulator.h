@@ -4,18 +4,35 @@
 #include <libgeodecomp/config.h>
 #ifdef LIBGEODECOMP_WITH_THREADS
 
-#include <omp.h>
 #include <libgeodecomp/io/logger.h>
 #include <libgeodecomp/parallelization/monolithicsimulator.h>
-#include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 
 namespace LibGeoDecomp {
 
 /**
- * CacheBlockingSimulator is an experimental simulator to explore the
- * infrastructure required to implement a pipelined wavefront update
- * algorith and which benefits is may provide.
+ * CacheBlockingSimulator implements temporal blocking for
+ * (memory-bound) stencil codes: it advances the grid by up to
+ * pipelineLength nano steps per hop, working on columns of cells
+ * which are small enough to stay cache resident meanwhile.
+ *
+ * The simulation space is partitioned into columns along all but
+ * the last axis, the cross section of each column is given by
+ * wavefrontDim. Each hop runs through multiple phases: first each
+ * thread updates a column whose update region shrinks with every nano
+ * step by the stencil's radius (on the sides where it borders other
+ * columns), so columns are independent of each other. The following
+ * phases fill the gaps between columns with regions that grow with
+ * each nano step. This is trapezoidal tiling, which works with just
+ * two grids and yields results identical to those of the
+ * SerialSimulator. Gaps across the boundaries of periodic axes are
+ * handled just like those between columns, so arbitrary torus
+ * topologies are supported.
+ *
+ * Columns need to be at least 2 * pipelineLength * radius cells
+ * wide. If wavefrontDim is too small, the pipeline length will be
+ * reduced accordingly.
  */
 template<typename CELL>
 class CacheBlockingSimulator : public MonolithicSimulator<CELL>
@@ -23,13 +40,17 @@ class CacheBlockingSimulator : public MonolithicSimulator<CELL>
 public:
     friend class CacheBlockingSimulatorTest;
 
-    typedef typename APITraits::SelectTopology<CELL>::Value Topology;
-    typedef typename TopologiesHelpers::Topology<3, Topology::template WrapsAxis<0>::VALUE, Topology::template WrapsAxis<1>::VALUE, true> BufferTopology;
-    typedef Grid<CELL, Topology> GridType;
-    typedef DisplacedGrid<CELL, BufferTopology> BufferType;
-    typedef std::vector<std::vector<Region<3> > > WavefrontFrames;
+    typedef typename MonolithicSimulator<CELL>::GridType GridBaseType;
+    typedef typename MonolithicSimulator<CELL>::Topology Topology;
+    typedef typename APITraits::SelectSoA<CELL>::Value SupportsSoA;
+    typedef typename GridTypeSelector<CELL, Topology, false, SupportsSoA>::Value GridType;
+    typedef typename APITraits::SelectStencil<CELL>::Value Stencil;
+    typedef typename Steerer<CELL>::SteererFeedback SteererFeedback;
     static const int DIM = Topology::DIM;
 
+    // for each nano step of a hop one region per task of a phase:
+    typedef std::vector<std::vector<Region<DIM> > > PhaseFrames;
+
     using MonolithicSimulator<CELL>::NANO_STEPS;
     using MonolithicSimulator<CELL>::chronometer;
 
@@ -38,30 +59,28 @@ public:
         int pipelineLength,
         const Coord<DIM - 1>& wavefrontDim) :
         MonolithicSimulator<CELL>(initializer),
-        buffers(omp_get_max_threads()),
         pipelineLength(pipelineLength),
-        wavefrontDim(wavefrontDim)
+        wavefrontDim(wavefrontDim),
+        nanoStep(0)
     {
+        if (pipelineLength < 1) {
+            throw std::invalid_argument("CacheBlockingSimulator needs a pipelineLength >= 1");
+        }
+        for (int d = 0; d < (DIM - 1); ++d) {
+            if (wavefrontDim[d] < 1) {
+                throw std::invalid_argument("CacheBlockingSimulator needs a positive wavefrontDim");
+            }
+        }
+
+        stepNum = initializer->startStep();
         Coord<DIM> dim = initializer->gridBox().dimensions;
-        curGrid = new GridType(dim);
-        newGrid = new GridType(dim);
+        simArea << CoordBox<DIM>(Coord<DIM>(), dim);
+        curGrid = new GridType(simArea);
+        newGrid = new GridType(simArea);
         initializer->grid(curGrid);
         initializer->grid(newGrid);
 
-        Coord<DIM> bufferDim;
-
-        for (int i = 0; i < DIM - 1; ++i) {
-            bufferDim[i] = wavefrontDim[i] + 2 * pipelineLength - 2;
-        }
-        bufferDim[DIM - 1] = pipelineLength * 4 - 4;
-
-        for (std::size_t i = 0; i < buffers.size(); ++i) {
-            buffers[i] = BufferType(CoordBox<DIM>(Coord<DIM>(), bufferDim), curGrid->getEdgeCell(), curGrid->getEdgeCell());
-        }
-        LOG(DBG, "created " << buffers.size() << " buffers");
-
         generateFrames();
-        nanoStep = 0;
     }
 
     virtual ~CacheBlockingSimulator()
@@ -70,9 +89,13 @@ public:
         delete curGrid;
     }
 
+    /**
+     * performs a single simulation step.
+     */
     virtual void step()
     {
-        // fixme
+        SteererFeedback feedback;
+        step(&feedback, 1);
     }
 
     virtual void run()
@@ -80,25 +103,21 @@ public:
         initializer->grid(curGrid);
         stepNum = initializer->startStep();
         nanoStep = 0;
+        setIORegions();
 
-        for(unsigned i = 0; i < writers.size(); ++i) {
-            writers[i]->stepFinished(
-                *getGrid(),
-                getStep(),
-                WRITER_INITIALIZED);
-        }
+        SteererFeedback feedback;
+        handleInput(STEERER_INITIALIZED, &feedback);
+        handleOutput(WRITER_INITIALIZED);
 
-        for (stepNum = initializer->startStep();
-             stepNum < initializer->maxSteps();) {
-            hop();
-        }
+        for (; stepNum < initializer->maxSteps();) {
+            if (feedback.simulationEnded()) {
+                break;
+            }
 
-        for(unsigned i = 0; i < writers.size(); ++i) {
-            writers[i]->stepFinished(
-                *getGrid(),
-                getStep(),
-                WRITER_ALL_DONE);
+            step(&feedback, stepsUntilNextEvent());
         }
+
+        handleInput(STEERER_ALL_DONE, &feedback);
     }
 
     virtual const GridType *getGrid()
@@ -106,231 +125,320 @@ public:
         return curGrid;
     }
 
+    /**
+     * Returns the pipeline length which is actually used. It may be
+     * smaller than requested if the wavefront is too narrow.
+     */
+    int getPipelineLength() const
+    {
+        return frames.empty() ? 1 : frames[0].size();
+    }
+
 private:
     using MonolithicSimulator<CELL>::initializer;
     using MonolithicSimulator<CELL>::steerers;
     using MonolithicSimulator<CELL>::stepNum;
     using MonolithicSimulator<CELL>::writers;
     using MonolithicSimulator<CELL>::getStep;
+    using MonolithicSimulator<CELL>::gridDim;
 
     GridType *curGrid;
     GridType *newGrid;
-    std::vector<BufferType> buffers;
+    Region<DIM> simArea;
     int pipelineLength;
     Coord<DIM - 1> wavefrontDim;
-    Grid<WavefrontFrames> frames;
+    std::vector<PhaseFrames> frames;
     unsigned nanoStep;
 
-    void generateFrames()
+    /**
+     * Advances the simulation by the given number of steps, but
+     * only notifies Steerers before the first and Writers after the
+     * last step. Callers need to ensure that no IO is due in between.
+     */
+    void step(SteererFeedback *feedback, unsigned steps)
     {
-        Coord<DIM> gridDim = initializer->gridBox().dimensions;
+        TimeTotal t(&chronometer);
 
-        Coord<DIM - 1> framesDim;
-        for (int i = 0; i < (DIM - 1); ++i) {
-            framesDim[i] = gridDim[i] / wavefrontDim[i];
-            if ((gridDim[i] % wavefrontDim[i]) != 0) {
-                framesDim[i] += 1;
-            }
+        handleInput(STEERER_NEXT_STEP, feedback);
+        if (feedback->simulationEnded()) {
+            steps = 1;
         }
-        frames.resize(framesDim);
 
-        for (int y = 0; y < framesDim.y(); ++y) {
-            for (int x = 0; x < framesDim.x(); ++x) {
-                frames[Coord<2>(x, y)] = generateWavefrontFrames(
-                    Coord<3>(x * wavefrontDim.x(),
-                             y * wavefrontDim.y(),
-                             0));
+        {
+            TimeCompute t(&chronometer);
 
+            std::size_t remainingNanoSteps = std::size_t(steps) * NANO_STEPS;
+            while (remainingNanoSteps > 0) {
+                std::size_t hopLength = (std::min)(remainingNanoSteps, std::size_t(getPipelineLength()));
+                hop(hopLength);
+                remainingNanoSteps -= hopLength;
             }
         }
+
+        stepNum += steps;
+
+        WriterEvent event = WRITER_STEP_FINISHED;
+        if (stepNum == initializer->maxSteps()) {
+            event = WRITER_ALL_DONE;
+        }
+        handleOutput(event);
     }
 
-    WavefrontFrames generateWavefrontFrames(const Coord<DIM> offset)
+    /**
+     * Number of steps we can do before the next Writer or Steerer
+     * needs to be notified.
+     */
+    unsigned stepsUntilNextEvent() const
     {
-        Coord<DIM> gridDim = initializer->gridBox().dimensions;
-        Coord<DIM> wavefrontRegionDim;
-        for (int i = 0; i < (DIM - 1); ++i) {
-            wavefrontRegionDim[i] = wavefrontDim[i];
+        unsigned ret = initializer->maxSteps() - stepNum;
+
+        for (unsigned i = 0; i < writers.size(); ++i) {
+            unsigned period = writers[i]->getPeriod();
+            ret = (std::min)(ret, period - (stepNum % period));
         }
-        wavefrontRegionDim[DIM - 1] = gridDim[DIM - 1] - offset[DIM - 1];
-        Region<DIM> region;
-        region << CoordBox<DIM>(offset, wavefrontRegionDim);
-        std::vector<Region<3> > regions(pipelineLength);
-        regions[pipelineLength - 1] = region.expandWithTopology(
-            0, gridDim, Topologies::Cube<3>::Topology());
-
-        for (int i = pipelineLength - 2; i >= 0; --i) {
-            regions[i] = regions[i + 1].expandWithTopology(
-                1, gridDim, Topologies::Cube<3>::Topology());
+
+        for (unsigned i = 0; i < steerers.size(); ++i) {
+            unsigned period = steerers[i]->getPeriod();
+            ret = (std::min)(ret, period - (stepNum % period));
         }
 
-        int wavefrontLength = gridDim[DIM - 1] + 1;
-        WavefrontFrames ret(wavefrontLength, std::vector<Region<DIM> >(pipelineLength));
+        return ret;
+    }
+
+    /**
+     * Splits each of the first DIM - 1 axes into tiles of (at least)
+     * the wavefront's width and sets up the update regions of all
+     * phases: phase p handles the gaps between tiles on all axes
+     * whose bit is set in p. Phases with more bits set depend on
+     * those with fewer bits, tasks within a phase are independent.
+     */
+    void generateFrames()
+    {
+        Coord<DIM> dim = initializer->gridDimensions();
+        int radius = (std::max)(int(Stencil::RADIUS), 1);
+        int hopLength = pipelineLength;
+        std::vector<std::vector<int> > boundaries(DIM - 1);
 
-        for (int index = 0; index < wavefrontLength; ++index) {
-            Coord<DIM> maskOrigin;
-            maskOrigin[DIM - 1] = index;
-            Topology::normalize(maskOrigin, initializer->gridDimensions());
-            Coord<DIM> maskDim = gridDim;
-            maskDim[DIM - 1] = 1;
+        for (int d = 0; d < (DIM - 1); ++d) {
+            int numTiles = (std::max)(dim[d] / wavefrontDim[d], 1);
+            for (int i = 0; i < numTiles; ++i) {
+                boundaries[d].push_back(i * wavefrontDim[d]);
+            }
+            boundaries[d].push_back(dim[d]);
 
-            Region<DIM> mask;
-            mask << CoordBox<DIM>(maskOrigin, maskDim);
-            for (int i = 0; i < pipelineLength; ++i) {
-                ret[index][i] = regions[i] & mask;
+            // a single tile on a non-periodic axis doesn't constrain
+            // the pipeline length as it has no gaps to fill:
+            if ((numTiles > 1) || wrapsAxis(d)) {
+                int minWidth = (std::min)(wavefrontDim[d], dim[d]);
+                hopLength = (std::min)(hopLength, minWidth / (2 * radius));
             }
         }
 
-        return ret;
-    }
+        if (hopLength < 1) {
+            LOG(WARN, "CacheBlockingSimulator: grid too small for wavefront blocking, falling back to stepwise updates");
+            frames.clear();
+            frames.push_back(PhaseFrames(1, std::vector<Region<DIM> >(1, simArea)));
+            return;
+        }
 
-    void hop()
-    {
-        using std::swap;
-        TimeTotal t(&chronometer);
+        // emulating a stable sort by the number of bits set per phase:
+        std::vector<int> phases;
+        for (int bits = 0; bits < DIM; ++bits) {
+            for (int phase = 0; phase < (1 << (DIM - 1)); ++phase) {
+                if (countBits(phase) == bits) {
+                    phases.push_back(phase);
+                }
+            }
+        }
 
-        CoordBox<DIM - 1> frameBox = frames.boundingBox();
-        // for (typename CoordBox<DIM -1>::Iterator waveIter = frameBox.begin();
-        //      waveIter != frameBox.end();
-        //      ++waveIter) {
-        //     updateWavefront(*waveIter);
-        // }
-
-#pragma omp parallel for
-        for (int y = 0; y < frameBox.dimensions.y(); ++y) {
-            for (int x = 0; x < frameBox.dimensions.x(); ++x) {
-                updateWavefront(&buffers[omp_get_thread_num()], Coord<2>(x, y));
+        frames.clear();
+        for (std::size_t i = 0; i < phases.size(); ++i) {
+            PhaseFrames phaseFrames(hopLength);
+            generatePhaseFrames(phases[i], boundaries, radius, &phaseFrames);
+            if (!phaseFrames[0].empty()) {
+                frames.push_back(phaseFrames);
             }
         }
 
-        swap(curGrid, newGrid);
-        int curNanoStep = nanoStep + pipelineLength;
-        stepNum += curNanoStep / NANO_STEPS;
-        nanoStep = curNanoStep % NANO_STEPS;
+        LOG(DBG, "CacheBlockingSimulator: " << frames.size() << " phases, pipeline length " << hopLength);
     }
 
-    void updateWavefront(BufferType *buffer, const Coord<DIM - 1>& wavefrontCoord)
+    void generatePhaseFrames(
+        int phase,
+        const std::vector<std::vector<int> >& boundaries,
+        int radius,
+        PhaseFrames *phaseFrames)
     {
-        LOG(INFO, "wavefrontCoord(" << wavefrontCoord << ")");
-        buffer->setEdge(curGrid->getEdge());
-        // buffer->fill(buffer->boundingBox(), curGrid->getEdgeCell());
-        fixBufferOrigin(buffer, wavefrontCoord);
-
-        int index = 0;
-        CoordBox<DIM> boundingBox = curGrid->boundingBox();
-        int maxIndex = boundingBox.origin[DIM - 1] + boundingBox.dimensions[DIM - 1];
-
-        // fill pipeline
-        for (; index < 2 * pipelineLength - 2; ++index) {
-            int lastStage = (index >> 1) + 1;
-            pipelinedUpdate(buffer, wavefrontCoord, index, index, 0, lastStage);
+        Coord<DIM - 1> numTasks;
+        for (int d = 0; d < (DIM - 1); ++d) {
+            // tiles have one entry less than the boundaries (these
+            // include the end of the axis), interior gaps two less.
+            // Periodic axes have one more gap at their ends.
+            numTasks[d] = boundaries[d].size() - 1;
+            if (phase & (1 << d)) {
+                numTasks[d] -= wrapsAxis(d) ? 0 : 1;
+            }
         }
 
-        // normal operation
-        for (; index < maxIndex; ++index) {
-            pipelinedUpdate(buffer, wavefrontCoord, index, index, 0, pipelineLength);
+        if (numTasks.prod() == 0) {
+            return;
         }
 
-        // let pipeline drain
-        for (; index < (maxIndex + 2 * pipelineLength - 2); ++index) {
-            int firstStage = (index - maxIndex + 1) >> 1 ;
-            pipelinedUpdate(buffer, wavefrontCoord, index, index, firstStage, pipelineLength);
+        CoordBox<DIM - 1> tasks(Coord<DIM - 1>(), numTasks);
+        for (typename CoordBox<DIM - 1>::Iterator i = tasks.begin(); i != tasks.end(); ++i) {
+            for (std::size_t s = 0; s < phaseFrames->size(); ++s) {
+                (*phaseFrames)[s].push_back(
+                    taskRegion(phase, *i, boundaries, radius * int(s + 1)));
+            }
         }
     }
 
-    void fixBufferOrigin(BufferType *buffer, const Coord<DIM - 1>& frameCoord)
+    Region<DIM> taskRegion(
+        int phase,
+        const Coord<DIM - 1>& task,
+        const std::vector<std::vector<int> >& boundaries,
+        int shrink)
     {
-        Coord<DIM> bufferOrigin;
-        // fixme: wrong on boundary with Torus topology
+        Coord<DIM> dim = initializer->gridDimensions();
+        Coord<DIM> origin;
+        Coord<DIM> end = dim;
+
         for (int d = 0; d < (DIM - 1); ++d) {
-            bufferOrigin[d] = (std::max)(0, frameCoord[d] * wavefrontDim[d] - pipelineLength + 1);
+            if (phase & (1 << d)) {
+                int gap = boundaries[d][task[d] + (wrapsAxis(d) ? 0 : 1)];
+                origin[d] = gap - shrink;
+                end[d]    = gap + shrink;
+            } else {
+                origin[d] = boundaries[d][task[d] + 0];
+                end[d]    = boundaries[d][task[d] + 1];
+                if ((origin[d] != 0) || wrapsAxis(d)) {
+                    origin[d] += shrink;
+                }
+                if ((end[d] != dim[d]) || wrapsAxis(d)) {
+                    end[d] -= shrink;
+                }
+            }
+
+            if (origin[d] >= end[d]) {
+                return Region<DIM>();
+            }
         }
-        bufferOrigin[DIM - 1] = 0;
-        buffer->setOrigin(bufferOrigin);
+
+        Region<DIM> ret;
+        ret << CoordBox<DIM>(origin, end - origin);
+        // normalizes gaps which span the boundaries of periodic axes:
+        ret = ret.expandWithTopology(0, dim, Topology());
+
+        return curGrid->remapRegion(ret);
     }
 
-    void pipelinedUpdate(
-        BufferType *buffer,
-        const Coord<DIM - 1>& frameCoord,
-        int globalIndex,
-        int localIndex,
-        int firstStage,
-        int lastStage)
+    /**
+     * Advances the grid by hopLength nano steps (which must not
+     * exceed the pipeline length).
+     */
+    void hop(std::size_t hopLength)
     {
-        LOG(DBG, "  pipelinedUpdate(frameCoord = " << frameCoord << ", globalIndex = " << globalIndex << ", localIndex = " << localIndex << ", firstStage = " << firstStage << ", lastStage = " << lastStage << ")");
-
-        for (int i = firstStage; i < lastStage; ++i) {
-            bool firstIteration = (i == 0);
-            bool lastIteration =  (i == (pipelineLength - 1));
-            int currentGlobalIndex = globalIndex - 2 * i;
-            bool needsFlushing = (i == firstStage) &&
-                (currentGlobalIndex >= newGrid->getDimensions()[DIM - 1]);
-            int sourceIndex = firstIteration ? currentGlobalIndex : normalizeIndex(localIndex + 2 - 4 * i);
-            int targetIndex = lastIteration  ? currentGlobalIndex : normalizeIndex(localIndex + 0 - 4 * i);
-
-            const Region<DIM>& updateFrame = frames[frameCoord][globalIndex - 2 * i][i];
-            unsigned curNanoStep = (nanoStep + i) % NANO_STEPS;
-
-            if ( firstIteration &&  lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *curGrid, newGrid, curNanoStep);
+        using std::swap;
+        GridType *grids[] = { curGrid, newGrid };
+
+        for (std::size_t p = 0; p < frames.size(); ++p) {
+            const PhaseFrames& phaseFrames = frames[p];
+            int numTasks = phaseFrames[0].size();
+
+            if (numTasks == 1) {
+                for (std::size_t s = 0; s < hopLength; ++s) {
+                    UpdateFunctor<CELL, UpdateFunctorHelpers::ConcurrencyEnableOpenMP>()(
+                        phaseFrames[s][0],
+                        Coord<DIM>(),
+                        Coord<DIM>(),
+                        *grids[(s + 0) % 2],
+                        grids[(s + 1) % 2],
+                        (nanoStep + s) % NANO_STEPS,
+                        UpdateFunctorHelpers::ConcurrencyEnableOpenMP(false, false));
+                }
+                continue;
             }
 
-            if ( firstIteration && !lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *curGrid, buffer,  curNanoStep);
+#pragma omp parallel for schedule(dynamic)
+            for (int task = 0; task < numTasks; ++task) {
+                for (std::size_t s = 0; s < hopLength; ++s) {
+                    UpdateFunctor<CELL>()(
+                        phaseFrames[s][task],
+                        Coord<DIM>(),
+                        Coord<DIM>(),
+                        *grids[(s + 0) % 2],
+                        grids[(s + 1) % 2],
+                        (nanoStep + s) % NANO_STEPS);
+                }
             }
+        }
 
-            if (!firstIteration &&  lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *buffer,  newGrid, curNanoStep);
-            }
+        if (hopLength % 2) {
+            swap(curGrid, newGrid);
+        }
+        nanoStep = (nanoStep + hopLength) % NANO_STEPS;
+    }
 
-            if (!firstIteration && !lastIteration) {
-                frameUpdate(needsFlushing, updateFrame, sourceIndex, targetIndex, *buffer,  buffer,  curNanoStep);
+    bool wrapsAxis(int dimension) const
+    {
+        return Topology::wrapsAxis(dimension);
+    }
+
+    static int countBits(int phase)
+    {
+        int ret = 0;
+        for (; phase != 0; phase >>= 1) {
+            ret += phase & 1;
+        }
+        return ret;
+    }
+
+    /**
+     * notifies all registered Writers
+     */
+    void handleOutput(WriterEvent event)
+    {
+        TimeOutput t(&chronometer);
+
+        for (unsigned i = 0; i < writers.size(); i++) {
+            if ((event != WRITER_STEP_FINISHED) ||
+                ((getStep() % writers[i]->getPeriod()) == 0)) {
+                writers[i]->stepFinished(
+                    *curGrid,
+                    getStep(),
+                    event);
             }
         }
     }
 
-    template<class GRID1, class GRID2>
-    void frameUpdate(
-        bool needsFlushing,
-        const Region<DIM>& updateFrame,
-        int sourceIndex,
-        int targetIndex,
-        const GRID1& sourceGrid,
-        GRID2 *targetGrid,
-        unsigned curNanoStep)
+    /**
+     * notifies all registered Steerers
+     */
+    void handleInput(SteererEvent event, SteererFeedback *feedback)
     {
-        LOG(DBG, "    frameUpdate("
-            << needsFlushing << ", "
-            << updateFrame.boundingBox() << ", "
-            << sourceIndex << ", "
-            << targetIndex <<  ")");
-
-        if (needsFlushing) {
-            // fixme: only works with cube topologies
-            Coord<DIM> fillOrigin = buffers[omp_get_thread_num()].getOrigin();
-            fillOrigin[DIM - 1] = targetIndex;
-            Coord<DIM> fillDim = buffers[omp_get_thread_num()].getDimensions();
-            fillDim[DIM - 1] = 1;
-
-            // buffers[omp_get_thread_num()].fill(
-            //     CoordBox<DIM>(fillOrigin, fillDim),
-            //     buffers[omp_get_thread_num()].getEdgeCell());
-        } else {
-            Coord<DIM> sourceOffset;
-            Coord<DIM> targetOffset;
-            sourceOffset[DIM - 1] = sourceIndex;
-            targetOffset[DIM - 1] = targetIndex;
-
-            UpdateFunctor<CELL>()(updateFrame, sourceOffset, targetOffset, sourceGrid, targetGrid, curNanoStep);
+        TimeInput t(&chronometer);
+
+        for (unsigned i = 0; i < steerers.size(); ++i) {
+            if ((event != STEERER_NEXT_STEP) ||
+                (stepNum % steerers[i]->getPeriod() == 0)) {
+                steerers[i]->nextStep(
+                    curGrid,
+                    simArea,
+                    gridDim,
+                    getStep(),
+                    event,
+                    0,
+                    true,
+                    feedback);
+            }
         }
-     }
+    }
 
-    // wraps the index (for 3D this will be the Z coordinate) around
-    // the buffer's dimension
-    int normalizeIndex(int localIndex)
+    void setIORegions()
     {
-        int bufferSize = buffers[0].getDimensions()[DIM - 1];
-        return (localIndex + bufferSize) % bufferSize;
+        for (unsigned i = 0; i < steerers.size(); i++) {
+            steerers[i]->setRegion(simArea);
+        }
     }
 };
 
@@ -55,6 +55,9 @@ protected:
                 balanceLoad();
                 insertNextLoadBalancingEvent();
             }
+            if (*i == REPARTITIONING) {
+                repartition();
+            }
         }
         events.erase(events.begin());
     }
@@ -73,6 +76,16 @@ protected:
 
     virtual void balanceLoad() = 0;
 
+    /**
+     * Applies a new domain decomposition. Simulators which schedule
+     * REPARTITIONING events (usually from within balanceLoad()) need
+     * to override this.
+     */
+    virtual void repartition()
+    {
+        throw std::logic_error("repartitioning not supported by this Simulator");
+    }
+
     /**
      * returns the number of nano steps until the next event needs to be handled.
      */
@@ -54,6 +54,8 @@ public:
     typedef typename ParentType::GridType GridType;
     typedef ParallelWriterAdapter<typename UpdateGroupType::GridType, CELL_TYPE> ParallelWriterAdapterType;
     typedef SteererAdapter<typename UpdateGroupType::GridType, CELL_TYPE> SteererAdapterType;
+    typedef typename SharedPtr<ParallelWriterAdapterType>::Type ParallelWriterAdapterPtr;
+    typedef typename SharedPtr<SteererAdapterType>::Type SteererAdapterPtr;
 
     static const int DIM = Topology::DIM;
 
@@ -70,9 +72,49 @@ public:
             enableFineGrainedParallelism),
         balancer(balancer),
         ghostZoneWidth(ghostZoneWidth),
-        mpiLayer(communicator)
+        mpiLayer(communicator),
+        balancingEnabled(false),
+        sharedMemoryEnabled(false),
+        neighborhoodCollectivesEnabled(false),
+        zeroCopyEnabled(false),
+        lastRepartitioningNanoStep(0)
     {}
 
+    /**
+     * Lets ranks on the same node exchange their ghost zones via an
+     * MPI-3 shared memory window (see MPIUpdateGroup). All ranks
+     * need to agree on this setting, and it needs to be chosen
+     * before the simulation is started.
+     */
+    void enableSharedMemory(bool enable = true)
+    {
+        checkNotStarted();
+        sharedMemoryEnabled = enable;
+    }
+
+    /**
+     * Bundles the ghost zone transfers of each sync point to ranks
+     * on other nodes into a single MPI neighborhood collective (see
+     * CollectivePatchLink). Same restrictions as for
+     * enableSharedMemory() apply.
+     */
+    void enableNeighborhoodCollectives(bool enable = true)
+    {
+        checkNotStarted();
+        neighborhoodCollectivesEnabled = enable;
+    }
+
+    /**
+     * Sends ghost zones directly from the grid instead of packing
+     * them into buffers first (see PatchLink). Same restrictions as
+     * for enableSharedMemory() apply.
+     */
+    void enableZeroCopy(bool enable = true)
+    {
+        checkNotStarted();
+        zeroCopyEnabled = enable;
+    }
+
     inline void run()
     {
         initSimulation();
@@ -101,7 +143,7 @@ public:
         DistributedSimulator<CELL_TYPE>::addSteerer(steerer);
 
         // two adapters needed, just as for the writers
-        typename UpdateGroupType::PatchProviderPtr adapterGhost(
+        SteererAdapterPtr adapterGhost(
             new SteererAdapterType(
                 steerers.back(),
                 initializer->startStep(),
@@ -126,7 +168,7 @@ public:
         // we need two adapters as each ParallelWriter needs to be
         // notified twice: once for the (inner) ghost zone, and once
         // for the inner set.
-        typename UpdateGroupType::PatchAccepterPtr adapterGhost(
+        ParallelWriterAdapterPtr adapterGhost(
             new ParallelWriterAdapterType(
                 writers.back(),
                 initializer->startStep(),
@@ -159,9 +201,20 @@ private:
     MPILayer mpiLayer;
     typename SharedPtr<UpdateGroupType>::Type updateGroup;
 
-    typename UpdateGroupType::PatchProviderVec steererAdaptersGhost;
+    bool balancingEnabled;
+    bool sharedMemoryEnabled;
+    bool neighborhoodCollectivesEnabled;
+    bool zeroCopyEnabled;
+    Chronometer lastBalancingStatistics;
+    LoadBalancer::WeightVec pendingWeights;
+    long lastRepartitioningNanoStep;
+
+    // the adapters are retained as they need to be handed over to new
+    // Steppers upon repartitioning. Ghost zone adapters are kept with
+    // their actual type as they need to be suspended beforehand.
+    std::vector<SteererAdapterPtr> steererAdaptersGhost;
     typename UpdateGroupType::PatchProviderVec steererAdaptersInner;
-    typename UpdateGroupType::PatchAccepterVec writerAdaptersGhost;
+    std::vector<ParallelWriterAdapterPtr> writerAdaptersGhost;
     typename UpdateGroupType::PatchAccepterVec writerAdaptersInner;
 
     inline void nanoStep(long s)
@@ -175,6 +228,13 @@ private:
         }
     }
 
+    inline void checkNotStarted() const
+    {
+        if (updateGroup) {
+            throw std::logic_error("communication modes can't be changed once the simulation has started");
+        }
+    }
+
     /**
      * We need to do late/lazy initialization to give the user time to
      * add ParallelWriter objects before calling run(). Writers may
@@ -192,8 +252,6 @@ private:
         }
 
         CoordBox<DIM> box = initializer->gridBox();
-        Region<DIM> globalRegion;
-        globalRegion << box;
 
         double mySpeed = APITraits::SelectSpeedGuide<CELL_TYPE>::value();
         std::vector<double> rankSpeeds = mpiLayer.allGather(mySpeed);
@@ -201,54 +259,165 @@ private:
             box.dimensions.prod(),
             rankSpeeds);
 
-        typename SharedPtr<PARTITION>::Type partition(
-            new PARTITION(
-                box.origin,
-                box.dimensions,
-                0,
-                weights,
-                initializer->getAdjacency(globalRegion)));
-
         updateGroup.reset(
             new UpdateGroupType(
-                partition,
+                makePartition(weights),
                 box,
                 ghostZoneWidth,
                 initializer,
                 static_cast<STEPPER*>(0),
-                writerAdaptersGhost,
+                typename UpdateGroupType::PatchAccepterVec(
+                    writerAdaptersGhost.begin(), writerAdaptersGhost.end()),
                 writerAdaptersInner,
-                steererAdaptersGhost,
+                typename UpdateGroupType::PatchProviderVec(
+                    steererAdaptersGhost.begin(), steererAdaptersGhost.end()),
                 steererAdaptersInner,
                 enableFineGrainedParallelism,
-                mpiLayer.communicator()));
+                mpiLayer.communicator(),
+                sharedMemoryEnabled,
+                neighborhoodCollectivesEnabled,
+                zeroCopyEnabled));
 
-        writerAdaptersGhost.clear();
-        writerAdaptersInner.clear();
-        steererAdaptersGhost.clear();
-        steererAdaptersInner.clear();
+        // only the root needs a LoadBalancer, but all ranks need to
+        // know whether to take part in load balancing:
+        balancingEnabled = mpiLayer.broadcast(int(balancer != 0), 0);
+        lastRepartitioningNanoStep = currentNanoStep();
 
         initEvents();
     }
 
+    inline typename SharedPtr<PARTITION>::Type makePartition(const std::vector<std::size_t>& weights)
+    {
+        CoordBox<DIM> box = initializer->gridBox();
+        Region<DIM> globalRegion;
+        globalRegion << box;
+
+        typename SharedPtr<PARTITION>::Type partition(
+            new PARTITION(
+                box.origin,
+                box.dimensions,
+                0,
+                weights,
+                initializer->getAdjacency(globalRegion)));
+
+        typename Initializer<CELL_TYPE>::CellCostsPtr costs = initializer->getCellCosts();
+        if (costs) {
+            partition->setCellCosts(costs);
+        }
+
+        return partition;
+    }
+
     inline long currentNanoStep() const
     {
         std::pair<int, int> now = updateGroup->currentStep();
         return (long)now.first * NANO_STEPS + now.second;
     }
 
+    /**
+     * Gathers the compute/wall clock time ratio of all ranks since
+     * the last load balancing and lets the LoadBalancer derive new
+     * weights from those. If the weights have changed, a
+     * repartitioning is scheduled for the next nano step at which
+     * the domain decomposition can be exchanged.
+     */
     inline void balanceLoad()
     {
+        if (!balancingEnabled || !pendingWeights.empty()) {
+            return;
+        }
+
+        Chronometer stats = updateGroup->statistics();
+        double computeTime =
+            stats.interval<TimeCompute>() - lastBalancingStatistics.interval<TimeCompute>();
+        double totalTime =
+            stats.interval<TimeTotal>() - lastBalancingStatistics.interval<TimeTotal>();
+        lastBalancingStatistics = stats;
+
+        // see Chronometer::ratio() for why 0.5 is used here:
+        double myLoad = (totalTime > 0) ? (computeTime / totalTime) : 0.5;
+        LoadBalancer::LoadVec loads = mpiLayer.gather(myLoad, 0);
+        LoadBalancer::WeightVec oldWeights = updateGroup->getWeights();
+        LoadBalancer::WeightVec newWeights;
+
         if (mpiLayer.rank() == 0) {
-            if (!balancer) {
-                return;
-            }
-
-            LoadBalancer::LoadVec loads(mpiLayer.size(), 1.0);
-            LoadBalancer::WeightVec newWeights =
-                balancer->balance(updateGroup->getWeights(), loads);
-            // fixme: actually balance the load!
+            newWeights = balancer->balance(oldWeights, loads);
+        }
+
+        // all ranks need to fail alike, or the others would wait
+        // forever for rank 0 to join the next collective:
+        newWeights = mpiLayer.broadcastVector(newWeights, 0);
+        if ((newWeights.size() != oldWeights.size()) ||
+            (sum(newWeights) != sum(oldWeights))) {
+            throw std::logic_error("LoadBalancer returned weights which don't maintain invariance");
+        }
+
+        if (newWeights == oldWeights) {
+            return;
+        }
+
+        long nextRepartitioning = nextRepartitioningNanoStep();
+        if (nextRepartitioning >= long(initializer->maxSteps() * NANO_STEPS)) {
+            return;
+        }
+
+        // the current Stepper must not deliver any ghost zone
+        // callbacks beyond the repartitioning as the new Stepper
+        // will recompute the ghost zones for its new region.
+        for (std::size_t i = 0; i < writerAdaptersGhost.size(); ++i) {
+            writerAdaptersGhost[i]->suspendAfter(nextRepartitioning);
+        }
+        for (std::size_t i = 0; i < steererAdaptersGhost.size(); ++i) {
+            steererAdaptersGhost[i]->suspendAfter(nextRepartitioning);
+        }
+
+        pendingWeights = newWeights;
+        events[nextRepartitioning] << REPARTITIONING;
+    }
+
+    /**
+     * Repartitioning is only possible at the beginning of a time
+     * step at which the Stepper has just synchronized its ghost zone
+     * (i.e. every ghostZoneWidth nano steps after the last
+     * repartitioning). Returns the first such nano step in the
+     * future.
+     */
+    inline long nextRepartitioningNanoStep() const
+    {
+        long now = currentNanoStep();
+        long ret = lastRepartitioningNanoStep +
+            ((now - lastRepartitioningNanoStep) / ghostZoneWidth + 1) * ghostZoneWidth;
+
+        while ((ret % NANO_STEPS) != 0) {
+            ret += ghostZoneWidth;
+        }
+
+        return ret;
+    }
+
+    inline void repartition()
+    {
+        for (std::size_t i = 0; i < writerAdaptersGhost.size(); ++i) {
+            writerAdaptersGhost[i]->resume();
         }
+        for (std::size_t i = 0; i < steererAdaptersGhost.size(); ++i) {
+            steererAdaptersGhost[i]->resume();
+        }
+
+        updateGroup->repartition(
+            makePartition(pendingWeights),
+            initializer->gridBox(),
+            static_cast<STEPPER*>(0),
+            typename UpdateGroupType::PatchAccepterVec(
+                writerAdaptersGhost.begin(), writerAdaptersGhost.end()),
+            writerAdaptersInner,
+            typename UpdateGroupType::PatchProviderVec(
+                steererAdaptersGhost.begin(), steererAdaptersGhost.end()),
+            steererAdaptersInner,
+            enableFineGrainedParallelism);
+
+        pendingWeights.clear();
+        lastRepartitioningNanoStep = currentNanoStep();
     }
 };
 
@@ -248,6 +248,11 @@ private:
                 weights,
                 initializer->getAdjacency(globalRegion)));
 
+        typename Initializer<CELL_TYPE>::CellCostsPtr costs = initializer->getCellCosts();
+        if (costs) {
+            partition->setCellCosts(costs);
+        }
+
         std::vector<hpx::future<UpdateGroupPtr> > updateGroupCreationFutures;
 
         for (std::size_t i = localityIndices[rank + 0]; i < localityIndices[rank + 1]; ++i) {
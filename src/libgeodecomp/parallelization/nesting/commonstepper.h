@@ -3,7 +3,6 @@
 
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/parallelization/nesting/stepper.h>
-#include <libgeodecomp/storage/patchbufferfixed.h>
 
 namespace LibGeoDecomp {
 
@@ -23,8 +22,6 @@ public:
     typedef class CommonStepper<CELL_TYPE> ParentType;
     typedef typename ParentType::GridType GridType;
     typedef PartitionManager<Topology> PartitionManagerType;
-    typedef PatchBufferFixed<GridType, GridType, 1> PatchBufferType1;
-    typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
     typedef typename ParentType::PatchProviderVec PatchProviderVec;
 
@@ -105,8 +102,6 @@ protected:
     unsigned validGhostZoneWidth;
     typename SharedPtr<GridType>::Type oldGrid;
     typename SharedPtr<GridType>::Type newGrid;
-    PatchBufferType2 rimBuffer;
-    PatchBufferType1 kernelBuffer;
     Region<DIM> kernelFraction;
     bool enableFineGrainedParallelism;
 
@@ -115,6 +110,7 @@ protected:
         const typename ParentType::PatchType& patchType,
         std::size_t nanoStep)
     {
+        Tracer::setContext(nanoStep, region, patchType);
         TimePatchAccepters t(&chronometer);
 
         for (typename ParentType::PatchAccepterList::iterator i =
@@ -130,6 +126,13 @@ protected:
                     partitionManager->rank());
             }
         }
+
+        for (typename ParentType::PatchAccepterList::iterator i =
+                 patchAccepters[patchType].begin();
+             i != patchAccepters[patchType].end();
+             ++i) {
+            (*i)->releaseGrid();
+        }
     }
 
     virtual inline void notifyPatchProviders(
@@ -137,6 +140,7 @@ protected:
         const typename ParentType::PatchType& patchType,
         std::size_t nanoStep)
     {
+        Tracer::setContext(nanoStep, region, patchType);
         TimePatchProviders t(&chronometer);
 
         for (typename ParentType::PatchProviderList::iterator i =
@@ -169,8 +173,19 @@ protected:
         oldGrid.reset(makeGrid(partitionManager->ownExpandedRegion(), gridBox, topoDim, Topology()));
         newGrid.reset(makeGrid(partitionManager->ownExpandedRegion(), gridBox, topoDim, Topology()));
 
-        initializer->grid(&*oldGrid);
-        *newGrid = *oldGrid;
+        {
+            TimeInput t(&chronometer);
+            initializer->initRegion(&*oldGrid, partitionManager->ownExpandedRegion());
+
+            // the first kernel update will overwrite newGrid's
+            // innerSet(1), so only the remainder of our expanded
+            // region (rim and outer ghost zone) needs to be copied:
+            Region<DIM> halo = partitionManager->ownExpandedRegion();
+            if (ghostZoneWidth() > 0) {
+                halo -= innerSet(1);
+            }
+            copyRegion(*oldGrid, &*newGrid, halo);
+        }
 
         remapRegions(*oldGrid);
 
@@ -181,8 +196,6 @@ protected:
         newGrid->setEdge(oldGrid->getEdge());
 
         resetValidGhostZoneWidth();
-        kernelBuffer = PatchBufferType1(getVolatileKernel());
-        rimBuffer = PatchBufferType2(rim());
 
         return gridBox;
     }
@@ -232,50 +245,6 @@ protected:
         validGhostZoneWidth = ghostZoneWidth();
     }
 
-    inline void saveRim(std::size_t nanoStep)
-    {
-        rimBuffer.pushRequest(nanoStep);
-        rimBuffer.put(
-            *oldGrid,
-            rim(),
-            partitionManager->getSimulationArea(),
-            nanoStep,
-            partitionManager->rank());
-    }
-
-    inline void restoreRim(bool remove)
-    {
-        rimBuffer.get(
-            &*oldGrid,
-            rim(),
-            partitionManager->getSimulationArea(),
-            globalNanoStep(),
-            partitionManager->rank(),
-            remove);
-    }
-
-    inline void saveKernel()
-    {
-        kernelBuffer.pushRequest(globalNanoStep());
-        kernelBuffer.put(
-            *oldGrid,
-            innerSet(ghostZoneWidth()),
-            partitionManager->getSimulationArea(),
-            globalNanoStep(),
-            partitionManager->rank());
-    }
-
-    inline void restoreKernel()
-    {
-        kernelBuffer.get(
-            &*oldGrid,
-            getVolatileKernel(),
-            partitionManager->getSimulationArea(),
-            globalNanoStep(),
-            partitionManager->rank(),
-            true);
-    }
-
     inline GridType *makeGrid(
         const Region<DIM>& region,
         const CoordBox<DIM>& /* unused: boundingBox */,
@@ -295,6 +264,40 @@ protected:
         return new GridType(boundingBox, CELL_TYPE(), CELL_TYPE(), topoDim);
     }
 
+    inline void copyRegion(const GridType& source, GridType *target, const Region<DIM>& region) const
+    {
+        copyRegion(source, target, region, Topology());
+    }
+
+    /**
+     * Unstructured grids carry more state than just their cells
+     * (e.g. weights, ID remapping), so we copy them wholesale.
+     */
+    inline void copyRegion(
+        const GridType& source,
+        GridType *target,
+        const Region<DIM>& /* unused: region */,
+        const Topologies::Unstructured::Topology& /* unused: topo */) const
+    {
+        *target = source;
+    }
+
+    template<typename TOPOLOGY>
+    inline void copyRegion(
+        const GridType& source,
+        GridType *target,
+        const Region<DIM>& region,
+        const TOPOLOGY& /* unused: topo */) const
+    {
+        std::vector<CELL_TYPE> buffer;
+
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            buffer.resize(std::size_t(i->length()));
+            source.get(*i, &buffer[0]);
+            target->set(*i, &buffer[0]);
+        }
+    }
+
     void remapRegions(const GridType& grid)
     {
         remappedInnerSets.reserve(ghostZoneWidth() + 1);
@@ -268,8 +268,6 @@ public:
     typedef typename ParentType::GridType GridType;
     typedef CUDAGrid<CELL_TYPE, Topology, true> CUDAGridType;
     typedef PartitionManager<Topology> PartitionManagerType;
-    typedef PatchBufferFixed<GridType, GridType, 1> PatchBufferType1;
-    typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
     typedef typename ParentType::PatchProviderVec PatchProviderVec;
 
@@ -282,16 +280,12 @@ public:
     using CommonStepper<CELL_TYPE>::notifyPatchProviders;
 
     using CommonStepper<CELL_TYPE>::innerSet;
-    using CommonStepper<CELL_TYPE>::saveKernel;
-    using CommonStepper<CELL_TYPE>::restoreRim;
     using CommonStepper<CELL_TYPE>::globalNanoStep;
     using CommonStepper<CELL_TYPE>::rim;
     using CommonStepper<CELL_TYPE>::resetValidGhostZoneWidth;
     using CommonStepper<CELL_TYPE>::initGridsCommon;
     using CommonStepper<CELL_TYPE>::getVolatileKernel;
-    using CommonStepper<CELL_TYPE>::saveRim;
     using CommonStepper<CELL_TYPE>::getInnerRim;
-    using CommonStepper<CELL_TYPE>::restoreKernel;
 
     using CommonStepper<CELL_TYPE>::curStep;
     using CommonStepper<CELL_TYPE>::curNanoStep;
@@ -299,8 +293,6 @@ public:
     using CommonStepper<CELL_TYPE>::ghostZoneWidth;
     using CommonStepper<CELL_TYPE>::oldGrid;
     using CommonStepper<CELL_TYPE>::newGrid;
-    using CommonStepper<CELL_TYPE>::rimBuffer;
-    using CommonStepper<CELL_TYPE>::kernelBuffer;
     using CommonStepper<CELL_TYPE>::kernelFraction;
 
     using typename ParentType::InitPtr;
@@ -571,8 +563,6 @@ private:
             curNanoStep = oldNanoStep;
             curStep = oldStep;
 
-            // fixme: we don't need this any longer, as the kernel is handled on the device
-            // saveRim(curGlobalNanoStep);
             if (ghostZoneWidth() % 2) {
                 swap(oldGrid, newGrid);
             }
@@ -24,8 +24,6 @@ public:
     typedef VanillaStepper<CELL_TYPE, CONCURRENCY_SPEC> ParentType;
     typedef typename ParentType::GridType GridType;
     typedef PartitionManager<Topology> PartitionManagerType;
-    typedef PatchBufferFixed<GridType, GridType, 1> PatchBufferType1;
-    typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
     typedef typename ParentType::PatchProviderVec PatchProviderVec;
 
@@ -40,8 +38,6 @@ public:
     using ParentType::ghostZoneWidth;
     using ParentType::oldGrid;
     using ParentType::newGrid;
-    using ParentType::rimBuffer;
-    using ParentType::kernelBuffer;
     using ParentType::kernelFraction;
     using ParentType::enableFineGrainedParallelism;
 
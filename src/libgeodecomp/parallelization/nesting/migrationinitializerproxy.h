@@ -0,0 +1,112 @@
+#ifndef LIBGEODECOMP_PARALLELIZATION_NESTING_MIGRATIONINITIALIZERPROXY_H
+#define LIBGEODECOMP_PARALLELIZATION_NESTING_MIGRATIONINITIALIZERPROXY_H
+
+#include <libgeodecomp/io/initializer.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * This Initializer is used to hand over cells which have been
+ * migrated between ranks (e.g. after load balancing) to a freshly
+ * created Stepper. Instead of setting up the grid from scratch it
+ * restores the patches which were added via addPatch(). All other
+ * queries are forwarded to the wrapped Initializer, except for
+ * startStep(), which yields the time step at which the migration
+ * took place.
+ *
+ * The patches are released once grid() has been called, as Steppers
+ * only need to initialize their grids once.
+ */
+template<typename CELL>
+class MigrationInitializerProxy : public Initializer<CELL>
+{
+public:
+    typedef typename Initializer<CELL>::AdjacencyPtr AdjacencyPtr;
+    typedef typename Initializer<CELL>::CellCostsPtr CellCostsPtr;
+    typedef typename Initializer<CELL>::Topology Topology;
+    typedef typename SharedPtr<Initializer<CELL> >::Type InitPtr;
+    typedef typename SerializationBuffer<CELL>::BufferType BufferType;
+
+    const static int DIM = Topology::DIM;
+
+    MigrationInitializerProxy(
+        InitPtr delegate,
+        unsigned currentStep,
+        const CELL& edgeCell) :
+        delegate(delegate),
+        currentStep(currentStep),
+        edgeCell(edgeCell)
+    {}
+
+    /**
+     * Stores a copy of the cells in region, serialized to buffer.
+     */
+    void addPatch(const BufferType& buffer, const Region<DIM>& region)
+    {
+        buffers << buffer;
+        regions << region;
+    }
+
+    virtual void grid(GridBase<CELL, DIM> *target)
+    {
+        target->setEdge(edgeCell);
+
+        for (std::size_t i = 0; i < regions.size(); ++i) {
+            target->loadRegion(buffers[i], regions[i]);
+        }
+
+        buffers.clear();
+        regions.clear();
+    }
+
+    virtual Coord<DIM> gridDimensions() const
+    {
+        return delegate->gridDimensions();
+    }
+
+    virtual CoordBox<DIM> gridBox()
+    {
+        return delegate->gridBox();
+    }
+
+    virtual unsigned startStep() const
+    {
+        return currentStep;
+    }
+
+    virtual unsigned maxSteps() const
+    {
+        return delegate->maxSteps();
+    }
+
+    virtual AdjacencyPtr getAdjacency(const Region<DIM>& region) const
+    {
+        return delegate->getAdjacency(region);
+    }
+
+    virtual AdjacencyPtr getReverseAdjacency(const Region<DIM>& region) const
+    {
+        // getReverseAdjacency() is private in Initializer, hence the detour:
+        const AdjacencyManufacturer<DIM>& manufacturer = *delegate;
+        return manufacturer.getReverseAdjacency(region);
+    }
+
+    virtual CellCostsPtr getCellCosts() const
+    {
+        return delegate->getCellCosts();
+    }
+
+private:
+    InitPtr delegate;
+    unsigned currentStep;
+    CELL edgeCell;
+    std::vector<BufferType> buffers;
+    std::vector<Region<DIM> > regions;
+};
+
+}
+
+#endif
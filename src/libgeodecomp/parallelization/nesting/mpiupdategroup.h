@@ -4,8 +4,11 @@
 #include <libgeodecomp/config.h>
 #ifdef LIBGEODECOMP_WITH_MPI
 
+#include <libgeodecomp/communication/collectivepatchlink.h>
 #include <libgeodecomp/communication/mpilayer.h>
 #include <libgeodecomp/communication/patchlink.h>
+#include <libgeodecomp/communication/sharedmemorypatchlink.h>
+#include <libgeodecomp/parallelization/nesting/migrationinitializerproxy.h>
 #include <libgeodecomp/parallelization/nesting/updategroup.h>
 
 namespace LibGeoDecomp {
@@ -15,6 +18,27 @@ class HiParSimulatorTest;
 /**
  * This is an implementation of the UpdateGroup for MPI-based
  * hiearchical Simulators, e.g. the HiParSimulator.
+ *
+ * If enableSharedMemory is set, ghost zones are exchanged between
+ * ranks on the same node via a SharedMemoryPatchLink, so neighbors
+ * copy them directly from each other's memory. Ranks on other nodes
+ * (and grids which don't support this, see
+ * PatchLinkHelpers::SelectZeroCopy) will still use PatchLinks.
+ *
+ * enableNeighborhoodCollectives replaces the PatchLinks to the
+ * remaining ranks by CollectivePatchLinks, which bundle all ghost
+ * zone transfers of a sync point into a single neighborhood
+ * collective. This has the same restrictions as the shared memory
+ * mode.
+ *
+ * enableZeroCopy lets the remaining PatchLink Accepters send ghost
+ * zones directly from the grid via derived MPI datatypes. This saves
+ * the copy to the send buffers, but the Stepper then has to wait for
+ * these sends to complete once it has handed the ghost zone to all
+ * neighbors (see PatchAccepter::releaseGrid()). Buffered sends don't
+ * need to be waited for, hence it's disabled by default.
+ *
+ * All ranks need to agree on all three flags.
  */
 template<class CELL_TYPE>
 class MPIUpdateGroup : public UpdateGroup<CELL_TYPE, PatchLink>
@@ -32,9 +56,17 @@ public:
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PartitionPtr PartitionPtr;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchLinkAccepterPtr PatchLinkAccepterPtr;
     typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PatchLinkProviderPtr PatchLinkProviderPtr;
+    typedef typename UpdateGroup<CELL_TYPE, PatchLink>::PartitionManagerType PartitionManagerType;
+    typedef typename UpdateGroup<CELL_TYPE, PatchLink>::RegionVecMap RegionVecMap;
+    typedef typename UpdateGroup<CELL_TYPE, PatchLink>::GridType GridType;
+    typedef typename SerializationBuffer<CELL_TYPE>::BufferType BufferType;
 
     using UpdateGroup<CELL_TYPE, PatchLink>::init;
+    using UpdateGroup<CELL_TYPE, PatchLink>::ghostZoneWidth;
+    using UpdateGroup<CELL_TYPE, PatchLink>::initializer;
+    using UpdateGroup<CELL_TYPE, PatchLink>::partitionManager;
     using UpdateGroup<CELL_TYPE, PatchLink>::rank;
+    using UpdateGroup<CELL_TYPE, PatchLink>::stepper;
 
     const static int DIM = UpdateGroup<CELL_TYPE, PatchLink>::DIM;
 
@@ -50,10 +82,21 @@ public:
         PatchProviderVec patchProvidersGhost = PatchProviderVec(),
         PatchProviderVec patchProvidersInner = PatchProviderVec(),
         bool enableFineGrainedParallelism = false,
-        MPI_Comm communicator = MPI_COMM_WORLD) :
+        MPI_Comm communicator = MPI_COMM_WORLD,
+        bool enableSharedMemory = false,
+        bool enableNeighborhoodCollectives = false,
+        bool enableZeroCopy = false) :
         UpdateGroup<CELL_TYPE, PatchLink>(ghostZoneWidth, initializer, MPILayer(communicator).rank()),
-        mpiLayer(communicator)
+        mpiLayer(communicator),
+        enableNeighborhoodCollectives(enableNeighborhoodCollectives && SupportsCollectives()),
+        enableZeroCopy(enableZeroCopy)
     {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        if (enableSharedMemory && SupportsSharedMemory()) {
+            window.reset(new SharedMemoryWindow(communicator));
+        }
+#endif
+
         init(
             partition,
             box,
@@ -68,7 +111,22 @@ public:
     }
 
 private:
+    typedef CollectivePatchLink<GridType> CollectiveLink;
+    typedef typename CollectiveLink::Exchange CollectiveExchange;
+    typedef typename CollectiveLink::ExchangePtr CollectiveExchangePtr;
+    typedef typename CollectiveLink::Supported SupportsCollectives;
+
     MPILayer mpiLayer;
+    bool enableNeighborhoodCollectives;
+    bool enableZeroCopy;
+    CollectiveExchangePtr exchange;
+#ifdef LIBGEODECOMP_WITH_CPP14
+    typedef SharedMemoryPatchLink<GridType> SharedMemoryLink;
+    typedef typename SharedMemoryLink::Window SharedMemoryWindow;
+    typedef typename SharedMemoryLink::Supported SupportsSharedMemory;
+
+    typename SharedPtr<SharedMemoryWindow>::Type window;
+#endif
 
     std::vector<CoordBox<DIM> > gatherBoundingBoxes(
         const CoordBox<DIM>& ownBoundingBox,
@@ -80,20 +138,255 @@ private:
         return boundingBoxes;
     }
 
+    virtual InitPtr migrateCells(
+        PartitionManagerType& oldPartitionManager,
+        unsigned currentStep)
+    {
+        typedef MigrationInitializerProxy<CELL_TYPE> ProxyType;
+
+        // pre-posted receives of other ranks' old PatchLinks might
+        // otherwise intercept patches sent by our new ones:
+        mpiLayer.barrier();
+
+        const GridType& grid = stepper->grid();
+        typename SharedPtr<ProxyType>::Type proxy(
+            new ProxyType(initializer, currentStep, grid.getEdge()));
+
+        const Region<DIM>& oldRegion = oldPartitionManager.ownRegion();
+        const Region<DIM>& newRegion = partitionManager->ownExpandedRegion();
+        CoordBox<DIM> oldBoundingBox = oldRegion.boundingBox();
+        CoordBox<DIM> newBoundingBox = newRegion.boundingBox();
+
+        // cells which stay on this rank don't need to travel:
+        Region<DIM> remainingRegion = oldRegion & newRegion;
+        if (!remainingRegion.empty()) {
+            BufferType buffer;
+            SerializationBuffer<CELL_TYPE>::resize(&buffer, remainingRegion.size());
+            grid.saveRegion(&buffer, remainingRegion);
+            proxy->addPatch(buffer, remainingRegion);
+        }
+
+        std::vector<int> sources;
+        std::vector<int> targets;
+        std::vector<Region<DIM> > recvRegions;
+        std::vector<Region<DIM> > sendRegions;
+
+        // only ranks with intersecting bounding boxes need to be checked:
+        std::vector<std::size_t> candidates = oldPartitionManager.findNodes(newBoundingBox);
+        for (std::vector<std::size_t>::iterator i = candidates.begin(); i != candidates.end(); ++i) {
+            if (*i == rank) {
+                continue;
+            }
+
+            Region<DIM> incoming = oldPartitionManager.clippedRegion(*i, newRegion, 0)[0];
+            if (!incoming.empty()) {
+                sources << int(*i);
+                recvRegions << incoming;
+            }
+        }
+
+        // remote regions are clipped before they are expanded, so we
+        // don't pay for expanding them in full:
+        Region<DIM> oldVicinity = partitionManager->vicinity(oldRegion, ghostZoneWidth);
+        candidates = partitionManager->findNodesExpanded(oldBoundingBox);
+        for (std::vector<std::size_t>::iterator i = candidates.begin(); i != candidates.end(); ++i) {
+            if (*i == rank) {
+                continue;
+            }
+
+            Region<DIM> outgoing =
+                oldRegion & partitionManager->clippedRegion(*i, oldVicinity, ghostZoneWidth).back();
+            if (!outgoing.empty()) {
+                targets << int(*i);
+                sendRegions << outgoing;
+            }
+        }
+
+        // buffer sizes are exchanged first as they can't be deduced
+        // from the Regions for cells with variable serialized size
+        // (e.g. when using Boost.Serialization):
+        std::vector<int> recvSizes(sources.size());
+        std::vector<int> sendSizes(targets.size());
+        std::vector<BufferType> recvBuffers(sources.size());
+        std::vector<BufferType> sendBuffers(targets.size());
+
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            mpiLayer.recv(&recvSizes[i], sources[i], 1, MPILayer::CELL_MIGRATION, MPI_INT);
+        }
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            SerializationBuffer<CELL_TYPE>::resize(&sendBuffers[i], sendRegions[i].size());
+            grid.saveRegion(&sendBuffers[i], sendRegions[i]);
+            sendSizes[i] = sendBuffers[i].size();
+            mpiLayer.send(&sendSizes[i], targets[i], 1, MPILayer::CELL_MIGRATION, MPI_INT);
+        }
+        mpiLayer.wait(MPILayer::CELL_MIGRATION);
+
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            recvBuffers[i].resize(recvSizes[i]);
+            mpiLayer.recv(
+                recvBuffers[i].data(),
+                sources[i],
+                recvSizes[i],
+                MPILayer::CELL_MIGRATION,
+                SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+        }
+        for (std::size_t i = 0; i < targets.size(); ++i) {
+            mpiLayer.send(
+                sendBuffers[i].data(),
+                targets[i],
+                sendSizes[i],
+                MPILayer::CELL_MIGRATION,
+                SerializationBuffer<CELL_TYPE>::cellMPIDataType());
+        }
+        mpiLayer.wait(MPILayer::CELL_MIGRATION);
+
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            proxy->addPatch(recvBuffers[i], recvRegions[i]);
+        }
+
+        return proxy;
+    }
+
+    /**
+     * Sets up the shared memory window for the patches we send to
+     * ranks on our node and the Exchange for those to other nodes.
+     */
+    virtual void preparePatchLinks()
+    {
+        std::map<int, Region<DIM> > localOutgoing;
+        std::map<int, Region<DIM> > remoteOutgoing;
+        std::map<int, Region<DIM> > localIncoming;
+        std::map<int, Region<DIM> > remoteIncoming;
+        sortFragments(partitionManager->getInnerGhostZoneFragments(), &localOutgoing, &remoteOutgoing);
+        sortFragments(partitionManager->getOuterGhostZoneFragments(), &localIncoming, &remoteIncoming);
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+        if (window) {
+            window->allocate(localOutgoing);
+        }
+#endif
+
+        if (enableNeighborhoodCollectives) {
+            exchange.reset(
+                new CollectiveExchange(
+                    remoteOutgoing,
+                    remoteIncoming,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                    mpiLayer.communicator()));
+        }
+    }
+
+    /**
+     * Sorts the (non-empty) ghost zone fragments by whether the
+     * corresponding rank resides on our node.
+     */
+    void sortFragments(
+        const RegionVecMap& fragments,
+        std::map<int, Region<DIM> > *local,
+        std::map<int, Region<DIM> > *remote) const
+    {
+        for (typename RegionVecMap::const_iterator i = fragments.begin(); i != fragments.end(); ++i) {
+            if ((i->first < 0) || i->second.back().empty()) {
+                continue;
+            }
+
+            if (isNodeLocal(i->first)) {
+                (*local)[i->first] = i->second.back();
+            } else {
+                (*remote)[i->first] = i->second.back();
+            }
+        }
+    }
+
+    bool isNodeLocal(int peer) const
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        return window && (peer >= 0) && window->isLocal(peer);
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * The Exchange's collective needs to be started on all ranks,
+     * regardless of whether they have any CollectivePatchLinks.
+     */
+    virtual PatchLinkAccepterPtr makeSyncPointAccepter()
+    {
+        if (!exchange) {
+            return PatchLinkAccepterPtr();
+        }
+
+        return PatchLinkAccepterPtr(
+            new typename CollectiveLink::SyncPoint(
+                SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                exchange,
+                mpiLayer.communicator()));
+    }
+
     virtual PatchLinkAccepterPtr makePatchLinkAccepter(int target, const Region<DIM>& region)
     {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        if (isNodeLocal(target)) {
+            return PatchLinkAccepterPtr(
+                new typename SharedMemoryLink::Accepter(
+                    region,
+                    target,
+                    MPILayer::PATCH_LINK,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                    *window,
+                    rank));
+        }
+#endif
+
+        if (exchange) {
+            return PatchLinkAccepterPtr(
+                new typename CollectiveLink::Accepter(
+                    region,
+                    target,
+                    MPILayer::PATCH_LINK,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                    exchange,
+                    mpiLayer.communicator()));
+        }
+
         return PatchLinkAccepterPtr(
             new PatchLinkAccepter(
                 region,
                 target,
                 MPILayer::PATCH_LINK,
                 SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
-                mpiLayer.communicator()));
-
+                mpiLayer.communicator(),
+                PatchLink<GridType>::DEFAULT_NUM_BUFFERS,
+                enableZeroCopy));
     }
 
     virtual PatchLinkProviderPtr makePatchLinkProvider(int source, const Region<DIM>& region)
     {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        if (isNodeLocal(source)) {
+            return PatchLinkProviderPtr(
+                new typename SharedMemoryLink::Provider(
+                    region,
+                    source,
+                    MPILayer::PATCH_LINK,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                    *window,
+                    rank));
+        }
+#endif
+
+        if (exchange) {
+            return PatchLinkProviderPtr(
+                new typename CollectiveLink::Provider(
+                    region,
+                    source,
+                    MPILayer::PATCH_LINK,
+                    SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                    exchange,
+                    mpiLayer.communicator()));
+        }
+
         return PatchLinkProviderPtr(
             new PatchLinkProvider(
                 region,
@@ -4,50 +4,283 @@
 #include <libgeodecomp/config.h>
 #ifdef LIBGEODECOMP_WITH_THREADS
 
-#include <libgeodecomp/parallelization/nesting/commonstepper.h>
-#include <libgeodecomp/storage/patchbufferfixed.h>
+#include <libgeodecomp/parallelization/nesting/vanillastepper.h>
 
 namespace LibGeoDecomp {
 
+namespace MultiCoreStepperHelpers {
+
+/**
+ * Wavefront blocking relies on cells only accessing spatially close
+ * neighbors, which doesn't hold for unstructured grids.
+ */
+template<typename TOPOLOGY>
+class SupportsWavefront
+{
+public:
+    static const bool VALUE = true;
+};
+
+template<>
+class SupportsWavefront<Topologies::Unstructured::Topology>
+{
+public:
+    static const bool VALUE = false;
+};
+
+}
+
 /**
  * MultiCoreStepper is an OpenMP-enabled implementation of the Stepper
- * concept.
+ * concept. It inherits the ghost zone handling from VanillaStepper,
+ * but exploits wide ghost zones for temporal blocking of the kernel
+ * update: instead of sweeping the whole inner set once per nano
+ * step, it splits the grid into slabs along the last axis and
+ * advances them by multiple nano steps in a wavefront. Within each
+ * step a slab is updated by all threads (using static scheduling so
+ * that threads keep working on the same streaks). Slabs are sized so
+ * that all slabs touched by one wavefront fit into the cache (see
+ * DEFAULT_CACHE_SIZE), hence memory-bound kernels read each cell
+ * only once from main memory per block of nano steps.
+ *
+ * Blocks end whenever the ghost zone needs to be synchronized or an
+ * inner set PatchAccepter/PatchProvider needs to be served, so the
+ * results are identical to those of VanillaStepper. Unstructured
+ * grids and domains wrapping around the blocking axis fall back to
+ * stepwise updates.
  *
  * fixme: how to handle threading if user code has a multithreaded
  *        update() itself? (e.g. n-body codes)
- *
- * fixme: cache blocking?
- *
- * fixme: mpi pacing?
  */
 template<typename CELL_TYPE>
-class MultiCoreStepper : public CommonStepper<CELL_TYPE>
+class MultiCoreStepper : public VanillaStepper<CELL_TYPE, UpdateFunctorHelpers::ConcurrencyEnableOpenMP>
 {
 public:
-    typedef typename Stepper<CELL_TYPE>::Topology Topology;
-    typedef typename Stepper<CELL_TYPE>::InitPtr InitPtr;
-    typedef typename Stepper<CELL_TYPE>::PartitionManagerPtr PartitionManagerPtr;
-    typedef class Stepper<CELL_TYPE> ParentType;
+    friend class MultiCoreStepperTest;
+
+    typedef UpdateFunctorHelpers::ConcurrencyEnableOpenMP ConcurrencySpec;
+    typedef VanillaStepper<CELL_TYPE, ConcurrencySpec> ParentType;
+    typedef typename ParentType::Topology Topology;
     typedef typename ParentType::GridType GridType;
-    typedef PartitionManager<Topology> PartitionManagerType;
-    typedef PatchBufferFixed<GridType, GridType, 1> PatchBufferType1;
-    typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
+    typedef typename ParentType::PatchProviderVec PatchProviderVec;
+    typedef typename ParentType::PatchAccepterList PatchAccepterList;
+    typedef typename ParentType::PatchProviderList PatchProviderList;
+    typedef typename ParentType::InitPtr InitPtr;
+    typedef typename ParentType::PartitionManagerPtr PartitionManagerPtr;
+    typedef typename APITraits::SelectStencil<CELL_TYPE>::Value Stencil;
 
     const static int DIM = Topology::DIM;
     const static unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL_TYPE>::VALUE;
 
+    /**
+     * Amount of memory (in bytes) which all slabs of one wavefront
+     * (in both grids) should fit into. Chosen to match a typical
+     * last level cache share.
+     */
+    static const std::size_t DEFAULT_CACHE_SIZE = 4 << 20;
+
+    using ParentType::chronometer;
+    using ParentType::curNanoStep;
+    using ParentType::curStep;
+    using ParentType::enableFineGrainedParallelism;
+    using ParentType::finishKernelUpdate;
+    using ParentType::ghostZoneWidth;
+    using ParentType::globalNanoStep;
+    using ParentType::initializer;
+    using ParentType::newGrid;
+    using ParentType::oldGrid;
+    using ParentType::patchAccepters;
+    using ParentType::patchProviders;
+    using ParentType::remappedInnerSet;
+    using ParentType::update1;
+    using ParentType::validGhostZoneWidth;
+
     inline MultiCoreStepper(
         PartitionManagerPtr partitionManager,
         InitPtr initializer,
         const PatchAccepterVec& ghostZonePatchAccepters = PatchAccepterVec(),
-        const PatchAccepterVec& innerSetPatchAccepters = PatchAccepterVec()) :
-        CommonStepper<CELL_TYPE>(
+        const PatchAccepterVec& innerSetPatchAccepters = PatchAccepterVec(),
+        const PatchProviderVec& ghostZonePatchProvidersPhase0 = PatchProviderVec(),
+        const PatchProviderVec& ghostZonePatchProvidersPhase1 = PatchProviderVec(),
+        const PatchProviderVec& innerSetPatchProviders = PatchProviderVec(),
+        bool enableFineGrainedParallelism = false) :
+        ParentType(
             partitionManager,
             initializer,
             ghostZonePatchAccepters,
-            innerSetPatchAccepters)
-    {}
+            innerSetPatchAccepters,
+            ghostZonePatchProvidersPhase0,
+            ghostZonePatchProvidersPhase1,
+            innerSetPatchProviders,
+            enableFineGrainedParallelism)
+    {
+        initSlabs(DEFAULT_CACHE_SIZE);
+    }
+
+    inline virtual void update(std::size_t nanoSteps)
+    {
+        while (nanoSteps > 0) {
+            std::size_t blockLength = (std::min)(nanoSteps, maxBlockLength());
+
+            if (blockLength > 1) {
+                updateBlock(blockLength);
+            } else {
+                update1();
+            }
+
+            nanoSteps -= blockLength;
+        }
+    }
+
+private:
+    /**
+     * slabs[i][j] holds the j-th slab of the (remapped) inner set i.
+     * Empty if wavefront blocking is not applicable.
+     */
+    std::vector<std::vector<Region<DIM> > > slabs;
+
+    inline void initSlabs(std::size_t cacheSize)
+    {
+        slabs.clear();
+        CoordBox<DIM> box = oldGrid->boundingBox();
+        long extent = box.dimensions[DIM - 1];
+        if (!MultiCoreStepperHelpers::SupportsWavefront<Topology>::VALUE || (box.dimensions.prod() == 0)) {
+            return;
+        }
+
+        // Cells near the ends of a periodic axis would depend on each
+        // other, breaking the wavefront's order.
+        if (Topology::template WrapsAxis<DIM - 1>::VALUE &&
+            (extent >= initializer->gridDimensions()[DIM - 1])) {
+            return;
+        }
+
+        // the wavefront keeps up to ghostZoneWidth() + 2 slabs alive
+        // per grid, slabs need to be at least as thick as the
+        // stencil's radius:
+        std::size_t planeSize = box.dimensions.prod() / extent * sizeof(CELL_TYPE);
+        long radius = Stencil::RADIUS;
+        long thickness = cacheSize / (2 * (ghostZoneWidth() + 2) * planeSize);
+        thickness = (std::max)(thickness, (std::max)(radius, 1L));
+        thickness = (std::min)(thickness, extent);
+
+        Coord<DIM> slabDim = box.dimensions;
+        slabDim[DIM - 1] = thickness;
+
+        slabs.resize(ghostZoneWidth() + 1);
+        for (unsigned i = 1; i <= ghostZoneWidth(); ++i) {
+            for (long offset = 0; offset < extent; offset += thickness) {
+                Coord<DIM> slabOrigin = box.origin;
+                slabOrigin[DIM - 1] += offset;
+                Region<DIM> slab;
+                slab << CoordBox<DIM>(slabOrigin, slabDim);
+
+                slabs[i].push_back(remappedInnerSet(i) & slab);
+            }
+        }
+    }
+
+    /**
+     * Number of nano steps which may be computed in one go: blocks
+     * end with the ghost zone's validity or when an inner set
+     * PatchAccepter/PatchProvider is due.
+     */
+    inline std::size_t maxBlockLength()
+    {
+        if (slabs.empty()) {
+            return 1;
+        }
+
+        std::size_t currentNanoStep = globalNanoStep();
+        std::size_t ret = validGhostZoneWidth;
+
+        for (typename PatchAccepterList::iterator i =
+                 patchAccepters[ParentType::INNER_SET].begin();
+             i != patchAccepters[ParentType::INNER_SET].end();
+             ++i) {
+            std::size_t next = (*i)->nextRequiredNanoStep();
+            if (next > currentNanoStep) {
+                ret = (std::min)(ret, next - currentNanoStep);
+            }
+        }
+
+        for (typename PatchProviderList::iterator i =
+                 patchProviders[ParentType::INNER_SET].begin();
+             i != patchProviders[ParentType::INNER_SET].end();
+             ++i) {
+            std::size_t next = (*i)->nextAvailableNanoStep();
+            if (next > currentNanoStep) {
+                ret = (std::min)(ret, next - currentNanoStep);
+            }
+        }
+
+        return ret;
+    }
+
+    /**
+     * Equivalent to blockLength calls of update1(), but reuses
+     * cache-resident data across the nano steps.
+     */
+    inline void updateBlock(std::size_t blockLength)
+    {
+        using std::swap;
+        TimeTotal t(&chronometer);
+        unsigned firstIndex = ghostZoneWidth() - validGhostZoneWidth + 1;
+        Tracer::setContext(globalNanoStep(), remappedInnerSet(firstIndex));
+        {
+            TimeComputeInner t(&chronometer);
+
+            updateWavefront(firstIndex, blockLength);
+            if (blockLength % 2) {
+                swap(oldGrid, newGrid);
+            }
+
+            validGhostZoneWidth -= blockLength;
+            for (std::size_t i = 0; i < blockLength; ++i) {
+                ++curNanoStep;
+                if (curNanoStep == NANO_STEPS) {
+                    curNanoStep = 0;
+                    ++curStep;
+                }
+            }
+        }
+
+        finishKernelUpdate();
+    }
+
+    /**
+     * Stage s updates slab j to nano step s + 1 (relative to the
+     * beginning of the block) when the wavefront reaches j + s. By
+     * then slabs j - 1, j, and j + 1 have been advanced to step s,
+     * and none of them will be overwritten with step s + 2 before
+     * stage s has read them, as long as slabs are at least as thick
+     * as the stencil's radius.
+     */
+    inline void updateWavefront(unsigned firstIndex, std::size_t blockLength)
+    {
+        GridType *grids[] = { &*oldGrid, &*newGrid };
+        std::size_t numSlabs = slabs[firstIndex].size();
+
+        for (std::size_t front = 0; front < (numSlabs + blockLength - 1); ++front) {
+            unsigned nanoStep = curNanoStep;
+
+            for (std::size_t stage = 0; stage < blockLength; ++stage) {
+                if ((stage <= front) && ((front - stage) < numSlabs)) {
+                    UpdateFunctor<CELL_TYPE, ConcurrencySpec>()(
+                        slabs[firstIndex + stage][front - stage],
+                        Coord<DIM>(),
+                        Coord<DIM>(),
+                        *grids[stage % 2],
+                        grids[(stage + 1) % 2],
+                        nanoStep,
+                        ConcurrencySpec(false, enableFineGrainedParallelism));
+                }
+
+                nanoStep = (nanoStep + 1) % NANO_STEPS;
+            }
+        }
+    }
 };
 
 }
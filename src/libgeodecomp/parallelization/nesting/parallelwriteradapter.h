@@ -25,6 +25,7 @@ public:
     static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL_TYPE>::VALUE;
 
     using PatchAccepter<GRID_TYPE>::checkNanoStepPut;
+    using PatchAccepter<GRID_TYPE>::infinity;
     using PatchAccepter<GRID_TYPE>::pushRequest;
     using PatchAccepter<GRID_TYPE>::requestedNanoSteps;
 
@@ -37,7 +38,8 @@ public:
         firstNanoStep(firstStep * NANO_STEPS),
         lastNanoStep(lastStep   * NANO_STEPS),
         stride(writer->getPeriod() * NANO_STEPS),
-        lastCall(lastCall)
+        lastCall(lastCall),
+        suspensionNanoStep(infinity())
     {
         pushRequest(firstNanoStep);
         pushRequest(lastNanoStep);
@@ -48,6 +50,32 @@ public:
         writer->setRegion(region);
     }
 
+    virtual std::size_t nextRequiredNanoStep() const
+    {
+        std::size_t ret = PatchAccepter<GRID_TYPE>::nextRequiredNanoStep();
+        if (ret > suspensionNanoStep) {
+            return infinity();
+        }
+
+        return ret;
+    }
+
+    /**
+     * Hides all requests for nano steps past the given one until
+     * resume() is called. This keeps a Stepper which is about to be
+     * replaced (e.g. during repartitioning) from running ahead with
+     * its ghost zone output. The new Stepper will then take over.
+     */
+    void suspendAfter(const std::size_t nanoStep)
+    {
+        suspensionNanoStep = nanoStep;
+    }
+
+    void resume()
+    {
+        suspensionNanoStep = infinity();
+    }
+
     virtual void put(
         const GRID_TYPE& grid,
         const Region<GRID_TYPE::DIM>& validRegion,
@@ -94,6 +122,7 @@ private:
     std::size_t lastNanoStep;
     std::size_t stride;
     bool lastCall;
+    std::size_t suspensionNanoStep;
 };
 
 }
@@ -24,6 +24,7 @@ public:
 
     using PatchProvider<GRID_TYPE>::storedNanoSteps;
     using PatchProvider<GRID_TYPE>::get;
+    using PatchProvider<GRID_TYPE>::infinity;
 
     SteererAdapter(
         SteererPtr steerer,
@@ -33,7 +34,8 @@ public:
         steerer(steerer),
         firstNanoStep(firstStep * NANO_STEPS),
         lastNanoStep(lastStep   * NANO_STEPS),
-        lastCall(lastCall)
+        lastCall(lastCall),
+        suspensionNanoStep(infinity())
     {
         std::size_t firstRegularEventStep = firstStep;
         std::size_t period = steerer->getPeriod();
@@ -50,6 +52,30 @@ public:
         steerer->setRegion(region);
     }
 
+    virtual std::size_t nextAvailableNanoStep() const
+    {
+        std::size_t ret = PatchProvider<GRID_TYPE>::nextAvailableNanoStep();
+        if (ret > suspensionNanoStep) {
+            return infinity();
+        }
+
+        return ret;
+    }
+
+    /**
+     * Hides all steering events past the given nano step until
+     * resume() is called. See ParallelWriterAdapter::suspendAfter().
+     */
+    void suspendAfter(const std::size_t nanoStep)
+    {
+        suspensionNanoStep = nanoStep;
+    }
+
+    void resume()
+    {
+        suspensionNanoStep = infinity();
+    }
+
     virtual void get(
         GRID_TYPE *destinationGrid,
         const Region<DIM>& patchableRegion,
@@ -113,6 +139,7 @@ private:
     std::size_t firstNanoStep;
     std::size_t lastNanoStep;
     bool lastCall;
+    std::size_t suspensionNanoStep;
 };
 
 }
@@ -4,52 +4,157 @@
 #include <libgeodecomp/io/testinitializer.h>
 #include <libgeodecomp/misc/testhelper.h>
 #include <libgeodecomp/parallelization/nesting/multicorestepper.h>
+#include <libgeodecomp/parallelization/nesting/vanillastepper.h>
 #include <libgeodecomp/storage/mockpatchaccepter.h>
 
 using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
-class MulticoreStepperTest : public CxxTest::TestSuite
+class MultiCoreStepperTest : public CxxTest::TestSuite
 {
 public:
-    typedef APITraits::SelectTopology<TestCell<2> >::Value Topology;
-    typedef DisplacedGrid<TestCell<2>, Topology, true> GridType;
+    typedef TestCell<
+        3,
+        Stencils::Moore<3, 1>,
+        Topologies::Torus<3>::Topology,
+        TestCellHelpers::EmptyAPI,
+        TestCellHelpers::NoOutput> TestCell3D;
+
+    typedef APITraits::SelectTopology<TestCell<2> >::Value Topology2D;
+    typedef APITraits::SelectTopology<TestCell3D>::Value Topology3D;
+#ifdef LIBGEODECOMP_WITH_THREADS
+    typedef MultiCoreStepper<TestCell<2> > StepperType2D;
+    typedef MultiCoreStepper<TestCell3D> StepperType3D;
+    typedef StepperType2D::GridType GridType2D;
+    typedef VanillaStepper<TestCell3D, UpdateFunctorHelpers::ConcurrencyNoP> ReferenceStepperType;
+#endif
+
+    void testUpdate()
+    {
 #ifdef LIBGEODECOMP_WITH_THREADS
-    typedef MultiCoreStepper<TestCell<2> > StepperType;
+        SharedPtr<TestInitializer<TestCell<2> > >::Type init(
+            new TestInitializer<TestCell<2> >(Coord<2>(17, 12)));
+        SharedPtr<PartitionManager<Topology2D> >::Type partitionManager =
+            makePartitionManager<Topology2D>(init->gridBox(), 1, 0, 3);
+        StepperType2D stepper(partitionManager, init);
+
+        // single process, no periodic boundaries, hence wavefront
+        // blocking should be enabled:
+        TS_ASSERT_EQUALS(std::size_t(4), stepper.slabs.size());
+
+        TS_ASSERT_TEST_GRID(GridType2D, stepper.grid(), 0);
+        stepper.update(1);
+        TS_ASSERT_TEST_GRID(GridType2D, stepper.grid(), 1);
+        stepper.update(3);
+        TS_ASSERT_TEST_GRID(GridType2D, stepper.grid(), 4);
+        stepper.update(32);
+        TS_ASSERT_TEST_GRID(GridType2D, stepper.grid(), 36);
 #endif
+    }
 
-    void setUp()
+    void testInnerSetPatchAcceptersLimitBlocks()
     {
-        init.reset(new TestInitializer<TestCell<2> >(Coord<2>(17, 12)));
-        CoordBox<2> rect = init->gridBox();
+#ifdef LIBGEODECOMP_WITH_THREADS
+        SharedPtr<TestInitializer<TestCell<2> > >::Type init(
+            new TestInitializer<TestCell<2> >(Coord<2>(17, 12)));
+        SharedPtr<PartitionManager<Topology2D> >::Type partitionManager =
+            makePartitionManager<Topology2D>(init->gridBox(), 1, 0, 4);
+        StepperType2D stepper(partitionManager, init);
 
-        patchAccepter.reset(new MockPatchAccepter<GridType>());
+        SharedPtr<MockPatchAccepter<GridType2D> >::Type patchAccepter(
+            new MockPatchAccepter<GridType2D>());
         patchAccepter->pushRequest(2);
-        patchAccepter->pushRequest(10);
-        patchAccepter->pushRequest(13);
+        patchAccepter->pushRequest(3);
+        patchAccepter->pushRequest(9);
+        stepper.addPatchAccepter(patchAccepter, StepperType2D::INNER_SET);
 
-        partitionManager.reset(new PartitionManager<Topology>(rect));
-        // stepper.reset(
-        //     new StepperType(partitionManager, init));
+        stepper.update(11);
+        TS_ASSERT_TEST_GRID(GridType2D, stepper.grid(), 11);
 
-        // stepper->addPatchAccepter(patchAccepter, StepperType::GHOST);
+        std::deque<std::size_t> expected;
+        expected << 2 << 3 << 9;
+        TS_ASSERT_EQUALS(expected, patchAccepter->getOfferedNanoSteps());
+#endif
     }
 
-    void testFoo()
+    void testMatchesVanillaStepper()
     {
 #ifdef LIBGEODECOMP_WITH_THREADS
-        std::cout << "fixme\n";
+        // we take the middle stripe of three, so the Stepper will
+        // have to deal with shrinking inner sets:
+        SharedPtr<TestInitializer<TestCell3D> >::Type init(
+            new TestInitializer<TestCell3D>(Coord<3>(19, 13, 41)));
+        SharedPtr<PartitionManager<Topology3D> >::Type partitionManager =
+            makePartitionManager<Topology3D>(init->gridBox(), 3, 1, 4);
+        StepperType3D stepper(partitionManager, init);
+        ReferenceStepperType referenceStepper(partitionManager, init);
+
+        // force thin slabs to get a proper wavefront:
+        stepper.initSlabs(1);
+        TS_ASSERT_EQUALS(std::size_t(5), stepper.slabs.size());
+        TS_ASSERT_EQUALS(
+            std::size_t(stepper.grid().boundingBox().dimensions.z()),
+            stepper.slabs[1].size());
+
+        std::size_t steps[] = { 1, 2, 5, 11 };
+        for (int i = 0; i < 4; ++i) {
+            stepper.update(steps[i]);
+            referenceStepper.update(steps[i]);
+            TS_ASSERT_EQUALS(referenceStepper.currentStep(), stepper.currentStep());
+            TS_ASSERT_EQUALS(referenceStepper.grid(), stepper.grid());
+        }
 #endif
     }
 
-private:
-    SharedPtr<TestInitializer<TestCell<2> > >::Type init;
-    SharedPtr<PartitionManager<Topology> >::Type partitionManager;
+    void testPeriodicBoundariesDisableBlocking()
+    {
 #ifdef LIBGEODECOMP_WITH_THREADS
-    SharedPtr<StepperType>::Type stepper;
+        SharedPtr<TestInitializer<TestCell3D> >::Type init(
+            new TestInitializer<TestCell3D>(Coord<3>(8, 9, 10)));
+        SharedPtr<PartitionManager<Topology3D> >::Type partitionManager =
+            makePartitionManager<Topology3D>(init->gridBox(), 1, 0, 2);
+        StepperType3D stepper(partitionManager, init);
+
+        TS_ASSERT(stepper.slabs.empty());
+        stepper.update(7);
+        TS_ASSERT_TEST_GRID(StepperType3D::GridType, stepper.grid(), 7);
 #endif
-    SharedPtr<MockPatchAccepter<GridType> >::Type patchAccepter;
+    }
+
+private:
+    template<typename TOPOLOGY>
+    typename SharedPtr<PartitionManager<TOPOLOGY> >::Type makePartitionManager(
+        const CoordBox<TOPOLOGY::DIM>& box,
+        std::size_t numStripes,
+        unsigned rank,
+        unsigned ghostZoneWidth)
+    {
+        const int DIM = TOPOLOGY::DIM;
+        std::vector<std::size_t> weights(numStripes, box.dimensions.prod() / numStripes);
+        weights.back() += box.dimensions.prod() - sum(weights);
+        typename SharedPtr<Partition<DIM> >::Type partition(
+            new StripingPartition<DIM>(Coord<DIM>(), box.dimensions, 0, weights));
+
+        typename SharedPtr<PartitionManager<TOPOLOGY> >::Type partitionManager(
+            new PartitionManager<TOPOLOGY>());
+        partitionManager->resetRegions(
+            makeShared(new DummyAdjacencyManufacturer<DIM>()),
+            box,
+            partition,
+            rank,
+            ghostZoneWidth);
+
+        std::vector<CoordBox<DIM> > boundingBoxes;
+        std::vector<CoordBox<DIM> > expandedBoundingBoxes;
+        for (std::size_t i = 0; i < numStripes; ++i) {
+            boundingBoxes << partitionManager->getRegion(i, 0).boundingBox();
+            expandedBoundingBoxes << partitionManager->getRegion(i, ghostZoneWidth).boundingBox();
+        }
+        partitionManager->resetGhostZones(boundingBoxes, expandedBoundingBoxes);
+
+        return partitionManager;
+    }
 };
 
 }
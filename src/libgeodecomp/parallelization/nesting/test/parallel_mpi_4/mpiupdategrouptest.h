@@ -69,6 +69,22 @@ public:
         TS_ASSERT_EQUALS(actualNanoSteps, expectedNanoSteps);
     }
 
+    void testSharedMemory()
+    {
+        checkUpdate(true, false, false);
+    }
+
+    void testNeighborhoodCollectives()
+    {
+        // shared memory would take precedence for ranks on the same node:
+        checkUpdate(false, true, false);
+    }
+
+    void testZeroCopy()
+    {
+        checkUpdate(false, false, true);
+    }
+
 private:
     std::deque<std::size_t> expectedNanoSteps;
     unsigned rank;
@@ -79,6 +95,39 @@ private:
     SharedPtr<Initializer<TestCell<2> > >::Type init;
     SharedPtr<MPIUpdateGroup<TestCell<2> > >::Type updateGroup;
     SharedPtr<MockPatchAccepter<GridType> >::Type mockPatchAccepter;
+
+    void checkUpdate(bool enableSharedMemory, bool enableNeighborhoodCollectives, bool enableZeroCopy)
+    {
+        // the fixture's PatchLinks use the same tags as ours and
+        // would intercept our patches:
+        updateGroup.reset();
+
+        UpdateGroupType group(
+            partition,
+            CoordBox<2>(Coord<2>(), dimensions),
+            ghostZoneWidth,
+            init,
+            reinterpret_cast<StepperType*>(0),
+            UpdateGroupType::PatchAccepterVec(),
+            UpdateGroupType::PatchAccepterVec(),
+            UpdateGroupType::PatchProviderVec(),
+            UpdateGroupType::PatchProviderVec(),
+            false,
+            MPI_COMM_WORLD,
+            enableSharedMemory,
+            enableNeighborhoodCollectives,
+            enableZeroCopy);
+
+        unsigned nanoSteps = 4 * ghostZoneWidth;
+        group.update(nanoSteps);
+
+        const GridType& grid = group.grid();
+        Region<2> ownRegion = partition->getRegion(rank);
+        for (Region<2>::Iterator i = ownRegion.begin(); i != ownRegion.end(); ++i) {
+            TS_ASSERT(grid[*i].valid());
+            TS_ASSERT_EQUALS(nanoSteps, grid[*i].cycleCounter);
+        }
+    }
 };
 
 }
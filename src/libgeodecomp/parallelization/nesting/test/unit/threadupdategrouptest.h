@@ -0,0 +1,150 @@
+#include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/nesting/threadupdategroup.h>
+#include <libgeodecomp/parallelization/nesting/vanillastepper.h>
+
+#include <cxxtest/TestSuite.h>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <thread>
+#endif
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ThreadUpdateGroupTest : public CxxTest::TestSuite
+{
+public:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    typedef ZCurvePartition<2> PartitionType;
+    typedef VanillaStepper<TestCell<2>, UpdateFunctorHelpers::ConcurrencyNoP> StepperType;
+    typedef ThreadUpdateGroup<TestCell<2> > UpdateGroupType;
+    typedef UpdateGroupType::Exchange Exchange;
+    typedef UpdateGroupType::ExchangePtr ExchangePtr;
+
+    /**
+     * Counts the cells within the group's own region which have
+     * correctly been updated for the given number of nano steps.
+     */
+    class Runner
+    {
+    public:
+        Runner(
+            SharedPtr<PartitionType>::Type partition,
+            SharedPtr<Initializer<TestCell<2> > >::Type init,
+            ExchangePtr exchange,
+            unsigned ghostZoneWidth,
+            unsigned rank,
+            unsigned nanoSteps,
+            int *validCells) :
+            partition(partition),
+            init(init),
+            exchange(exchange),
+            ghostZoneWidth(ghostZoneWidth),
+            rank(rank),
+            nanoSteps(nanoSteps),
+            validCells(validCells)
+        {}
+
+        void operator()()
+        {
+            UpdateGroupType updateGroup(
+                partition,
+                CoordBox<2>(Coord<2>(), init->gridDimensions()),
+                ghostZoneWidth,
+                init,
+                reinterpret_cast<StepperType*>(0),
+                exchange,
+                rank);
+            updateGroup.update(nanoSteps);
+
+            const UpdateGroupType::GridType& grid = updateGroup.grid();
+            Region<2> ownRegion = partition->getRegion(rank);
+            *validCells = 0;
+            for (Region<2>::Iterator i = ownRegion.begin(); i != ownRegion.end(); ++i) {
+                const TestCell<2>& cell = grid[*i];
+                if (cell.valid() && (cell.cycleCounter == nanoSteps)) {
+                    ++*validCells;
+                }
+            }
+        }
+
+    private:
+        SharedPtr<PartitionType>::Type partition;
+        SharedPtr<Initializer<TestCell<2> > >::Type init;
+        ExchangePtr exchange;
+        unsigned ghostZoneWidth;
+        unsigned rank;
+        unsigned nanoSteps;
+        int *validCells;
+    };
+#endif
+
+    void testUpdate()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        Coord<2> dimensions(131, 77);
+        std::vector<std::size_t> weights;
+        weights << 3000
+                << 2000
+                << 2500;
+        weights << dimensions.prod() - sum(weights);
+        std::size_t numThreads = weights.size();
+
+        SharedPtr<PartitionType>::Type partition(
+            new PartitionType(Coord<2>(), dimensions, 0, weights));
+        SharedPtr<Initializer<TestCell<2> > >::Type init(
+            new TestInitializer<TestCell<2> >(dimensions));
+        ExchangePtr exchange(new Exchange(numThreads));
+
+        // the rim is only consistent with the kernel at the end of
+        // a ghost zone cycle:
+        unsigned nanoSteps = 30;
+        std::vector<int> validCells(numThreads, -1);
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < numThreads; ++i) {
+            threads.push_back(std::thread(Runner(partition, init, exchange, 3, i, nanoSteps, &validCells[i])));
+        }
+        for (std::size_t i = 0; i < numThreads; ++i) {
+            threads[i].join();
+        }
+
+        for (std::size_t i = 0; i < numThreads; ++i) {
+            TS_ASSERT_EQUALS(int(weights[i]), validCells[i]);
+        }
+#endif
+    }
+
+    void testMismatchingExchange()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        Coord<2> dimensions(20, 10);
+        std::vector<std::size_t> weights;
+        weights << 100
+                << 100;
+
+        SharedPtr<PartitionType>::Type partition(
+            new PartitionType(Coord<2>(), dimensions, 0, weights));
+        SharedPtr<Initializer<TestCell<2> > >::Type init(
+            new TestInitializer<TestCell<2> >(dimensions));
+        ExchangePtr exchange(new Exchange(3));
+
+        TS_ASSERT_THROWS(
+            UpdateGroupType(
+                partition,
+                CoordBox<2>(Coord<2>(), dimensions),
+                1,
+                init,
+                reinterpret_cast<StepperType*>(0),
+                exchange,
+                0),
+            std::invalid_argument&);
+#endif
+    }
+};
+
+}
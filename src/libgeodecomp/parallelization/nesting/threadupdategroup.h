@@ -0,0 +1,122 @@
+#ifndef LIBGEODECOMP_PARALLELIZATION_NESTING_THREADUPDATEGROUP_H
+#define LIBGEODECOMP_PARALLELIZATION_NESTING_THREADUPDATEGROUP_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_CPP14
+
+#include <libgeodecomp/communication/threadpatchlink.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/parallelization/nesting/updategroup.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * This implementation of the UpdateGroup allows a single process to
+ * host multiple subdomains, each driven by its own thread. Ghost
+ * zones are exchanged via ThreadPatchLinks, i.e. through shared
+ * memory and without MPI. The rank of a group corresponds to its
+ * index within the domain decomposition, all groups need to share
+ * the same Exchange, whose size has to match the number of weights
+ * of the Partition.
+ *
+ * The constructor is collective as the groups need to exchange
+ * their bounding boxes. Each thread should construct and update its
+ * own group, so that the grid memory is first touched (and thus
+ * placed) by the thread that will work on it. Pinning the threads
+ * to cores or NUMA domains is left to the caller. If the groups
+ * share an Initializer, it needs to be thread-safe.
+ */
+template<class CELL_TYPE>
+class ThreadUpdateGroup : public UpdateGroup<CELL_TYPE, ThreadPatchLink>
+{
+public:
+    friend class UpdateGroupPrototypeTest;
+    friend class UpdateGroupTest;
+
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::GridType GridType;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PatchAccepterVec PatchAccepterVec;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PatchProviderVec PatchProviderVec;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PatchLinkAccepter PatchLinkAccepter;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PatchLinkProvider PatchLinkProvider;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::InitPtr InitPtr;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PartitionPtr PartitionPtr;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PatchLinkAccepterPtr PatchLinkAccepterPtr;
+    typedef typename UpdateGroup<CELL_TYPE, ThreadPatchLink>::PatchLinkProviderPtr PatchLinkProviderPtr;
+    typedef typename ThreadPatchLink<GridType>::Exchange Exchange;
+    typedef typename ThreadPatchLink<GridType>::ExchangePtr ExchangePtr;
+
+    using UpdateGroup<CELL_TYPE, ThreadPatchLink>::init;
+    using UpdateGroup<CELL_TYPE, ThreadPatchLink>::rank;
+
+    const static int DIM = UpdateGroup<CELL_TYPE, ThreadPatchLink>::DIM;
+
+    template<typename STEPPER>
+    ThreadUpdateGroup(
+        PartitionPtr partition,
+        const CoordBox<DIM>& box,
+        unsigned ghostZoneWidth,
+        InitPtr initializer,
+        STEPPER *stepperType,
+        ExchangePtr exchange,
+        unsigned rank,
+        PatchAccepterVec patchAcceptersGhost = PatchAccepterVec(),
+        PatchAccepterVec patchAcceptersInner = PatchAccepterVec(),
+        PatchProviderVec patchProvidersGhost = PatchProviderVec(),
+        PatchProviderVec patchProvidersInner = PatchProviderVec(),
+        bool enableFineGrainedParallelism = false) :
+        UpdateGroup<CELL_TYPE, ThreadPatchLink>(ghostZoneWidth, initializer, rank),
+        exchange(exchange)
+    {
+        if (partition->getWeights().size() != exchange->size()) {
+            throw std::invalid_argument("number of subdomains doesn't match size of Exchange");
+        }
+
+        init(
+            partition,
+            box,
+            ghostZoneWidth,
+            initializer,
+            stepperType,
+            patchAcceptersGhost,
+            patchAcceptersInner,
+            patchProvidersGhost,
+            patchProvidersInner,
+            enableFineGrainedParallelism);
+    }
+
+private:
+    ExchangePtr exchange;
+
+    std::vector<CoordBox<DIM> > gatherBoundingBoxes(
+        const CoordBox<DIM>& ownBoundingBox,
+        std::size_t /* unused: size */,
+        std::size_t /* unused: tag */) const
+    {
+        return exchange->allGather(ownBoundingBox, rank);
+    }
+
+    virtual PatchLinkAccepterPtr makePatchLinkAccepter(int target, const Region<DIM>& region)
+    {
+        return PatchLinkAccepterPtr(
+            new PatchLinkAccepter(
+                region,
+                exchange,
+                rank,
+                target));
+    }
+
+    virtual PatchLinkProviderPtr makePatchLinkProvider(int source, const Region<DIM>& region)
+    {
+        return PatchLinkProviderPtr(
+            new PatchLinkProvider(
+                region,
+                exchange,
+                source,
+                rank));
+    }
+};
+
+}
+
+#endif
+#endif
@@ -79,9 +79,14 @@ public:
         }
     }
 
-    const Chronometer& statistics() const
+    /**
+     * Returns the time measurements of the current Stepper,
+     * including those of any Steppers which were retired during
+     * repartitioning.
+     */
+    Chronometer statistics() const
     {
-        return stepper->statistics();
+        return retiredStatistics + stepper->statistics();
     }
 
     void addPatchProvider(
@@ -118,6 +123,54 @@ public:
         return partitionManager->getWeights();
     }
 
+    /**
+     * Replaces the current domain decomposition by newPartition:
+     * cells whose owner changes are migrated to their new ranks,
+     * ghost zone fragments and PatchLinks are rebuilt and a fresh
+     * Stepper resumes the simulation at the current time step.
+     *
+     * This may only be called at the beginning of a time step and
+     * when the Stepper has just synchronized its ghost zones (i.e.
+     * its whole own region is valid). The PatchAccepters/Providers
+     * will be handed to the new Stepper, so they need to be ready to
+     * be called for any nano step following the current one.
+     */
+    template<typename STEPPER>
+    void repartition(
+        PartitionPtr newPartition,
+        const CoordBox<DIM>& box,
+        STEPPER *stepperType,
+        PatchAccepterVec patchAcceptersGhost,
+        PatchAccepterVec patchAcceptersInner,
+        PatchProviderVec patchProvidersGhost,
+        PatchProviderVec patchProvidersInner,
+        bool enableFineGrainedParallelism)
+    {
+        std::pair<int, int> now = currentStep();
+        if (now.second != 0) {
+            throw std::logic_error("repartitioning is only possible at the beginning of a time step");
+        }
+
+        typename SharedPtr<PartitionManagerType>::Type oldPartitionManager = partitionManager;
+        partitionManager.reset(new PartitionManagerType());
+        resetPartitionManager(newPartition, box, ghostZoneWidth, initializer);
+
+        retirePatchLinks();
+        InitPtr migrationInitializer = migrateCells(*oldPartitionManager, now.first);
+
+        retiredStatistics += stepper->statistics();
+        stepper.reset();
+
+        initStepper(
+            migrationInitializer,
+            stepperType,
+            patchAcceptersGhost,
+            patchAcceptersInner,
+            patchProvidersGhost,
+            patchProvidersInner,
+            enableFineGrainedParallelism);
+    }
+
     inline double computeTimeInner() const
     {
         return stepper->computeTimeInner;
@@ -145,6 +198,7 @@ protected:
     unsigned ghostZoneWidth;
     InitPtr initializer;
     unsigned rank;
+    Chronometer retiredStatistics;
 
     /**
      * Actual initialization of the UpdateGroup, can't be done in
@@ -165,6 +219,23 @@ protected:
         PatchProviderVec patchProvidersGhost,
         PatchProviderVec patchProvidersInner,
         bool enableFineGrainedParallelism)
+    {
+        resetPartitionManager(partition, box, ghostZoneWidth, initializer);
+        initStepper(
+            initializer,
+            stepperType,
+            patchAcceptersGhost,
+            patchAcceptersInner,
+            patchProvidersGhost,
+            patchProvidersInner,
+            enableFineGrainedParallelism);
+    }
+
+    void resetPartitionManager(
+        PartitionPtr partition,
+        const CoordBox<DIM>& box,
+        unsigned ghostZoneWidth,
+        InitPtr initializer)
     {
         partitionManager->resetRegions(
             initializer,
@@ -178,11 +249,30 @@ protected:
         std::vector<CoordBox<DIM> > expandedBoundingBoxes =
             gatherBoundingBoxes(partitionManager->ownExpandedRegion().boundingBox(), size, 1);
         partitionManager->resetGhostZones(boundingBoxes, expandedBoundingBoxes);
+    }
 
+    /**
+     * Sets up PatchLinks and Stepper based on the current state of
+     * the PartitionManager. The Stepper will be initialized by
+     * initializer, which is not necessarily identical to the
+     * UpdateGroup's initializer (see repartition()).
+     */
+    template<typename STEPPER>
+    void initStepper(
+        InitPtr initializer,
+        STEPPER *stepperType,
+        PatchAccepterVec patchAcceptersGhost,
+        PatchAccepterVec patchAcceptersInner,
+        PatchProviderVec patchProvidersGhost,
+        PatchProviderVec patchProvidersInner,
+        bool enableFineGrainedParallelism)
+    {
         long firstSyncPoint =
             initializer->startStep() * APITraits::SelectNanoSteps<CELL_TYPE>::VALUE +
             ghostZoneWidth;
 
+        preparePatchLinks();
+
         // We need to create the patch providers first, as the HPX patch
         // accepters will look up their IDs upon creation:
         PatchProviderVec patchLinkProviders;
@@ -224,6 +314,18 @@ protected:
             }
         }
 
+        // goes last so that it will see all other links' patches:
+        PatchLinkAccepterPtr syncPoint = makeSyncPointAccepter();
+        if (syncPoint) {
+            ghostZoneAccepterLinks << syncPoint;
+            patchLinks << syncPoint;
+
+            syncPoint->charge(
+                firstSyncPoint,
+                PatchAccepter<GridType>::infinity(),
+                ghostZoneWidth);
+        }
+
         // notify all PatchAccepters of the process' region:
         for (std::size_t i = 0; i < patchAcceptersGhost.size(); ++i) {
             patchAcceptersGhost[i]->setRegion(partitionManager->ownRegion());
@@ -243,7 +345,7 @@ protected:
         stepper.reset(
             new STEPPER(
                 partitionManager,
-                this->initializer,
+                initializer,
                 patchAcceptersGhost + ghostZoneAccepterLinks,
                 patchAcceptersInner,
                 // add external PatchProviders last to allow them to override
@@ -259,6 +361,59 @@ protected:
         std::size_t size,
         std::size_t tag) const = 0;
 
+    /**
+     * The old links need to complete their pending transmissions
+     * (and drop any pre-posted receives) before cells are migrated
+     * and the new links start to send on the same tags.
+     */
+    inline void retirePatchLinks()
+    {
+        for (typename std::vector<PatchLinkPtr>::iterator i = patchLinks.begin();
+             i != patchLinks.end();
+             ++i) {
+            (*i)->cleanup();
+        }
+
+        patchLinks.clear();
+    }
+
+    /**
+     * Exchanges the cells of the current Stepper's grid according to
+     * the new PartitionManager, so that each rank receives its new
+     * region, including the outer ghost zone. Returns an Initializer
+     * which will set up the grids of the new Stepper from these
+     * cells.
+     *
+     * The old PatchLinks have already been cleaned up on this rank
+     * when this function is called. Implementations must not return
+     * before the same holds for all other ranks.
+     */
+    virtual InitPtr migrateCells(
+        PartitionManagerType& /* unused: oldPartitionManager */,
+        unsigned /* unused: currentStep */)
+    {
+        throw std::logic_error("cell migration not implemented for this UpdateGroup");
+    }
+
+    /**
+     * Called before the PatchLinks are created for the current
+     * PartitionManager, e.g. to set up resources which are shared by
+     * multiple links. Needs to be collective if the resources are.
+     */
+    virtual void preparePatchLinks()
+    {}
+
+    /**
+     * May yield an Accepter which is notified at each sync point
+     * after all PatchLinks have received their patches, e.g. to start
+     * a collective. It will be created on all ranks, even those
+     * without any neighbors.
+     */
+    virtual PatchLinkAccepterPtr makeSyncPointAccepter()
+    {
+        return PatchLinkAccepterPtr();
+    }
+
     virtual PatchLinkAccepterPtr makePatchLinkAccepter(int target, const Region<DIM>& region) = 0;
     virtual PatchLinkProviderPtr makePatchLinkProvider(int source, const Region<DIM>& region) = 0;
 };
@@ -2,6 +2,7 @@
 #define LIBGEODECOMP_PARALLELIZATION_NESTING_VANILLASTEPPER_H
 
 #include <libgeodecomp/parallelization/nesting/commonstepper.h>
+#include <libgeodecomp/storage/serializationbuffer.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 
 namespace LibGeoDecomp {
@@ -13,6 +14,12 @@ namespace LibGeoDecomp {
  * calculation and support wide halos (halos = ghostzones). Ghost
  * zones of width k mean that synchronization only needs to be done
  * every k'th (nano) step.
+ *
+ * Three grids are used: two for the kernel update and a third one
+ * which retains the rim between ghost zone updates. The ghost zone
+ * is advanced in the two grids not holding the kernel, so the kernel
+ * never needs to be saved and restored. Unless the cells use SoA,
+ * the third grid only spans the rims it receives (see ghostRegion()).
  */
 template<typename CELL_TYPE, typename CONCURRENCY_SPEC>
 class VanillaStepper : public CommonStepper<CELL_TYPE>
@@ -29,8 +36,7 @@ public:
     typedef class CommonStepper<CELL_TYPE> ParentType;
     typedef typename ParentType::GridType GridType;
     typedef PartitionManager<Topology> PartitionManagerType;
-    typedef PatchBufferFixed<GridType, GridType, 1> PatchBufferType1;
-    typedef PatchBufferFixed<GridType, GridType, 2> PatchBufferType2;
+    typedef typename SerializationBuffer<CELL_TYPE>::BufferType BufferType;
     typedef typename ParentType::PatchAccepterVec PatchAccepterVec;
     typedef typename ParentType::PatchProviderVec PatchProviderVec;
     typedef typename ParentType::InitPtr InitPtr;
@@ -44,17 +50,15 @@ public:
 
     using ParentType::innerSet;
     using ParentType::remappedInnerSet;
-    using ParentType::saveKernel;
-    using ParentType::restoreRim;
     using ParentType::globalNanoStep;
     using ParentType::rim;
     using ParentType::remappedRim;
     using ParentType::resetValidGhostZoneWidth;
     using ParentType::initGridsCommon;
     using ParentType::getVolatileKernel;
-    using ParentType::saveRim;
     using ParentType::getInnerRim;
-    using ParentType::restoreKernel;
+    using ParentType::makeGrid;
+    using ParentType::copyRegion;
 
     using ParentType::curStep;
     using ParentType::curNanoStep;
@@ -62,8 +66,6 @@ public:
     using ParentType::ghostZoneWidth;
     using ParentType::oldGrid;
     using ParentType::newGrid;
-    using ParentType::rimBuffer;
-    using ParentType::kernelBuffer;
     using ParentType::kernelFraction;
     using ParentType::enableFineGrainedParallelism;
 
@@ -89,13 +91,19 @@ public:
         initGrids();
     }
 
-private:
+protected:
+    typename SharedPtr<GridType>::Type ghostGrid;
+    BufferType rimBuffer;
+    Region<DIM> steeredRegion;
+    BufferType steeredBuffer;
+
     inline void update1()
     {
         using std::swap;
         TimeTotal t(&chronometer);
         unsigned index = ghostZoneWidth() - --validGhostZoneWidth;
         const Region<DIM>& region = remappedInnerSet(index);
+        Tracer::setContext(globalNanoStep(), region);
         {
             TimeComputeInner t(&chronometer);
 
@@ -116,6 +124,17 @@ private:
             }
         }
 
+        finishKernelUpdate();
+    }
+
+    /**
+     * To be called once the kernel has been advanced (and
+     * validGhostZoneWidth has been decreased accordingly): notifies
+     * the inner set PatchAccepters/PatchProviders and updates the
+     * ghost zone once its valid width has been used up.
+     */
+    inline void finishKernelUpdate()
+    {
         this->notifyPatchAccepters(innerSet(ghostZoneWidth()), ParentType::INNER_SET, globalNanoStep());
 
         if (validGhostZoneWidth == 0) {
@@ -123,14 +142,27 @@ private:
             resetValidGhostZoneWidth();
         }
 
-        index = ghostZoneWidth() - validGhostZoneWidth;
+        unsigned index = ghostZoneWidth() - validGhostZoneWidth;
         const Region<DIM>& nextRegion = innerSet(index);
         this->notifyPatchProviders(nextRegion, ParentType::INNER_SET, globalNanoStep());
     }
 
     inline void initGrids()
     {
-        initGridsCommon();
+        CoordBox<DIM> gridBox = initGridsCommon();
+
+        ghostGrid.reset(makeGrid(
+                            partitionManager->ownExpandedRegion(),
+                            ghostGridBox(gridBox, typename APITraits::SelectSoA<CELL_TYPE>::Value()),
+                            initializer->gridDimensions(),
+                            Topology()));
+        {
+            // ghostGrid is only ever read within the rim, see restoreRim():
+            TimeInput t(&chronometer);
+            copyRegion(*oldGrid, &*ghostGrid, rim());
+        }
+        ghostGrid->setEdge(oldGrid->getEdge());
+        rimBuffer = SerializationBuffer<CELL_TYPE>::create(rim());
 
         this->notifyPatchAccepters(
             rim(),
@@ -141,39 +173,42 @@ private:
             ParentType::INNER_SET,
             globalNanoStep());
 
-        saveRim(globalNanoStep());
         updateGhost();
     }
 
     /**
      * computes the next ghost zone at time "t_1 = globalNanoStep() +
      * ghostZoneWidth()". Expects that oldGrid has its kernel and its
-     * outer ghostzone updated to time "globalNanoStep()" and that the
-     * inner ghostzones (rim) at time t_1 can be retrieved from the
-     * internal patch buffer. Will leave oldgrid in a state so that
-     * its whole ownRegion() will be at time t_1 and the rim will be
-     * saved to the patchBuffer at "t2 = t1 + ghostZoneWidth()".
+     * outer ghostzone updated to time "globalNanoStep()" and that
+     * ghostGrid holds the rim at that time. Will leave oldGrid in a
+     * state so that its whole ownRegion() will be at time
+     * globalNanoStep() and ghostGrid will hold the rim at time t_1.
      */
     inline void updateGhost()
     {
-        using std::swap;
+        Tracer::setContext(globalNanoStep(), rim());
         {
             TimeComputeGhost t(&chronometer);
 
-            // fixme: skip all this ghost zone buffering for
-            // ghostZoneWidth == 1?
-
-            // 1: Prepare grid. The following update of the ghostzone will
-            // destroy parts of the kernel, which is why we'll
-            // save/restore those.
-            saveKernel();
-            // We need to restore the rim since it got destroyed while the
-            // kernel was updated.
-            restoreRim(false);
+            // 1: The kernel update has advanced parts of the rim to
+            // intermediate time steps. Its current state is held by
+            // ghostGrid.
+            restoreRim();
         }
 
-        // 2: actual ghostzone update
+        // 2: actual ghostzone update. Step t reads from grid X_t and
+        // writes to X_(t+1) with X_0 = oldGrid. The remaining steps
+        // alternate between newGrid and ghostGrid, ending with
+        // X_(ghostZoneWidth()) = ghostGrid. This leaves the kernel in
+        // oldGrid untouched and no kernel update will overwrite the
+        // new rim.
+        typename SharedPtr<GridType>::Type kernelGrid = oldGrid;
         std::size_t oldNanoStep = curNanoStep;
+        bool steering = patchProvidersPending(ParentType::GHOST_PHASE_1, globalNanoStep());
+        if (steering) {
+            saveSteeredRegion();
+        }
+
         std::size_t oldStep = curStep;
         std::size_t curGlobalNanoStep = globalNanoStep();
 
@@ -184,13 +219,17 @@ private:
             {
                 TimeComputeGhost timer(&chronometer);
 
+                typename SharedPtr<GridType>::Type target =
+                    ((ghostZoneWidth() - t - 1) % 2) ? newGrid : ghostGrid;
+
                 const Region<DIM>& region = remappedRim(t + 1);
+                Tracer::setContext(globalNanoStep(), region);
                 UpdateFunctor<CELL_TYPE, CONCURRENCY_SPEC>()(
                     region,
                     Coord<DIM>(),
                     Coord<DIM>(),
                     *oldGrid,
-                    &*newGrid,
+                    &*target,
                     curNanoStep,
                     CONCURRENCY_SPEC(true, enableFineGrainedParallelism));
 
@@ -200,7 +239,7 @@ private:
                     curStep++;
                 }
 
-                swap(oldGrid, newGrid);
+                oldGrid = target;
 
                 ++curGlobalNanoStep;
             }
@@ -208,20 +247,88 @@ private:
             this->notifyPatchAccepters(rim(ghostZoneWidth()), ParentType::GHOST_PHASE_0, curGlobalNanoStep);
         }
 
-        {
-            TimeComputeGhost t(&chronometer);
+        // 3: restore state for kernel update
+        oldGrid = kernelGrid;
+        if (steering) {
+            restoreSteeredRegion();
+        }
+        curNanoStep = oldNanoStep;
+        curStep = oldStep;
+    }
 
-            saveRim(curGlobalNanoStep);
-            if (ghostZoneWidth() % 2) {
-                swap(oldGrid, newGrid);
-            }
+    /**
+     * External PatchProviders of the ghost phase (e.g. steerers) will
+     * modify oldGrid's rim and volatile kernel prior to the first
+     * ghost step. These changes must not persist, since the
+     * INNER_SET providers will be applied to the kernel separately.
+     */
+    inline void saveSteeredRegion()
+    {
+        steeredRegion = rim() + getVolatileKernel();
+        SerializationBuffer<CELL_TYPE>::resize(&steeredBuffer, steeredRegion.size());
+        oldGrid->saveRegion(&steeredBuffer, steeredRegion);
+    }
 
-            // 3: restore grid for kernel update
-            curNanoStep = oldNanoStep;
-            curStep = oldStep;
-            restoreRim(true);
-            restoreKernel();
+    inline void restoreSteeredRegion()
+    {
+        oldGrid->loadRegion(steeredBuffer, steeredRegion);
+    }
+
+    inline bool patchProvidersPending(
+        const typename ParentType::PatchType& patchType,
+        std::size_t nanoStep) const
+    {
+        for (typename ParentType::PatchProviderList::const_iterator i =
+                 patchProviders[patchType].begin();
+             i != patchProviders[patchType].end();
+             ++i) {
+            if (nanoStep == (*i)->nextAvailableNanoStep()) {
+                return true;
+            }
         }
+
+        return false;
+    }
+
+    /**
+     * The ghost zone update writes to ghostGrid in every other step,
+     * ending with rim(). Rims shrink with each step, so the first of
+     * these yields the region ghostGrid needs to cover. Reads from
+     * ghostGrid never exceed the previously written rim.
+     */
+    inline const Region<DIM>& ghostRegion() const
+    {
+        return rim((std::min)(ghostZoneWidth(), 2 - ghostZoneWidth() % 2));
+    }
+
+    inline CoordBox<DIM> ghostGridBox(const CoordBox<DIM>& /* unused: gridBox */, APITraits::FalseType) const
+    {
+        CoordBox<DIM> ret;
+        OffsetHelper<DIM - 1, DIM, Topology>()(
+            &ret.origin,
+            &ret.dimensions,
+            ghostRegion(),
+            initializer->gridBox());
+
+        return ret;
+    }
+
+    /**
+     * Updates on SoA grids require source and target grid to be of
+     * the same size.
+     */
+    inline CoordBox<DIM> ghostGridBox(const CoordBox<DIM>& gridBox, APITraits::TrueType) const
+    {
+        return gridBox;
+    }
+
+    /**
+     * Copies the rim from ghostGrid to oldGrid.
+     */
+    inline void restoreRim()
+    {
+        ghostGrid->saveRegion(&rimBuffer, rim());
+        oldGrid->loadRegion(rimBuffer, rim());
     }
 };
 
@@ -20,6 +20,13 @@ namespace LibGeoDecomp {
  * This class aims at providing a very simple, but working parallel
  * simulation facility. It's not very modular, it's not fast, but it's
  * simple and it actually works.
+ *
+ * With a ghostZoneWidth of k each node keeps k layers of ghost cells
+ * around its stripe. Those are exchanged only every k nano steps, in
+ * between the nodes redundantly update the shrinking valid part of
+ * their ghost zones. The exchange itself is overlapped with the
+ * update of the stripe's interior. Steerer modifications become
+ * visible to neighboring nodes with the next ghost zone exchange.
  */
 template<typename CELL_TYPE>
 class StripingSimulator : public DistributedSimulator<CELL_TYPE>
@@ -58,11 +65,14 @@ public:
     explicit StripingSimulator(
         Initializer<CELL_TYPE> *initializer,
         LoadBalancer *balancer = 0,
-        unsigned loadBalancingPeriod = 1):
+        unsigned loadBalancingPeriod = 1,
+        unsigned ghostZoneWidth = 1):
         DistributedSimulator<CELL_TYPE>(initializer),
         balancer(balancer),
         partitions(partition(initializer->gridDimensions()[DIM - 1], MPILayer().size())),
-        loadBalancingPeriod(loadBalancingPeriod)
+        loadBalancingPeriod(loadBalancingPeriod),
+        ghostZoneWidth(ghostZoneWidth),
+        validGhostZoneWidth(ghostZoneWidth)
     {
         validateConstructorParams();
 
@@ -77,11 +87,14 @@ public:
     explicit StripingSimulator(
         const InitPtr& initializer,
         LoadBalancer *balancer = 0,
-        unsigned loadBalancingPeriod = 1):
+        unsigned loadBalancingPeriod = 1,
+        unsigned ghostZoneWidth = 1):
         DistributedSimulator<CELL_TYPE>(initializer),
         balancer(balancer),
         partitions(partition(initializer->gridDimensions()[DIM - 1], MPILayer().size())),
-        loadBalancingPeriod(loadBalancingPeriod)
+        loadBalancingPeriod(loadBalancingPeriod),
+        ghostZoneWidth(ghostZoneWidth),
+        validGhostZoneWidth(ghostZoneWidth)
     {
         validateConstructorParams();
 
@@ -141,6 +154,11 @@ public:
         return loadBalancingPeriod;
     }
 
+    inline unsigned getGhostZoneWidth() const
+    {
+        return ghostZoneWidth;
+    }
+
     std::vector<Chronometer> gatherStatistics()
     {
         return mpilayer.gather(chronometer, 0);
@@ -168,6 +186,13 @@ private:
     Region<DIM> innerGhostRegion;
     Region<DIM> remappedInnerRegion;
     Region<DIM> remappedInnerGhostRegion;
+    /**
+     * our stripe, expanded by i layers of ghost cells. Index 0 is
+     * unused as the stripe itself is updated via the inner region
+     * and the inner ghost region.
+     */
+    std::vector<Region<DIM> > expandedRegions;
+    std::vector<Region<DIM> > remappedExpandedRegions;
     std::map<int, Region<DIM> > innerGhostRegions;
     std::map<int, Region<DIM> > outerGhostRegions;
     std::map<int, BufferType>  sendBuffers;
@@ -176,6 +201,9 @@ private:
     // contains the start and stop rows for each node's stripe
     WeightVec partitions;
     unsigned loadBalancingPeriod;
+    unsigned ghostZoneWidth;
+    // number of ghost cell layers in curStripe which are still up to date:
+    unsigned validGhostZoneWidth;
 
     /**
      * these Regions will only be used by the UpdateFunctor. They
@@ -186,6 +214,11 @@ private:
     {
         remappedInnerRegion = curStripe->remapRegion(innerRegion);
         remappedInnerGhostRegion = curStripe->remapRegion(innerGhostRegion);
+
+        remappedExpandedRegions.resize(expandedRegions.size());
+        for (std::size_t i = 1; i < expandedRegions.size(); ++i) {
+            remappedExpandedRegions[i] = curStripe->remapRegion(expandedRegions[i]);
+        }
     }
 
     /**
@@ -277,12 +310,24 @@ private:
         // but this would be a hell to code and debug.
 
         waitForGhostRegions(curStripe);
+
+        // as long as curStripe holds more than one valid ghost layer
+        // we can skip communication and update the remaining ghost
+        // layers alongside our stripe:
+        if (validGhostZoneWidth > 1) {
+            --validGhostZoneWidth;
+            updateExpandedRegion(nanoStep);
+            swapGrids();
+            return;
+        }
+
         recvOuterGhostRegion();
         updateInnerGhostRegion(nanoStep);
         sendInnerGhostRegion(newStripe);
 
         updateInside(nanoStep);
         swapGrids();
+        validGhostZoneWidth = ghostZoneWidth;
     }
 
     void waitForGhostRegions(GridType *stripe)
@@ -389,6 +434,12 @@ private:
         updateRegion(remappedInnerGhostRegion, nanoStep);
     }
 
+    void updateExpandedRegion(unsigned nanoStep)
+    {
+        TimeComputeInner t(&chronometer);
+        updateRegion(remappedExpandedRegions[validGhostZoneWidth], nanoStep);
+    }
+
     void recvOuterGhostRegion()
     {
         TimeCommunication t(&chronometer);
@@ -449,8 +500,17 @@ private:
         region = fillRegion(startRow, endRow);
         {
             SharedPtr<Adjacency>::Type adjacency = initializer->getAdjacency(region);
+            expandedRegions.resize(ghostZoneWidth);
+            for (unsigned i = 1; i < ghostZoneWidth; ++i) {
+                expandedRegions[i] = region.expandWithTopology(
+                    i,
+                    initializer->gridDimensions(),
+                    Topology(),
+                    *adjacency);
+            }
+
             regionWithOuterGhosts = region.expandWithTopology(
-                1,
+                ghostZoneWidth,
                 initializer->gridDimensions(),
                 Topology(),
                 *adjacency);
@@ -467,7 +527,7 @@ private:
                 Region<DIM> otherRegion = fillRegion(startRow, endRow);
                 SharedPtr<Adjacency>::Type adjacency = initializer->getAdjacency(otherRegion);
                 Region<DIM> otherRegionExpanded = otherRegion.expandWithTopology(
-                    1,
+                    ghostZoneWidth,
                     initializer->gridDimensions(),
                     Topology(),
                     *adjacency);
@@ -503,6 +563,7 @@ private:
         initializer->grid(curStripe);
         initializer->grid(newStripe);
         stepNum = initializer->startStep();
+        validGhostZoneWidth = ghostZoneWidth;
         remapUpdateRegions();
     }
 
@@ -525,6 +586,13 @@ private:
         return ret;
     }
 
+    /**
+     * Moves the rows which change their owner to their new owners.
+     * Rows which remain on this node are copied locally while the
+     * transfers are in flight. Afterwards the ghost zones are
+     * refilled, but that exchange will only be completed by the next
+     * nanoStep().
+     */
     void redistributeGrid(const WeightVec& oldPartitions,
                           const WeightVec& newPartitions)
     {
@@ -534,23 +602,29 @@ private:
         }
         initRegions(newPartitions);
         adaptBuffers();
+        setIORegions();
         delete newStripe;
         newStripe = new GridType(regionWithOuterGhosts);
         initializer->grid(newStripe);
 
+        int rank = mpilayer.rank();
+        unsigned oldStartRow = oldPartitions[rank + 0];
+        unsigned oldEndRow   = oldPartitions[rank + 1];
+        unsigned newStartRow = newPartitions[rank + 0];
+        unsigned newEndRow   = newPartitions[rank + 1];
+
         // collect newStripe from others
-        unsigned newStartRow = newPartitions[mpilayer.rank() + 0];
-        unsigned newEndRow =   newPartitions[mpilayer.rank() + 1];
         std::vector<BufferType> receiveBuffers;
         std::vector<Region<DIM> > receiveRegions;
         receiveBuffers.reserve(newPartitions.size() - 1);
 
         for (std::size_t i = 0; i < newPartitions.size() - 1; ++i) {
-            unsigned sourceStartRow = oldPartitions[i];
-            unsigned sourceEndRow   = oldPartitions[i + 1];
+            if (int(i) == rank) {
+                continue;
+            }
 
-            unsigned intersectionStart = (std::max)(newStartRow, sourceStartRow);
-            unsigned intersectionEnd   = (std::min)(newEndRow,   sourceEndRow);
+            unsigned intersectionStart = (std::max)(newStartRow, unsigned(oldPartitions[i]));
+            unsigned intersectionEnd   = (std::min)(newEndRow,   unsigned(oldPartitions[i + 1]));
 
             if (intersectionEnd > intersectionStart) {
                 Region<DIM> intersection = fillRegion(intersectionStart, intersectionEnd);
@@ -568,17 +642,16 @@ private:
         }
 
         // send curStripe to others
-        unsigned oldStartRow = oldPartitions[mpilayer.rank() + 0];
-        unsigned oldEndRow =   oldPartitions[mpilayer.rank() + 1];
         std::vector<BufferType> sendBuffers;
         sendBuffers.reserve(newPartitions.size() - 1);
 
         for (std::size_t i = 0; i < newPartitions.size() - 1; ++i) {
-            unsigned targetStartRow = newPartitions[i];
-            unsigned targetEndRow   = newPartitions[i + 1];
+            if (int(i) == rank) {
+                continue;
+            }
 
-            unsigned intersectionStart = (std::max)(oldStartRow, targetStartRow);
-            unsigned intersectionEnd   = (std::min)(oldEndRow,   targetEndRow);
+            unsigned intersectionStart = (std::max)(oldStartRow, unsigned(newPartitions[i]));
+            unsigned intersectionEnd   = (std::min)(oldEndRow,   unsigned(newPartitions[i + 1]));
 
             if (intersectionEnd > intersectionStart) {
                 Region<DIM> intersection = fillRegion(intersectionStart, intersectionEnd);
@@ -594,6 +667,16 @@ private:
             }
         }
 
+        // rows which we keep don't need to go through MPI:
+        unsigned keptStart = (std::max)(oldStartRow, newStartRow);
+        unsigned keptEnd   = (std::min)(oldEndRow,   newEndRow);
+        if (keptEnd > keptStart) {
+            Region<DIM> kept = fillRegion(keptStart, keptEnd);
+            BufferType buffer = SerializationBuffer<CELL_TYPE>::create(kept);
+            curStripe->saveRegion(&buffer, kept);
+            newStripe->loadRegion(buffer, kept);
+        }
+
         mpilayer.wait(BALANCELOADS);
 
         for (std::size_t i = 0; i < receiveBuffers.size(); ++i) {
@@ -606,6 +689,7 @@ private:
         swapGrids();
         sendInnerGhostRegion(curStripe);
         recvOuterGhostRegion();
+        validGhostZoneWidth = ghostZoneWidth;
 
         remapUpdateRegions();
     }
@@ -636,6 +720,10 @@ private:
                 ") must be positive");
         }
 
+        if (ghostZoneWidth < 1) {
+            throw std::invalid_argument("ghostZoneWidth must be positive");
+        }
+
         // node 0 needs a (central) LoadBalancer...
         if ((mpilayer.rank() == 0) && (balancer.get() == 0)) {
             throw std::invalid_argument(
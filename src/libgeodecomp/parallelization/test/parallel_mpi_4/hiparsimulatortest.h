@@ -63,6 +63,39 @@ private:
     std::size_t cellsSeen;
 };
 
+/**
+ * Deterministically shifts a quarter of the first rank's cells to
+ * the last rank upon each call, so we can test repartitioning
+ * independently of the measured loads.
+ */
+class ShiftingBalancer : public LoadBalancer
+{
+public:
+    virtual WeightVec balance(const WeightVec& weights, const LoadVec& /* relativeLoads */)
+    {
+        WeightVec ret = weights;
+        std::size_t delta = ret.front() / 4;
+        ret.front() -= delta;
+        ret.back()  += delta;
+        return ret;
+    }
+};
+
+/**
+ * Returns weights which lose a cell, which HiParSimulator needs to
+ * reject on all ranks alike.
+ */
+class LeakingBalancer : public LoadBalancer
+{
+public:
+    virtual WeightVec balance(const WeightVec& weights, const LoadVec& /* relativeLoads */)
+    {
+        WeightVec ret = weights;
+        ret.back() -= 1;
+        return ret;
+    }
+};
+
 class HiParSimulatorTest : public CxxTest::TestSuite
 {
 public:
@@ -163,15 +196,108 @@ public:
         TS_ASSERT_EQUALS(dim, grids[t].getDimensions());
 
         if (rank == 0) {
-            std::string expectedEvents;
-            for (int i = 0; i < 2; ++i) {
-                expectedEvents += "balance() [1415, 1415, 1415, 1416] [1, 1, 1, 1]\n";
+            // relative loads are measured at runtime, so we can only
+            // check the weights:
+            StringVec events = StringOps::tokenize(MockBalancer::events, "\n");
+            std::string expectedPrefix = "balance() [1415, 1415, 1415, 1416] [";
+            TS_ASSERT_EQUALS(std::size_t(2), events.size());
+            for (std::size_t i = 0; i < events.size(); ++i) {
+                TS_ASSERT_EQUALS(expectedPrefix, events[i].substr(0, expectedPrefix.size()));
             }
-
-            TS_ASSERT_EQUALS(expectedEvents, MockBalancer::events);
         }
     }
 
+    void testRepartitioning()
+    {
+        TestInitializer<TestCell<2> > *init = new TestInitializer<TestCell<2> >(
+            dim, maxSteps, firstStep);
+        SimulatorType sim(
+            init,
+            new ShiftingBalancer(),
+            7,
+            3);
+        checkRepartitioningRun(&sim);
+    }
+
+    void testSharedMemory()
+    {
+        SimulatorType sim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            new ShiftingBalancer(),
+            7,
+            3);
+        sim.enableSharedMemory();
+        checkRepartitioningRun(&sim);
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+        TS_ASSERT(sim.updateGroup->window);
+#endif
+        TS_ASSERT_THROWS(sim.enableSharedMemory(false), std::logic_error&);
+    }
+
+    void testNeighborhoodCollectives()
+    {
+        SimulatorType sim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            new ShiftingBalancer(),
+            7,
+            3);
+        sim.enableNeighborhoodCollectives();
+        checkRepartitioningRun(&sim);
+
+        TS_ASSERT_EQUALS(
+            bool(MPIUpdateGroup<TestCell<2> >::SupportsCollectives()),
+            bool(sim.updateGroup->exchange));
+    }
+
+    void testZeroCopy()
+    {
+        SimulatorType sim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            new ShiftingBalancer(),
+            7,
+            3);
+        sim.enableZeroCopy();
+        checkRepartitioningRun(&sim);
+
+        TS_ASSERT(sim.updateGroup->enableZeroCopy);
+    }
+
+    void testInvalidWeightsFailOnAllRanks()
+    {
+        TestInitializer<TestCell<2> > *init = new TestInitializer<TestCell<2> >(
+            dim, maxSteps, firstStep);
+        SimulatorType sim(
+            init,
+            new LeakingBalancer(),
+            7,
+            3);
+        TS_ASSERT_THROWS(sim.run(), std::logic_error&);
+    }
+
+    void testRepartitioningWithSteerer()
+    {
+        TestInitializer<TestCell<2> > *init = new TestInitializer<TestCell<2> >(
+            dim, maxSteps, firstStep);
+        SimulatorType sim(
+            init,
+            new ShiftingBalancer(),
+            7,
+            3);
+        sim.addSteerer(new TestSteererType(5, 25, 4711 * 27));
+        sim.run();
+
+        const Region<2> *region = &sim.updateGroup->partitionManager->innerSet(3);
+        const GridBaseType *grid = &sim.updateGroup->grid();
+        int cycle = 101 * 27 + 4711 * 27;
+
+        TS_ASSERT_TEST_GRID_REGION(
+            GridBaseType,
+            *grid,
+            *region,
+            cycle);
+    }
+
     void testSteererCallback()
     {
         SharedPtr<MockSteererType::EventsStore>::Type events(new MockSteererType::EventsStore);
@@ -1492,6 +1618,34 @@ private:
     MockWriter<> *mockWriter;
     MemoryWriterType *memoryWriter;
     std::size_t rank;
+
+    /**
+     * Runs a simulation which uses the ShiftingBalancer and checks
+     * that all time steps are computed correctly across the
+     * repartitionings.
+     */
+    void checkRepartitioningRun(SimulatorType *sim)
+    {
+        MemoryWriterType *writer = new MemoryWriterType(1);
+        sim->addWriter(writer);
+        sim->addWriter(new AccumulatingWriter());
+        sim->run();
+
+        for (unsigned t = firstStep; t <= maxSteps; ++t) {
+            unsigned globalNanoStep = t * NANO_STEPS;
+            MemoryWriterType::GridMap& grids = writer->getGrids();
+            TS_ASSERT_TEST_GRID(
+                MemoryWriterType::GridType,
+                grids[t],
+                globalNanoStep);
+        }
+
+        std::vector<std::size_t> weights = sim->updateGroup->getWeights();
+        TS_ASSERT_EQUALS(std::size_t(4), weights.size());
+        TS_ASSERT(weights.front() < 1415);
+        TS_ASSERT(weights.back()  > 1416);
+        TS_ASSERT_EQUALS(std::size_t(51 * 111), weights[0] + weights[1] + weights[2] + weights[3]);
+    }
 };
 
 }
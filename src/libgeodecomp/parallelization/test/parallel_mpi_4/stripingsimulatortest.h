@@ -463,6 +463,78 @@ public:
             cycle);
     }
 
+    void testWideGhostZones()
+    {
+        // a ghostZoneWidth of 4 exceeds the height of the stripes
+        // (3 rows), so ghost zones will span multiple neighbors:
+        for (unsigned ghostZoneWidth = 2; ghostZoneWidth <= 4; ++ghostZoneWidth) {
+            StripingSimulator<TestCell<2> > sim(
+                init->clone(),
+                rank? 0 : new NoOpBalancer(),
+                1,
+                ghostZoneWidth);
+            TS_ASSERT_EQUALS(ghostZoneWidth, sim.getGhostZoneWidth());
+
+            int cycle = firstCycle;
+            for (int i = 0; i < 10; ++i) {
+                sim.step();
+                cycle += NANO_STEPS;
+
+                TS_ASSERT_TEST_GRID_REGION(
+                    GridBaseType,
+                    *sim.curStripe,
+                    sim.region,
+                    cycle);
+            }
+        }
+    }
+
+    void testWideGhostZonesWithLoadBalancing()
+    {
+        StripingSimulator<TestCell<2> > sim(
+            init->clone(),
+            rank? 0 : new RandomBalancer(),
+            3,
+            3);
+        sim.run();
+
+        int cycle = maxSteps * NANO_STEPS;
+        TS_ASSERT_TEST_GRID_REGION(
+            GridBaseType,
+            *sim.curStripe,
+            sim.region,
+            cycle);
+    }
+
+    void testWideGhostZonesWithSteerer()
+    {
+        StripingSimulator<TestCell<2> > sim(
+            init->clone(),
+            rank? 0 : new NoOpBalancer(),
+            1,
+            3);
+        sim.addSteerer(new TestSteererType(5, 25, 4711 * 27));
+        sim.run();
+
+        int cycle = maxSteps * NANO_STEPS + 4711 * 27;
+        TS_ASSERT_TEST_GRID_REGION(
+            GridBaseType,
+            *sim.curStripe,
+            sim.region,
+            cycle);
+    }
+
+    void testInvalidGhostZoneWidth()
+    {
+        TS_ASSERT_THROWS(
+            StripingSimulator<TestCell<2> > s(
+                new TestInitializer<TestCell<2> >(),
+                rank? 0 : new NoOpBalancer(),
+                1,
+                0),
+            std::invalid_argument&);
+    }
+
 // fixme
 //     void testNonPoDCellLittle()
 //     {
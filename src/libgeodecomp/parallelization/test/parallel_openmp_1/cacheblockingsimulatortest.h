@@ -1,8 +1,8 @@
 #include <cxxtest/TestSuite.h>
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include <libgeodecomp/io/mocksteerer.h>
+#include <libgeodecomp/io/mockwriter.h>
 #include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/io/testwriter.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/misc/testcell.h>
@@ -16,110 +16,156 @@ namespace LibGeoDecomp {
 class CacheBlockingSimulatorTest : public CxxTest::TestSuite
 {
 public:
-    typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Cube<3>::Topology> TestCellType;
+    typedef TestCell<3, Stencils::Moore<3, 1>, Topologies::Cube<3>::Topology> TestCellCube;
+    typedef TestCell<2, Stencils::Moore<2, 1>, Topologies::Torus<2>::Topology> TestCellTorus2D;
+    typedef GridBase<TestCell<3>, 3> GridBaseType;
+    typedef MockSteerer<TestCell<3> > MockSteererType;
 
-    void setUp()
+    static const int NANO_STEPS = APITraits::SelectNanoSteps<TestCell<3> >::VALUE;
+    static const int NANO_STEPS_2D = APITraits::SelectNanoSteps<TestCell<2> >::VALUE;
+
+    void testStep()
+    {
+        CacheBlockingSimulator<TestCell<3> > sim(
+            new TestInitializer<TestCell<3> >(Coord<3>(40, 30, 20), 10, 0),
+            5,
+            Coord<2>(10, 8));
+        // the wavefront's height limits the pipeline length:
+        TS_ASSERT_EQUALS(4, sim.getPipelineLength());
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 0);
+
+        sim.step();
+        TS_ASSERT_EQUALS(unsigned(1), sim.getStep());
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 1 * NANO_STEPS);
+
+        sim.step();
+        sim.step();
+        TS_ASSERT_EQUALS(unsigned(3), sim.getStep());
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 3 * NANO_STEPS);
+    }
+
+    void testRunWithWriter()
+    {
+        int startStep = 3;
+        int endStep = 22;
+        CacheBlockingSimulator<TestCell<3> > sim(
+            new TestInitializer<TestCell<3> >(Coord<3>(31, 27, 11), endStep, startStep),
+            7,
+            Coord<2>(14, 9));
+        TestWriter<TestCell<3> > *writer = new TestWriter<TestCell<3> >(4, startStep, endStep);
+        sim.addWriter(writer);
+
+        sim.run();
+        TS_ASSERT(writer->allEventsDone());
+        TS_ASSERT_EQUALS(unsigned(endStep), sim.getStep());
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), endStep * NANO_STEPS);
+    }
+
+    void testWriterEvents()
+    {
+        SharedPtr<MockWriter<TestCell<3> >::EventsStore>::Type events(
+            new MockWriter<TestCell<3> >::EventsStore);
+        CacheBlockingSimulator<TestCell<3> > sim(
+            new TestInitializer<TestCell<3> >(Coord<3>(20, 20, 20), 17, 2),
+            3,
+            Coord<2>(8, 8));
+        sim.addWriter(new MockWriter<TestCell<3> >(events, 3));
+        sim.run();
+
+        MockWriter<TestCell<3> >::EventsStore expectedEvents;
+        expectedEvents << MockWriter<TestCell<3> >::Event(2, WRITER_INITIALIZED, 0, true);
+        for (unsigned i = 3; i < 17; i += 3) {
+            expectedEvents << MockWriter<TestCell<3> >::Event(i, WRITER_STEP_FINISHED, 0, true);
+        }
+        expectedEvents << MockWriter<TestCell<3> >::Event(17, WRITER_ALL_DONE, 0, true);
+
+        TS_ASSERT_EQUALS(expectedEvents, *events);
+    }
+
+    void testSteererCallback()
+    {
+        SharedPtr<MockSteererType::EventsStore>::Type events(new MockSteererType::EventsStore);
+        CacheBlockingSimulator<TestCell<3> > *sim = new CacheBlockingSimulator<TestCell<3> >(
+            new TestInitializer<TestCell<3> >(Coord<3>(20, 20, 20), 21, 13),
+            4,
+            Coord<2>(10, 10));
+        sim->addSteerer(new MockSteererType(5, events));
+
+        MockSteererType::EventsStore expectedEvents;
+        expectedEvents << MockSteererType::Event(13, STEERER_INITIALIZED, 0, true)
+                       << MockSteererType::Event(15, STEERER_NEXT_STEP, 0, true)
+                       << MockSteererType::Event(20, STEERER_NEXT_STEP, 0, true)
+                       << MockSteererType::Event(21, STEERER_ALL_DONE,  0, true)
+                       << MockSteererType::Event(-1, STEERER_ALL_DONE, -1, true);
+
+        sim->run();
+        delete sim;
+
+        TS_ASSERT_EQUALS(*events, expectedEvents);
+    }
+
+    void testCubeTopology()
+    {
+        typedef GridBase<TestCellCube, 3> GridBaseCube;
+        CacheBlockingSimulator<TestCellCube> sim(
+            new TestInitializer<TestCellCube>(Coord<3>(33, 21, 13), 10, 0),
+            3,
+            Coord<2>(7, 6));
+        TS_ASSERT_EQUALS(3, sim.getPipelineLength());
+
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseCube, *sim.getGrid(), 10 * NANO_STEPS);
+    }
+
+    void test2D()
+    {
+        typedef GridBase<TestCell<2>, 2> GridBase2D;
+        CacheBlockingSimulator<TestCell<2> > sim(
+            new TestInitializer<TestCell<2> >(Coord<2>(47, 13), 3, 0),
+            5,
+            Coord<1>(11));
+        TS_ASSERT_EQUALS(5, sim.getPipelineLength());
+
+        sim.step();
+        TS_ASSERT_TEST_GRID(GridBase2D, *sim.getGrid(), NANO_STEPS_2D);
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBase2D, *sim.getGrid(), 3 * NANO_STEPS_2D);
+    }
+
+    void testTorus2DWithSingleTile()
     {
+        typedef GridBase<TestCellTorus2D, 2> GridBaseTorus2D;
+        CacheBlockingSimulator<TestCellTorus2D> sim(
+            new TestInitializer<TestCellTorus2D>(Coord<2>(12, 30), 2, 0),
+            9,
+            Coord<1>(100));
+        // the gap across the periodic boundary limits the pipeline:
+        TS_ASSERT_EQUALS(6, sim.getPipelineLength());
+
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseTorus2D, *sim.getGrid(), 2 * NANO_STEPS_2D);
     }
 
-    void tearDown()
+    void testNarrowWavefrontFallsBackToStepwiseUpdates()
     {
-        // sim.reset();
+        CacheBlockingSimulator<TestCell<3> > sim(
+            new TestInitializer<TestCell<3> >(Coord<3>(10, 10, 10), 4, 0),
+            5,
+            Coord<2>(1, 1));
+        TS_ASSERT_EQUALS(1, sim.getPipelineLength());
+
+        sim.run();
+        TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 4 * NANO_STEPS);
     }
 
-    void testPipelinedUpdate()
+    void testInvalidParameters()
     {
-//         init(Coord<3>(40, 1, 20));
-
-//         sim->buffer.atEdge() = sim->curGrid->atEdge();
-//         sim->buffer.fill(sim->buffer.boundingBox(), sim->curGrid->getEdgeCell());
-//         sim->fixBufferOrigin(Coord<2>(0, 0));
-//         int i = 0;
-
-//         for (; i < 2 * pipelineLength - 2; ++i) {
-//             int lastStage = (i >> 1) + 1;
-//             sim->pipelinedUpdate(Coord<2>(0, 0), i, i, 0, lastStage);
-//         }
-//         for (; i < dim.z(); ++i) {
-//             sim->pipelinedUpdate(Coord<2>(0, 0), i, i, 0, pipelineLength);
-//         }
-//         for (; i < (dim.z() + 2 * pipelineLength - 2); ++i) {
-//             int firstStage = ((i - dim.z() + 1) >> 1);
-//             sim->pipelinedUpdate(Coord<2>(0, 0), i, i, firstStage, pipelineLength);
-//         }
-//     }
-
-//     void testUpdateWavefront()
-//     {
-//         init(Coord<3>(40, 30, 20));
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 0);
-//         sim->updateWavefront(Coord<2>(0, 0));
-//         sim->updateWavefront(Coord<2>(1, 0));
-//         sim->updateWavefront(Coord<2>(2, 0));
-
-//         sim->updateWavefront(Coord<2>(0, 1));
-//         sim->updateWavefront(Coord<2>(1, 1));
-//         sim->updateWavefront(Coord<2>(2, 1));
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->newGrid), pipelineLength);
-//     }
-
-//     void testHop1()
-//     {
-//         init(Coord<3>(40, 30, 20));
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  0);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  5);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 10);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 15);
-//     }
-
-//     void testHop2()
-//     {
-//         init(Coord<3>(40, 30, 20), 7);
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  0);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  7);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 14);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid), 21);
-//     }
-
-//     void testHop3()
-//     {
-//         init(Coord<3>(40, 30, 20), 1);
-
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  0);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  1);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  2);
-//         sim->hop();
-//         TS_ASSERT_TEST_GRID(CacheBlockingSimulator<TestCellType>::GridType, *(sim->curGrid),  3);
-//     }
-
-// private:
-//     int pipelineLength;
-//     Coord<3> dim;
-//     SharedPtr<CacheBlockingSimulator<TestCellType> >::Type sim;
-
-//     void init(const Coord<3>& gridDim, int newPipelineLength = 5, const Coord<2> wavefrontDim = Coord<2>(16, 16))
-//     {
-//         pipelineLength = newPipelineLength;
-//         dim = gridDim;
-//         sim.reset(new CacheBlockingSimulator<TestCellType>(
-//                       new TestInitializer<TestCellType>(
-//                           dim,
-//                           10000,
-//                           0),
-//                       pipelineLength,
-//                       wavefrontDim));
+        TS_ASSERT_THROWS(
+            CacheBlockingSimulator<TestCell<3> >(new TestInitializer<TestCell<3> >(), 0, Coord<2>(10, 10)),
+            std::invalid_argument&);
+        TS_ASSERT_THROWS(
+            CacheBlockingSimulator<TestCell<3> >(new TestInitializer<TestCell<3> >(), 2, Coord<2>(10, 0)),
+            std::invalid_argument&);
     }
 };
 
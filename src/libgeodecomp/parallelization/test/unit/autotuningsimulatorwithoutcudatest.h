@@ -7,6 +7,8 @@
 #include <libgeodecomp/misc/simplexoptimizer.h>
 #include <libgeodecomp/misc/simulationfactory.h>
 #include <libgeodecomp/misc/simulationparameters.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/tuningcache.h>
 #include <libgeodecomp/parallelization/autotuningsimulator.h>
 #include <sstream>
 
@@ -120,7 +122,7 @@ public:
         params.addParameter("WavefrontHeight", 1, 300);
         params.addParameter("PipelineLength", 1, 25);
 
-        ats.getSimulation("CacheBlockingSimulation")->parameters = params;
+        ats.getSimulation("CacheBlockingSimulator")->parameters = params;
         ats.run();
 #endif
 #endif
@@ -128,9 +130,6 @@ public:
 
     void testInvalidArgumentsForCacheBlockingSim()
     {
-        // fixme
-        return;
-
 #ifdef LIBGEODECOMP_WITH_THREADS
 #ifdef LIBGEODECOMP_WITH_CPP14
         AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(new SimFabTestInitializer(dim, maxSteps));
@@ -157,6 +156,58 @@ public:
 #endif
     }
 
+    void testTrialRunsWithTuningCache()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::string cacheFile = TempFile::serial("tuningcache");
+        TuningCache::Entry entry;
+
+        {
+            AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+                new SimFabTestInitializer(dim, maxSteps), 2);
+            ats.simulations.clear();
+            ats.addSimulation(
+                "SerialSimulation",
+                SerialSimulationFactory<SimFabTestCell>(ats.varStepInitializer));
+            ats.setTrialSteps(2, 1);
+            ats.setTuningCache(cacheFile);
+            ats.run();
+
+            TuningCache cache(cacheFile);
+            TS_ASSERT_EQUALS(std::size_t(1), cache.size());
+            TS_ASSERT(cache.lookup(ats.tuningCacheKey(), &entry));
+            TS_ASSERT_EQUALS("SerialSimulation", entry.simulator);
+            TS_ASSERT(entry.fitness < 0);
+            TS_ASSERT_EQUALS(0, ats.getSimulation("SerialSimulation")->simulationFactory->getTrialSteps());
+        }
+
+        {
+            AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+                new SimFabTestInitializer(dim, maxSteps), 2);
+            ats.simulations.clear();
+            ats.addSimulation(
+                "SerialSimulation",
+                SerialSimulationFactory<SimFabTestCell>(ats.varStepInitializer));
+            ats.setTuningCache(cacheFile);
+            ats.run();
+
+            // a cache hit skips the tuning and reuses the stored fitness:
+            TS_ASSERT_EQUALS(entry.fitness, ats.getSimulation("SerialSimulation")->fitness);
+        }
+
+        remove(cacheFile.c_str());
+#endif
+    }
+
+    void testInvalidTrialSteps()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+            new SimFabTestInitializer(dim, maxSteps));
+        TS_ASSERT_THROWS(ats.setTrialSteps(2, 1, 0), std::invalid_argument&);
+#endif
+    }
+
 private:
     Coord<3> dim;
     unsigned maxSteps;
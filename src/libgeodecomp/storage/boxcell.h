@@ -4,10 +4,13 @@
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/stencils.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/storage/neighborhooditerator.h>
 #include <libgeodecomp/storage/fixedarray.h>
 
+#include <algorithm>
+
 namespace LibGeoDecomp {
 
 /**
@@ -17,6 +20,15 @@ namespace LibGeoDecomp {
  * particles (of type Cargo) which reside in its area in the given
  * CONTAINER type (e.g. LibGeoDecomp::FixedArray or std::vector). Particles can
  * access neighboring particles in a given distance during update().
+ *
+ * If Cargo's API derives from APITraits::HasIncrementalMigration,
+ * the BoxCell bins its particles at the end of each time step by the
+ * container they reside in (itself or one of its neighbors). In the
+ * next time step each BoxCell then only picks up the bins destined
+ * for it instead of testing all neighboring particles. Containers
+ * which haven't been binned (e.g. fresh from the Initializer or
+ * modified via insert()) are still searched exhaustively, as are
+ * particles which matched none of the neighbors (see LOST_GROUP).
  */
 template<typename CONTAINER>
 class BoxCell
@@ -36,6 +48,23 @@ public:
     {};
 
     const static int DIM = Topology::DIM;
+    const static int NANO_STEPS = APITraits::SelectNanoSteps<Cargo>::VALUE;
+
+    /**
+     * Particles are binned into one group per neighbor (in the order
+     * of a CoordBox spanning the neighborhood, center omitted), one
+     * for the particles which stay (RESIDENT_GROUP) and one for
+     * those which lie in none of the neighbors' boxes (LOST_GROUP).
+     * The latter have either left the neighborhood altogether or
+     * were wrapped around a periodic boundary by the model, in which
+     * case their new container lies on the opposite side of the
+     * simulation space. As the neighbors' boxes aren't wrapped, all
+     * neighbors search this group exhaustively.
+     */
+    const static int NUM_NEIGHBORS = Stencils::Moore<DIM, 1>::VOLUME - 1;
+    const static int RESIDENT_GROUP = NUM_NEIGHBORS;
+    const static int LOST_GROUP = NUM_NEIGHBORS + 1;
+    const static int NUM_GROUPS = NUM_NEIGHBORS + 2;
 
     template<
         typename WRITE_CONTAINER,
@@ -52,8 +81,11 @@ public:
         const FloatCoord<DIM>& origin = Coord<DIM>(),
         const FloatCoord<DIM>& dimension = Coord<DIM>()) :
         origin(origin),
-        dimension(dimension)
-    {}
+        dimension(dimension),
+        binned(false)
+    {
+        std::fill(groupOffsets, groupOffsets + NUM_GROUPS + 1, 0);
+    }
 
     inline const_iterator begin() const
     {
@@ -78,11 +110,13 @@ public:
     inline void insert(const Cargo& particle)
     {
         particles << particle;
+        binned = false;
     }
 
     inline void remove(const std::size_t i)
     {
         particles.remove(i);
+        binned = false;
     }
 
     inline std::size_t size() const
@@ -106,6 +140,7 @@ public:
     BoxCell& operator<<(const Cargo& cargo)
     {
         particles << cargo;
+        binned = false;
         return *this;
     }
 
@@ -131,10 +166,14 @@ public:
 
         if (nanoStep == 0) {
             particles.clear();
-            addContainedParticles(ownNeighbors.begin(), ownNeighbors.end());
+            addMigratedParticles(
+                ownNeighbors,
+                typename APITraits::SelectIncrementalMigration<Cargo>::Value());
         } else {
             particles = oldSelf.particles;
         }
+
+        binned = false;
     }
 
     template<class NEIGHBORHOOD_ADAPTER_ALL>
@@ -149,6 +188,12 @@ public:
         for (typename Container::iterator i = particles.begin(); i != end; ++i) {
             i->update(allNeighbors, nanoStep);
         }
+
+        // particles are only rebinned after the last nano step, so
+        // that's when our neighbors will come looking for them:
+        if ((nanoStep + 1) >= NANO_STEPS) {
+            binParticles(typename APITraits::SelectIncrementalMigration<Cargo>::Value());
+        }
     }
 
     const FloatCoord<3>& getDimensions() const
@@ -156,10 +201,48 @@ public:
         return dimension;
     }
 
+    /**
+     * Returns true iff the particles are grouped by the container
+     * they're headed for, see groupBegin() and groupEnd().
+     */
+    inline bool isBinned() const
+    {
+        return binned;
+    }
+
+    inline std::size_t groupBegin(const int group) const
+    {
+        return groupOffsets[group];
+    }
+
+    inline std::size_t groupEnd(const int group) const
+    {
+        return groupOffsets[group + 1];
+    }
+
+    /**
+     * Index of the group of particles destined for the neighbor at
+     * the given offset.
+     */
+    static inline int neighborGroup(const Coord<DIM>& offset)
+    {
+        int index = 0;
+        int stride = 1;
+        for (int d = 0; d < DIM; ++d) {
+            index += (offset[d] + 1) * stride;
+            stride *= 3;
+        }
+
+        // the center is skipped:
+        return (index < (NUM_NEIGHBORS / 2)) ? index : (index - 1);
+    }
+
 protected:
     FloatCoord<DIM> origin;
     FloatCoord<DIM> dimension;
     Container particles;
+    std::size_t groupOffsets[NUM_GROUPS + 1];
+    bool binned;
 
     template<typename ITERATOR>
     void addContainedParticles(const ITERATOR& begin, const ITERATOR& end)
@@ -172,6 +255,105 @@ protected:
             }
         }
     }
+
+    template<class NEIGHBORHOOD_ADAPTER_SELF>
+    inline void addMigratedParticles(
+        NEIGHBORHOOD_ADAPTER_SELF& ownNeighbors,
+        APITraits::FalseType)
+    {
+        addContainedParticles(ownNeighbors.begin(), ownNeighbors.end());
+    }
+
+    template<class NEIGHBORHOOD_ADAPTER_SELF>
+    inline void addMigratedParticles(
+        NEIGHBORHOOD_ADAPTER_SELF& ownNeighbors,
+        APITraits::TrueType)
+    {
+        CoordBox<DIM> box(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
+
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            const BoxCell& neighbor = ownNeighbors.neighbor(*i);
+
+            if (!neighbor.binned) {
+                addContainedParticles(neighbor.particles.begin(), neighbor.particles.end());
+                continue;
+            }
+
+            // the neighbor at offset i files particles for us under -i:
+            int group = (*i == Coord<DIM>()) ? int(RESIDENT_GROUP) : neighborGroup(-*i);
+            for (std::size_t j = neighbor.groupBegin(group); j != neighbor.groupEnd(group); ++j) {
+                particles << neighbor.particles[j];
+            }
+
+            addContainedParticles(
+                neighbor.particles.begin() + neighbor.groupBegin(LOST_GROUP),
+                neighbor.particles.begin() + neighbor.groupEnd(LOST_GROUP));
+        }
+    }
+
+    inline void binParticles(APITraits::FalseType)
+    {}
+
+    /**
+     * In-place bucket sort of all particles by the group they
+     * belong to. Inserting into group g only needs to move the first
+     * particle of each subsequent group to its end, so for
+     * mostly resident particles this boils down to one position
+     * check per particle. Lost particles are kept at the end so our
+     * neighbors can search them.
+     */
+    inline void binParticles(APITraits::TrueType)
+    {
+        std::fill(groupOffsets, groupOffsets + NUM_GROUPS + 1, 0);
+
+        // invariant: particles [0, i) are grouped according to groupOffsets
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            int group = findGroup(particles[i]);
+
+            if (groupOffsets[group + 1] != i) {
+                Cargo particle = particles[i];
+                std::size_t hole = i;
+
+                for (int g = NUM_GROUPS - 1; g > group; --g) {
+                    if (groupOffsets[g] != hole) {
+                        particles[hole] = particles[groupOffsets[g]];
+                        hole = groupOffsets[g];
+                    }
+                }
+
+                particles[hole] = particle;
+            }
+
+            for (int g = group + 1; g <= NUM_GROUPS; ++g) {
+                ++groupOffsets[g];
+            }
+        }
+
+        binned = true;
+    }
+
+    inline int findGroup(const Cargo& particle) const
+    {
+        if (APITraits::SelectPositionChecker<Cargo>::value(particle, origin, origin + dimension)) {
+            return RESIDENT_GROUP;
+        }
+
+        CoordBox<DIM> box(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
+
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            if (*i == Coord<DIM>()) {
+                continue;
+            }
+
+            FloatCoord<DIM> neighborOrigin = origin + dimension.scale(*i);
+            if (APITraits::SelectPositionChecker<Cargo>::value(
+                    particle, neighborOrigin, neighborOrigin + dimension)) {
+                return neighborGroup(*i);
+            }
+        }
+
+        return LOST_GROUP;
+    }
 };
 
 }
@@ -0,0 +1,243 @@
+#ifndef LIBGEODECOMP_STORAGE_COPYPLAN_H
+#define LIBGEODECOMP_STORAGE_COPYPLAN_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/misc/sharedptr.h>
+
+#include <vector>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <mutex>
+#endif
+
+namespace LibGeoDecomp {
+
+/**
+ * A CopyPlan is the precompiled form of a Region for one particular
+ * grid: a list of runs of consecutive elements in the grid's memory,
+ * ordered the same way saveRegion()/loadRegion() lay out cells in a
+ * buffer. Streaks which are adjacent in memory are fused into a
+ * single run. Executing a plan thus boils down to a few bulk copies,
+ * without walking the Region or locating each Streak again.
+ */
+class CopyPlan
+{
+public:
+    class Run
+    {
+    public:
+        inline Run(long offset, long length) :
+            offset(offset),
+            length(length)
+        {}
+
+        // position of the first element in the grid's storage:
+        long offset;
+        long length;
+    };
+
+    typedef std::vector<Run>::const_iterator Iterator;
+
+    inline void push(long offset, long length)
+    {
+        if (!runs.empty() && ((runs.back().offset + runs.back().length) == offset)) {
+            runs.back().length += length;
+            return;
+        }
+
+        runs.push_back(Run(offset, length));
+    }
+
+    inline Iterator begin() const
+    {
+        return runs.begin();
+    }
+
+    inline Iterator end() const
+    {
+        return runs.end();
+    }
+
+    inline std::size_t size() const
+    {
+        return runs.size();
+    }
+
+private:
+    std::vector<Run> runs;
+};
+
+/**
+ * Caches the CopyPlans of the Regions most recently passed to a
+ * grid's saveRegion()/loadRegion(). Regions are identified by their
+ * address and size (plus number of Streaks and bounding box, which
+ * Regions cache, too), so a lookup never needs to compare Streaks.
+ * This presumes that callers pass the same Region object for repeated
+ * transfers (e.g. a PatchLink's Region) and don't reshape it in place
+ * without changing its size or extent. Plans are only built for
+ * Regions which are seen at least twice, so one-off transfers don't
+ * pay for building and storing a plan. A null plan may be stored for
+ * Regions which the grid can't handle via a CopyPlan.
+ *
+ * Plans are specific to the geometry of the grid they were built
+ * for, hence copies of a cache start out empty and grids need to
+ * clear() their cache upon resizing.
+ */
+template<int DIM>
+class CopyPlanCache
+{
+public:
+    typedef SharedPtr<CopyPlan>::Type PlanPtr;
+
+    static const std::size_t CAPACITY = 32;
+
+    inline CopyPlanCache() :
+        next(0),
+        last(0)
+    {}
+
+    inline CopyPlanCache(const CopyPlanCache& /* other */) :
+        next(0),
+        last(0)
+    {}
+
+    inline CopyPlanCache& operator=(const CopyPlanCache& /* other */)
+    {
+        clear();
+        return *this;
+    }
+
+    /**
+     * Returns the plan for region (shifted by offset) or a null
+     * pointer if none is available. Sets buildPlan to true if the
+     * caller should build a plan and insert() it.
+     */
+    inline PlanPtr lookup(const Region<DIM>& region, const Coord<DIM>& offset, bool *buildPlan)
+    {
+        *buildPlan = false;
+        Entry key(region, offset);
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        Entry *entry = find(key);
+        if (entry == 0) {
+            store(key);
+            return PlanPtr();
+        }
+
+        if (!entry->planned) {
+            *buildPlan = true;
+        }
+
+        return entry->plan;
+    }
+
+    inline void insert(const Region<DIM>& region, const Coord<DIM>& offset, const PlanPtr& plan)
+    {
+        Entry key(region, offset);
+        key.planned = true;
+        key.plan = plan;
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        Entry *entry = find(key);
+        if (entry == 0) {
+            store(key);
+            return;
+        }
+
+        *entry = key;
+    }
+
+    inline void clear()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        entries.clear();
+        next = 0;
+        last = 0;
+    }
+
+private:
+    class Entry
+    {
+    public:
+        inline Entry(const Region<DIM>& region, const Coord<DIM>& offset) :
+            region(&region),
+            size(region.size()),
+            numStreaks(region.numStreaks()),
+            boundingBox(region.boundingBox()),
+            offset(offset),
+            planned(false)
+        {}
+
+        inline bool matches(const Entry& other) const
+        {
+            return
+                (region == other.region) &&
+                (size == other.size) &&
+                (numStreaks == other.numStreaks) &&
+                (offset == other.offset) &&
+                (boundingBox == other.boundingBox);
+        }
+
+        const Region<DIM> *region;
+        std::size_t size;
+        std::size_t numStreaks;
+        CoordBox<DIM> boundingBox;
+        Coord<DIM> offset;
+        // false as long as the Region has been seen only once:
+        bool planned;
+        PlanPtr plan;
+    };
+
+    std::vector<Entry> entries;
+    std::size_t next;
+    std::size_t last;
+#ifdef LIBGEODECOMP_WITH_CPP14
+    std::mutex mutex;
+#endif
+
+    /**
+     * Caller needs to hold the lock. Tries the most recent hit first,
+     * as grids tend to see the same Region several times in a row
+     * (e.g. once per neighbor).
+     */
+    inline Entry *find(const Entry& key)
+    {
+        if ((last < entries.size()) && entries[last].matches(key)) {
+            return &entries[last];
+        }
+
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].matches(key)) {
+                last = i;
+                return &entries[i];
+            }
+        }
+
+        return 0;
+    }
+
+    /**
+     * Caller needs to hold the lock. Evicts entries round robin.
+     */
+    inline void store(const Entry& entry)
+    {
+        if (entries.size() < CAPACITY) {
+            entries.push_back(entry);
+            return;
+        }
+
+        entries[next] = entry;
+        next = (next + 1) % CAPACITY;
+    }
+};
+
+}
+
+#endif
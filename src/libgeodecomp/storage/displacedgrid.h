@@ -3,6 +3,7 @@
 
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/storage/copyplan.h>
 #include <libgeodecomp/storage/grid.h>
 
 #include <libgeodecomp/config.h>
@@ -191,12 +192,14 @@ public:
     inline void setOrigin(const Coord<DIM>& newOrigin)
     {
         origin = newOrigin;
+        copyPlans.clear();
     }
 
     inline void resize(const CoordBox<DIM>& box)
     {
         delegate.resize(box.dimensions);
         origin = box.origin;
+        copyPlans.clear();
     }
 
     inline CELL_TYPE& operator[](const Coord<DIM>& absoluteCoord)
@@ -220,9 +223,18 @@ public:
 
     virtual void set(const Streak<DIM>& streak, const CELL_TYPE *cells)
     {
-        delegate.set(Streak<DIM>(streak.origin - origin,
-                                 streak.endX - origin.x()),
-                     cells);
+        Streak<DIM> relativeStreak = relativize(streak);
+        if (delegate.boundingBox().inBounds(relativeStreak)) {
+            delegate.set(relativeStreak, cells);
+            return;
+        }
+
+        // streak wraps around the torus' boundaries:
+        Coord<DIM> cursor = streak.origin;
+        for (; cursor.x() < streak.endX; ++cursor.x()) {
+            (*this)[cursor] = *cells;
+            ++cells;
+        }
     }
 
     virtual CELL_TYPE get(const Coord<DIM>& coord) const
@@ -232,9 +244,17 @@ public:
 
     virtual void get(const Streak<DIM>& streak, CELL_TYPE *cells) const
     {
-        delegate.get(Streak<DIM>(streak.origin - origin,
-                                 streak.endX - origin.x()),
-                     cells);
+        Streak<DIM> relativeStreak = relativize(streak);
+        if (delegate.boundingBox().inBounds(relativeStreak)) {
+            delegate.get(relativeStreak, cells);
+            return;
+        }
+
+        Coord<DIM> cursor = streak.origin;
+        for (; cursor.x() < streak.endX; ++cursor.x()) {
+            *cells = (*this)[cursor];
+            ++cells;
+        }
     }
 
     virtual void setEdge(const CELL_TYPE& cell)
@@ -262,6 +282,12 @@ public:
         const Region<DIM>& region,
         const Coord<DIM>& offset = Coord<DIM>()) const
     {
+        typename CopyPlanCache<DIM>::PlanPtr plan = copyPlan(region, offset);
+        if (plan) {
+            savePlan(buffer, *plan);
+            return;
+        }
+
         typedef DisplacedGridHelpers::NormalizingIterator<TOPOLOGY, TOPOLOGICALLY_CORRECT> NormalizingIterator;
         NormalizingIterator iter(region.beginStreak(offset - origin), topoDimensions);
         delegate.saveRegionImplementation(buffer, iter, region.endStreak(offset - origin));
@@ -283,6 +309,12 @@ public:
         const Region<DIM>& region,
         const Coord<DIM>& offset = Coord<DIM>())
     {
+        typename CopyPlanCache<DIM>::PlanPtr plan = copyPlan(region, offset);
+        if (plan) {
+            loadPlan(buffer, *plan);
+            return;
+        }
+
         typedef DisplacedGridHelpers::NormalizingIterator<TOPOLOGY, TOPOLOGICALLY_CORRECT> NormalizingIterator;
         NormalizingIterator iter(region.beginStreak(offset - origin), topoDimensions);
         delegate.loadRegionImplementation(buffer, iter, region.endStreak(offset - origin));
@@ -421,6 +453,95 @@ protected:
 private:
     Delegate delegate;
     Coord<DIM> origin;
+    mutable CopyPlanCache<DIM> copyPlans;
+
+    /**
+     * Maps a Streak into the delegate's coordinate system.
+     */
+    inline Streak<DIM> relativize(const Streak<DIM>& streak) const
+    {
+        Coord<DIM> relativeOrigin = streak.origin - origin;
+        if (TOPOLOGICALLY_CORRECT) {
+            relativeOrigin = Topology::normalize(relativeOrigin, topoDimensions);
+        }
+        return Streak<DIM>(relativeOrigin, relativeOrigin.x() + streak.length());
+    }
+
+    /**
+     * Yields the cached CopyPlan for the given Region, if any.
+     */
+    typename CopyPlanCache<DIM>::PlanPtr copyPlan(const Region<DIM>& region, const Coord<DIM>& offset) const
+    {
+        bool buildPlan;
+        typename CopyPlanCache<DIM>::PlanPtr plan = copyPlans.lookup(region, offset, &buildPlan);
+        if (!buildPlan) {
+            return plan;
+        }
+
+        typedef DisplacedGridHelpers::NormalizingIterator<TOPOLOGY, TOPOLOGICALLY_CORRECT> NormalizingIterator;
+        NormalizingIterator iter(region.beginStreak(offset - origin), topoDimensions);
+        plan.reset(new CopyPlan);
+        if (!buildCopyPlan(&*plan, iter, region.endStreak(offset - origin))) {
+            plan.reset();
+        }
+
+        copyPlans.insert(region, offset, plan);
+        return plan;
+    }
+
+    /**
+     * Appends the runs of cells covered by the given (relative)
+     * Streaks to plan. Returns false if any Coord maps to the edge
+     * cell, which can't be expressed by a CopyPlan.
+     */
+    template<typename ITER1, typename ITER2>
+    bool buildCopyPlan(CopyPlan *plan, const ITER1& begin, const ITER2& end) const
+    {
+        const CELL_TYPE *base = delegate.data();
+        const CELL_TYPE *limit = base + delegate.getDimensions().prod();
+        CoordBox<DIM> box = delegate.boundingBox();
+
+        for (ITER1 i = begin; i != end; ++i) {
+            Coord<DIM> cursor = i->origin;
+
+            if (box.inBounds(*i)) {
+                plan->push(&delegate[cursor] - base, i->length());
+                continue;
+            }
+
+            for (; cursor.x() < i->endX; ++cursor.x()) {
+                const CELL_TYPE *cell = &delegate[cursor];
+                if ((cell < base) || (cell >= limit)) {
+                    return false;
+                }
+                plan->push(cell - base, 1);
+            }
+        }
+
+        return true;
+    }
+
+    void savePlan(std::vector<CELL_TYPE> *buffer, const CopyPlan& plan) const
+    {
+        CELL_TYPE *target = buffer->data();
+        const CELL_TYPE *base = delegate.data();
+
+        for (CopyPlan::Iterator i = plan.begin(); i != plan.end(); ++i) {
+            std::copy(base + i->offset, base + i->offset + i->length, target);
+            target += i->length;
+        }
+    }
+
+    void loadPlan(const std::vector<CELL_TYPE>& buffer, const CopyPlan& plan)
+    {
+        const CELL_TYPE *source = buffer.data();
+        CELL_TYPE *base = delegate.data();
+
+        for (CopyPlan::Iterator i = plan.begin(); i != plan.end(); ++i) {
+            std::copy(source, source + i->length, base + i->offset);
+            source += i->length;
+        }
+    }
 };
 
 #ifdef _MSC_BUILD
@@ -227,6 +227,26 @@ public:
         saveMemberImplementation(reinterpret_cast<char*>(target), targetLocation, selector, region.beginStreak(), region.endStreak());
     }
 
+    /**
+     * Same as saveMember(), but restricted to the streaks [begin,
+     * end) of a Region. This lets callers process large Regions in
+     * chunks without having to construct a Region per chunk.
+     */
+    template<typename MEMBER>
+    void saveMember(
+        MEMBER *target,
+        MemoryLocation::Location targetLocation,
+        const Selector<CELL>& selector,
+        const typename Region<DIM>::StreakIterator& begin,
+        const typename Region<DIM>::StreakIterator& end) const
+    {
+        if (!selector.template checkTypeID<MEMBER>()) {
+            throw std::invalid_argument("cannot save member as selector was created for different type");
+        }
+
+        saveMemberImplementation(reinterpret_cast<char*>(target), targetLocation, selector, begin, end);
+    }
+
     /**
      * Same as saveMember(), but sans the type checking. Useful in
      * Writers and other components that might not know about the
@@ -27,7 +27,8 @@ class Adapter
         const typename Iterator::Neighborhood *hood) :
         container(container),
         myBegin(Iterator::begin(container, *hood)),
-        myEnd(Iterator::end(container, *hood))
+        myEnd(Iterator::end(container, *hood)),
+        hood(hood)
     {}
 
     inline
@@ -48,10 +49,22 @@ class Adapter
         (*container) << particle;
     }
 
+    /**
+     * Grants direct access to the container at the given offset
+     * (relative to the current cell) within the neighborhood.
+     */
+    template<typename COORD>
+    inline
+    const typename Iterator::Container& neighbor(const COORD& relativeCoord) const
+    {
+        return typename Iterator::CollectionInterfaceType()((*hood)[relativeCoord]);
+    }
+
  private:
     CONTAINER *container;
     Iterator myBegin;
     Iterator myEnd;
+    const typename Iterator::Neighborhood *hood;
 };
 
 
@@ -74,6 +87,7 @@ public:
     friend class NeighborhoodIteratorTest;
 
     typedef NEIGHBORHOOD Neighborhood;
+    typedef COLLECTION_INTERFACE CollectionInterfaceType;
     typedef typename Neighborhood::Cell Cell;
     typedef typename COLLECTION_INTERFACE::Container Container;
     typedef typename COLLECTION_INTERFACE::Container::const_iterator CellIterator;
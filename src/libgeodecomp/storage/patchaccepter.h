@@ -52,6 +52,15 @@ public:
     }
 #endif
 
+    /**
+     * put() may keep reading from the grid after it has returned
+     * (e.g. PatchLink's zero-copy sends). Steppers call this once
+     * they have served all PatchAccepters of a phase and before they
+     * modify the grid again.
+     */
+    virtual void releaseGrid()
+    {}
+
     virtual void setRegion(const Region<DIM>& region)
     {
         // empty as most implementations won't need it anyway.
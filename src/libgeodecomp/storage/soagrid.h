@@ -8,6 +8,7 @@
 #include <libgeodecomp/geometry/topologies.h>
 #include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/misc/stringops.h>
+#include <libgeodecomp/storage/copyplan.h>
 #include <libgeodecomp/storage/gridbase.h>
 #include <libgeodecomp/storage/selector.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
@@ -265,6 +266,103 @@ private:
     long memberOffset;
 };
 
+/**
+ * Translates Streaks (given in the 3D coordinates of the underlying
+ * soa_grid) to runs of indices within the SoA layout.
+ */
+template<typename CELL, typename ITER1, typename ITER2>
+class BuildCopyPlan
+{
+public:
+    BuildCopyPlan(CopyPlan *plan, const ITER1& start, const ITER2& end) :
+        plan(plan),
+        start(start),
+        end(end)
+    {}
+
+    template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
+    void operator()(LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>& /* accessor */) const
+    {
+        typedef LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX> Accessor;
+
+        for (ITER1 i = start; i != end; ++i) {
+            long index = Accessor::gen_index(
+                static_cast<long>(i->origin[0]),
+                static_cast<long>(i->origin[1]),
+                static_cast<long>(i->origin[2]));
+            plan->push(index, i->length());
+        }
+    }
+
+private:
+    CopyPlan *plan;
+    const ITER1& start;
+    const ITER2& end;
+};
+
+/**
+ * Copies all members of the cells referenced by a CopyPlan to a
+ * buffer, like LibFlatArray's save(), but without walking a Region.
+ */
+template<typename CELL>
+class SavePlan
+{
+public:
+    SavePlan(const CopyPlan& plan, char *target, std::size_t count) :
+        plan(plan),
+        target(target),
+        count(count)
+    {}
+
+    template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
+    void operator()(LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>& accessor) const
+    {
+        std::size_t offset = 0;
+
+        for (CopyPlan::Iterator i = plan.begin(); i != plan.end(); ++i) {
+            accessor.index() = i->offset;
+            accessor.save(target, std::size_t(i->length), offset, count);
+            offset += std::size_t(i->length);
+        }
+    }
+
+private:
+    const CopyPlan& plan;
+    char *target;
+    std::size_t count;
+};
+
+/**
+ * Counterpart to SavePlan
+ */
+template<typename CELL>
+class LoadPlan
+{
+public:
+    LoadPlan(const CopyPlan& plan, const char *source, std::size_t count) :
+        plan(plan),
+        source(source),
+        count(count)
+    {}
+
+    template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
+    void operator()(LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>& accessor) const
+    {
+        std::size_t offset = 0;
+
+        for (CopyPlan::Iterator i = plan.begin(); i != plan.end(); ++i) {
+            accessor.index() = i->offset;
+            accessor.load(source, std::size_t(i->length), offset, count);
+            offset += std::size_t(i->length);
+        }
+    }
+
+private:
+    const CopyPlan& plan;
+    const char *source;
+    std::size_t count;
+};
+
 /**
  * This class duplicates some functionality from RegionStreakIterator,
  * but is still necessary as we always need 3D coordinates (because of
@@ -408,6 +506,7 @@ public:
     inline void resize(const CoordBox<DIM>& newBox, bool setEdges)
     {
         box = newBox;
+        copyPlans.clear();
         actualDimensions = Coord<3>::diagonal(1);
         for (int i = 0; i < DIM; ++i) {
             actualDimensions[i] = newBox.dimensions[i];
@@ -531,6 +630,13 @@ public:
         StreakIteratorType start(region.beginStreak(), actualOffset);
         StreakIteratorType end(  region.endStreak(),   actualOffset);
 
+        typename CopyPlanCache<DIM>::PlanPtr plan = copyPlan(region, offset, start, end);
+        if (plan) {
+            SerializationBuffer<CELL>::resize(target, region.size());
+            delegate.callback(SoAGridHelpers::SavePlan<CELL>(*plan, target->data(), region.size()));
+            return;
+        }
+
         saveRegionImplementationInternal(target, start, end, region.size());
     }
 
@@ -559,6 +665,13 @@ public:
         StreakIteratorType start(region.beginStreak(), actualOffset);
         StreakIteratorType end(region.endStreak(), actualOffset);
 
+        typename CopyPlanCache<DIM>::PlanPtr plan = copyPlan(region, offset, start, end);
+        if (plan) {
+            checkSourceSize(source, region.size());
+            delegate.callback(SoAGridHelpers::LoadPlan<CELL>(*plan, source.data(), region.size()));
+            return;
+        }
+
         loadRegionImplementationInternal(source, start, end, region.size());
     }
 
@@ -633,6 +746,12 @@ protected:
 
     template<typename ITER1, typename ITER2>
     inline void loadRegionImplementationInternal(const std::vector<char>& source, const ITER1& start, const ITER2& end, int size)
+    {
+        checkSourceSize(source, size);
+        delegate.load(start, end, source.data(), size);
+    }
+
+    inline void checkSourceSize(const std::vector<char>& source, int size) const
     {
         std::size_t expectedMinimumSize = SerializationBuffer<CELL>::minimumStorageSize(size);
         if (source.size() < expectedMinimumSize) {
@@ -640,8 +759,6 @@ protected:
                 "source buffer too small (is " + StringOps::itoa(source.size()) +
                 ", expected at least: " + StringOps::itoa(expectedMinimumSize) + ")");
         }
-
-        delegate.load(start, end, source.data(), size);
     }
 
     void saveMemberImplementation(
@@ -680,6 +797,29 @@ private:
     Coord<3> actualDimensions;
     CELL edgeCell;
     CoordBox<DIM> box;
+    mutable CopyPlanCache<DIM> copyPlans;
+
+    /**
+     * Yields the cached CopyPlan for the given Region, if any.
+     */
+    template<typename ITER1, typename ITER2>
+    typename CopyPlanCache<DIM>::PlanPtr copyPlan(
+        const Region<DIM>& region,
+        const Coord<DIM>& offset,
+        const ITER1& start,
+        const ITER2& end) const
+    {
+        bool buildPlan;
+        typename CopyPlanCache<DIM>::PlanPtr plan = copyPlans.lookup(region, offset, &buildPlan);
+        if (!buildPlan) {
+            return plan;
+        }
+
+        plan.reset(new CopyPlan);
+        delegate.callback(SoAGridHelpers::BuildCopyPlan<CELL, ITER1, ITER2>(&*plan, start, end));
+        copyPlans.insert(region, offset, plan);
+        return plan;
+    }
 
     CELL delegateGet(const Coord<1>& coord) const
     {
@@ -5,6 +5,8 @@
 #include <libgeodecomp/misc/apitraits.h>
 #include <cxxtest/TestSuite.h>
 
+#include <cmath>
+
 using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
@@ -69,6 +71,93 @@ private:
     int neighbors;
 };
 
+/**
+ * Same as SimpleParticle, but opts into incremental migration.
+ */
+template<int DIM>
+class MigratingParticle : public SimpleParticle<DIM>
+{
+public:
+    class API :
+        public APITraits::HasCubeTopology<DIM>,
+        public APITraits::HasIncrementalMigration
+    {};
+
+    explicit MigratingParticle(
+        const FloatCoord<DIM>& pos = FloatCoord<DIM>(),
+        const double positionFactor = 1.0,
+        const double maxDistance = 0) :
+        SimpleParticle<DIM>(pos, positionFactor, maxDistance)
+    {}
+};
+
+/**
+ * Moves once by the given offset, then sits still.
+ */
+class JumpingParticle
+{
+public:
+    class API :
+        public APITraits::HasCubeTopology<2>,
+        public APITraits::HasIncrementalMigration
+    {};
+
+    explicit JumpingParticle(
+        const FloatCoord<2>& pos = FloatCoord<2>(),
+        const FloatCoord<2>& jump = FloatCoord<2>(),
+        const int id = 0) :
+        pos(pos),
+        jump(jump),
+        id(id)
+    {}
+
+    template<typename HOOD>
+    inline void update(const HOOD& hood, const int nanoStep)
+    {
+        pos += jump;
+        jump = FloatCoord<2>();
+    }
+
+    inline const FloatCoord<2>& getPos() const
+    {
+        return pos;
+    }
+
+    FloatCoord<2> pos;
+    FloatCoord<2> jump;
+    int id;
+};
+
+/**
+ * Moves once by the given offset, wrapping around the boundaries of
+ * a 3x3 torus of unit cells, then sits still.
+ */
+class WrappingParticle : public JumpingParticle
+{
+public:
+    class API :
+        public APITraits::HasTorusTopology<2>,
+        public APITraits::HasIncrementalMigration
+    {};
+
+    explicit WrappingParticle(
+        const FloatCoord<2>& pos = FloatCoord<2>(),
+        const FloatCoord<2>& jump = FloatCoord<2>(),
+        const int id = 0) :
+        JumpingParticle(pos, jump, id)
+    {}
+
+    template<typename HOOD>
+    inline void update(const HOOD& hood, const int nanoStep)
+    {
+        JumpingParticle::update(hood, nanoStep);
+
+        for (int d = 0; d < 2; ++d) {
+            pos[d] = std::fmod(pos[d] + 3.0, 3.0);
+        }
+    }
+};
+
 /**
  * Another simple test particle which simply spawns new particles
  */
@@ -394,6 +483,133 @@ public:
         }
     }
 
+    void testIncrementalMigrationMatchesFullRebinning2D()
+    {
+        typedef BoxCell<FixedArray<MigratingParticle<2>, 30> > MigratingCellType;
+        Grid<MigratingCellType> migratingGrid1(gridDim);
+        Grid<MigratingCellType> migratingGrid2(gridDim);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            migratingGrid1[*i] = MigratingCellType(cellDim.scale(*i), cellDim);
+            for (std::size_t j = 0; j < grid1[*i].size(); ++j) {
+                migratingGrid1[*i].insert(
+                    MigratingParticle<2>(grid1[*i][j].getPos(), 0.95, 2.9));
+            }
+        }
+
+        for (int step = 0; step < 4; ++step) {
+            UpdateFunctor<CellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+            UpdateFunctor<MigratingCellType>()(region, Coord<2>(), Coord<2>(), migratingGrid1, &migratingGrid2, 0);
+            std::swap(grid1, grid2);
+            std::swap(migratingGrid1, migratingGrid2);
+
+            for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+                TS_ASSERT(migratingGrid1[*i].isBinned());
+                TS_ASSERT_EQUALS(grid1[*i].size(), migratingGrid1[*i].size());
+
+                // particle order differs, so we compare sorted keys:
+                std::vector<double> expected;
+                std::vector<double> actual;
+                for (std::size_t j = 0; j < grid1[*i].size(); ++j) {
+                    const SimpleParticle<2>& a = grid1[*i][j];
+                    const SimpleParticle<2>& b = migratingGrid1[*i][j];
+                    expected << (a.getPos()[0] * 1000 + a.getPos()[1]) * 1000 + a.getNeighbors();
+                    actual   << (b.getPos()[0] * 1000 + b.getPos()[1]) * 1000 + b.getNeighbors();
+                }
+                std::sort(expected.begin(), expected.end());
+                std::sort(actual.begin(), actual.end());
+                TS_ASSERT_EQUALS(expected, actual);
+            }
+        }
+    }
+
+    void testIncrementalMigrationBinning()
+    {
+        typedef BoxCell<FixedArray<JumpingParticle, 10> > JumpingCellType;
+        Coord<2> dim(3, 3);
+        CoordBox<2> box(Coord<2>(), dim);
+        Region<2> region;
+        region << box;
+        Grid<JumpingCellType> grid1(dim);
+        Grid<JumpingCellType> grid2(dim);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            grid1[*i] = JumpingCellType(FloatCoord<2>(*i), FloatCoord<2>(1.0, 1.0));
+        }
+        FloatCoord<2> center(1.5, 1.5);
+        grid1[Coord<2>(1, 1)] << JumpingParticle(center, FloatCoord<2>( 1.0,  0.0), 1)
+                              << JumpingParticle(center, FloatCoord<2>( 0.0,  0.0), 2)
+                              << JumpingParticle(center, FloatCoord<2>(-1.0, -1.0), 3)
+                              << JumpingParticle(center, FloatCoord<2>( 5.0,  0.0), 4)
+                              << JumpingParticle(center, FloatCoord<2>( 0.2,  0.0), 5)
+                              << JumpingParticle(center, FloatCoord<2>( 1.0,  0.0), 6);
+        TS_ASSERT(!grid1[Coord<2>(1, 1)].isBinned());
+
+        UpdateFunctor<JumpingCellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        const JumpingCellType& cell = grid2[Coord<2>(1, 1)];
+        TS_ASSERT(cell.isBinned());
+        TS_ASSERT_EQUALS(std::size_t(6), cell.size());
+
+        // the particle which left the neighborhood is kept for an
+        // exhaustive search by our neighbors:
+        int lost = JumpingCellType::LOST_GROUP;
+        TS_ASSERT_EQUALS(std::size_t(1), cell.groupEnd(lost) - cell.groupBegin(lost));
+        TS_ASSERT_EQUALS(4, cell[cell.groupBegin(lost)].id);
+
+        int right = JumpingCellType::neighborGroup(Coord<2>(1, 0));
+        int lowerLeft = JumpingCellType::neighborGroup(Coord<2>(-1, -1));
+        TS_ASSERT_EQUALS(std::size_t(1), cell.groupEnd(lowerLeft) - cell.groupBegin(lowerLeft));
+        TS_ASSERT_EQUALS(3, cell[cell.groupBegin(lowerLeft)].id);
+        TS_ASSERT_EQUALS(std::size_t(2), cell.groupEnd(right) - cell.groupBegin(right));
+        // order within groups is unspecified:
+        TS_ASSERT_EQUALS(1 + 6, cell[cell.groupBegin(right) + 0].id + cell[cell.groupBegin(right) + 1].id);
+
+        int resident = JumpingCellType::RESIDENT_GROUP;
+        TS_ASSERT_EQUALS(std::size_t(2), cell.groupEnd(resident) - cell.groupBegin(resident));
+        TS_ASSERT_EQUALS(2 + 5, cell[cell.groupBegin(resident) + 0].id + cell[cell.groupBegin(resident) + 1].id);
+
+        UpdateFunctor<JumpingCellType>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+        TS_ASSERT_EQUALS(std::size_t(2), grid1[Coord<2>(1, 1)].size());
+        TS_ASSERT_EQUALS(std::size_t(2), grid1[Coord<2>(2, 1)].size());
+        TS_ASSERT_EQUALS(std::size_t(1), grid1[Coord<2>(0, 0)].size());
+        TS_ASSERT_EQUALS(3, grid1[Coord<2>(0, 0)][0].id);
+        TS_ASSERT_EQUALS(std::size_t(0), grid1[Coord<2>(0, 1)].size());
+    }
+
+    void testIncrementalMigrationOnTorus()
+    {
+        typedef BoxCell<FixedArray<WrappingParticle, 10> > WrappingCellType;
+        typedef Grid<WrappingCellType, Topologies::Torus<2>::Topology> WrappingGridType;
+        Coord<2> dim(3, 3);
+        CoordBox<2> box(Coord<2>(), dim);
+        Region<2> region;
+        region << box;
+        WrappingGridType grid1(dim);
+        WrappingGridType grid2(dim);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            grid1[*i] = WrappingCellType(FloatCoord<2>(*i), FloatCoord<2>(1.0, 1.0));
+        }
+        grid1[Coord<2>(2, 1)] << WrappingParticle(FloatCoord<2>(2.5, 1.5), FloatCoord<2>(1.0,  0.0), 1);
+        grid1[Coord<2>(1, 0)] << WrappingParticle(FloatCoord<2>(1.5, 0.5), FloatCoord<2>(0.0, -1.0), 2);
+
+        // the first update bins the wrapped particles...
+        UpdateFunctor<WrappingCellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        // ...the second one needs to hand them across the boundary:
+        UpdateFunctor<WrappingCellType>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+
+        TS_ASSERT_EQUALS(std::size_t(1), grid1[Coord<2>(0, 1)].size());
+        TS_ASSERT_EQUALS(1, grid1[Coord<2>(0, 1)][0].id);
+        TS_ASSERT_EQUALS(std::size_t(1), grid1[Coord<2>(1, 2)].size());
+        TS_ASSERT_EQUALS(2, grid1[Coord<2>(1, 2)][0].id);
+
+        std::size_t total = 0;
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            total += grid1[*i].size();
+        }
+        TS_ASSERT_EQUALS(std::size_t(2), total);
+    }
+
     void testRemove()
     {
         typedef BoxCell<FixedArray<SpawningParticle, 222> > CellType;
@@ -0,0 +1,106 @@
+#include <libgeodecomp/storage/copyplan.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class CopyPlanTest : public CxxTest::TestSuite
+{
+public:
+    void testPushCoalescesAdjacentRuns()
+    {
+        CopyPlan plan;
+        plan.push(10, 5);
+        plan.push(15, 3);
+        plan.push(20, 2);
+        plan.push(22, 1);
+        plan.push(0,  4);
+
+        TS_ASSERT_EQUALS(std::size_t(3), plan.size());
+        CopyPlan::Iterator i = plan.begin();
+        TS_ASSERT_EQUALS(10, i->offset);
+        TS_ASSERT_EQUALS(8,  i->length);
+        ++i;
+        TS_ASSERT_EQUALS(20, i->offset);
+        TS_ASSERT_EQUALS(3,  i->length);
+        ++i;
+        TS_ASSERT_EQUALS(0,  i->offset);
+        TS_ASSERT_EQUALS(4,  i->length);
+        ++i;
+        TS_ASSERT(i == plan.end());
+    }
+
+    void testPlansAreBuiltOnSecondSighting()
+    {
+        CopyPlanCache<2> cache;
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(1, 2), Coord<2>(3, 4));
+        bool buildPlan = true;
+
+        TS_ASSERT(!cache.lookup(region, Coord<2>(), &buildPlan));
+        TS_ASSERT(!buildPlan);
+
+        TS_ASSERT(!cache.lookup(region, Coord<2>(), &buildPlan));
+        TS_ASSERT(buildPlan);
+
+        CopyPlanCache<2>::PlanPtr plan(new CopyPlan);
+        cache.insert(region, Coord<2>(), plan);
+        TS_ASSERT_EQUALS(plan, cache.lookup(region, Coord<2>(), &buildPlan));
+        TS_ASSERT(!buildPlan);
+
+        // different offsets require separate plans:
+        TS_ASSERT(!cache.lookup(region, Coord<2>(1, 0), &buildPlan));
+        TS_ASSERT(!buildPlan);
+    }
+
+    void testRegionsAreKeyedByIdentity()
+    {
+        CopyPlanCache<2> cache;
+        Region<2> region1;
+        region1 << Streak<2>(Coord<2>(0, 0), 2)
+                << Streak<2>(Coord<2>(3, 1), 8);
+        Region<2> region2 = region1;
+        TS_ASSERT_EQUALS(region1, region2);
+
+        bool buildPlan;
+        CopyPlanCache<2>::PlanPtr plan(new CopyPlan);
+        cache.lookup(region1, Coord<2>(), &buildPlan);
+        cache.lookup(region1, Coord<2>(), &buildPlan);
+        TS_ASSERT(buildPlan);
+        cache.insert(region1, Coord<2>(), plan);
+        TS_ASSERT_EQUALS(plan, cache.lookup(region1, Coord<2>(), &buildPlan));
+
+        // equal Regions stored elsewhere don't share the plan:
+        TS_ASSERT(!cache.lookup(region2, Coord<2>(), &buildPlan));
+        TS_ASSERT(!buildPlan);
+
+        // neither does the same Region once it has been modified:
+        region1 << Streak<2>(Coord<2>(0, 2), 1);
+        TS_ASSERT(!cache.lookup(region1, Coord<2>(), &buildPlan));
+        TS_ASSERT(!buildPlan);
+    }
+
+    void testCopiesStartEmpty()
+    {
+        CopyPlanCache<1> cache;
+        Region<1> region;
+        region << Streak<1>(Coord<1>(0), 10);
+        bool buildPlan;
+
+        cache.lookup(region, Coord<1>(), &buildPlan);
+        CopyPlanCache<1> copy(cache);
+        copy.lookup(region, Coord<1>(), &buildPlan);
+        TS_ASSERT(!buildPlan);
+
+        cache.lookup(region, Coord<1>(), &buildPlan);
+        TS_ASSERT(buildPlan);
+
+        cache.clear();
+        cache.lookup(region, Coord<1>(), &buildPlan);
+        TS_ASSERT(!buildPlan);
+    }
+};
+
+}
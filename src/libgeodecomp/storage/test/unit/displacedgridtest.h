@@ -262,6 +262,42 @@ public:
         TS_ASSERT_EQUALS(actual, expected);
     }
 
+    void testGetSetStreakWithTorus()
+    {
+        CoordBox<2> box(Coord<2>(-3, -2), Coord<2>(8, 6));
+        DisplacedGrid<int, Topologies::Torus<2>::Topology, true> grid(
+            box,
+            -2,
+            -2,
+            Coord<2>(15, 10));
+
+        for (int y = -2; y < 4; ++y) {
+            for (int x = -3; x < 5; ++x) {
+                grid[Coord<2>(x, y)] = (y + 3) * 10 + (x + 3);
+            }
+        }
+
+        // this streak wraps around the torus' boundary in x direction:
+        Streak<2> streak(Coord<2>(12, 9), 17);
+        std::vector<int> actual(5);
+        grid.get(streak, &actual[0]);
+
+        std::vector<int> expected;
+        expected << 20 << 21 << 22 << 23 << 24;
+        TS_ASSERT_EQUALS(actual, expected);
+
+        std::vector<int> cells;
+        cells << 1 << 2 << 3 << 4 << 5;
+        grid.set(streak, &cells[0]);
+        TS_ASSERT_EQUALS(1, grid[Coord<2>(-3, -1)]);
+        TS_ASSERT_EQUALS(5, grid[Coord<2>( 1, -1)]);
+
+        // streaks which don't wrap are still handled as a whole:
+        grid.set(Streak<2>(Coord<2>(0, 10), 5), &cells[0]);
+        TS_ASSERT_EQUALS(1, grid[Coord<2>(0, 0)]);
+        TS_ASSERT_EQUALS(5, grid[Coord<2>(4, 0)]);
+    }
+
     void testLoadSaveMember()
     {
         // basic setup:
@@ -434,6 +470,60 @@ public:
         }
     }
 
+    void testRepeatedLoadSaveRegion()
+    {
+        CoordBox<2> box(Coord<2>(10, 20), Coord<2>(30, 15));
+        DisplacedGrid<TestCell<2> > source(box);
+        DisplacedGrid<TestCell<2> > target(box);
+        source.setEdge(TestCell<2>(Coord<2>(-1, -1), Coord<2>(), 0, 4711));
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            source[*i].testValue = i->y() * 100 + i->x();
+        }
+
+        Region<2> inner;
+        inner << CoordBox<2>(Coord<2>(13, 23), Coord<2>(24, 9));
+        Region<2> rim = inner.expand(1) - inner;
+        // this one references the edge cell, so it can't be served
+        // by a CopyPlan:
+        Region<2> outside = inner.expand(4) - inner.expand(3);
+
+        // repeat so that cached CopyPlans get built and used:
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            std::vector<TestCell<2> > buffer(rim.size());
+            source.saveRegion(&buffer, rim);
+            target.loadRegion(buffer, rim);
+
+            for (Region<2>::Iterator i = rim.begin(); i != rim.end(); ++i) {
+                TS_ASSERT_EQUALS(i->y() * 100 + i->x(), target[*i].testValue);
+            }
+
+            buffer.resize(outside.size());
+            source.saveRegion(&buffer, outside);
+            for (std::size_t i = 0; i < buffer.size(); ++i) {
+                TS_ASSERT_EQUALS(4711, buffer[i].testValue);
+            }
+
+            // the same Region with an offset needs a separate plan:
+            buffer.resize(rim.size());
+            source.saveRegion(&buffer, rim, Coord<2>(1, 0));
+            Region<2>::Iterator iter = rim.begin();
+            for (std::size_t i = 0; i < buffer.size(); ++i, ++iter) {
+                double expected = source[*iter + Coord<2>(1, 0)].testValue;
+                TS_ASSERT_EQUALS(expected, buffer[i].testValue);
+            }
+        }
+
+        // moving the grid invalidates its CopyPlans:
+        source.setOrigin(box.origin + Coord<2>(0, 1));
+        std::vector<TestCell<2> > buffer(rim.size());
+        source.saveRegion(&buffer, rim);
+        Region<2>::Iterator iter = rim.begin();
+        for (std::size_t i = 0; i < buffer.size(); ++i, ++iter) {
+            TS_ASSERT_EQUALS((iter->y() - 1) * 100 + iter->x(), buffer[i].testValue);
+        }
+    }
+
     void testLoadSaveRegionWithBoostSerialization()
     {
 #ifdef LIBGEODECOMP_WITH_BOOST_SERIALIZATION
@@ -582,6 +582,56 @@ public:
         }
     }
 
+    void testRepeatedLoadSaveRegion()
+    {
+        Coord<3> origin(5, 7, 3);
+        Coord<3> dim(20, 15, 10);
+        CoordBox<3> box(origin, dim);
+        SoAGrid<TestCellType2, Topology2> source(box);
+        SoAGrid<TestCellType2, Topology2> target(box);
+
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            source.set(*i, TestCellType2(*i, dim, 0, i->toIndex(dim)));
+        }
+
+        Region<3> inner;
+        inner << CoordBox<3>(origin + Coord<3>(2, 2, 2), dim - Coord<3>(4, 4, 4));
+        Region<3> rim = inner.expand(1) - inner;
+        std::vector<char> buffer;
+
+        // repeat so that cached CopyPlans get built and used:
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            source.saveRegion(&buffer, rim);
+            target.loadRegion(buffer, rim);
+
+            for (Region<3>::Iterator i = rim.begin(); i != rim.end(); ++i) {
+                TS_ASSERT_EQUALS(source.get(*i), target.get(*i));
+            }
+
+            source.saveRegion(&buffer, rim, Coord<3>(-1, 0, 0));
+            Region<3> shiftedRim;
+            for (Region<3>::StreakIterator i = rim.beginStreak(); i != rim.endStreak(); ++i) {
+                Streak<3> streak = *i;
+                streak.origin.x() -= 1;
+                streak.endX -= 1;
+                shiftedRim << streak;
+            }
+            target.loadRegion(buffer, shiftedRim);
+
+            for (Region<3>::Iterator i = shiftedRim.begin(); i != shiftedRim.end(); ++i) {
+                TS_ASSERT_EQUALS(source.get(*i).testValue, target.get(*i).testValue);
+            }
+        }
+
+        // plans are invalid after resizing:
+        target.resize(CoordBox<3>(origin, dim + Coord<3>(1, 0, 0)));
+        target.loadRegion(buffer, rim, Coord<3>(-1, 0, 0));
+        for (Region<3>::Iterator i = rim.begin(); i != rim.end(); ++i) {
+            Coord<3> c = *i + Coord<3>(-1, 0, 0);
+            TS_ASSERT_EQUALS(source.get(c).testValue, target.get(c).testValue);
+        }
+    }
+
     void testLoadSaveMember2D()
     {
         // basic setup:
@@ -1,5 +1,6 @@
 #include <mpi.h>
 #include <libgeodecomp.h>
+#include <libgeodecomp/communication/collectivepatchlink.h>
 #include <libgeodecomp/communication/mpilayer.h>
 #include <libgeodecomp/communication/patchlink.h>
 #include <libgeodecomp/geometry/partitions/hilbertpartition.h>
@@ -186,6 +187,139 @@ private:
 
 };
 
+/**
+ * Exchanges the ghost zones of a stack of subdomains which are
+ * distributed along the z-axis (i.e. each rank has two neighbors).
+ * Compares one PatchLink per neighbor and sync point ("gold") to a
+ * single neighborhood collective per sync point ("platinum").
+ */
+template<typename CELL_TYPE>
+class HaloExchangePerfTest : public CPUBenchmark
+{
+public:
+    typedef typename Stepper<CELL_TYPE>::GridType GridType;
+    // CollectivePatchLinks derive from PatchLinks, so we can store both:
+    typedef typename SharedPtr<typename PatchLink<GridType>::Accepter>::Type AccepterPtr;
+    typedef typename SharedPtr<typename PatchLink<GridType>::Provider>::Type ProviderPtr;
+    typedef std::map<int, Region<3> > RegionMap;
+
+    explicit HaloExchangePerfTest(const std::string& modelName, bool useCollectives) :
+        modelName(modelName),
+        useCollectives(useCollectives)
+    {}
+
+    std::string family()
+    {
+        return "HaloExchange<" + modelName + ">";
+    }
+
+    std::string species()
+    {
+        return useCollectives ? "platinum" : "gold";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        MPILayer mpiLayer;
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        int size = mpiLayer.size();
+        int upper = (mpiLayer.rank() + 1) % size;
+        int lower = (mpiLayer.rank() - 1 + size) % size;
+
+        CoordBox<3> gridBox(Coord<3>(), dim);
+        GridType grid(gridBox, CELL_TYPE(), CELL_TYPE(), dim);
+        Region<3> wholeGridRegion;
+        wholeGridRegion << gridBox;
+
+        // with two ranks both neighbors coincide, hence we may need
+        // to merge the slices:
+        RegionMap outgoing;
+        RegionMap incoming;
+        outgoing[upper] << slice(dim, dim.z() - 2);
+        outgoing[lower] << slice(dim, 1);
+        incoming[lower] << slice(dim, 0);
+        incoming[upper] << slice(dim, dim.z() - 1);
+
+        std::vector<AccepterPtr> accepters;
+        std::vector<ProviderPtr> providers;
+        MPI_Datatype datatype = SerializationBuffer<CELL_TYPE>::cellMPIDataType();
+        int maxNanoStep = 201234;
+
+        if (useCollectives) {
+            typedef CollectivePatchLink<GridType> LinkType;
+            typename LinkType::ExchangePtr exchange(new typename LinkType::Exchange(outgoing, incoming, datatype));
+
+            for (RegionMap::iterator i = outgoing.begin(); i != outgoing.end(); ++i) {
+                accepters << AccepterPtr(new typename LinkType::Accepter(i->second, i->first, 666, datatype, exchange));
+            }
+            for (RegionMap::iterator i = incoming.begin(); i != incoming.end(); ++i) {
+                providers << ProviderPtr(new typename LinkType::Provider(i->second, i->first, 666, datatype, exchange));
+            }
+            // starts the collective, hence needs to go last:
+            accepters << AccepterPtr(new typename LinkType::SyncPoint(datatype, exchange));
+        } else {
+            typedef PatchLink<GridType> LinkType;
+
+            for (RegionMap::iterator i = outgoing.begin(); i != outgoing.end(); ++i) {
+                accepters << AccepterPtr(new typename LinkType::Accepter(i->second, i->first, 666, datatype));
+            }
+            for (RegionMap::iterator i = incoming.begin(); i != incoming.end(); ++i) {
+                providers << ProviderPtr(new typename LinkType::Provider(i->second, i->first, 666, datatype));
+            }
+        }
+
+        for (std::size_t i = 0; i < accepters.size(); ++i) {
+            accepters[i]->charge(1234, maxNanoStep, 1000);
+        }
+        for (std::size_t i = 0; i < providers.size(); ++i) {
+            providers[i]->charge(1234, maxNanoStep, 1000);
+        }
+
+        std::size_t cells = 0;
+        for (RegionMap::iterator i = incoming.begin(); i != incoming.end(); ++i) {
+            cells += i->second.size();
+        }
+
+        int repeats = 0;
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            for (int nanoStep = 1234; nanoStep <= maxNanoStep; nanoStep += 1000) {
+                for (std::size_t i = 0; i < accepters.size(); ++i) {
+                    accepters[i]->put(grid, wholeGridRegion, dim, nanoStep, 0);
+                }
+                for (std::size_t i = 0; i < providers.size(); ++i) {
+                    providers[i]->get(&grid, wholeGridRegion, dim, nanoStep, 0, true);
+                }
+                ++repeats;
+            }
+        }
+
+        // PatchLinks are required to be cleaned up before destruction:
+        for (std::size_t i = 0; i < providers.size(); ++i) {
+            providers[i]->cleanup();
+        }
+        mpiLayer.barrier();
+
+        return 2.0 * cells * repeats * sizeof(CELL_TYPE) * 1e-9 / seconds;
+    }
+
+    std::string unit()
+    {
+        return "GB/s";
+    }
+
+private:
+    std::string modelName;
+    bool useCollectives;
+
+    CoordBox<3> slice(const Coord<3>& dim, int z)
+    {
+        return CoordBox<3>(Coord<3>(0, 0, z), Coord<3>(dim.x(), dim.y(), 1));
+    }
+};
+
 template<typename PARTITION>
 class PartitionManagerBig3DPerfTest : public CPUBenchmark
 {
@@ -314,6 +448,12 @@ int main(int argc, char **argv)
     eval(PatchLinkPerfTest<TestCell<3> >("TestCell<3> ", "gold"),                              diag64,  output);
     eval(PatchLinkPerfTest<TestCellSoA>( "TestCell<3> ", "platinum"),                          diag64,  output);
 
+    eval(HaloExchangePerfTest<MySimpleCell>("MySimpleCell", false),                          diag200, output);
+    eval(HaloExchangePerfTest<MySimpleCell>("MySimpleCell", true),                           diag200, output);
+
+    eval(HaloExchangePerfTest<TestCell<3> >("TestCell<3> ", false),                          diag64,  output);
+    eval(HaloExchangePerfTest<TestCell<3> >("TestCell<3> ", true),                           diag64,  output);
+
     eval(PartitionManagerBig3DPerfTest<RecursiveBisectionPartition<3> >("RecursiveBisection"), diag100, output);
     eval(PartitionManagerBig3DPerfTest<ZCurvePartition<3> >("ZCurve"),                         diag100, output);
 
@@ -7,10 +7,13 @@
 #include <libgeodecomp/geometry/floatcoord.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/stencils.h>
+#include <libgeodecomp/geometry/voronoimesher.h>
 #include <libgeodecomp/geometry/partitions/hindexingpartition.h>
 #include <libgeodecomp/geometry/partitions/hilbertpartition.h>
+#include <libgeodecomp/geometry/partitions/hilbertpartition3d.h>
 #include <libgeodecomp/geometry/partitions/stripingpartition.h>
 #include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/storage/containercell.h>
 #include <libgeodecomp/storage/grid.h>
 #include <libgeodecomp/storage/linepointerassembly.h>
 #include <libgeodecomp/storage/linepointerupdatefunctor.h>
@@ -379,6 +382,95 @@ private:
     int expansionWidth;
 };
 
+/**
+ * Unlike the benchmarks above, this one uses Regions with many short
+ * Streaks per row (as they result e.g. from intersecting a Region
+ * with a cell-wise partition) and times just the set operation, not
+ * the setup.
+ */
+class RegionFragmentedOperation : public CPUBenchmark
+{
+public:
+    enum Operation {
+        INTERSECT,
+        SUBTRACT,
+        UNION,
+        EXPAND
+    };
+
+    explicit RegionFragmentedOperation(Operation operation) :
+        operation(operation)
+    {}
+
+    std::string family()
+    {
+        const char *names[] = {
+            "RegionIntersectFrag",
+            "RegionSubtractFrag",
+            "RegionUnionFrag",
+            "RegionExpandFrag"
+        };
+        return names[operation];
+    }
+
+    std::string species()
+    {
+        return "gold";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        double seconds = 0;
+
+        Region<3> r1;
+        Region<3> r2;
+
+        for (int z = 0; z < dim.z(); ++z) {
+            for (int y = 0; y < dim.y(); ++y) {
+                for (int x = (y + z) % 4; x < dim.x(); x += 8) {
+                    r1 << Streak<3>(Coord<3>(x, y, z), x + 4);
+                    r2 << Streak<3>(Coord<3>(x + 2, y, z), x + 7);
+                }
+            }
+        }
+
+        std::size_t sum = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            switch (operation) {
+            case INTERSECT:
+                sum += (r1 & r2).numStreaks();
+                break;
+            case SUBTRACT:
+                sum += (r1 - r2).numStreaks();
+                break;
+            case UNION:
+                sum += (r1 + r2).numStreaks();
+                break;
+            case EXPAND:
+                sum += r1.expand(1).numStreaks();
+                break;
+            }
+        }
+
+        if (sum == 31) {
+            std::cout << "pure debug statement to prevent the compiler from optimizing away the previous operation";
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+
+private:
+    Operation operation;
+};
+
 class RegionExpandWithAdjacency : public CPUBenchmark
 {
 public:
@@ -618,6 +710,127 @@ private:
 };
 
 
+template<int DIM>
+class VoronoiMesherElement
+{
+public:
+    class API :
+        public APITraits::HasCubeTopology<DIM>,
+        public APITraits::HasCoordType<FloatCoord<DIM> >
+    {};
+
+    explicit VoronoiMesherElement(const FloatCoord<DIM>& center = FloatCoord<DIM>(), int id = -1) :
+        center(center),
+        id(id),
+        area(0)
+    {}
+
+    void setArea(double newArea)
+    {
+        area = newArea;
+    }
+
+    void setShape(const std::vector<FloatCoord<DIM> >& newShape)
+    {
+        shape = newShape;
+    }
+
+    void pushNeighbor(int neighborID, double length, const FloatCoord<DIM>& /* dir */)
+    {
+        neighborIDs << neighborID;
+        lengths << length;
+    }
+
+    std::size_t numberOfNeighbors() const
+    {
+        return neighborIDs.size();
+    }
+
+    FloatCoord<DIM> center;
+    int id;
+    double area;
+    std::vector<FloatCoord<DIM> > shape;
+    std::vector<int> neighborIDs;
+    std::vector<double> lengths;
+};
+
+template<int DIM>
+class VoronoiMesherFill : public CPUBenchmark
+{
+public:
+    typedef ContainerCell<VoronoiMesherElement<DIM>, 100> ContainerCellType;
+    typedef Grid<ContainerCellType, typename Topologies::Cube<DIM>::Topology> GridType;
+
+    std::string family()
+    {
+        std::stringstream buf;
+        buf << "VoronoiMesherFill" << DIM << "D";
+        return buf.str();
+    }
+
+    std::string species()
+    {
+        return "gold";
+    }
+
+    /**
+     * The first DIM parameters give the number of container cells
+     * per dimension, the last one the number of elements per
+     * container cell.
+     */
+    double performance(std::vector<int> dim)
+    {
+        Coord<DIM> gridDim;
+        for (int i = 0; i < DIM; ++i) {
+            gridDim[i] = dim[i];
+        }
+        std::size_t elementsPerContainer = dim[DIM];
+
+        GridType grid(gridDim);
+        Mesher mesher(gridDim);
+        CoordBox<DIM> box = grid.boundingBox();
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            mesher.addRandomCells(&grid, *i, elementsPerContainer);
+        }
+
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+            mesher.fillGeometryData(&grid);
+        }
+
+        if (grid[Coord<DIM>()].begin()->area == 4711) {
+            std::cout << "pure debug statement to prevent the compiler from optimizing away the previous function";
+        }
+
+        return seconds;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+
+private:
+    class Mesher : public VoronoiMesher<ContainerCellType>
+    {
+    public:
+        explicit Mesher(const Coord<DIM>& gridDim) :
+            VoronoiMesher<ContainerCellType>(gridDim, FloatCoord<DIM>::diagonal(100), 1),
+            counter(0)
+        {}
+
+        void addCell(ContainerCellType *container, const FloatCoord<DIM>& center)
+        {
+            int id = counter++;
+            container->insert(id, VoronoiMesherElement<DIM>(center, id));
+        }
+
+    private:
+        int counter;
+    };
+};
+
 class CoordEnumerationVanilla : public CPUBenchmark
 {
 public:
@@ -2074,7 +2287,7 @@ public:
     }
 };
 
-template<class PARTITION>
+template<class PARTITION, int DIM = 2>
 class PartitionBenchmark : public CPUBenchmark
 {
 public:
@@ -2094,22 +2307,26 @@ public:
 
     double performance(std::vector<int> rawDim)
     {
-        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
         double duration = 0;
-        Coord<2> accu;
-        Coord<2> realDim(dim.x(), dim.y());
+        Coord<DIM> accu;
+        Coord<DIM> origin;
+        Coord<DIM> realDim;
+        for (int d = 0; d < DIM; ++d) {
+            origin[d] = 100 * (d + 1);
+            realDim[d] = rawDim[d];
+        }
 
         {
             ScopedTimer t(&duration);
 
-            PARTITION h(Coord<2>(100, 200), realDim);
+            PARTITION h(origin, realDim);
             typename PARTITION::Iterator end = h.end();
             for (typename PARTITION::Iterator i = h.begin(); i != end; ++i) {
                 accu += *i;
             }
         }
 
-        if (accu == Coord<2>()) {
+        if (accu == Coord<DIM>()) {
             throw std::runtime_error("oops, partition iteration went bad!");
         }
 
@@ -2125,6 +2342,72 @@ private:
     std::string name;
 };
 
+/**
+ * Measures how long it takes to compute the Regions of all nodes,
+ * which is what PartitionManager does during domain decomposition.
+ */
+template<class PARTITION, int DIM>
+class PartitionGetRegionBenchmark : public CPUBenchmark
+{
+public:
+    explicit PartitionGetRegionBenchmark(const std::string& name, std::size_t numNodes = 64) :
+        name(name),
+        numNodes(numNodes)
+    {}
+
+    std::string species()
+    {
+        return "gold";
+    }
+
+    std::string family()
+    {
+        return name;
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        double duration = 0;
+        Coord<DIM> realDim;
+        for (int d = 0; d < DIM; ++d) {
+            realDim[d] = rawDim[d];
+        }
+
+        std::size_t volume = 1;
+        for (int d = 0; d < DIM; ++d) {
+            volume *= realDim[d];
+        }
+        std::vector<std::size_t> weights(numNodes, volume / numNodes);
+        weights.back() += volume % numNodes;
+
+        std::size_t accu = 0;
+
+        {
+            ScopedTimer t(&duration);
+
+            PARTITION h(Coord<DIM>(), realDim, 0, weights);
+            for (std::size_t i = 0; i < numNodes; ++i) {
+                accu += h.getRegion(i).size();
+            }
+        }
+
+        if (accu != volume) {
+            throw std::runtime_error("oops, partition regions went bad!");
+        }
+
+        return duration;
+    }
+
+    std::string unit()
+    {
+        return "s";
+    }
+
+private:
+    std::string name;
+    std::size_t numNodes;
+};
+
 #ifdef LIBGEODECOMP_WITH_CPP14
 typedef double ValueType;
 const std::size_t MATRICES = 1;
@@ -2847,15 +3130,15 @@ public:
     double performance(std::vector<int> dim)
     {
         CoordBox<3> bigBox(Coord<3>(), Coord<3>(dim[0], dim[0], dim[0]));
-        CoordBox<3> smallBox(Coord<3>(1, 1, 1), Coord<3>::diagonal(dim[0] - 2));
 
         Region<3> region(bigBox);
-        region << CoordBox<3>(Coord<3>(0, 0, 0), Coord<3>(1, dim[0], dim[0]));
-        region << CoordBox<3>(Coord<3>(dim[0] - 1, 0, 0), Coord<3>(1, dim[0], dim[0]));
-        region << CoordBox<3>(Coord<3>(0, 0, 0), Coord<3>(dim[0], 1, dim[0]));
-        region << CoordBox<3>(Coord<3>(0, dim[0] - 1, 0), Coord<3>(dim[0], 1, dim[0]));
-        region << CoordBox<3>(Coord<3>(0, 0, 0), Coord<3>(dim[0], dim[0], 1));
-        region << CoordBox<3>(Coord<3>(0, 0, dim[0] - 1), Coord<3>(dim[0], dim[0], 1));
+        // dim[1] > 0 restricts the transfer to a shell of that
+        // thickness, i.e. the typical shape of a ghost zone:
+        if (dim[1] > 0) {
+            Region<3> interior;
+            interior << CoordBox<3>(Coord<3>::diagonal(dim[1]), Coord<3>::diagonal(dim[0] - 2 * dim[1]));
+            region = region - interior;
+        }
 
         GRID_TYPE grid1(bigBox);
         GRID_TYPE grid2(bigBox);
@@ -3010,6 +3293,18 @@ int main(int argc, char **argv)
     eval(RegionExpand(5), toVector(Coord<3>( 512,  512,  512)));
     eval(RegionExpand(5), toVector(Coord<3>(2048, 2048, 2048)));
 
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::INTERSECT), toVector(Coord<3>(128, 128, 128)));
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::INTERSECT), toVector(Coord<3>(512, 512,  64)));
+
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::SUBTRACT),  toVector(Coord<3>(128, 128, 128)));
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::SUBTRACT),  toVector(Coord<3>(512, 512,  64)));
+
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::UNION),     toVector(Coord<3>(128, 128, 128)));
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::UNION),     toVector(Coord<3>(512, 512,  64)));
+
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::EXPAND),    toVector(Coord<3>(128, 128, 128)));
+    eval(RegionFragmentedOperation(RegionFragmentedOperation::EXPAND),    toVector(Coord<3>(512, 512,  64)));
+
     {
         std::vector<int> params(4);
         int numCells = 2000000;
@@ -3037,6 +3332,21 @@ int main(int argc, char **argv)
         eval(RegionExpandWithAdjacency(cells), params);
     }
 
+    {
+        std::vector<int> params(3);
+        params[0] = 100;
+        params[1] = 100;
+        params[2] = 20;
+        eval(VoronoiMesherFill<2>(), params);
+
+        params.resize(4);
+        params[0] = 10;
+        params[1] = 10;
+        params[2] = 10;
+        params[3] = 50;
+        eval(VoronoiMesherFill<3>(), params);
+    }
+
     eval(CoordEnumerationVanilla(), toVector(Coord<3>( 128,  128,  128)));
     eval(CoordEnumerationVanilla(), toVector(Coord<3>( 512,  512,  512)));
     eval(CoordEnumerationVanilla(), toVector(Coord<3>(2048, 2048, 2048)));
@@ -3110,12 +3420,23 @@ int main(int argc, char **argv)
     eval(PartitionBenchmark<HilbertPartition     >("PartitionHilbert"),   dim);
     eval(PartitionBenchmark<ZCurvePartition<2>   >("PartitionZCurve"),    dim);
 
+    dim = toVector(Coord<3>(512, 512, 512));
+    eval(PartitionBenchmark<StripingPartition<3>, 3>("PartitionStriping3D"), dim);
+    eval(PartitionBenchmark<HilbertPartition3D,   3>("PartitionHilbert3D"),  dim);
+    eval(PartitionBenchmark<ZCurvePartition<3>,   3>("PartitionZCurve3D"),   dim);
+
+    eval(PartitionGetRegionBenchmark<StripingPartition<3>, 3>("PartitionGetRegionStriping3D"), dim);
+    eval(PartitionGetRegionBenchmark<HilbertPartition3D,   3>("PartitionGetRegionHilbert3D"),  dim);
+    eval(PartitionGetRegionBenchmark<ZCurvePartition<3>,   3>("PartitionGetRegionZCurve3D"),   dim);
+
     dim = toVector(Coord<3>(10000, 2000, 0));
     eval(UpdateFunctorThreadingSilver(), dim);
     eval(UpdateFunctorThreadingGold(), dim);
 
     eval(GridLoadSaveRegionAoS(), toVector(Coord<3>(256, 0, 32)));
     eval(GridLoadSaveRegionSoA(), toVector(Coord<3>(256, 0, 32)));
+    eval(GridLoadSaveRegionAoS(), toVector(Coord<3>(128, 2, 200)));
+    eval(GridLoadSaveRegionSoA(), toVector(Coord<3>(128, 2, 200)));
 
 #ifdef LIBGEODECOMP_WITH_CUDA
     cudaTests(name, revision, cudaDevice);